@@ -32,6 +32,7 @@
 #include <atomic>
 
 #include "datactl/frametype.h"
+#include "framepool.h"
 #include "configwindow.h"
 
 SYNTALOS_MODULE(AravisCameraModule)
@@ -48,6 +49,7 @@ private:
     std::shared_ptr<QArvCamera> m_camera;
     std::shared_ptr<QArvDecoder> m_decoder;
     TransformParams *m_tfParams;
+    std::unique_ptr<FrameBufferPool> m_framePool;
 
     int m_expectedWidth;
     int m_expectedHeight;
@@ -63,6 +65,7 @@ public:
 
         m_outStream = registerOutputPort<Frame>(QStringLiteral("video"), QStringLiteral("Video"));
         m_modIcon = modInfo->icon();
+        m_framePool = std::make_unique<FrameBufferPool>(QStringLiteral("camera-arv"));
     }
 
     bool initialize() final
@@ -133,6 +136,12 @@ public:
         m_outStream->setMetadataValue("size", MetaSize(outWidth, outHeight));
         m_outStream->setMetadataValue("framerate", m_camera->getFPS());
 
+        // have a few frame buffers ready before the first frame arrives (rotated frames
+        // have the same size, so they share these buffers)
+        m_framePool->resetStats();
+        if (m_decoder)
+            m_framePool->reserve(m_expectedHeight, m_expectedWidth, m_decoder->cvType(), 4);
+
         // start the stream
         m_outStream->start();
 
@@ -234,31 +243,42 @@ public:
                 return;
             }
 
+            // The decoder reuses its output buffer for every frame, so the frame we emit is
+            // written into a buffer from our pool that downstream modules can hold on to.
+            auto frameMat = m_framePool->acquire(img.rows, img.cols, img.type());
             if (m_tfParams->invert) {
                 int bits = img.depth() == CV_8U ? 8 : 16;
-                cv::subtract((1 << bits) - 1, img, img);
+                cv::subtract((1 << bits) - 1, img, frameMat);
+            } else {
+                img.copyTo(frameMat);
             }
 
             if (m_tfParams->flip != -100)
-                cv::flip(img, img, m_tfParams->flip);
+                cv::flip(frameMat, frameMat, m_tfParams->flip);
 
             switch (m_tfParams->rot) {
-            case 1:
-                cv::transpose(img, img);
-                cv::flip(img, img, 0);
+            case 1: {
+                auto rotated = m_framePool->acquire(frameMat.cols, frameMat.rows, frameMat.type());
+                cv::transpose(frameMat, rotated);
+                cv::flip(rotated, rotated, 0);
+                frameMat = rotated;
                 break;
+            }
 
             case 2:
-                cv::flip(img, img, -1);
+                cv::flip(frameMat, frameMat, -1);
                 break;
 
-            case 3:
-                cv::transpose(img, img);
-                cv::flip(img, img, 1);
+            case 3: {
+                auto rotated = m_framePool->acquire(frameMat.cols, frameMat.rows, frameMat.type());
+                cv::transpose(frameMat, rotated);
+                cv::flip(rotated, rotated, 1);
+                frameMat = rotated;
                 break;
             }
+            }
 
-            m_outStream->push(Frame(img, acqState->frameCount++, masterTime));
+            m_outStream->push(Frame(frameMat, acqState->frameCount++, masterTime));
             acqState->fpsWindowFrameCount++;
         });
 
@@ -338,6 +358,15 @@ public:
         }
 
         m_configWindow->setCameraInUseExternal(false);
+
+        const auto poolStats = m_framePool->stats();
+        LOG_DEBUG(
+            m_log,
+            "Frame buffer pool: {} reused, {} newly allocated, {} MiB held",
+            poolStats.hits,
+            poolStats.misses,
+            poolStats.bytesMapped / (1024 * 1024));
+
         statusMessage("Camera stopped.");
         AbstractModule::stop();
     }
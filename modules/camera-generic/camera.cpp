@@ -30,6 +30,8 @@
 #include <opencv2/videoio.hpp>
 #include <sys/ioctl.h>
 
+#include "framepool.h"
+
 struct CameraPropertyInfo {
     int id;
     const char *name;
@@ -111,6 +113,10 @@ public:
 
     uint droppedFrameCount;
     QString lastError;
+
+    // recycles frame buffers once all downstream modules are done with a frame
+    std::unique_ptr<FrameBufferPool> framePool;
+    int frameType{CV_8UC3}; // pixel type the backend delivered for the last frame
 };
 #pragma GCC diagnostic pop
 
@@ -138,6 +144,7 @@ Camera::Camera(QuillLogger *logger)
     d->autoExposureRaw = 1;
 
     d->cam = new cv::VideoCapture();
+    d->framePool = std::make_unique<FrameBufferPool>(QStringLiteral("camera-generic"));
 }
 
 Camera::~Camera()
@@ -418,8 +425,17 @@ bool Camera::connect()
 void Camera::disconnect()
 {
     d->cam->release();
-    if (d->connected)
+    if (d->connected) {
+        const auto poolStats = d->framePool->stats();
         LOG_INFO(d->log, "Disconnected camera {}", d->camId);
+        LOG_DEBUG(
+            d->log,
+            "Frame buffer pool: {} reused, {} newly allocated, {} MiB held",
+            poolStats.hits,
+            poolStats.misses,
+            poolStats.bytesMapped / (1024 * 1024));
+        d->framePool->resetStats();
+    }
     d->connected = false;
     d->activeFps = d->fps;
 }
@@ -530,8 +546,12 @@ bool Camera::recordFrame(Frame &frame, SecondaryClockSynchronizer *clockSync)
     }
 
     try {
-        cv::Mat mat;
+        // retrieve into a pooled buffer - if the backend's frame matches its geometry, it is written
+        // in place, otherwise OpenCV reallocates it from the same pool
+        cv::Mat mat = d->framePool->acquire(d->frameSize.height, d->frameSize.width, d->frameType);
         status = d->cam->retrieve(mat);
+        if (status)
+            d->frameType = mat.type();
         frame.mat = mat;
     } catch (const cv::Exception &e) {
         status = false;
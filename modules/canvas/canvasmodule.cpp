@@ -54,6 +54,7 @@ private:
     // Stream FPS tracking
     symaster_timepoint m_lastStreamCalcTime;
     uint32_t m_streamedFramesSinceLastCalc{};
+    uint64_t m_lastEnqueuedCount{};
     double m_expectedFps{};
     double m_currentFpsEma{}; // Exponential moving average of stream FPS
 
@@ -92,8 +93,15 @@ public:
     {
         m_frameSub.reset();
         m_ctlSub.reset();
-        if (m_framesIn->hasSubscription())
+        if (m_framesIn->hasSubscription()) {
             m_frameSub = m_framesIn->subscription();
+
+            // We only ever display the most recent frame, so the source just replaces the frame
+            // we have not picked up yet instead of queueing it. No matter how fast the source
+            // runs, at most one frame is ever waiting for us. This has to be set up before any
+            // module starts producing data.
+            m_frameSub->setLatestValueOnly(true);
+        }
         if (m_ctlIn->hasSubscription())
             m_ctlSub = m_ctlIn->subscription();
 
@@ -131,12 +139,7 @@ public:
         m_currentDisplayFps = m_targetDisplayFps;
         m_avgDisplayTimeMs = 1000.0 / m_targetDisplayFps;
 
-        // Stable, coarse cap on the producer to trim extreme upstream rates and avoid
-        // pointless enqueue churn. The precise rate limiting is done on our side by
-        // draining the queue down to the most recent frame on every pass, so this
-        // value never needs to adapt - the headroom just keeps a fresh frame ready
-        // for each display tick.
-        m_frameSub->setThrottleItemsPerSec(static_cast<uint>(std::ceil(m_targetDisplayFps * 2)));
+        m_lastEnqueuedCount = m_frameSub->enqueuedCount();
 
         auto imgWinTitle = qstr(m_frameSub->metadataValue<std::string>(CommonMetadataKey::SrcModName, {}));
         if (imgWinTitle.isEmpty())
@@ -160,28 +163,21 @@ public:
             }
 
             if (m_paused) {
-                // keep the queue empty while paused, so we don't accumulate a backlog
+                // drop the waiting frame while paused, so we don't show a stale one on resume
                 m_frameSub->clearPending();
+                m_lastEnqueuedCount = m_frameSub->enqueuedCount();
                 return;
             }
         }
 
-        // Drain the whole queue, keeping only the most recent frame. This exists
-        // so we never build up a backlog: no matter how fast the source runs,
-        // the queue is emptied on every pass and we only ever display the freshest
-        // frame. Every drained frame still counts towards the measured stream rate.
-        std::optional<Frame> latest;
-        uint drainedCount = 0;
-        while (auto maybeFrame = m_frameSub->peekNext()) {
-            latest = std::move(maybeFrame);
-            ++drainedCount;
-        }
+        // Pick up the freshest frame, if a new one arrived since the last pass
+        auto latest = m_frameSub->peekNext();
 
-        // Count ALL frames that arrived from the source: the ones we just drained
-        // plus the ones the producer-side throttle already dropped. This gives the
-        // true source rate.
-        const auto skippedFrames = m_frameSub->retrieveApproxSkippedElements();
-        m_streamedFramesSinceLastCalc += skippedFrames + drainedCount;
+        // Count ALL frames that arrived from the source, including the ones that were
+        // replaced by a newer frame before we got to them. This gives the true source rate.
+        const auto enqueuedCount = m_frameSub->enqueuedCount();
+        m_streamedFramesSinceLastCalc += static_cast<uint32_t>(enqueuedCount - m_lastEnqueuedCount);
+        m_lastEnqueuedCount = enqueuedCount;
 
         if (!latest.has_value())
             return;
@@ -227,6 +227,9 @@ public:
             SignalBlockF32 fsb(blockLen, 3);
             SignalBlockI32 isb(blockLen, 1);
             SignalBlockU16 usb(blockLen, 2);
+            auto &fsbData = fsb.mutableData();
+            auto &isbData = isb.mutableData();
+            auto &usbData = usb.mutableData();
             for (int i = 0; i < blockLen; ++i) {
                 const uint64_t n = m_sampleCount + static_cast<uint64_t>(i);
                 const double t = static_cast<double>(n) / m_sampleRate;
@@ -235,17 +238,17 @@ public:
                 const double lo = 0.5 * std::sin(2.0 * M_PI * m_freqLow * t);
                 const double hi = 0.5 * std::sin(2.0 * M_PI * m_freqHigh * t);
 
-                fsb.timestamps[i] = ts;
-                fsb.data(i, 0) = static_cast<float>(lo);
-                fsb.data(i, 1) = static_cast<float>(hi);
-                fsb.data(i, 2) = static_cast<float>(lo + hi);
+                fsb.mutableTimestamps()[i] = ts;
+                fsbData(i, 0) = static_cast<float>(lo);
+                fsbData(i, 1) = static_cast<float>(hi);
+                fsbData(i, 2) = static_cast<float>(lo + hi);
 
-                isb.timestamps[i] = ts;
-                isb.data(i, 0) = static_cast<int32_t>(std::lround(1000.0 * lo));
+                isb.mutableTimestamps()[i] = ts;
+                isbData(i, 0) = static_cast<int32_t>(std::lround(1000.0 * lo));
 
-                usb.timestamps[i] = ts;
-                usb.data(i, 0) = static_cast<uint16_t>(std::lround(2000.0 + 1000.0 * lo));
-                usb.data(i, 1) = static_cast<uint16_t>(std::lround(2000.0 + 1000.0 * hi));
+                usb.mutableTimestamps()[i] = ts;
+                usbData(i, 0) = static_cast<uint16_t>(std::lround(2000.0 + 1000.0 * lo));
+                usbData(i, 1) = static_cast<uint16_t>(std::lround(2000.0 + 1000.0 * hi));
             }
             m_sampleCount += static_cast<uint64_t>(blockLen);
 
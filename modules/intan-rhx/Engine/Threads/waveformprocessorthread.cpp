@@ -216,6 +216,9 @@ void WaveformProcessorThread::run()
                                                          channel->getNativeChannelNumber());
                             }
                         }
+
+                        syntalosModuleExportAmplifierGroupData(syMod, group, wide, NumSamples,
+                                                               signalSources->numAmplifierChannels());
                     }
 
                     if (state->getReportSpikes()) {
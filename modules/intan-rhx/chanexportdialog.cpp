@@ -97,9 +97,27 @@ ChanExportDialog::ChanExportDialog(SystemState *state, QWidget *parent) :
     channelsRow->addLayout(addRemoveColumn);
     channelsRow->addLayout(channelsToStreamColumn);
 
+    m_ampExportModeComboBox = new QComboBox(this);
+    m_ampExportModeComboBox->addItem("One stream per channel (µV)", static_cast<int>(AmpExportMode::PerChannel));
+    m_ampExportModeComboBox->addItem("One stream per port (µV)", static_cast<int>(AmpExportMode::PortFloat));
+    m_ampExportModeComboBox->addItem("One stream per port (raw ADC values)", static_cast<int>(AmpExportMode::PortRaw));
+    m_ampExportModeComboBox->setToolTip("Port streams carry all exported amplifier channels of a port as columns of a single "
+                                        "signal block, which is much more efficient for high channel counts.");
+    connect(m_ampExportModeComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, [this](int) {
+        emit exportedChannelsChanged(m_exportedChannels.values());
+    });
+
+    // the run state decides whether the exported channels may be changed
+    connect(m_state, &SystemState::stateChanged, this, &ChanExportDialog::availableChannelSelected);
+
+    QHBoxLayout *exportModeRow = new QHBoxLayout;
+    exportModeRow->addWidget(new QLabel("Amplifier channel output:", this));
+    exportModeRow->addWidget(m_ampExportModeComboBox, 1);
+
     QVBoxLayout *mainLayout = new QVBoxLayout;
     //dataOutputColumn->addWidget(waveformOutputGroupBox);
     mainLayout->addLayout(channelsRow);
+    mainLayout->addLayout(exportModeRow);
 
     updateAvailableChannelsTable();
 
@@ -177,10 +195,24 @@ QStringList ChanExportDialog::exportedChannelNames() const
     return m_exportedChannels.keys();
 }
 
+AmpExportMode ChanExportDialog::ampExportMode() const
+{
+    return static_cast<AmpExportMode>(m_ampExportModeComboBox->currentData().toInt());
+}
+
+void ChanExportDialog::setAmpExportMode(AmpExportMode mode)
+{
+    const QSignalBlocker blocker(m_ampExportModeComboBox);
+    m_ampExportModeComboBox->setCurrentIndex(m_ampExportModeComboBox->findData(static_cast<int>(mode)));
+}
+
 void ChanExportDialog::availableChannelSelected()
 {
     bool changeChannelsAllowed = !m_state->running && (m_availableChannelsTable->selectedItems().size() > 0);
     m_addChannelButton->setEnabled(changeChannelsAllowed);
+
+    // changing the export mode rebuilds the module's ports, which must not happen mid-run
+    m_ampExportModeComboBox->setEnabled(!m_state->running);
 }
 
 
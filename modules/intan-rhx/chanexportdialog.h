@@ -22,6 +22,7 @@
 #include <QtWidgets>
 #include "systemstate.h"
 #include "channel.h"
+#include "intanrhxmodule.h"
 
 class QPushButton;
 class QLabel;
@@ -40,6 +41,9 @@ public slots:
     void updateExportChannelsTable();
     QStringList exportedChannelNames() const;
 
+    AmpExportMode ampExportMode() const;
+    void setAmpExportMode(AmpExportMode mode);
+
 private slots:
     void availableChannelSelected();
 
@@ -66,6 +70,8 @@ private:
 
     QTableWidget *m_exportChannelsTable;
 
+    QComboBox *m_ampExportModeComboBox;
+
     SystemState *m_state;
     SignalSources *m_signalSources;
 
@@ -80,6 +80,7 @@ IntanRhxModule::IntanRhxModule(IntanRhxModuleInfo *modInfo, QObject *parent)
       m_sysState(nullptr)
 {
     blocksPerTimestamp = 5;
+    ampExportMode = AmpExportMode::PerChannel;
     // TODO: Since Intan RHS v3.5.0 we can pass a startup config file here, that we should load
     // from the Syntalos configuration somehow (likely just generate it from there) to avoid
     // extra dialogs.
@@ -196,6 +197,30 @@ bool IntanRhxModule::prepare(const TestSubject &)
             sdi.stream->setMetadataValue("signal_names", MetaArray{QStringLiteral("F%1").arg(i).toStdString()});
         }
     }
+    for (auto &gsdi : ampGroupSdi) {
+        if (!gsdi.active)
+            continue;
+
+        MetaArray namesMeta;
+        for (const auto &name : gsdi.channelNames)
+            namesMeta.push_back(MetaValue{name.toStdString()});
+
+        // raw values are offset-binary, physical = data_scale * raw + data_offset
+        VariantDataStream *stream = gsdi.floatStream.get();
+        if (ampExportMode == AmpExportMode::PortRaw) {
+            stream = gsdi.rawStream.get();
+            stream->setMetadataValue("data_scale", 0.195);
+            stream->setMetadataValue("data_offset", -32768.0 * 0.195);
+        }
+        stream->setMetadataValue("sample_rate", (double)sampleRate);
+        stream->setMetadataValue("time_unit", "index");
+        stream->setMetadataValue("data_unit", "µV");
+        stream->setMetadataValue("signal_names", namesMeta);
+
+        // the mapping to the interleaved buffer is learned from the first data block
+        std::fill(gsdi.rawIndexByColumn.begin(), gsdi.rawIndexByColumn.end(), -1);
+        gsdi.runsValid = false;
+    }
 
     // start output port streams
     for (auto &port : outPorts())
@@ -270,6 +295,16 @@ void IntanRhxModule::serializeSettings(const QString&, QVariantHash &settings, Q
     extraData = m_ctlWindow->globalSettingsAsByteArray();
 
     settings.insert("port_channel_names", m_chanExportDlg->exportedChannelNames());
+    switch (m_chanExportDlg->ampExportMode()) {
+    case AmpExportMode::PortFloat:
+        settings.insert("amp_export_mode", QStringLiteral("port-float"));
+        break;
+    case AmpExportMode::PortRaw:
+        settings.insert("amp_export_mode", QStringLiteral("port-raw"));
+        break;
+    default:
+        settings.insert("amp_export_mode", QStringLiteral("channel"));
+    }
 }
 
 bool IntanRhxModule::loadSettings(const QString &, const QVariantHash &settings, const QByteArray &extraData)
@@ -280,6 +315,14 @@ bool IntanRhxModule::loadSettings(const QString &, const QVariantHash &settings,
             return ret;
     }
 
+    const auto exportModeStr = settings.value("amp_export_mode").toString();
+    if (exportModeStr == QStringLiteral("port-float"))
+        m_chanExportDlg->setAmpExportMode(AmpExportMode::PortFloat);
+    else if (exportModeStr == QStringLiteral("port-raw"))
+        m_chanExportDlg->setAmpExportMode(AmpExportMode::PortRaw);
+    else
+        m_chanExportDlg->setAmpExportMode(AmpExportMode::PerChannel);
+
     m_chanExportDlg->removeAllChannels();
     const auto exportedChannelNames = settings.value("port_channel_names").toStringList();
     for (const auto &chanName : exportedChannelNames)
@@ -298,15 +341,15 @@ void IntanRhxModule::setPortSignalBlockSampleSize(size_t sampleNum)
 {
     for (auto &blocks : intSdiByGroupChannel) {
         for (auto &sdi : blocks) {
-            sdi.signalBlock->timestamps.resize(sampleNum);
-            sdi.signalBlock->data.resize(sampleNum, 1);
+            sdi.signalBlock->mutableTimestamps().resize(sampleNum);
+            sdi.signalBlock->mutableData().resize(sampleNum, 1);
         }
     }
 
     for (auto &blocks : floatSdiByGroupChannel) {
         for (auto &sdi : blocks) {
-            sdi.signalBlock->timestamps.resize(sampleNum);
-            sdi.signalBlock->data.resize(sampleNum, 1);
+            sdi.signalBlock->mutableTimestamps().resize(sampleNum);
+            sdi.signalBlock->mutableData().resize(sampleNum, 1);
         }
     }
 }
@@ -318,8 +361,10 @@ void IntanRhxModule::onExportedChannelsChanged(const QList<Channel *> &channels)
     clearInPorts();
     intSdiByGroupChannel.clear();
     floatSdiByGroupChannel.clear();
+    ampGroupSdi.clear();
 
     auto signalSources = m_sysState->signalSources;
+    ampExportMode = m_chanExportDlg->ampExportMode();
 
     // add new ports
     for (const auto &channel : channels) {
@@ -337,6 +382,21 @@ void IntanRhxModule::onExportedChannelsChanged(const QList<Channel *> &channels)
             sdi.active = true;
 
             intSdiByGroupChannel[groupIndex][channel->getNativeChannelNumber()] = sdi;
+        } else if (ampExportMode != AmpExportMode::PerChannel && channel->getSignalType() == AmplifierSignal) {
+            const auto groupIndex = signalSources->groupIndexByName(channel->getGroupName());
+            if ((int) ampGroupSdi.size() <= groupIndex)
+                ampGroupSdi.resize(groupIndex + 1);
+            auto &gsdi = ampGroupSdi[groupIndex];
+            gsdi.channelGroup = groupIndex;
+
+            const auto nativeChan = channel->getNativeChannelNumber();
+            if ((int) gsdi.columnByNativeChannel.size() <= nativeChan)
+                gsdi.columnByNativeChannel.resize(nativeChan + 1, -1);
+            gsdi.columnByNativeChannel[nativeChan] = gsdi.columnCount();
+            gsdi.rawIndexByColumn.push_back(-1);
+            gsdi.channelNames.append(channel->getNativeName());
+            gsdi.runsValid = false;
+            gsdi.active = true;
         } else {
             const auto groupIndex = signalSources->groupIndexByName(channel->getGroupName());
             if ((int) floatSdiByGroupChannel.size() <= groupIndex)
@@ -351,4 +411,17 @@ void IntanRhxModule::onExportedChannelsChanged(const QList<Channel *> &channels)
             floatSdiByGroupChannel[groupIndex][channel->getNativeChannelNumber()] = sdi;
         }
     }
+
+    // register one output port for each port group with exported amplifier channels
+    for (auto &gsdi : ampGroupSdi) {
+        if (!gsdi.active)
+            continue;
+        const auto group = signalSources->groupByIndex(gsdi.channelGroup);
+        const auto portId = QStringLiteral("port-%1").arg(group->getPrefix());
+        const auto portTitle = QStringLiteral("%1 (%2 channels)").arg(group->getName()).arg(gsdi.columnCount());
+        if (ampExportMode == AmpExportMode::PortRaw)
+            gsdi.rawStream = registerOutputPort<SignalBlockU16>(portId, portTitle);
+        else
+            gsdi.floatStream = registerOutputPort<SignalBlockF32>(portId, portTitle);
+    }
 }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <QObject>
+#include <algorithm>
 #include "moduleapi.h"
 
 SYNTALOS_DECLARE_MODULE
@@ -66,6 +67,90 @@ public:
     int nativeChannel;
 };
 
+/**
+ * How amplifier channels are published on the module's output ports.
+ */
+enum class AmpExportMode {
+    PerChannel, /// one single-column stream (µV) per exported channel
+    PortFloat,  /// one multi-column stream (µV) per port group
+    PortRaw     /// one multi-column stream of raw ADC values per port group
+};
+
+/**
+ * Output stream publishing all exported amplifier channels of one port group
+ * as the columns of a single signal block.
+ */
+class GroupStreamDataInfo
+{
+public:
+    /** A range of output columns that is contiguous in the interleaved amplifier buffer */
+    struct ColumnRun {
+        int rawStart;
+        int column;
+        int length;
+    };
+
+    explicit GroupStreamDataInfo(int group = -1)
+        : active(false),
+          channelGroup(group),
+          runsValid(false)
+    {
+    }
+
+    int columnCount() const
+    {
+        return static_cast<int>(rawIndexByColumn.size());
+    }
+
+    /** Record where the data of the given native channel lives in the interleaved buffer */
+    void setRawIndex(int nativeChannel, int rawIndex)
+    {
+        if (nativeChannel < 0 || nativeChannel >= (int)columnByNativeChannel.size())
+            return;
+        const auto column = columnByNativeChannel[nativeChannel];
+        if (column < 0 || rawIndexByColumn[column] == rawIndex)
+            return;
+        rawIndexByColumn[column] = rawIndex;
+        runsValid = false;
+    }
+
+    void rebuildRuns()
+    {
+        runs.clear();
+        allColumnsMapped = true;
+        for (int col = 0; col < columnCount(); ++col) {
+            const auto rawIdx = rawIndexByColumn[col];
+            if (rawIdx < 0) {
+                allColumnsMapped = false;
+                continue;
+            }
+            if (!runs.empty()) {
+                auto &last = runs.back();
+                if (last.column + last.length == col && last.rawStart + last.length == rawIdx) {
+                    last.length++;
+                    continue;
+                }
+            }
+            runs.push_back({rawIdx, col, 1});
+        }
+        runsValid = true;
+    }
+
+    bool active;
+    int channelGroup;
+    QStringList channelNames;
+    std::vector<int> columnByNativeChannel; // -1 if a channel is not exported
+    std::vector<int> rawIndexByColumn;      // -1 if not known yet
+    std::vector<ColumnRun> runs;
+    bool runsValid;
+    bool allColumnsMapped = false;
+
+    std::shared_ptr<DataStream<SignalBlockF32>> floatStream;
+    std::shared_ptr<DataStream<SignalBlockU16>> rawStream;
+    SignalBlockF32 floatBlock;
+    SignalBlockU16 rawBlock;
+};
+
 class IntanRhxModule : public AbstractModule
 {
     Q_OBJECT
@@ -96,6 +181,9 @@ public:
     std::vector<std::vector<StreamDataInfo<SignalBlockF32>>> floatSdiByGroupChannel;
     std::vector<std::vector<StreamDataInfo<SignalBlockI32>>> intSdiByGroupChannel;
 
+    AmpExportMode ampExportMode;
+    std::vector<GroupStreamDataInfo> ampGroupSdi;
+
     std::unique_ptr<FreqCounterSynchronizer> clockSync;
 
     // these are used by timesync code
@@ -136,7 +224,7 @@ inline void syntalosModuleSetSignalBlocksTimestamps(IntanRhxModule *mod, const m
         for (auto &sdi : blocks) {
             if (!sdi.active)
                 continue;
-            sdi.signalBlock->timestamps = tvm;
+            sdi.signalBlock->setTimestamps(tvm);
         }
     }
 
@@ -144,10 +232,19 @@ inline void syntalosModuleSetSignalBlocksTimestamps(IntanRhxModule *mod, const m
         for (auto &sdi : blocks) {
             if (!sdi.active)
                 continue;
-            sdi.signalBlock->timestamps = tvm;
+            sdi.signalBlock->setTimestamps(tvm);
         }
     }
 
+    for (auto &gsdi : mod->ampGroupSdi) {
+        if (!gsdi.active)
+            continue;
+        if (mod->ampExportMode == AmpExportMode::PortRaw)
+            gsdi.rawBlock.setTimestamps(tvm);
+        else
+            gsdi.floatBlock.setTimestamps(tvm);
+    }
+
     int currentBlockIdx = mod->currentBlockIdx;
     const auto blocksPerTimestamp = mod->blocksPerTimestamp;
     if (blockRecvTimestamp != mod->lastBlockTimestamp) {
@@ -166,12 +263,30 @@ inline void syntalosModuleSetSignalBlocksTimestamps(IntanRhxModule *mod, const m
     mod->currentBlockIdx = currentBlockIdx;
 }
 
+/**
+ * Convert raw amplifier ADC values to microvolts.
+ * Written as a plain loop over contiguous memory so the compiler can vectorize it.
+ */
+inline void intanAmpRawToMicrovolts(float *__restrict dst, const uint16_t *__restrict src, int count)
+{
+    for (int k = 0; k < count; ++k)
+        dst[k] = 0.195F * (static_cast<float>(src[k]) - 32768.0F);
+}
+
 inline void syntalosModuleExportAmplifierChanData(IntanRhxModule *mod, int group, int channel, uint16_t *rawBuf, size_t numSamples,
                                                   int numAmplifierChannels, int rawChanIndex)
 {
     if (mod == nullptr)
         return;
 
+    // in grouped mode we only note where the channel's data lives, the whole
+    // group is published at once by syntalosModuleExportAmplifierGroupData()
+    if (mod->ampExportMode != AmpExportMode::PerChannel) {
+        if (group < (int) mod->ampGroupSdi.size())
+            mod->ampGroupSdi[group].setRawIndex(channel, rawChanIndex);
+        return;
+    }
+
     if (group >= (int) mod->floatSdiByGroupChannel.size())
         return;
     auto &blocks = mod->floatSdiByGroupChannel[group];
@@ -181,12 +296,14 @@ inline void syntalosModuleExportAmplifierChanData(IntanRhxModule *mod, int group
     if (!sdi.active)
         return;
 
-    sdi.signalBlock->data.resize(numSamples, 1);
+    auto &data = sdi.signalBlock->mutableData();
+    data.resize(numSamples, 1);
     for (size_t i = 0; i < numSamples; ++i)
-        sdi.signalBlock->data(i, 0) = 0.195F * (((double) rawBuf[numAmplifierChannels * i + rawChanIndex]) - 32768.0F);
+        data(i, 0) = 0.195F * (((double) rawBuf[numAmplifierChannels * i + rawChanIndex]) - 32768.0F);
 
-    // publish new data on this stream
-    sdi.stream->push(*sdi.signalBlock.get());
+    // publish new data on this stream, handing over the payload so the next block
+    // does not have to detach from the one subscribers still hold
+    sdi.stream->push(std::move(*sdi.signalBlock));
 }
 
 inline void syntalosModuleExportDigitalChanData(IntanRhxModule *mod, int group, int channel, float *rawBuf, size_t numSamples)
@@ -203,10 +320,55 @@ inline void syntalosModuleExportDigitalChanData(IntanRhxModule *mod, int group,
     if (!sdi.active)
         return;
 
-    sdi.signalBlock->data.resize(numSamples, 1);
+    auto &data = sdi.signalBlock->mutableData();
+    data.resize(numSamples, 1);
     for (size_t i = 0; i < numSamples; ++i)
-        sdi.signalBlock->data(i, 0) = static_cast<int>(rawBuf[i]);
+        data(i, 0) = static_cast<int>(rawBuf[i]);
 
-    // publish new data on this stream
-    sdi.stream->push(*sdi.signalBlock.get());
+    // publish new data on this stream, handing over the payload
+    sdi.stream->push(std::move(*sdi.signalBlock));
+}
+
+inline void syntalosModuleExportAmplifierGroupData(IntanRhxModule *mod, int group, const uint16_t *rawBuf, size_t numSamples,
+                                                   int numAmplifierChannels)
+{
+    if (mod == nullptr || mod->ampExportMode == AmpExportMode::PerChannel)
+        return;
+    if (group >= (int) mod->ampGroupSdi.size())
+        return;
+    auto &gsdi = mod->ampGroupSdi[group];
+    if (!gsdi.active)
+        return;
+
+    if (!gsdi.runsValid)
+        gsdi.rebuildRuns();
+    const auto nCols = gsdi.columnCount();
+
+    // the data matrices are row-major, so every sample row of a run is a contiguous
+    // span in both the interleaved source buffer and the output block
+    if (mod->ampExportMode == AmpExportMode::PortRaw) {
+        auto &data = gsdi.rawBlock.mutableData();
+        data.resize(numSamples, nCols);
+        if (!gsdi.allColumnsMapped)
+            data.setZero();
+        for (size_t i = 0; i < numSamples; ++i) {
+            const auto srcRow = rawBuf + numAmplifierChannels * i;
+            auto dstRow = data.data() + nCols * i;
+            for (const auto &run : gsdi.runs)
+                std::copy_n(srcRow + run.rawStart, run.length, dstRow + run.column);
+        }
+        gsdi.rawStream->push(std::move(gsdi.rawBlock));
+    } else {
+        auto &data = gsdi.floatBlock.mutableData();
+        data.resize(numSamples, nCols);
+        if (!gsdi.allColumnsMapped)
+            data.setZero();
+        for (size_t i = 0; i < numSamples; ++i) {
+            const auto srcRow = rawBuf + numAmplifierChannels * i;
+            auto dstRow = data.data() + nCols * i;
+            for (const auto &run : gsdi.runs)
+                intanAmpRawToMicrovolts(dstRow + run.column, srcRow + run.rawStart, run.length);
+        }
+        gsdi.floatStream->push(std::move(gsdi.floatBlock));
+    }
 }
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonblockwriter.h"
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <zstd.h>
+
+/// Size of the blocks handed to the I/O thread
+static constexpr size_t JSON_WRITE_BLOCK_SIZE = 1024 * 1024;
+
+/// Number of blocks that may be queued for writing before appending data blocks
+static constexpr size_t JSON_WRITE_QUEUE_LENGTH = 8;
+
+/// zstd compression level, the default level keeps up with the data rates we expect
+static constexpr int JSON_ZSTD_LEVEL = 3;
+
+class JsonBlockWriter::Private
+{
+public:
+    Private()
+        : fd(-1),
+          cctx(nullptr),
+          stopThread(false),
+          hasError(false)
+    {
+    }
+
+    ~Private()
+    {
+        if (cctx != nullptr)
+            ZSTD_freeCCtx(cctx);
+    }
+
+    int fd;
+    ZSTD_CCtx *cctx;
+    std::vector<char> compBuffer;
+
+    std::thread ioThread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::string> writeQueue;
+    std::vector<std::string> freeBlocks;
+    bool stopThread;
+
+    std::atomic_bool hasError;
+    std::string ioError;
+};
+
+static std::string writeAllToFile(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        const auto ret = ::write(fd, data, size);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return std::string("Unable to write JSON data: ") + std::strerror(errno);
+        }
+        data += ret;
+        size -= static_cast<size_t>(ret);
+    }
+
+    return {};
+}
+
+JsonBlockWriter::JsonBlockWriter()
+    : d(std::make_unique<JsonBlockWriter::Private>()),
+      m_blockSize(JSON_WRITE_BLOCK_SIZE),
+      m_rowCount(0),
+      m_newlineDelimited(false)
+{
+}
+
+JsonBlockWriter::~JsonBlockWriter()
+{
+    close();
+}
+
+std::expected<void, std::string> JsonBlockWriter::open(const std::string &fname, bool compress)
+{
+    if (d->fd >= 0)
+        return std::unexpected("JSON file is already open.");
+
+    d->fd = ::open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (d->fd < 0)
+        return std::unexpected(std::string("Unable to open file: ") + std::strerror(errno));
+
+    if (compress) {
+        if (d->cctx == nullptr)
+            d->cctx = ZSTD_createCCtx();
+        ZSTD_CCtx_reset(d->cctx, ZSTD_reset_session_and_parameters);
+        ZSTD_CCtx_setParameter(d->cctx, ZSTD_c_compressionLevel, JSON_ZSTD_LEVEL);
+        ZSTD_CCtx_setParameter(d->cctx, ZSTD_c_checksumFlag, 1);
+        d->compBuffer.resize(ZSTD_CStreamOutSize());
+    } else if (d->cctx != nullptr) {
+        ZSTD_freeCCtx(d->cctx);
+        d->cctx = nullptr;
+    }
+
+    d->stopThread = false;
+    d->hasError = false;
+    d->ioError.clear();
+    m_buffer.clear();
+    m_buffer.reserve(m_blockSize + 4096);
+    m_rowCount = 0;
+    d->ioThread = std::thread(&JsonBlockWriter::ioThreadMain, this);
+
+    return {};
+}
+
+std::expected<void, std::string> JsonBlockWriter::close()
+{
+    if (d->fd < 0)
+        return {};
+
+    {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        if (!m_buffer.empty())
+            d->writeQueue.push_back(std::move(m_buffer));
+        d->stopThread = true;
+    }
+    d->cond.notify_all();
+    d->ioThread.join();
+    m_buffer = std::string();
+
+    std::string error = d->ioError;
+    if (error.empty() && d->cctx != nullptr) {
+        // finish the zstd frame
+        ZSTD_inBuffer input = {nullptr, 0, 0};
+        size_t remaining;
+        do {
+            ZSTD_outBuffer output = {d->compBuffer.data(), d->compBuffer.size(), 0};
+            remaining = ZSTD_compressStream2(d->cctx, &output, &input, ZSTD_e_end);
+            if (ZSTD_isError(remaining)) {
+                error = std::string("Unable to compress JSON data: ") + ZSTD_getErrorName(remaining);
+                break;
+            }
+            error = writeAllToFile(d->fd, d->compBuffer.data(), output.pos);
+        } while (remaining != 0 && error.empty());
+    }
+
+    if (::close(d->fd) != 0 && error.empty())
+        error = std::string("Unable to close JSON file: ") + std::strerror(errno);
+    d->fd = -1;
+    d->freeBlocks.clear();
+
+    if (!error.empty())
+        return std::unexpected(error);
+    return {};
+}
+
+bool JsonBlockWriter::isOpen() const
+{
+    return d->fd >= 0;
+}
+
+bool JsonBlockWriter::failed() const
+{
+    return d->hasError;
+}
+
+void JsonBlockWriter::setNewlineDelimited(bool enabled)
+{
+    m_newlineDelimited = enabled;
+}
+
+bool JsonBlockWriter::newlineDelimited() const
+{
+    return m_newlineDelimited;
+}
+
+void JsonBlockWriter::appendString(std::string_view str)
+{
+    m_buffer.push_back('"');
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            m_buffer.append("\\\"");
+            break;
+        case '\\':
+            m_buffer.append("\\\\");
+            break;
+        case '\n':
+            m_buffer.append("\\n");
+            break;
+        case '\r':
+            m_buffer.append("\\r");
+            break;
+        case '\t':
+            m_buffer.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char esc[8];
+                const auto len = std::snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned>(c));
+                m_buffer.append(esc, static_cast<size_t>(len));
+            } else {
+                m_buffer.push_back(c);
+            }
+        }
+    }
+    m_buffer.push_back('"');
+
+    if (m_buffer.size() >= m_blockSize)
+        submitBlock();
+}
+
+void JsonBlockWriter::submitBlock()
+{
+    if (d->fd < 0 || d->hasError) {
+        // nowhere to write to, drop the data
+        m_buffer.clear();
+        return;
+    }
+
+    std::string next;
+    {
+        std::unique_lock<std::mutex> lock(d->mutex);
+        d->cond.wait(lock, [this] {
+            return d->writeQueue.size() < JSON_WRITE_QUEUE_LENGTH;
+        });
+        d->writeQueue.push_back(std::move(m_buffer));
+        if (!d->freeBlocks.empty()) {
+            next = std::move(d->freeBlocks.back());
+            d->freeBlocks.pop_back();
+        }
+    }
+    d->cond.notify_all();
+
+    next.clear();
+    if (next.capacity() < m_blockSize)
+        next.reserve(m_blockSize + 4096);
+    m_buffer = std::move(next);
+}
+
+void JsonBlockWriter::ioThreadMain()
+{
+    pthread_setname_np(pthread_self(), "jsonwriter_io");
+
+    while (true) {
+        std::string block;
+        {
+            std::unique_lock<std::mutex> lock(d->mutex);
+            d->cond.wait(lock, [this] {
+                return d->stopThread || !d->writeQueue.empty();
+            });
+            if (d->writeQueue.empty())
+                break;
+            block = std::move(d->writeQueue.front());
+            d->writeQueue.pop_front();
+        }
+        d->cond.notify_all();
+
+        // once we have failed, we just discard all data
+        std::string error;
+        if (!d->hasError) {
+            if (d->cctx == nullptr) {
+                error = writeAllToFile(d->fd, block.data(), block.size());
+            } else {
+                // flush after every block, so everything written so far can be decompressed
+                ZSTD_inBuffer input = {block.data(), block.size(), 0};
+                size_t remaining;
+                do {
+                    ZSTD_outBuffer output = {d->compBuffer.data(), d->compBuffer.size(), 0};
+                    remaining = ZSTD_compressStream2(d->cctx, &output, &input, ZSTD_e_flush);
+                    if (ZSTD_isError(remaining)) {
+                        error = std::string("Unable to compress JSON data: ") + ZSTD_getErrorName(remaining);
+                        break;
+                    }
+                    error = writeAllToFile(d->fd, d->compBuffer.data(), output.pos);
+                } while (remaining != 0 && error.empty());
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(d->mutex);
+        if (!error.empty() && !d->hasError) {
+            d->ioError = error;
+            d->hasError = true;
+        }
+        if (d->freeBlocks.size() < JSON_WRITE_QUEUE_LENGTH)
+            d->freeBlocks.push_back(std::move(block));
+    }
+}
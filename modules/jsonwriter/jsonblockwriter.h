@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Buffered writer for large JSON text files.
+ *
+ * Text and numbers are formatted directly into an in-memory block, which is handed
+ * to a dedicated I/O thread once it is full. The I/O thread optionally compresses
+ * the data with zstd before writing it to disk. Every block is flushed as a complete
+ * zstd block, so a compressed file stays readable up to the last written block
+ * even if it was never closed.
+ */
+class JsonBlockWriter
+{
+public:
+    explicit JsonBlockWriter();
+    ~JsonBlockWriter();
+
+    std::expected<void, std::string> open(const std::string &fname, bool compress);
+    std::expected<void, std::string> close();
+    bool isOpen() const;
+
+    /**
+     * True if writing data failed. Any data appended afterwards is discarded,
+     * the error is returned by close().
+     */
+    bool failed() const;
+
+    void append(std::string_view text)
+    {
+        m_buffer.append(text);
+        if (m_buffer.size() >= m_blockSize)
+            submitBlock();
+    }
+
+    void append(char c)
+    {
+        m_buffer.push_back(c);
+        if (m_buffer.size() >= m_blockSize)
+            submitBlock();
+    }
+
+    /// Append @p str as a quoted and escaped JSON string.
+    void appendString(std::string_view str);
+
+    /**
+     * Lay out rows as newline-delimited JSON, one row per line, instead of
+     * as comma-separated elements of a JSON array.
+     */
+    void setNewlineDelimited(bool enabled);
+    bool newlineDelimited() const;
+
+    /// Start a new row, separating it from the previous one.
+    void beginRow()
+    {
+        if (m_rowCount > 0 && !m_newlineDelimited)
+            append(std::string_view(",\n"));
+        append('[');
+    }
+
+    void endRow()
+    {
+        append(m_newlineDelimited ? std::string_view("]\n") : std::string_view("]"));
+        m_rowCount++;
+    }
+
+    template<typename T>
+    void appendNumber(T value)
+        requires std::integral<T> || std::floating_point<T>
+    {
+        if constexpr (std::floating_point<T>) {
+            if (std::isnan(value)) {
+                append(std::string_view("NaN"));
+                return;
+            }
+
+            // this is an extension to the JSON spec that Pandas parses
+            if (std::isinf(value)) {
+                append(value > 0 ? std::string_view("Infinity") : std::string_view("-Infinity"));
+                return;
+            }
+        }
+
+        // format in place, the shortest round-trip representation of any number fits in 32 bytes
+        const auto pos = m_buffer.size();
+        m_buffer.resize(pos + 32);
+        const auto res = std::to_chars(m_buffer.data() + pos, m_buffer.data() + m_buffer.size(), value);
+        m_buffer.resize(static_cast<size_t>(res.ptr - m_buffer.data()));
+        if (m_buffer.size() >= m_blockSize)
+            submitBlock();
+    }
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+
+    std::string m_buffer;
+    size_t m_blockSize;
+    size_t m_rowCount;
+    bool m_newlineDelimited;
+
+    void submitBlock();
+    void ioThreadMain();
+};
@@ -43,6 +43,7 @@ JSONSettingsDialog::JSONSettingsDialog(QWidget *parent)
     ui->inputTypeSel->addDataType(SignalBlockF32::staticTypeId(), QStringLiteral("Float Signals"));
     ui->inputTypeSel->addDataType(SignalBlockI32::staticTypeId(), QStringLiteral("Integer Signals"));
     ui->inputTypeSel->addDataType(TableRow::staticTypeId(), QStringLiteral("Table Rows"));
+    ui->inputTypeSel->addDataType(TableRecord::staticTypeId(), QStringLiteral("Table Records"));
     ui->inputTypeSel->addDataType(LineReading::staticTypeId(), QStringLiteral("Line Readings"));
     connect(ui->inputTypeSel, &DataTypeSelector::selectionChanged, this, &JSONSettingsDialog::settingsChanged);
 
@@ -56,6 +57,10 @@ JSONSettingsDialog::JSONSettingsDialog(QWidget *parent)
     // register formats
     ui->formatComboBox->addItem("Pandas-compatible JSON", "pandas-split");
     ui->formatComboBox->addItem("Metadata-extended JSON", "extended-pandas");
+    ui->formatComboBox->addItem("Newline-delimited JSON (NDJSON)", "ndjson");
+
+    // compress with zstd by default
+    ui->compressCheckBox->setChecked(true);
 }
 
 JSONSettingsDialog::~JSONSettingsDialog()
@@ -109,6 +114,16 @@ void JSONSettingsDialog::setJsonFormat(const QString &format)
     }
 }
 
+bool JSONSettingsDialog::compressData() const
+{
+    return ui->compressCheckBox->isChecked();
+}
+
+void JSONSettingsDialog::setCompressData(bool compress)
+{
+    ui->compressCheckBox->setChecked(compress);
+}
+
 bool JSONSettingsDialog::recordAllData() const
 {
     return ui->useAllDataCheckBox->isChecked();
@@ -50,6 +50,9 @@ public:
     QString jsonFormat() const;
     void setJsonFormat(const QString &format);
 
+    bool compressData() const;
+    void setCompressData(bool compress);
+
     bool recordAllData() const;
     void setRecordAllData(bool enabled);
 
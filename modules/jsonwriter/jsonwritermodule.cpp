@@ -20,8 +20,9 @@
 #include "jsonwritermodule.h"
 
 #include <QUuid>
-#include <KCompressionDevice>
+#include <algorithm>
 
+#include "jsonblockwriter.h"
 #include "jsonsettingsdialog.h"
 
 SYNTALOS_MODULE(JSONWriterModule)
@@ -31,6 +32,7 @@ enum class InputSourceKind {
     FLOAT,
     INT,
     ROW,
+    RECORD,
     LINE_READING
 };
 
@@ -42,6 +44,8 @@ static InputSourceKind inputSourceKindFromTypeId(int typeId)
         return InputSourceKind::INT;
     if (typeId == TableRow::staticTypeId())
         return InputSourceKind::ROW;
+    if (typeId == TableRecord::staticTypeId())
+        return InputSourceKind::RECORD;
     if (typeId == LineReading::staticTypeId())
         return InputSourceKind::LINE_READING;
     return InputSourceKind::NONE;
@@ -54,20 +58,22 @@ private:
     std::shared_ptr<StreamInputPort<SignalBlockF32>> m_floatIn;
     std::shared_ptr<StreamInputPort<SignalBlockI32>> m_intIn;
     std::shared_ptr<StreamInputPort<TableRow>> m_rowsIn;
+    std::shared_ptr<StreamInputPort<TableRecord>> m_recordsIn;
     std::shared_ptr<StreamInputPort<LineReading>> m_lineIn;
 
     std::shared_ptr<StreamSubscription<SignalBlockF32>> m_floatSub;
     std::shared_ptr<StreamSubscription<SignalBlockI32>> m_intSub;
     std::shared_ptr<StreamSubscription<TableRow>> m_rowSub;
+    std::shared_ptr<StreamSubscription<TableRecord>> m_recordSub;
     std::shared_ptr<StreamSubscription<LineReading>> m_lineSub;
 
     InputSourceKind m_isrcKind;
     std::shared_ptr<EDLDataset> m_currentDSet;
 
-    std::unique_ptr<KCompressionDevice> m_compDev;
-    std::unique_ptr<QTextStream> m_textStream;
+    std::unique_ptr<JsonBlockWriter> m_writer;
     bool m_initFile;
-    QSet<int> m_selectedIndices;
+    bool m_ndjson;
+    std::vector<int> m_selectedIndices;
     bool m_writeData;
 
     JSONSettingsDialog *m_settingsDlg;
@@ -99,6 +105,7 @@ public:
         m_floatIn.reset();
         m_intIn.reset();
         m_rowsIn.reset();
+        m_recordsIn.reset();
         m_lineIn.reset();
 
         setStatusMessage({});
@@ -112,6 +119,9 @@ public:
         case InputSourceKind::ROW:
             m_rowsIn = registerInputPort<TableRow>(QStringLiteral("rows-in"), QStringLiteral("Table Rows"));
             break;
+        case InputSourceKind::RECORD:
+            m_recordsIn = registerInputPort<TableRecord>(QStringLiteral("records-in"), QStringLiteral("Table Records"));
+            break;
         case InputSourceKind::LINE_READING:
             m_lineIn = registerInputPort<LineReading>(QStringLiteral("lines-in"), QStringLiteral("Line Readings"));
             break;
@@ -153,7 +163,7 @@ public:
             m_floatSub = m_floatIn->subscription();
             m_isrcKind = InputSourceKind::FLOAT;
 
-            registerDataReceivedEvent(&JSONWriterModule::onFloatSignalBlockReceived, m_floatSub);
+            registerDataBatchReceivedEvent(&JSONWriterModule::onFloatSignalBlockReceived, m_floatSub);
         }
 
         m_intSub.reset();
@@ -161,7 +171,7 @@ public:
             m_intSub = m_intIn->subscription();
             m_isrcKind = InputSourceKind::INT;
 
-            registerDataReceivedEvent(&JSONWriterModule::onIntSignalBlockReceived, m_intSub);
+            registerDataBatchReceivedEvent(&JSONWriterModule::onIntSignalBlockReceived, m_intSub);
         }
 
         m_rowSub.reset();
@@ -169,7 +179,15 @@ public:
             m_rowSub = m_rowsIn->subscription();
             m_isrcKind = InputSourceKind::ROW;
 
-            registerDataReceivedEvent(&JSONWriterModule::onTableRowReceived, m_rowSub);
+            registerDataBatchReceivedEvent(&JSONWriterModule::onTableRowReceived, m_rowSub);
+        }
+
+        m_recordSub.reset();
+        if (m_recordsIn && m_recordsIn->hasSubscription()) {
+            m_recordSub = m_recordsIn->subscription();
+            m_isrcKind = InputSourceKind::RECORD;
+
+            registerDataBatchReceivedEvent(&JSONWriterModule::onTableRecordReceived, m_recordSub);
         }
 
         m_lineSub.reset();
@@ -177,7 +195,7 @@ public:
             m_lineSub = m_lineIn->subscription();
             m_isrcKind = InputSourceKind::LINE_READING;
 
-            registerDataReceivedEvent(&JSONWriterModule::onLineReadingReceived, m_lineSub);
+            registerDataBatchReceivedEvent(&JSONWriterModule::onLineReadingReceived, m_lineSub);
         }
 
         if (m_isrcKind == InputSourceKind::NONE) {
@@ -214,6 +232,9 @@ public:
         case InputSourceKind::ROW:
             mdata = m_rowSub->metadata();
             break;
+        case InputSourceKind::RECORD:
+            mdata = m_recordSub->metadata();
+            break;
         case InputSourceKind::LINE_READING:
             // Columns are fixed ([time, line_id, value]); no per-signal selection.
             mdata = m_lineSub->metadata();
@@ -233,7 +254,7 @@ public:
             const auto recSet = m_settingsDlg->recordedEntriesSet();
             for (int i = 0; i < signalNames.count(); i++) {
                 if (recSet.contains(signalNames[i]))
-                    m_selectedIndices.insert(i);
+                    m_selectedIndices.push_back(i);
             }
         }
 
@@ -248,71 +269,27 @@ public:
         }
 
         // get our file basename
+        m_ndjson = m_settingsDlg->jsonFormat() == QStringLiteral("ndjson");
+        const bool compress = m_settingsDlg->compressData();
         auto fname = dataBasenameFromSubMetadata(mdata, QStringLiteral("data"));
-        fname = QStringLiteral("%1.json.zst").arg(fname);
+        fname = QStringLiteral("%1.%2%3").arg(fname, m_ndjson ? "ndjson" : "json", compress ? ".zst" : "");
 
         // retrieve an absolute path from our file basename that we can open
         fname = QString::fromStdString(m_currentDSet->setDataFile(fname.toStdString()));
 
-        m_compDev = std::make_unique<KCompressionDevice>(fname, KCompressionDevice::Zstd);
-        if (!m_compDev->open(QIODevice::WriteOnly)) {
-            raiseError(QStringLiteral("Unable to open file '%1' for writing: %2").arg(fname, m_compDev->errorString()));
+        m_writer = std::make_unique<JsonBlockWriter>();
+        if (auto res = m_writer->open(fname.toStdString(), compress); !res) {
+            raiseError(QStringLiteral("Unable to open file '%1' for writing: %2")
+                           .arg(fname, QString::fromStdString(res.error())));
+            m_writer.reset();
+            m_writeData = false;
             return;
         }
+        m_writer->setNewlineDelimited(m_ndjson);
 
-        m_textStream = std::make_unique<QTextStream>(m_compDev.get());
         m_initFile = true;
     }
 
-    static QString toJsonValue(const QString &str)
-    {
-        QString res = str;
-        res.replace("\\", "\\\\");
-        res.replace("\"", "\\\"");
-        res.replace("\n", "\\n");
-        res.replace("\r", "\\r");
-        res.replace("\t", "\\t");
-
-        return "\"" + res + "\"";
-    }
-
-    static QString toJsonValue(const std::string &str)
-    {
-        QString res = QString::fromStdString(str);
-        res.replace("\\", "\\\\");
-        res.replace("\"", "\\\"");
-        res.replace("\n", "\\n");
-        res.replace("\r", "\\r");
-        res.replace("\t", "\\t");
-
-        return "\"" + res + "\"";
-    }
-
-    QString floatToJsonValue(double value)
-    {
-        if (std::isnan(value))
-            return "NaN";
-
-        // this is an extension to the JSON spec that Pandas parses
-        if (std::isinf(value))
-            return value > 0 ? "Infinity" : "-Infinity";
-
-        return QString::number(value, 'g', 16);
-    }
-
-    template<typename T>
-    QString intToJsonValue(T value)
-    {
-        if (std::isnan(value))
-            return "NaN";
-
-        // this is an extension to the JSON spec that Pandas parses
-        if (std::isinf(value))
-            return value > 0 ? "Infinity" : "-Infinity";
-
-        return QString::number(value);
-    }
-
     QString shortenTimeUnit(const QString &timeUnit)
     {
         if (timeUnit == "seconds")
@@ -335,7 +312,6 @@ public:
         double dataScale = 1.0;
         double dataOffset = 0.0;
         double sampleRate = -1.0;
-        QTextStream &stream = *m_textStream;
 
         switch (m_isrcKind) {
         case InputSourceKind::FLOAT:
@@ -363,6 +339,11 @@ public:
                 if (const auto s = v.get<std::string>())
                     columns << QString::fromStdString(*s);
             break;
+        case InputSourceKind::RECORD:
+            for (const auto &v : m_recordSub->metadataValue("table_header", MetaArray{}))
+                if (const auto s = v.get<std::string>())
+                    columns << QString::fromStdString(*s);
+            break;
         case InputSourceKind::LINE_READING:
             timeUnit = QString::fromStdString(m_lineSub->metadataValue("time_unit", std::string{"microseconds"}));
             dataUnit = QString::fromStdString(m_lineSub->metadataValue("data_unit", std::string{}));
@@ -390,30 +371,49 @@ public:
                 columns.prepend(QStringLiteral("timestamp_%1").arg(shortenTimeUnit(timeUnit)));
         }
 
-        stream << "{";
-        if (m_settingsDlg->jsonFormat() == "extended-pandas") {
-            stream << "\"collection_id\": " << toJsonValue(m_currentDSet->collectionId().toHex());
-            if (!timeUnit.isEmpty())
-                stream << ",\n\"time_unit\": " << toJsonValue(timeUnit);
-            if (!dataUnit.isEmpty())
-                stream << ",\n\"data_unit\": " << toJsonValue(dataUnit);
-            if (sampleRate > 0 || timeUnit == "index")
-                stream << ",\n\"sample_rate\": " << floatToJsonValue(sampleRate);
-            stream << ",\n";
+        // the NDJSON header object must fit on a single line
+        auto &out = *m_writer;
+        const auto sep = m_ndjson ? std::string_view(", ") : std::string_view(",\n");
+        out.append('{');
+        if (m_ndjson || m_settingsDlg->jsonFormat() == "extended-pandas") {
+            out.append(std::string_view("\"collection_id\": "));
+            out.appendString(m_currentDSet->collectionId().toHex());
+            if (!timeUnit.isEmpty()) {
+                out.append(sep);
+                out.append(std::string_view("\"time_unit\": "));
+                out.appendString(timeUnit.toStdString());
+            }
+            if (!dataUnit.isEmpty()) {
+                out.append(sep);
+                out.append(std::string_view("\"data_unit\": "));
+                out.appendString(dataUnit.toStdString());
+            }
+            if (sampleRate > 0 || timeUnit == "index") {
+                out.append(sep);
+                out.append(std::string_view("\"sample_rate\": "));
+                out.appendNumber(sampleRate);
+            }
+            out.append(sep);
         }
 
-        stream << "\"columns\": [";
-        QString columnsLine;
+        out.append(std::string_view("\"columns\": ["));
+        bool firstColumn = true;
         for (int i = 0; i < columns.length(); i++) {
             // always write timestamp column, then check the other channels for being whitelisted
-            if (i == 0)
-                columnsLine.append(toJsonValue(columns[i]) + ",");
-            else if (m_selectedIndices.isEmpty() || m_selectedIndices.contains(i - 1))
-                columnsLine.append(toJsonValue(columns[i]) + ",");
+            if (i != 0 && !m_selectedIndices.empty()
+                && !std::binary_search(m_selectedIndices.begin(), m_selectedIndices.end(), i - 1))
+                continue;
+            if (!firstColumn)
+                out.append(',');
+            out.appendString(columns[i].toStdString());
+            firstColumn = false;
         }
-        if (!columnsLine.isEmpty())
-            columnsLine = columnsLine.left(columnsLine.length() - 1);
-        stream << columnsLine << "],\n\"data\": [\n";
+
+        // NDJSON files have this header object on their first line, followed by one row per line
+        if (m_ndjson)
+            out.append(std::string_view("]}\n"));
+        else
+            out.append(std::string_view("],\n\"data\": [\n"));
 
         // add some metadata
         m_currentDSet->insertAttribute("json_schema", m_settingsDlg->jsonFormat().toStdString());
@@ -432,125 +432,131 @@ public:
         if (sampleRate > 0 || timeUnit == "index")
             m_currentDSet->insertAttribute("sample_rate", sampleRate);
 
-        // try to write the header to disk as soon as we can
-        stream.flush();
+        m_initFile = false;
     }
 
-    void writeEntryStart(const VectorXu64 &timestamps, int i)
+    /**
+     * Start a new data row, writing the file header first if needed.
+     */
+    void beginRow()
     {
-        if (i == 0 && m_initFile)
-            (*m_textStream) << "[" << intToJsonValue(timestamps(i, 0));
-        else
-            (*m_textStream) << ",\n[" << intToJsonValue(timestamps(i, 0));
+        if (m_initFile)
+            initJsonFile();
+        m_writer->beginRow();
     }
 
-    void onFloatSignalBlockReceived()
+    void endRow()
     {
-        auto maybeData = m_floatSub->peekNext();
-        if (!maybeData.has_value())
-            return;
-        const auto &data = *maybeData;
-        if (!m_writeData)
-            return;
+        m_writer->endRow();
+    }
 
-        if (m_initFile)
-            initJsonFile();
+    void checkWriteFailed()
+    {
+        if (!m_writer->failed())
+            return;
 
-        for (int i = 0; i < data.timestamps.rows(); ++i) {
-            writeEntryStart(data.timestamps, i);
+        // the actual I/O error is reported once the file is closed
+        m_writeData = false;
+        raiseError(QStringLiteral("Failed to write JSON data to disk."));
+    }
 
-            if (m_selectedIndices.isEmpty()) {
-                for (int k = 0; k < data.data.cols(); ++k)
-                    (*m_textStream) << "," << intToJsonValue(data.data(i, k));
-            } else {
-                for (const auto &k : m_selectedIndices)
-                    (*m_textStream) << "," << intToJsonValue(data.data(i, k));
+    template<typename BlockT>
+    void writeSignalBlocks(const std::vector<BlockT> &batch)
+    {
+        auto &out = *m_writer;
+        for (const auto &block : batch) {
+            const auto &timestamps = block.timestamps();
+            const auto &values = block.data();
+            for (int i = 0; i < timestamps.rows(); ++i) {
+                beginRow();
+                out.appendNumber(timestamps(i, 0));
+
+                if (m_selectedIndices.empty()) {
+                    for (int k = 0; k < values.cols(); ++k) {
+                        out.append(',');
+                        out.appendNumber(values(i, k));
+                    }
+                } else {
+                    for (const auto k : m_selectedIndices) {
+                        out.append(',');
+                        out.appendNumber(values(i, k));
+                    }
+                }
+                endRow();
             }
-            (*m_textStream) << "]";
         }
 
-        // ensure we don't initialize the file twice
-        m_initFile = false;
+        checkWriteFailed();
     }
 
-    void onIntSignalBlockReceived()
+    void onFloatSignalBlockReceived(std::vector<SignalBlockF32> &batch)
     {
-        auto maybeData = m_intSub->peekNext();
-        if (!maybeData.has_value())
-            return;
-        const auto &data = maybeData.value();
         if (!m_writeData)
             return;
+        writeSignalBlocks(batch);
+    }
 
-        if (m_initFile)
-            initJsonFile();
+    void onIntSignalBlockReceived(std::vector<SignalBlockI32> &batch)
+    {
+        if (!m_writeData)
+            return;
+        writeSignalBlocks(batch);
+    }
 
-        for (int i = 0; i < data.timestamps.rows(); ++i) {
-            writeEntryStart(data.timestamps, i);
+    void onTableRowReceived(std::vector<TableRow> &batch)
+    {
+        if (!m_writeData)
+            return;
 
-            if (m_selectedIndices.isEmpty()) {
-                for (int k = 0; k < data.data.cols(); ++k)
-                    (*m_textStream) << "," << floatToJsonValue(data.data(i, k));
-            } else {
-                for (const auto &k : m_selectedIndices)
-                    (*m_textStream) << "," << floatToJsonValue(data.data(i, k));
+        for (const auto &row : batch) {
+            beginRow();
+            for (int i = 0; i < row.length(); i++) {
+                if (i > 0)
+                    m_writer->append(',');
+                m_writer->appendString(row.data[i]);
             }
-            (*m_textStream) << "]";
+            endRow();
         }
 
-        // ensure we don't initialize the file twice
-        m_initFile = false;
+        checkWriteFailed();
     }
 
-    void onTableRowReceived()
+    void onTableRecordReceived(std::vector<TableRecord> &batch)
     {
-        auto maybeData = m_rowSub->peekNext();
-        if (!maybeData.has_value())
-            return;
-        const auto &row = *maybeData;
         if (!m_writeData)
             return;
 
-        if (m_initFile) {
-            initJsonFile();
-            (*m_textStream) << "[";
-        } else {
-            (*m_textStream) << ",\n[";
+        // the cells are numbers already, so they are written unquoted
+        for (const auto &record : batch) {
+            beginRow();
+            for (int i = 0; i < record.length(); i++) {
+                if (i > 0)
+                    m_writer->append(',');
+                m_writer->appendNumber(record.values[i]);
+            }
+            endRow();
         }
 
-        // ensure we don't initialize the file twice
-        m_initFile = false;
-
-        // write row
-        for (int i = 0; i < row.length(); i++) {
-            if (i == 0)
-                (*m_textStream) << toJsonValue(row.data[i]);
-            else
-                (*m_textStream) << "," << toJsonValue(row.data[i]);
-        }
-        (*m_textStream) << "]";
+        checkWriteFailed();
     }
 
-    void onLineReadingReceived()
+    void onLineReadingReceived(std::vector<LineReading> &batch)
     {
         if (!m_writeData)
             return;
 
         // One [time, line_id, value] row per edge event.
-        while (auto maybeData = m_lineSub->peekNext()) {
-            const auto &ev = maybeData.value();
-
-            if (m_initFile) {
-                initJsonFile();
-                (*m_textStream) << "[";
-            } else {
-                (*m_textStream) << ",\n[";
-            }
-            m_initFile = false;
-
-            (*m_textStream) << intToJsonValue(static_cast<uint64_t>(ev.time.count())) << ","
-                            << intToJsonValue(ev.lineId) << "," << intToJsonValue(ev.value) << "]";
+        for (const auto &ev : batch) {
+            beginRow();
+            m_writer->appendNumber(static_cast<uint64_t>(ev.time.count()));
+            m_writer->append(',');
+            m_writer->appendNumber(ev.lineId);
+            m_writer->append(',');
+            m_writer->appendNumber(ev.value);
+            endRow();
         }
+
+        checkWriteFailed();
     }
 
     void stop() override
@@ -558,19 +564,15 @@ public:
         if (m_isrcKind == InputSourceKind::NONE)
             return;
 
-        // write terminator
-        if (m_textStream.get() != nullptr) {
-            if (m_writeData)
-                (*m_textStream) << "\n]}\n";
-            m_textStream->flush();
+        if (m_writer) {
+            // write terminator, if we have written a header
+            if (m_writeData && !m_initFile && !m_ndjson)
+                m_writer->append(std::string_view("\n]}\n"));
+            if (auto res = m_writer->close(); !res)
+                raiseError(QStringLiteral("Failed to write JSON file: %1").arg(QString::fromStdString(res.error())));
+            m_writer.reset();
         }
 
-        // close file, reset pointers
-        if (m_compDev.get() != nullptr)
-            m_compDev->close();
-        m_textStream.reset();
-        m_compDev.reset();
-
         m_currentDSet.reset();
 
         // re-enable UI
@@ -583,6 +585,7 @@ public:
         settings.insert("use_name_from_source", m_settingsDlg->useNameFromSource());
         settings.insert("data_name", m_settingsDlg->dataName());
         settings.insert("format", m_settingsDlg->jsonFormat());
+        settings.insert("compress", m_settingsDlg->compressData());
 
         settings.insert("record_all", m_settingsDlg->recordAllData());
         settings.insert("available_entries", m_settingsDlg->availableEntries());
@@ -597,6 +600,7 @@ public:
         m_settingsDlg->setUseNameFromSource(settings.value("use_name_from_source", true).toBool());
         m_settingsDlg->setDataName(settings.value("data_name").toString());
         m_settingsDlg->setJsonFormat(settings.value("format").toString());
+        m_settingsDlg->setCompressData(settings.value("compress", true).toBool());
 
         m_settingsDlg->setRecordAllData(settings.value("record_all", true).toBool());
         m_settingsDlg->setAvailableEntries(settings.value("available_entries").toStringList());
@@ -364,9 +364,9 @@ private:
     void emitLatency(microseconds_t measTime, microseconds_t latency)
     {
         SignalBlockI32 sb(1, 1);
-        sb.timestamps[0] = static_cast<uint64_t>(measTime.count());
-        sb.data(0, 0) = latency.count();
-        m_latStream->push(sb);
+        sb.mutableTimestamps()[0] = static_cast<uint64_t>(measTime.count());
+        sb.mutableData()(0, 0) = latency.count();
+        m_latStream->push(std::move(sb));
 
         m_canvas->addValue(static_cast<float>(latency.count() / (float)US_PER_MS));
     }
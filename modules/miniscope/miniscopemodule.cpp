@@ -276,11 +276,12 @@ public:
 
             if (self->m_bnoVecOut->isActive()) {
                 SignalBlockF32 sblock(1, 4);
-                sblock.timestamps(0, 0) = updatedFrameTime.count();
-                sblock.data(0, 0) = orientation[0];
-                sblock.data(0, 1) = orientation[1];
-                sblock.data(0, 2) = orientation[2];
-                sblock.data(0, 3) = orientation[3];
+                auto &sdata = sblock.mutableData();
+                sblock.mutableTimestamps()(0, 0) = updatedFrameTime.count();
+                sdata(0, 0) = orientation[0];
+                sdata(0, 1) = orientation[1];
+                sdata(0, 2) = orientation[2];
+                sdata(0, 3) = orientation[3];
 
                 self->m_bnoVecOut->push(sblock);
             }
@@ -184,10 +184,11 @@ public:
             if (!sblock.has_value())
                 continue;
 
-            const auto qw = sblock->data(0, 0);
-            const auto qx = sblock->data(0, 1);
-            const auto qy = sblock->data(0, 2);
-            const auto qz = sblock->data(0, 3);
+            const auto &qdata = sblock->data();
+            const auto qw = qdata(0, 0);
+            const auto qx = qdata(0, 1);
+            const auto qy = qdata(0, 2);
+            const auto qz = qdata(0, 3);
 
             double yawEuler = atan2(2 * (qw * qz + qx * qy), 1 - 2 * (qy * qy + qz * qz));
             double yaw2Pi = fmod(yawEuler + 2 * M_PI, 2 * M_PI);
@@ -413,8 +413,10 @@ public:
                     continue;
                 }
 
-                g.block->data.resize(n, outCps);
-                g.block->timestamps = syncedTs;
+                // the previous block was handed to the stream, so this allocates a fresh payload
+                auto &blockData = g.block->mutableData();
+                blockData.resize(n, outCps);
+                g.block->setTimestamps(syncedTs);
 
                 // Row-major copy with mask: pick enabledLocalIndices[outCol]
                 // from each raw row, copy values, and zero-fill any
@@ -423,13 +425,13 @@ public:
                     const uint16_t *row = chunk.samples.data() + static_cast<size_t>(s) * rawCps;
                     for (int oc = 0; oc < outCps; ++oc) {
                         if (g.mutedOutputColumns[oc].load(std::memory_order_relaxed))
-                            g.block->data(s, oc) = 0;
+                            blockData(s, oc) = 0;
                         else
-                            g.block->data(s, oc) = row[g.enabledLocalIndices[oc]];
+                            blockData(s, oc) = row[g.enabledLocalIndices[oc]];
                     }
                 }
 
-                g.stream->push(*g.block);
+                g.stream->push(std::move(*g.block));
             }
 
             // Dispatch any incoming TTL trigger commands onto the board.
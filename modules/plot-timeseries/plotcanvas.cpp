@@ -22,14 +22,12 @@
 #include <QTimer>
 #include <algorithm>
 #include <cstdint>
-#include <cstring>
 #include <format>
 #include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <memory_resource>
 
 #include "qtimgui.h"
 #include <imgui.h>
@@ -37,121 +35,7 @@
 #include <implot_internal.h>
 #include <xxhash.h>
 
-template<typename T>
-class RingBuffer
-{
-public:
-    explicit RingBuffer(size_t cap = 80 * 1000)
-        : m_capacity(cap),
-          m_head(0),
-          m_count(0)
-    {
-        m_data.resize(cap);
-    }
-
-    void add(const T &value)
-    {
-        m_data[m_head] = value;
-        m_head = (m_head + 1) % m_capacity;
-        if (m_count < m_capacity)
-            ++m_count;
-    }
-
-    void add(const T *src, size_t n)
-    {
-        if (n == 0 || m_capacity == 0)
-            return;
-        if (n >= m_capacity) {
-            src += (n - m_capacity);
-            n = m_capacity;
-        }
-        const size_t tail = m_capacity - m_head;
-        if (n <= tail) {
-            std::memcpy(m_data.data() + m_head, src, n * sizeof(T));
-        } else {
-            std::memcpy(m_data.data() + m_head, src, tail * sizeof(T));
-            std::memcpy(m_data.data(), src + tail, (n - tail) * sizeof(T));
-        }
-        m_head = (m_head + n) % m_capacity;
-        m_count = std::min(m_count + n, m_capacity);
-    }
-
-    // Copy logical elements [from, from+len) in oldest-first order into dst.
-    void copyRange(size_t from, size_t len, T *dst) const
-    {
-        if (len == 0 || from >= m_count)
-            return;
-        len = std::min(len, m_count - from);
-        const size_t off = (m_count == m_capacity) ? m_head : 0;
-        const size_t start = (off + from) % m_capacity;
-        const size_t part1 = std::min(len, m_capacity - start);
-        std::memcpy(dst, m_data.data() + start, part1 * sizeof(T));
-        if (len > part1)
-            std::memcpy(dst + part1, m_data.data(), (len - part1) * sizeof(T));
-    }
-
-    // First logical index where value >= threshold (ring must be sorted ascending).
-    size_t lowerBoundLogical(T threshold, size_t startIdx = 0) const
-    {
-        if (m_count == 0 || startIdx >= m_count)
-            return startIdx;
-        const size_t off = (m_count == m_capacity) ? m_head : 0;
-        size_t lo = startIdx, hi = m_count;
-        while (lo < hi) {
-            const size_t mid = (lo + hi) / 2;
-            if (m_data[(off + mid) % m_capacity] < threshold)
-                lo = mid + 1;
-            else
-                hi = mid;
-        }
-        return lo;
-    }
-
-    const T *data() const
-    {
-        return m_data.data();
-    }
-
-    int offset() const
-    {
-        return (m_count == m_capacity) ? static_cast<int>(m_head) : 0;
-    }
-
-    bool isEmpty() const
-    {
-        return m_count == 0;
-    }
-
-    T last() const
-    {
-        return m_data[(m_head + m_capacity - 1) % m_capacity];
-    }
-
-    size_t size() const
-    {
-        return m_count;
-    }
-
-    void clear()
-    {
-        m_head = 0;
-        m_count = 0;
-    }
-
-    void setCapacity(size_t cap)
-    {
-        m_capacity = cap;
-        m_data.assign(cap, T{});
-        m_head = 0;
-        m_count = 0;
-    }
-
-private:
-    std::pmr::vector<T> m_data;
-    size_t m_capacity;
-    size_t m_head;
-    size_t m_count;
-};
+#include "sampleringbuffer.h"
 
 struct ChannelData {
     std::string portId;
@@ -159,7 +43,7 @@ struct ChannelData {
     std::string signalName;
     bool digital = false;
     bool enabled = true;
-    RingBuffer<float> samples;
+    SampleRingBuffer samples;
 };
 
 struct PortData {
@@ -261,7 +145,8 @@ public:
     struct PortSnap {
         std::string yLabel;
         size_t visFrom = 0;    // logical ring index where visible window starts
-        std::vector<float> ts; // timestamps[visFrom .. end)
+        size_t visLen = 0;     // number of timestamps in the visible window
+        std::vector<float> ts; // timestamps[visFrom .. end), only filled if needed
     };
 
     struct ChannelSnap {
@@ -274,10 +159,10 @@ public:
         size_t visLen = 0;
         std::vector<float> samples;
 
-        // Digital-only: self-contained timestamps (including the synthetic right-edge
-        // hold point). When non-empty, render uses these instead of the shared port
-        // snapshot, so a held line value stays visible across the whole window even
-        // when its last edge predates the window start.
+        // Self-contained timestamps of sample-and-hold channels (including the synthetic
+        // right-edge hold point) and of decimated channels. When non-empty, render uses
+        // these instead of the shared port snapshot, so e.g. a held line value stays visible
+        // across the whole window even when its last edge predates the window start.
         std::vector<float> tsOwn;
     };
 
@@ -296,8 +181,7 @@ public:
     std::vector<GraphSnap> graphSnaps;
 
     // Decimation scratch (reused each frame, overwritten per channel)
-    std::vector<float> decTs;
-    std::vector<float> decSamples;
+    std::vector<size_t> decIdx;
     float lastFrameWidth = 800.0f;
 };
 
@@ -426,7 +310,7 @@ void PlotCanvas::tombstoneChannels(const std::set<size_t> &removed)
     for (int ci : removed) {
         auto &c = d->channels[ci];
         c.enabled = false;
-        c.samples = RingBuffer<float>(0);
+        c.samples = SampleRingBuffer(0);
         c.portId.clear();
         c.signalName.clear();
     }
@@ -589,7 +473,7 @@ void PlotCanvas::setChannelEnabled(int channelIndex, bool enabled)
     if (enabled)
         c.samples.setCapacity(d->bufferSize);
     else
-        c.samples = RingBuffer<float>(0);
+        c.samples = SampleRingBuffer(0);
 }
 
 void PlotCanvas::setChannelDigital(int channelIndex, bool digital)
@@ -869,61 +753,6 @@ void PlotCanvas::loadGraphs(const QVariantList &v)
     Q_EMIT layoutChanged();
 }
 
-// Build a min/max envelope: for each of nBins time-ordered bins across [ts,samples)(length n),
-// emit the sample at the min and the sample at the max (1 or 2 points per bin, time-ordered).
-// Reduces rendering cost while preserving spike visibility.
-static void decimateMinMax(
-    const float *ts,
-    const float *samples,
-    size_t n,
-    std::vector<float> &outTs,
-    std::vector<float> &outSamples,
-    size_t nBins)
-{
-    outTs.clear();
-    outSamples.clear();
-    if (n == 0 || nBins == 0)
-        return;
-    outTs.reserve(nBins * 2);
-    outSamples.reserve(nBins * 2);
-
-    const double step = (double)n / nBins;
-    for (size_t b = 0; b < nBins; ++b) {
-        const size_t i0 = (size_t)(b * step);
-        const size_t i1 = std::min((size_t)((b + 1) * step + 0.5), n);
-        if (i0 >= i1)
-            continue;
-
-        float vMin = samples[i0], vMax = samples[i0];
-        size_t iMin = i0, iMax = i0;
-        for (size_t i = i0 + 1; i < i1; ++i) {
-            if (samples[i] < vMin) {
-                vMin = samples[i];
-                iMin = i;
-            }
-            if (samples[i] > vMax) {
-                vMax = samples[i];
-                iMax = i;
-            }
-        }
-
-        if (iMin == iMax) {
-            outTs.push_back(ts[iMin]);
-            outSamples.push_back(vMin);
-        } else if (iMin < iMax) {
-            outTs.push_back(ts[iMin]);
-            outSamples.push_back(vMin);
-            outTs.push_back(ts[iMax]);
-            outSamples.push_back(vMax);
-        } else {
-            outTs.push_back(ts[iMax]);
-            outSamples.push_back(vMax);
-            outTs.push_back(ts[iMin]);
-            outSamples.push_back(vMin);
-        }
-    }
-}
-
 /**
  * Mirrors ImPlot's NiceNum (vendor/implot/implot.cpp). Kept local so we can
  * derive a tick list identical in spirit to the default locator but shared
@@ -1066,7 +895,8 @@ void PlotCanvas::paintGL()
         }
         const auto tMin = (float)d->xLinkMin;
 
-        // Per-port: copy the visible timestamp window into portSnaps.
+        // Per-port: find the visible timestamp window. Its timestamps are only copied once
+        // a channel needs them for drawing raw samples, decimated channels look up their own.
         d->portSnaps.clear();
         for (const auto &[portId, pd] : d->ports) {
             const size_t tsTotal = pd.timestamps.size();
@@ -1075,13 +905,14 @@ void PlotCanvas::paintGL()
             Private::PortSnap ps;
             ps.yLabel = pd.yLabel;
             ps.visFrom = pd.timestamps.lowerBoundLogical(tMin);
-            const size_t visLen = tsTotal - ps.visFrom;
-            ps.ts.resize(visLen);
-            if (visLen > 0)
-                pd.timestamps.copyRange(ps.visFrom, visLen, ps.ts.data());
+            ps.visLen = tsTotal - ps.visFrom;
             d->portSnaps.emplace(portId, std::move(ps));
         }
 
+        // Channels with more visible samples than this get reduced to a min/max envelope
+        // of 2 x pixelWidth bins, so the cost of drawing is proportional to display pixels.
+        const size_t pixW = (size_t)std::max(d->lastFrameWidth, 64.0f);
+
         // Per-channel: copy matching samples, aligned to the port's ts window.
         d->channelSnaps.clear();
         for (int ci = 0; ci < (int)d->channels.size(); ++ci) {
@@ -1137,10 +968,10 @@ void PlotCanvas::paintGL()
             const auto psIt = d->portSnaps.find(c.portId);
             if (psIt == d->portSnaps.end())
                 continue;
-            const auto &ps = psIt->second;
+            auto &ps = psIt->second;
 
             // tsTotal - ring's current count; reconstruct from snapshot fields
-            const size_t tsTotal = ps.visFrom + ps.ts.size();
+            const size_t tsTotal = ps.visFrom + ps.visLen;
             const size_t sampTotal = c.samples.size();
             // Samples correspond to the last sampTotal entries of the ts ring.
             const size_t tsStart = tsTotal >= sampTotal ? tsTotal - sampTotal : 0;
@@ -1157,6 +988,24 @@ void PlotCanvas::paintGL()
             cs.tsOffset = adjVisFrom - ps.visFrom;
             cs.visLen = tsTotal - adjVisFrom;
             const size_t sampFrom = adjVisFrom - tsStart;
+
+            // Min/max envelope decimation, read from the channel's pyramid.
+            // Digital channels are skipped - their step edges must not be lost.
+            if (!c.digital && cs.visLen > pixW * 4) {
+                c.samples.minMaxEnvelope(sampFrom, cs.visLen, pixW * 2, d->decIdx, cs.samples);
+                cs.tsOwn.resize(d->decIdx.size());
+                for (size_t i = 0; i < d->decIdx.size(); ++i)
+                    cs.tsOwn[i] = pd.timestamps.at(tsStart + d->decIdx[i]);
+                cs.tsOffset = 0;
+                cs.visLen = cs.samples.size();
+                d->channelSnaps.push_back(std::move(cs));
+                continue;
+            }
+
+            if (ps.ts.size() != ps.visLen) {
+                ps.ts.resize(ps.visLen);
+                pd.timestamps.copyRange(ps.visFrom, ps.visLen, ps.ts.data());
+            }
             cs.samples.resize(cs.visLen);
             c.samples.copyRange(sampFrom, cs.visLen, cs.samples.data());
             d->channelSnaps.push_back(std::move(cs));
@@ -1295,8 +1144,8 @@ void PlotCanvas::paintGL()
                 const auto &cs = d->channelSnaps[csi];
 
                 // Sample-and-hold channels carry their own timestamps (with a right-edge
-                // hold) so they stay visible while quiet; continuous channels share the
-                // port's visible-window snapshot.
+                // hold) so they stay visible while quiet, and so do decimated channels.
+                // Other continuous channels share the port's visible-window snapshot.
                 const float *tsPtr;
                 int n;
                 if (!cs.tsOwn.empty()) {
@@ -1311,19 +1160,6 @@ void PlotCanvas::paintGL()
                 }
                 const float *sampPtr = cs.samples.data();
 
-                // Min/max envelope decimation: reduce to at most 2 x pixelWidth
-                // points so rendering cost is proportional to display pixels.
-                // Digital channels are skipped - their step edges must not be lost.
-                if (!cs.digital) {
-                    const int pixW = (int)std::max(d->lastFrameWidth, 64.0f);
-                    if (n > pixW * 4) {
-                        decimateMinMax(tsPtr, sampPtr, n, d->decTs, d->decSamples, pixW * 2);
-                        tsPtr = d->decTs.data();
-                        sampPtr = d->decSamples.data();
-                        n = (int)d->decTs.size();
-                    }
-                }
-
                 const auto label = std::format("{}##c{}", cs.signalName, cs.channelIdx);
                 const ImVec4 col = colorForChannel(cs.portId, cs.signalName, cs.colIdx);
                 ImPlotSpec spec;
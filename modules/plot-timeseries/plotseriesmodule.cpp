@@ -247,7 +247,7 @@ public:
             if (!maybeData.has_value())
                 break;
             const auto &data = *maybeData;
-            const int nCols = data.data.cols();
+            const int nCols = data.cols();
 
             // Grow the index cache on first sight of a new column count.
             if ((int)sd.channelIdxByCol.size() < nCols)
@@ -261,9 +261,9 @@ public:
 
             // One lock acquisition per block for all channels.
             if constexpr (std::is_same_v<T, SignalBlockI32>)
-                canvas->appendBlockI(sd.portId, data.timestamps, data.data, sd.channelIdxByCol.data(), nCols);
+                canvas->appendBlockI(sd.portId, data.timestamps(), data.data(), sd.channelIdxByCol.data(), nCols);
             else
-                canvas->appendBlockF(sd.portId, data.timestamps, data.data, sd.channelIdxByCol.data(), nCols);
+                canvas->appendBlockF(sd.portId, data.timestamps(), data.data(), sd.channelIdxByCol.data(), nCols);
         }
     }
 
@@ -0,0 +1,455 @@
+/*
+ * Copyright (C) 2024-2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+template<typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(size_t cap = 80 * 1000)
+        : m_capacity(cap),
+          m_head(0),
+          m_count(0)
+    {
+        m_data.resize(cap);
+    }
+
+    void add(const T &value)
+    {
+        m_data[m_head] = value;
+        m_head = (m_head + 1) % m_capacity;
+        if (m_count < m_capacity)
+            ++m_count;
+    }
+
+    void add(const T *src, size_t n)
+    {
+        if (n == 0 || m_capacity == 0)
+            return;
+        if (n >= m_capacity) {
+            src += (n - m_capacity);
+            n = m_capacity;
+        }
+        const size_t tail = m_capacity - m_head;
+        if (n <= tail) {
+            std::memcpy(m_data.data() + m_head, src, n * sizeof(T));
+        } else {
+            std::memcpy(m_data.data() + m_head, src, tail * sizeof(T));
+            std::memcpy(m_data.data(), src + tail, (n - tail) * sizeof(T));
+        }
+        m_head = (m_head + n) % m_capacity;
+        m_count = std::min(m_count + n, m_capacity);
+    }
+
+    // Copy logical elements [from, from+len) in oldest-first order into dst.
+    void copyRange(size_t from, size_t len, T *dst) const
+    {
+        if (len == 0 || from >= m_count)
+            return;
+        len = std::min(len, m_count - from);
+        const size_t off = (m_count == m_capacity) ? m_head : 0;
+        const size_t start = (off + from) % m_capacity;
+        const size_t part1 = std::min(len, m_capacity - start);
+        std::memcpy(dst, m_data.data() + start, part1 * sizeof(T));
+        if (len > part1)
+            std::memcpy(dst + part1, m_data.data(), (len - part1) * sizeof(T));
+    }
+
+    // First logical index where value >= threshold (ring must be sorted ascending).
+    size_t lowerBoundLogical(T threshold, size_t startIdx = 0) const
+    {
+        if (m_count == 0 || startIdx >= m_count)
+            return startIdx;
+        const size_t off = (m_count == m_capacity) ? m_head : 0;
+        size_t lo = startIdx, hi = m_count;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (m_data[(off + mid) % m_capacity] < threshold)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // Element at logical index idx, in oldest-first order.
+    T at(size_t idx) const
+    {
+        const size_t off = (m_count == m_capacity) ? m_head : 0;
+        return m_data[(off + idx) % m_capacity];
+    }
+
+    const T *data() const
+    {
+        return m_data.data();
+    }
+
+    int offset() const
+    {
+        return (m_count == m_capacity) ? static_cast<int>(m_head) : 0;
+    }
+
+    bool isEmpty() const
+    {
+        return m_count == 0;
+    }
+
+    T last() const
+    {
+        return m_data[(m_head + m_capacity - 1) % m_capacity];
+    }
+
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    void clear()
+    {
+        m_head = 0;
+        m_count = 0;
+    }
+
+    void setCapacity(size_t cap)
+    {
+        m_capacity = cap;
+        m_data.assign(cap, T{});
+        m_head = 0;
+        m_count = 0;
+    }
+
+private:
+    std::pmr::vector<T> m_data;
+    size_t m_capacity;
+    size_t m_head;
+    size_t m_count;
+};
+
+/**
+ * Ring buffer for the samples of a channel, with an incrementally maintained min/max pyramid.
+ *
+ * Level l of the pyramid splits the stream of samples into buckets of
+ * kMinMaxBaseBucket * kMinMaxFactor^l samples and keeps the minimum and maximum
+ * of every complete bucket that is still (partially) held by the ring.
+ * This lets us draw a min/max envelope of any window at a cost proportional
+ * to the number of bins, independent of the sample rate and history length.
+ */
+class SampleRingBuffer
+{
+public:
+    explicit SampleRingBuffer(size_t cap = 80 * 1000)
+        : m_ring(cap),
+          m_total(0)
+    {
+        resetLevels(cap);
+    }
+
+    void add(const float *src, size_t n)
+    {
+        m_ring.add(src, n);
+        if (m_levels.empty()) {
+            m_total += n;
+            return;
+        }
+
+        auto &l0 = m_levels[0];
+        while (n > 0) {
+            const size_t take = std::min(n, l0.bucketSize - l0.fill);
+            mergeRaw(l0.partial, l0.fill == 0, src, take, static_cast<uint32_t>(l0.fill));
+            l0.fill += take;
+            m_total += take;
+            src += take;
+            n -= take;
+            if (l0.fill == l0.bucketSize)
+                commitBucket(0);
+        }
+    }
+
+    void copyRange(size_t from, size_t len, float *dst) const
+    {
+        m_ring.copyRange(from, len, dst);
+    }
+
+    size_t size() const
+    {
+        return m_ring.size();
+    }
+
+    void clear()
+    {
+        m_ring.clear();
+        m_total = 0;
+        for (auto &level : m_levels)
+            level.fill = 0;
+    }
+
+    void setCapacity(size_t cap)
+    {
+        m_ring.setCapacity(cap);
+        m_total = 0;
+        resetLevels(cap);
+    }
+
+    /**
+     * Build a min/max envelope of the logical sample range [from, from + len) with about
+     * nBins bins. Every bin contributes its minimum and maximum sample (one point if they
+     * coincide) in time order, as logical sample index and value.
+     */
+    void minMaxEnvelope(
+        size_t from,
+        size_t len,
+        size_t nBins,
+        std::vector<size_t> &outIdx,
+        std::vector<float> &outSamples) const
+    {
+        outIdx.clear();
+        outSamples.clear();
+        if (len == 0 || nBins == 0 || from + len > m_ring.size())
+            return;
+        outIdx.reserve(nBins * 2 + 8);
+        outSamples.reserve(nBins * 2 + 8);
+
+        const uint64_t base = m_total - m_ring.size();
+        const uint64_t a0 = base + from;
+        const uint64_t a1 = a0 + len;
+        const size_t binLen = (len + nBins - 1) / nBins;
+
+        // use the coarsest level whose buckets still fit into a bin
+        const Level *level = nullptr;
+        for (const auto &l : m_levels) {
+            if (l.bucketSize > binLen)
+                break;
+            level = &l;
+        }
+
+        const auto emit = [&](const Bucket &b, uint64_t bucketStart) {
+            const uint64_t iMin = bucketStart + b.minOffset - base;
+            const uint64_t iMax = bucketStart + b.maxOffset - base;
+            if (iMin == iMax) {
+                outIdx.push_back(iMin);
+                outSamples.push_back(b.min);
+            } else if (iMin < iMax) {
+                outIdx.push_back(iMin);
+                outSamples.push_back(b.min);
+                outIdx.push_back(iMax);
+                outSamples.push_back(b.max);
+            } else {
+                outIdx.push_back(iMax);
+                outSamples.push_back(b.max);
+                outIdx.push_back(iMin);
+                outSamples.push_back(b.min);
+            }
+        };
+
+        const auto emitRaw = [&](uint64_t start, uint64_t end) {
+            for (uint64_t binStart = start; binStart < end; binStart += binLen) {
+                const uint64_t binEnd = std::min<uint64_t>(binStart + binLen, end);
+                Bucket b;
+                for (uint64_t i = binStart; i < binEnd; ++i) {
+                    const float v = m_ring.at(i - base);
+                    const auto off = static_cast<uint32_t>(i - binStart);
+                    if (i == binStart || v < b.min) {
+                        b.min = v;
+                        b.minOffset = off;
+                    }
+                    if (i == binStart || v > b.max) {
+                        b.max = v;
+                        b.maxOffset = off;
+                    }
+                }
+                emit(b, binStart);
+            }
+        };
+
+        if (level == nullptr) {
+            emitRaw(a0, a1);
+            return;
+        }
+
+        // buckets that are fully inside the window, raw samples before and after them
+        const uint64_t bs = level->bucketSize;
+        const uint64_t complete = (m_total / bs) * bs;
+        const uint64_t b0 = (a0 + bs - 1) / bs * bs;
+        const uint64_t b1 = std::min(a1 / bs * bs, complete);
+        if (b1 <= b0) {
+            emitRaw(a0, a1);
+            return;
+        }
+
+        emitRaw(a0, b0);
+        const uint64_t bucketsPerBin = std::max<uint64_t>(1, (binLen + bs / 2) / bs);
+        for (uint64_t bn = b0 / bs; bn < b1 / bs; bn += bucketsPerBin) {
+            const uint64_t bnEnd = std::min(bn + bucketsPerBin, b1 / bs);
+            Bucket b = level->buckets[bn % level->buckets.size()];
+            for (uint64_t child = bn + 1; child < bnEnd; ++child)
+                mergeBucket(b, level->buckets[child % level->buckets.size()], (child - bn) * bs);
+            emit(b, bn * bs);
+        }
+        emitRaw(b1, a1);
+    }
+
+    /// Minimum and maximum of a run of samples, positions are absolute sample numbers.
+    struct MinMax {
+        float min = 0;
+        float max = 0;
+        uint64_t minPos = 0;
+        uint64_t maxPos = 0;
+        uint64_t start = 0;
+        uint64_t count = 0;
+    };
+
+    size_t levelCount() const
+    {
+        return m_levels.size();
+    }
+
+    size_t levelBucketSize(size_t l) const
+    {
+        return m_levels[l].bucketSize;
+    }
+
+    /// Number of samples ever added, including the ones that were dropped from the ring again.
+    uint64_t totalAdded() const
+    {
+        return m_total;
+    }
+
+    /**
+     * Min/max of bucket @p bucketNo of pyramid level @p l, with buckets counted from the very first
+     * sample. For the current, incomplete bucket this covers everything merged into it so far.
+     * Returns nothing for buckets that are not started yet or no longer held by the ring.
+     */
+    std::optional<MinMax> levelBucket(size_t l, uint64_t bucketNo) const
+    {
+        const auto &level = m_levels[l];
+        const uint64_t bs = level.bucketSize;
+        const uint64_t base = m_total - m_ring.size();
+        const uint64_t start = bucketNo * bs;
+
+        const Bucket *b = nullptr;
+        uint64_t count = bs;
+        if (start + bs <= m_total) {
+            if (start + bs <= base)
+                return std::nullopt;
+            b = &level.buckets[bucketNo % level.buckets.size()];
+        } else if (bucketNo == m_total / bs && level.fill > 0) {
+            b = &level.partial;
+            count = (l == 0) ? level.fill : level.fill * m_levels[l - 1].bucketSize;
+        } else {
+            return std::nullopt;
+        }
+
+        return MinMax{b->min, b->max, start + b->minOffset, start + b->maxOffset, start, count};
+    }
+
+private:
+    // Offsets are relative to the start of the bucket
+    struct Bucket {
+        float min = 0;
+        float max = 0;
+        uint32_t minOffset = 0;
+        uint32_t maxOffset = 0;
+    };
+
+    struct Level {
+        size_t bucketSize = 0;
+        size_t fill = 0; // samples (level 0) or child buckets merged into the partial bucket
+        Bucket partial;
+        std::vector<Bucket> buckets;
+    };
+
+    static constexpr size_t kMinMaxBaseBucket = 32;
+    static constexpr size_t kMinMaxFactor = 8;
+    static constexpr size_t kMinMaxMaxLevels = 8;
+
+    RingBuffer<float> m_ring;
+    std::vector<Level> m_levels;
+    uint64_t m_total; // number of samples ever added
+
+    void resetLevels(size_t cap)
+    {
+        m_levels.clear();
+        size_t bucketSize = kMinMaxBaseBucket;
+        while (bucketSize <= cap && m_levels.size() < kMinMaxMaxLevels) {
+            Level level;
+            level.bucketSize = bucketSize;
+            // the ring may overlap with one partially overwritten bucket on either end
+            level.buckets.resize(cap / bucketSize + 2);
+            m_levels.push_back(std::move(level));
+            bucketSize *= kMinMaxFactor;
+        }
+    }
+
+    static void mergeRaw(Bucket &b, bool first, const float *src, size_t n, uint32_t offset)
+    {
+        if (first) {
+            b.min = b.max = src[0];
+            b.minOffset = b.maxOffset = offset;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (src[i] < b.min) {
+                b.min = src[i];
+                b.minOffset = offset + static_cast<uint32_t>(i);
+            }
+            if (src[i] > b.max) {
+                b.max = src[i];
+                b.maxOffset = offset + static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    static void mergeBucket(Bucket &b, const Bucket &child, uint64_t childOffset)
+    {
+        if (child.min < b.min) {
+            b.min = child.min;
+            b.minOffset = static_cast<uint32_t>(childOffset + child.minOffset);
+        }
+        if (child.max > b.max) {
+            b.max = child.max;
+            b.maxOffset = static_cast<uint32_t>(childOffset + child.maxOffset);
+        }
+    }
+
+    // Store the completed partial bucket of level l, and fold it into the next level.
+    void commitBucket(size_t l)
+    {
+        auto &level = m_levels[l];
+        const uint64_t bucketNo = m_total / level.bucketSize - 1;
+        level.buckets[bucketNo % level.buckets.size()] = level.partial;
+        level.fill = 0;
+
+        if (l + 1 >= m_levels.size())
+            return;
+        auto &next = m_levels[l + 1];
+        if (next.fill == 0)
+            next.partial = level.partial;
+        else
+            mergeBucket(next.partial, level.partial, next.fill * level.bucketSize);
+        if (++next.fill == kMinMaxFactor)
+            commitBucket(l + 1);
+    }
+};
@@ -20,161 +20,130 @@
 #include "filterpipeline.h"
 
 #include <Iir.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <pthread.h>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <pmmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+// The iir1 filters are only used to design the sections, so the state type of
+// their delay lines does not matter. TDF-II matches what processChannels() runs.
+using StateT = Iir::TransposedDirectFormII;
 
-IStageFilter::~IStageFilter() = default;
+/// Minimum number of channels worth handing to a separate thread
+static constexpr size_t MIN_CHANNELS_PER_THREAD = 32;
+/// Minimum number of section evaluations (rows * channels * sections) in a block to use worker threads
+static constexpr size_t MIN_PARALLEL_BLOCK_WORK = 64 * 1024;
+/// Channel ranges and state rows are aligned to this many channels (a cache line of floats)
+static constexpr size_t CHANNEL_ALIGN = 16;
 
-// Transposed Direct Form II is numerically better behaved than the default
-// DirectFormII at the low normalised cutoffs common in electrophysiology.
-using StateT = Iir::TransposedDirectFormII;
+static BiquadCoeffs biquadCoeffs(const Iir::Biquad &bq)
+{
+    const double a0 = bq.getA0();
+    return {bq.getB0() / a0, bq.getB1() / a0, bq.getB2() / a0, bq.getA1() / a0, bq.getA2() / a0};
+}
 
 /**
- * @brief Concrete wrapper holding one iir1 filter object (with its state).
+ * @brief Set up an iir1 filter of type @p IirT and return the sections it is made of.
  */
-template<typename IirT>
-class StageFilterT final : public IStageFilter
+template<typename IirT, typename... Args>
+static std::vector<BiquadCoeffs> designSections(Args... args)
 {
-public:
-    IirT inner;
-
-    double process(double x) override
-    {
-        return inner.filter(x);
+    IirT filter;
+    filter.setup(args...);
+
+    if constexpr (std::is_base_of_v<Iir::Biquad, IirT>) {
+        return {biquadCoeffs(filter)};
+    } else {
+        std::vector<BiquadCoeffs> result;
+        for (int i = 0; i < filter.getNumStages(); ++i)
+            result.push_back(biquadCoeffs(filter[i]));
+        return result;
     }
-
-    void reset() override
-    {
-        inner.reset();
-    }
-};
-
-template<typename IirT>
-std::unique_ptr<StageFilterT<IirT>> makeWrapper()
-{
-    return std::make_unique<StageFilterT<IirT>>();
 }
 
-static std::unique_ptr<IStageFilter> makeButterworth(const FilterStage &st, double fs, int order)
+static std::vector<BiquadCoeffs> designButterworth(const FilterStage &st, double fs, int order)
 {
     using namespace Iir::Butterworth;
     switch (st.response) {
-    case FilterResponse::LowPass: {
-        auto f = makeWrapper<LowPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1);
-        return f;
-    }
-    case FilterResponse::HighPass: {
-        auto f = makeWrapper<HighPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1);
-        return f;
-    }
-    case FilterResponse::BandPass: {
-        auto f = makeWrapper<BandPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.freq2);
-        return f;
-    }
-    case FilterResponse::BandStop: {
-        auto f = makeWrapper<BandStop<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.freq2);
-        return f;
-    }
+    case FilterResponse::LowPass:
+        return designSections<LowPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1);
+    case FilterResponse::HighPass:
+        return designSections<HighPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1);
+    case FilterResponse::BandPass:
+        return designSections<BandPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.freq2);
+    case FilterResponse::BandStop:
+        return designSections<BandStop<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.freq2);
     }
 
     throw std::invalid_argument("unknown filter response");
 }
 
-static std::unique_ptr<IStageFilter> makeChebyshevI(const FilterStage &st, double fs, int order)
+static std::vector<BiquadCoeffs> designChebyshevI(const FilterStage &st, double fs, int order)
 {
     using namespace Iir::ChebyshevI;
     switch (st.response) {
-    case FilterResponse::LowPass: {
-        auto f = makeWrapper<LowPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.rippleDb);
-        return f;
-    }
-    case FilterResponse::HighPass: {
-        auto f = makeWrapper<HighPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.rippleDb);
-        return f;
-    }
-    case FilterResponse::BandPass: {
-        auto f = makeWrapper<BandPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.freq2, st.rippleDb);
-        return f;
-    }
-    case FilterResponse::BandStop: {
-        auto f = makeWrapper<BandStop<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.freq2, st.rippleDb);
-        return f;
-    }
+    case FilterResponse::LowPass:
+        return designSections<LowPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.rippleDb);
+    case FilterResponse::HighPass:
+        return designSections<HighPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.rippleDb);
+    case FilterResponse::BandPass:
+        return designSections<BandPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.freq2, st.rippleDb);
+    case FilterResponse::BandStop:
+        return designSections<BandStop<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.freq2, st.rippleDb);
     }
 
     throw std::invalid_argument("unknown filter response");
 }
 
-static std::unique_ptr<IStageFilter> makeChebyshevII(const FilterStage &st, double fs, int order)
+static std::vector<BiquadCoeffs> designChebyshevII(const FilterStage &st, double fs, int order)
 {
     using namespace Iir::ChebyshevII;
     switch (st.response) {
-    case FilterResponse::LowPass: {
-        auto f = makeWrapper<LowPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.stopbandDb);
-        return f;
-    }
-    case FilterResponse::HighPass: {
-        auto f = makeWrapper<HighPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.stopbandDb);
-        return f;
-    }
-    case FilterResponse::BandPass: {
-        auto f = makeWrapper<BandPass<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.freq2, st.stopbandDb);
-        return f;
-    }
-    case FilterResponse::BandStop: {
-        auto f = makeWrapper<BandStop<MAX_FILTER_ORDER, StateT>>();
-        f->inner.setup(order, fs, st.freq1, st.freq2, st.stopbandDb);
-        return f;
-    }
+    case FilterResponse::LowPass:
+        return designSections<LowPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.stopbandDb);
+    case FilterResponse::HighPass:
+        return designSections<HighPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.stopbandDb);
+    case FilterResponse::BandPass:
+        return designSections<BandPass<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.freq2, st.stopbandDb);
+    case FilterResponse::BandStop:
+        return designSections<BandStop<MAX_FILTER_ORDER, StateT>>(order, fs, st.freq1, st.freq2, st.stopbandDb);
     }
 
     throw std::invalid_argument("unknown filter response");
 }
 
-static std::unique_ptr<IStageFilter> makeCustomSos(const FilterStage &st)
+static std::vector<BiquadCoeffs> designCustomSos(const FilterStage &st)
 {
     if (st.sos.empty())
         throw std::invalid_argument(
             "Custom (SOS) filter has no valid coefficients (expected lines of 6 numbers: b0 b1 b2 a0 a1 a2)");
-
-    // The number of sections is a compile-time template parameter, so we always
-    // instantiate the maximum and pad unused sections with the identity biquad
-    // {b0,b1,b2,a0,a1,a2} = {1,0,0,1,0,0} (transfer function H(z) = 1).
-    double coeffs[MAX_SOS_SECTIONS][6];
-    for (int i = 0; i < MAX_SOS_SECTIONS; ++i) {
-        coeffs[i][0] = 1.0;
-        coeffs[i][1] = 0.0;
-        coeffs[i][2] = 0.0;
-        coeffs[i][3] = 1.0;
-        coeffs[i][4] = 0.0;
-        coeffs[i][5] = 0.0;
-    }
-
     if (static_cast<int>(st.sos.size()) > MAX_SOS_SECTIONS)
         throw std::invalid_argument("too many second-order-sections (max " + std::to_string(MAX_SOS_SECTIONS) + ")");
 
-    const int n = static_cast<int>(st.sos.size());
-    for (int i = 0; i < n; ++i)
-        for (int j = 0; j < 6; ++j)
-            coeffs[i][j] = st.sos[static_cast<size_t>(i)][static_cast<size_t>(j)];
-
-    auto f = makeWrapper<Iir::Custom::SOSCascade<MAX_SOS_SECTIONS, StateT>>();
-    f->inner.setup(coeffs);
+    // scipy order is {b0,b1,b2,a0,a1,a2}, we normalise every section to a0 = 1
+    std::vector<BiquadCoeffs> result;
+    result.reserve(st.sos.size());
+    for (size_t i = 0; i < st.sos.size(); ++i) {
+        const auto &row = st.sos[i];
+        if (row[3] == 0.0)
+            throw std::invalid_argument("second-order-section " + std::to_string(i + 1) + " has a0 = 0");
+        result.push_back({row[0] / row[3], row[1] / row[3], row[2] / row[3], row[4] / row[3], row[5] / row[3]});
+    }
 
-    return f;
+    return result;
 }
 
-std::unique_ptr<IStageFilter> makeStageFilter(const FilterStage &stage, double sampleRate)
+std::vector<BiquadCoeffs> designStageSections(const FilterStage &stage, double sampleRate)
 {
     if (stage.needsSampleRate() && !(sampleRate > 0.0))
         throw std::invalid_argument("a valid sample rate is required for this filter");
@@ -187,23 +156,123 @@ std::unique_ptr<IStageFilter> makeStageFilter(const FilterStage &stage, double s
 
     switch (stage.family) {
     case FilterFamily::Butterworth:
-        return makeButterworth(stage, sampleRate, order);
+        return designButterworth(stage, sampleRate, order);
     case FilterFamily::ChebyshevI:
-        return makeChebyshevI(stage, sampleRate, order);
+        return designChebyshevI(stage, sampleRate, order);
     case FilterFamily::ChebyshevII:
-        return makeChebyshevII(stage, sampleRate, order);
-    case FilterFamily::RbjNotch: {
-        auto f = makeWrapper<Iir::RBJ::IIRNotch>();
-        f->inner.setup(sampleRate, stage.freq1, stage.qFactor);
-        return f;
-    }
+        return designChebyshevII(stage, sampleRate, order);
+    case FilterFamily::RbjNotch:
+        return designSections<Iir::RBJ::IIRNotch>(sampleRate, stage.freq1, stage.qFactor);
     case FilterFamily::CustomSOS:
-        return makeCustomSos(stage);
+        return designCustomSos(stage);
     }
 
     throw std::invalid_argument("unknown filter family");
 }
 
+/**
+ * @brief Persistent worker threads that filter channel ranges of a block in parallel.
+ */
+class FilterPipeline::WorkerPool
+{
+public:
+    explicit WorkerPool(int workerCount)
+        : m_job(nullptr),
+          m_jobCount(0),
+          m_nextIndex(0),
+          m_pending(0),
+          m_stop(false)
+    {
+        for (int i = 0; i < workerCount; ++i)
+            m_threads.emplace_back(&WorkerPool::workerMain, this);
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_workCond.notify_all();
+        for (auto &t : m_threads)
+            t.join();
+    }
+
+    [[nodiscard]] int workerCount() const
+    {
+        return static_cast<int>(m_threads.size());
+    }
+
+    /**
+     * Call @p fn for every index in [0, count) and return once all calls have finished.
+     * The calling thread takes on indices too.
+     */
+    void run(size_t count, const std::function<void(size_t)> &fn)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job = &fn;
+        m_jobCount = count;
+        m_nextIndex = 0;
+        m_pending = count;
+        m_workCond.notify_all();
+
+        while (m_nextIndex < m_jobCount) {
+            const auto index = m_nextIndex++;
+            lock.unlock();
+            fn(index);
+            lock.lock();
+            m_pending--;
+        }
+
+        m_doneCond.wait(lock, [this] {
+            return m_pending == 0;
+        });
+        m_job = nullptr;
+    }
+
+private:
+    void workerMain()
+    {
+        pthread_setname_np(pthread_self(), "sigfilter_work");
+#if defined(__SSE2__)
+        // denormal delay-line values (e.g. on a silent channel) are very slow to compute with
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#endif
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_workCond.wait(lock, [this] {
+                return m_stop || (m_job != nullptr && m_nextIndex < m_jobCount);
+            });
+            if (m_stop)
+                return;
+
+            const auto index = m_nextIndex++;
+            const auto job = m_job;
+            lock.unlock();
+            (*job)(index);
+            lock.lock();
+            if (--m_pending == 0)
+                m_doneCond.notify_all();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_workCond;
+    std::condition_variable m_doneCond;
+    const std::function<void(size_t)> *m_job;
+    size_t m_jobCount;
+    size_t m_nextIndex;
+    size_t m_pending;
+    bool m_stop;
+};
+
+FilterPipeline::FilterPipeline() = default;
+
+FilterPipeline::~FilterPipeline() = default;
+
 bool FilterPipeline::needsSampleRate() const
 {
     for (const auto &st : m_stages)
@@ -229,7 +298,9 @@ static void fillActive(std::vector<char> &active, int channelCount, const std::v
 bool FilterPipeline::build(int channelCount, const std::vector<bool> &channelMask, std::string *error)
 {
     m_channelCount = -1;
-    m_channelFilters.clear();
+    m_sections.clear();
+    m_stateF64.clear();
+    m_stateF32.clear();
     m_active.clear();
 
     if (channelCount <= 0) {
@@ -239,22 +310,34 @@ bool FilterPipeline::build(int channelCount, const std::vector<bool> &channelMas
     }
 
     try {
-        // Build the filter chain for every channel; the mask only gates which
+        // All channels share the same coefficients; the mask only gates which
         // ones are active, so channels can be toggled live without a rebuild.
-        m_channelFilters.resize(static_cast<size_t>(channelCount));
-        for (int ch = 0; ch < channelCount; ++ch) {
-            auto &chain = m_channelFilters[static_cast<size_t>(ch)];
-            chain.reserve(m_stages.size());
-            for (const auto &st : m_stages)
-                chain.push_back(makeStageFilter(st, m_sampleRate));
+        for (const auto &st : m_stages) {
+            const auto sections = designStageSections(st, m_sampleRate);
+            m_sections.insert(m_sections.end(), sections.begin(), sections.end());
         }
     } catch (const std::exception &e) {
-        m_channelFilters.clear();
+        m_sections.clear();
         if (error)
             *error = e.what();
         return false;
     }
 
+    m_stateStride = (static_cast<size_t>(channelCount) + CHANNEL_ALIGN - 1) / CHANNEL_ALIGN * CHANNEL_ALIGN;
+    const auto stateSize = m_sections.size() * 2 * m_stateStride;
+    if (m_precision == FilterPrecision::Single)
+        m_stateF32.assign(stateSize, 0.0f);
+    else
+        m_stateF64.assign(stateSize, 0.0);
+
+    // only spawn as many workers as there are channel ranges to hand out
+    const auto maxRanges = std::max<size_t>(1, static_cast<size_t>(channelCount) / MIN_CHANNELS_PER_THREAD);
+    const auto workerCount = static_cast<int>(std::min<size_t>(static_cast<size_t>(m_threadCount), maxRanges)) - 1;
+    if (workerCount <= 0)
+        m_pool.reset();
+    else if (!m_pool || m_pool->workerCount() != workerCount)
+        m_pool = std::make_unique<WorkerPool>(workerCount);
+
     fillActive(m_active, channelCount, channelMask);
     m_channelCount = channelCount;
     return true;
@@ -269,7 +352,126 @@ void FilterPipeline::setChannelMask(const std::vector<bool> &channelMask)
 
 void FilterPipeline::reset()
 {
-    for (auto &chain : m_channelFilters)
-        for (auto &f : chain)
-            f->reset();
+    std::fill(m_stateF64.begin(), m_stateF64.end(), 0.0);
+    std::fill(m_stateF32.begin(), m_stateF32.end(), 0.0f);
+}
+
+template<typename T, typename Sample>
+void FilterPipeline::processChannels(Sample *data, size_t rows, size_t cols, size_t chBegin, size_t chEnd)
+{
+    const size_t n = chEnd - chBegin;
+    auto &state = [this]() -> std::vector<T> & {
+        if constexpr (std::is_same_v<T, float>)
+            return m_stateF32;
+        else
+            return m_stateF64;
+    }();
+
+    thread_local std::vector<T> workBuffer;
+    workBuffer.resize(n);
+    T *__restrict work = workBuffer.data();
+
+    for (size_t r = 0; r < rows; ++r) {
+        Sample *row = data + r * cols + chBegin;
+        for (size_t i = 0; i < n; ++i)
+            work[i] = static_cast<T>(row[i]);
+
+        // Transposed Direct Form II, one section at a time across all channels of the range.
+        // The channels are independent, so the compiler vectorises the inner loop.
+        for (size_t k = 0; k < m_sections.size(); ++k) {
+            const auto &sec = m_sections[k];
+            const T b0 = static_cast<T>(sec.b0);
+            const T b1 = static_cast<T>(sec.b1);
+            const T b2 = static_cast<T>(sec.b2);
+            const T a1 = static_cast<T>(sec.a1);
+            const T a2 = static_cast<T>(sec.a2);
+            T *__restrict s1 = state.data() + (2 * k) * m_stateStride + chBegin;
+            T *__restrict s2 = state.data() + (2 * k + 1) * m_stateStride + chBegin;
+            for (size_t i = 0; i < n; ++i) {
+                const T x = work[i];
+                const T y = s1[i] + b0 * x;
+                s1[i] = s2[i] + b1 * x - a1 * y;
+                s2[i] = b2 * x - a2 * y;
+                work[i] = y;
+            }
+        }
+
+        const char *active = m_active.data() + chBegin;
+        for (size_t i = 0; i < n; ++i) {
+            if (!active[i])
+                continue;
+            if constexpr (std::is_floating_point_v<Sample>) {
+                row[i] = static_cast<Sample>(work[i]);
+            } else {
+                // Frequency filters remove the DC component, so the output swings around
+                // zero. On unsigned types (U16) the negative half clamps to the type
+                // minimum: filtering raw integer/unsigned DAQ samples is inherently lossy
+                // and callers should prefer F32. The clamp keeps it safe (no wraparound).
+                constexpr auto sampleMin = static_cast<double>(std::numeric_limits<Sample>::lowest());
+                constexpr auto sampleMax = static_cast<double>(std::numeric_limits<Sample>::max());
+                row[i] = static_cast<Sample>(
+                    std::clamp(std::nearbyint(static_cast<double>(work[i])), sampleMin, sampleMax));
+            }
+        }
+    }
+}
+
+template<typename Sample>
+void FilterPipeline::processBlockT(Sample *data, size_t rows, size_t cols)
+{
+    if (m_channelCount <= 0 || cols != static_cast<size_t>(m_channelCount) || rows == 0 || m_sections.empty())
+        return;
+
+#if defined(__SSE2__)
+    // denormal delay-line values (e.g. on a silent channel) are very slow to compute with
+    const auto prevCsr = _mm_getcsr();
+    _mm_setcsr(prevCsr | _MM_FLUSH_ZERO_ON | _MM_DENORMALS_ZERO_ON);
+#endif
+
+    const auto processRange = [&](size_t chBegin, size_t chEnd) {
+        if (m_precision == FilterPrecision::Single)
+            processChannels<float>(data, rows, cols, chBegin, chEnd);
+        else
+            processChannels<double>(data, rows, cols, chBegin, chEnd);
+    };
+
+    const auto blockWork = rows * cols * m_sections.size();
+    if (!m_pool || blockWork < MIN_PARALLEL_BLOCK_WORK) {
+        processRange(0, cols);
+    } else {
+        // split into contiguous, aligned channel ranges, one per thread
+        const auto rangeCount = static_cast<size_t>(m_pool->workerCount()) + 1;
+        const auto rangeSize = ((cols + rangeCount - 1) / rangeCount + CHANNEL_ALIGN - 1) / CHANNEL_ALIGN
+                               * CHANNEL_ALIGN;
+        const std::function<void(size_t)> job = [&](size_t index) {
+            const auto chBegin = index * rangeSize;
+            if (chBegin < cols)
+                processRange(chBegin, std::min(cols, chBegin + rangeSize));
+        };
+        m_pool->run(rangeCount, job);
+    }
+
+#if defined(__SSE2__)
+    _mm_setcsr(prevCsr);
+#endif
+}
+
+void FilterPipeline::processBlock(float *data, size_t rows, size_t cols)
+{
+    processBlockT(data, rows, cols);
+}
+
+void FilterPipeline::processBlock(double *data, size_t rows, size_t cols)
+{
+    processBlockT(data, rows, cols);
+}
+
+void FilterPipeline::processBlock(int32_t *data, size_t rows, size_t cols)
+{
+    processBlockT(data, rows, cols);
+}
+
+void FilterPipeline::processBlock(uint16_t *data, size_t rows, size_t cols)
+{
+    processBlockT(data, rows, cols);
 }
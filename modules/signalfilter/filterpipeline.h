@@ -20,6 +20,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -63,6 +64,25 @@ enum class FilterResponse {
     BandStop
 };
 
+/**
+ * @brief Arithmetic precision of the filter delay lines and coefficients.
+ */
+enum class FilterPrecision {
+    Double = 0, ///< float64, accurate even at very low normalised cutoffs
+    Single      ///< float32, twice as many channels per SIMD register
+};
+
+/**
+ * @brief Coefficients of one second-order section, normalised to a0 = 1.
+ */
+struct BiquadCoeffs {
+    double b0 = 1.0;
+    double b1 = 0.0;
+    double b2 = 0.0;
+    double a1 = 0.0;
+    double a2 = 0.0;
+};
+
 /**
  * @brief Serializable description of a single filter stage.
  *
@@ -97,40 +117,30 @@ struct FilterStage {
 };
 
 /**
- * @brief Type-erased single-channel IIR filter with internal state.
- *
- * iir1 keeps its delay-line state inside the filter object, so one instance is
- * required per channel and per stage.
- */
-class IStageFilter
-{
-public:
-    virtual ~IStageFilter();
-    /// Process a single sample, advancing the internal state.
-    virtual double process(double x) = 0;
-    /// Zero the delay lines, keeping the coefficients.
-    virtual void reset() = 0;
-};
-
-/**
- * @brief Build a single-channel filter realising @p stage at @p sampleRate.
+ * @brief Design the second-order sections realising @p stage at @p sampleRate.
  * @throws std::invalid_argument on invalid parameters (e.g. order too high).
- * @return never null on success.
  */
-std::unique_ptr<IStageFilter> makeStageFilter(const FilterStage &stage, double sampleRate);
+std::vector<BiquadCoeffs> designStageSections(const FilterStage &stage, double sampleRate);
 
 /**
  * @brief A chain of filter stages with independent per-channel state.
  *
  * Configure once with the stage list and sample rate, then @ref build for a
- * concrete channel count and selection mask. @ref processSample applies the
+ * concrete channel count and selection mask. @ref processBlock applies the
  * whole chain to channels that are selected and passes others through
  * unchanged.
+ *
+ * All stages are flattened into a single cascade of second-order sections
+ * that every channel shares. The delay lines are stored per section with the
+ * channels side by side, so each section is applied to a whole row of
+ * samples at once in SIMD lanes. Large channel counts are split into
+ * contiguous channel ranges that are filtered on worker threads.
  */
 class FilterPipeline
 {
 public:
-    FilterPipeline() = default;
+    FilterPipeline();
+    ~FilterPipeline();
 
     void setStages(std::vector<FilterStage> stages)
     {
@@ -149,6 +159,34 @@ public:
         m_channelCount = -1;
     }
 
+    void setPrecision(FilterPrecision precision)
+    {
+        m_precision = precision;
+        m_channelCount = -1;
+    }
+
+    [[nodiscard]] FilterPrecision precision() const
+    {
+        return m_precision;
+    }
+
+    /**
+     * @brief Set the maximum number of threads filtering a block, including the calling thread.
+     *
+     * Takes effect at the next @ref build. Small blocks are always filtered on the
+     * calling thread only.
+     */
+    void setThreadCount(int count)
+    {
+        m_threadCount = count < 1 ? 1 : count;
+        m_channelCount = -1;
+    }
+
+    [[nodiscard]] int threadCount() const
+    {
+        return m_threadCount;
+    }
+
     /// True if any configured stage requires a valid sample rate.
     [[nodiscard]] bool needsSampleRate() const;
 
@@ -159,7 +197,7 @@ public:
     }
 
     /**
-     * @brief (Re)build per-channel filter instances for @p channelCount channels.
+     * @brief (Re)build the filter state for @p channelCount channels.
      *
      * Filters are built for *every* channel; @p channelMask only decides which
      * channels are initially active. This lets channels be toggled live (via
@@ -189,28 +227,42 @@ public:
     void reset();
 
     /**
-     * @brief Filter a single sample of a given channel.
+     * @brief Filter a block of samples in place.
      *
-     * Hot path: called once per sample per channel. If @p ch is unselected (or
-     * out of range), the input is returned unchanged.
+     * @p data holds @p rows samples of @p cols channels in row-major order (one
+     * row per sample), and @p cols must match the channel count the pipeline
+     * was built for. Unselected channels are left unchanged. Integer samples
+     * are rounded and clamped to the range of their type.
      */
-    inline double processSample(int ch, double x)
-    {
-        if (ch < 0 || ch >= m_channelCount || !m_active[static_cast<size_t>(ch)])
-            return x;
-        auto &chain = m_channelFilters[static_cast<size_t>(ch)];
-        for (auto &f : chain)
-            x = f->process(x);
-
-        return x;
-    }
+    void processBlock(float *data, size_t rows, size_t cols);
+    void processBlock(double *data, size_t rows, size_t cols);
+    void processBlock(int32_t *data, size_t rows, size_t cols);
+    void processBlock(uint16_t *data, size_t rows, size_t cols);
 
 private:
+    class WorkerPool;
+
+    template<typename Sample>
+    void processBlockT(Sample *data, size_t rows, size_t cols);
+    template<typename T, typename Sample>
+    void processChannels(Sample *data, size_t rows, size_t cols, size_t chBegin, size_t chEnd);
+
     std::vector<FilterStage> m_stages;
     double m_sampleRate = -1.0;
+    FilterPrecision m_precision = FilterPrecision::Double;
+    int m_threadCount = 1;
     int m_channelCount = -1;
-    // [channel][stage]; filters are built for every channel.
-    std::vector<std::vector<std::unique_ptr<IStageFilter>>> m_channelFilters;
+
+    // All stages, flattened into one cascade of sections.
+    std::vector<BiquadCoeffs> m_sections;
+    // Delay lines as [section][s1, s2][channel], padded to m_stateStride channels.
+    // Only the vector matching m_precision is in use.
+    std::vector<double> m_stateF64;
+    std::vector<float> m_stateF32;
+    size_t m_stateStride = 0;
+
     // Per-channel gate: 0 = pass through unfiltered, 1 = run the filter chain.
     std::vector<char> m_active;
+
+    std::unique_ptr<WorkerPool> m_pool;
 };
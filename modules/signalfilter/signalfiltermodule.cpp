@@ -219,6 +219,9 @@ public:
         // discovered from the first data block, so the actual build is lazy
         const auto stages = m_settingsDlg->stages();
         m_pipeline.setStages(stages);
+        m_pipeline.setPrecision(m_settingsDlg->precision());
+        // large channel counts are split across a few threads, leaving room for the other modules
+        m_pipeline.setThreadCount(std::clamp(static_cast<int>(potentialNoaffinityCPUCount()) / 4, 1, 4));
         m_useAllChannels = m_settingsDlg->useAllChannels();
         m_selectedChannels = m_useAllChannels ? std::set<int>{}
                                               : parseChannelRanges(m_settingsDlg->channelSelectionText());
@@ -298,6 +301,7 @@ public:
         settings.insert("input_type", m_settingsDlg->selectedTypeName());
         settings.insert("use_all_channels", m_settingsDlg->useAllChannels());
         settings.insert("channel_selection", m_settingsDlg->channelSelectionText());
+        settings.insert("precision", static_cast<int>(m_settingsDlg->precision()));
 
         QVariantList stagesList;
         for (const auto &st : m_settingsDlg->stages())
@@ -313,6 +317,8 @@ public:
         m_settingsDlg->setChannelSelection(
             settings.value("use_all_channels", true).toBool(),
             settings.value("channel_selection").toString());
+        const auto precision = settings.value("precision", static_cast<int>(FilterPrecision::Double)).toInt();
+        m_settingsDlg->setPrecision(static_cast<FilterPrecision>(precision));
 
         std::vector<FilterStage> stages;
         for (const auto &v : settings.value("stages").toList())
@@ -541,10 +547,10 @@ private:
     template<typename BlockT>
     void filterBlock(BlockT &block)
     {
-        using Scalar = typename std::remove_reference_t<decltype(block.data)>::Scalar;
+        using Scalar = typename BlockT::Scalar;
 
-        const int nRows = static_cast<int>(block.data.rows());
-        const int nCols = static_cast<int>(block.data.cols());
+        const int nRows = static_cast<int>(block.rows());
+        const int nCols = static_cast<int>(block.cols());
         if (nCols <= 0 || nRows <= 0)
             return;
 
@@ -557,27 +563,11 @@ private:
             }
         }
 
-        constexpr bool isFloat = std::is_floating_point_v<Scalar>;
-        constexpr double scalarMin = static_cast<double>(std::numeric_limits<Scalar>::lowest());
-        constexpr double scalarMax = static_cast<double>(std::numeric_limits<Scalar>::max());
-
-        // rows = samples, cols = channels (row-major). Filter each channel
-        // through its own state, advancing sample by sample (row by row).
-        for (int c = 0; c < nCols; ++c) {
-            for (int r = 0; r < nRows; ++r) {
-                const double y = m_pipeline.processSample(c, static_cast<double>(block.data(r, c)));
-                if constexpr (isFloat) {
-                    block.data(r, c) = static_cast<Scalar>(y);
-                } else {
-                    // Frequency filters remove the DC component, so the output swings around
-                    // zero. On unsigned types (U16) the negative half clamps to the type
-                    // minimum: filtering raw integer/unsigned DAQ samples is inherently lossy
-                    // and callers should prefer F32. The clamp keeps it safe (no wraparound).
-                    const double clamped = std::clamp(std::nearbyint(y), scalarMin, scalarMax);
-                    block.data(r, c) = static_cast<Scalar>(clamped);
-                }
-            }
-        }
+        // only copies the samples if another subscriber still shares this block
+        auto &data = block.mutableData();
+
+        // rows = samples, cols = channels, stored row-major, as the pipeline expects
+        m_pipeline.processBlock(data.data(), static_cast<size_t>(nRows), static_cast<size_t>(nCols));
     }
 
     static QVariantHash stageToVariant(const FilterStage &st)
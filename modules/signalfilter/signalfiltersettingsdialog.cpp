@@ -42,6 +42,12 @@ SignalFilterSettingsDialog::SignalFilterSettingsDialog(QWidget *parent)
         "Frequency filters remove the DC offset, so filtering raw integer/unsigned signals is "
         "lossy (negative excursions clamp to the type minimum).\nPrefer Float32 where possible."));
 
+    // precision options; the combo indices match the enum values
+    ui->cbPrecision->addItems({QStringLiteral("Double (64-bit)"), QStringLiteral("Single (32-bit, faster)")});
+    ui->cbPrecision->setToolTip(QStringLiteral(
+        "Single precision filters twice as many channels at once, but may become inaccurate or unstable "
+        "for high filter orders at cutoffs far below the sample rate."));
+
     // family / response options; the combo indices match the enum values
     ui->cbFamily->addItems(
         {QStringLiteral("Butterworth"),
@@ -161,6 +167,16 @@ void SignalFilterSettingsDialog::setSelectedTypeName(const QString &typeName)
     ui->inputTypeSel->setSelectedTypeName(typeName);
 }
 
+FilterPrecision SignalFilterSettingsDialog::precision() const
+{
+    return static_cast<FilterPrecision>(ui->cbPrecision->currentIndex());
+}
+
+void SignalFilterSettingsDialog::setPrecision(FilterPrecision precision)
+{
+    ui->cbPrecision->setCurrentIndex(static_cast<int>(precision));
+}
+
 bool SignalFilterSettingsDialog::useAllChannels() const
 {
     return ui->rbAllChannels->isChecked();
@@ -199,8 +215,10 @@ void SignalFilterSettingsDialog::setStages(const std::vector<FilterStage> &stage
 void SignalFilterSettingsDialog::setRunning(bool running)
 {
     // Only the input type changes the port topology, so it must stay locked
-    // during a run. Channel selection and the filter design can be tuned live.
+    // during a run, as does the precision the filter state was allocated with.
+    // Channel selection and the filter design can be tuned live.
     ui->inputTypeSel->setEnabled(!running);
+    ui->cbPrecision->setEnabled(!running);
 }
 
 static QString sosToText(const std::vector<std::array<double, 6>> &sos)
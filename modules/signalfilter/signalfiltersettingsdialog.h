@@ -47,6 +47,10 @@ public:
     QString selectedTypeName() const;
     void setSelectedTypeName(const QString &typeName);
 
+    // arithmetic precision of the filters
+    FilterPrecision precision() const;
+    void setPrecision(FilterPrecision precision);
+
     // channel selection
     bool useAllChannels() const;
     QString channelSelectionText() const;
@@ -220,18 +220,20 @@ public:
             const uint dpTimestampMs = dataRecvTime.count() / 1000;
 
             // write data to block
-            cBlock.data(blockSampleIdx, 0) = temperatureC;
-            cBlock.timestamps(blockSampleIdx, 0) = dpTimestampMs;
-            paBlock.data(blockSampleIdx, 0) = pressureMilliPa;
-            paBlock.timestamps(blockSampleIdx, 0) = dpTimestampMs;
+            cBlock.mutableData()(blockSampleIdx, 0) = temperatureC;
+            cBlock.mutableTimestamps()(blockSampleIdx, 0) = dpTimestampMs;
+            paBlock.mutableData()(blockSampleIdx, 0) = pressureMilliPa;
+            paBlock.mutableTimestamps()(blockSampleIdx, 0) = dpTimestampMs;
 
             blockSampleIdx++;
             if (blockSampleIdx >= blockSize) {
                 blockSampleIdx = 0;
 
-                // submit data
-                m_paStream->push(paBlock);
-                m_tempStream->push(cBlock);
+                // submit data, and start new blocks instead of detaching the submitted ones
+                m_paStream->push(std::move(paBlock));
+                m_tempStream->push(std::move(cBlock));
+                paBlock = SignalBlockF32(blockSize, 1);
+                cBlock = SignalBlockF32(blockSize, 1);
             }
         }
 
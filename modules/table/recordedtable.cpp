@@ -19,13 +19,17 @@
 
 #include "recordedtable.h"
 
-#include <QFile>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QTableWidget>
 #include <QVBoxLayout>
 #include <QLabel>
 
+#include "datactl/priv/asyncio.h"
+
+// Amount of table data we collect before handing it to the writer
+static constexpr qsizetype EVENT_FILE_WRITE_CHUNK_SIZE = 16 * 1024;
+
 RecordedTable::RecordedTable(QObject *parent, const QIcon &winIcon)
     : QObject(parent),
       m_name(QString()),
@@ -54,7 +58,7 @@ RecordedTable::RecordedTable(QObject *parent, const QIcon &winIcon)
     m_infoLabel->setFixedHeight(20);
     layout->addWidget(m_infoLabel);
 
-    m_eventFile = new QFile;
+    m_eventFile = new Syntalos::AsyncFileWriter;
     m_haveEvents = false;
     m_infoLabel->setVisible(false);
 }
@@ -62,6 +66,7 @@ RecordedTable::RecordedTable(QObject *parent, const QIcon &winIcon)
 RecordedTable::~RecordedTable()
 {
     delete m_tableBox;
+    close();
     delete m_eventFile;
 }
 
@@ -102,14 +107,36 @@ bool RecordedTable::open(const QString &fileName)
 {
     m_eventFileName = fileName;
     close();
-    m_eventFile->setFileName(m_eventFileName);
-    return m_eventFile->open(QFile::WriteOnly | QFile::Truncate);
+    m_pendingLines.clear();
+    return m_eventFile->open(m_eventFileName.toStdString()).has_value();
 }
 
 void RecordedTable::close()
 {
-    if (m_eventFile->isOpen())
-        m_eventFile->close();
+    if (!m_eventFile->isOpen())
+        return;
+    flushLines();
+    m_eventFile->close();
+}
+
+void RecordedTable::writeLine(const QString &line)
+{
+    m_pendingLines.append(line.toUtf8());
+    m_pendingLines.append('\n');
+    if (m_pendingLines.size() >= EVENT_FILE_WRITE_CHUNK_SIZE)
+        flushLines();
+}
+
+void RecordedTable::flushLines()
+{
+    if (m_pendingLines.isEmpty())
+        return;
+
+    auto buffer = m_eventFile->takeBuffer();
+    const auto data = reinterpret_cast<const std::byte *>(m_pendingLines.constData());
+    buffer.assign(data, data + m_pendingLines.size());
+    m_eventFile->append(std::move(buffer));
+    m_pendingLines.clear();
 }
 
 void RecordedTable::show()
@@ -147,9 +174,8 @@ void RecordedTable::setHeader(const QStringList &headers)
     // write headers
     if (!m_eventFile->isOpen())
         return;
-    QTextStream tsout(m_eventFile);
     auto csvHdr = headers;
-    tsout << csvHdr.replaceInStrings(QStringLiteral(";"), QStringLiteral("；")).join(";") << "\n";
+    writeLine(csvHdr.replaceInStrings(QStringLiteral(";"), QStringLiteral("；")).join(";"));
 }
 
 void RecordedTable::addRows(const std::vector<std::string> &data)
@@ -160,7 +186,6 @@ void RecordedTable::addRows(const std::vector<std::string> &data)
         // write to file if file is opened
         if (!m_eventFile->isOpen())
             return;
-        QTextStream tsout(m_eventFile);
 
         // since our tables are semicolon-separated, we replace the "regular" semicolon
         // with a unicode fullwith semicolon (U+FF1B). That way, users of the table module
@@ -169,7 +194,7 @@ void RecordedTable::addRows(const std::vector<std::string> &data)
         csvRows.reserve(data.size());
         for (const auto &s : data)
             csvRows.append(QString::fromStdString(s));
-        tsout << csvRows.replaceInStrings(QStringLiteral(";"), QStringLiteral("；")).join(";") << "\n";
+        writeLine(csvRows.replaceInStrings(QStringLiteral(";"), QStringLiteral("；")).join(";"));
     }
 
     // exit if we shouldn't display data
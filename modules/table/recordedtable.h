@@ -24,7 +24,10 @@
 #include <QLabel>
 
 class QTableWidget;
-class QFile;
+namespace Syntalos
+{
+class AsyncFileWriter;
+}
 
 class RecordedTable : public QObject
 {
@@ -59,12 +62,15 @@ public:
 
 private:
     void updateInfoLabel();
+    void writeLine(const QString &line);
+    void flushLines();
 
 private:
     QWidget *m_tableBox;
     QLabel *m_infoLabel;
     QTableWidget *m_tableWidget;
-    QFile *m_eventFile;
+    Syntalos::AsyncFileWriter *m_eventFile;
+    QByteArray m_pendingLines;
     QString m_eventFileName;
     QString m_name;
 
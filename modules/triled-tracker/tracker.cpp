@@ -29,7 +29,7 @@
 
 #include "fabric/logging.h"
 
-Tracker::Tracker(std::shared_ptr<DataStream<TableRow>> dataStream, const QString &subjectId)
+Tracker::Tracker(std::shared_ptr<DataStream<TableRecord>> dataStream, const QString &subjectId)
     : QObject(nullptr),
       m_initialized(false),
       m_subjectId(subjectId),
@@ -83,6 +83,13 @@ bool Tracker::initialize()
             "Center X",
             "Center Y",
             "Turn Angle (deg)"});
+    // time and LED pixel positions are integers, the center and angle are not
+    MetaArray columnTypes;
+    for (int i = 0; i < 7; ++i)
+        columnTypes.push_back(toString(TableColumnType::Integer));
+    for (int i = 0; i < 3; ++i)
+        columnTypes.push_back(toString(TableColumnType::Float));
+    m_dataStream->setMetadataValue("table_column_types", columnTypes);
     m_dataStream->start();
 
     // clear maze position data
@@ -99,32 +106,19 @@ void Tracker::analyzeFrame(const cv::Mat &frame, const milliseconds_t time, cv::
     // do the tracking on the source frame
     auto triangle = trackPoints(frame, infoFrame, trackingFrame);
 
-    TableRow posInfo;
-    posInfo.reserve(10);
-
-    // store time value
-    posInfo.append(numToString(time.count()));
-
-    // red
-    posInfo.append(numToString(triangle.red.x));
-    posInfo.append(numToString(triangle.red.y));
-
-    // green
-    posInfo.append(numToString(triangle.green.x));
-    posInfo.append(numToString(triangle.green.y));
-
-    // blue
-    posInfo.append(numToString(triangle.blue.x));
-    posInfo.append(numToString(triangle.blue.y));
-
-    // center
-    posInfo.append(numToString(triangle.center.x));
-    posInfo.append(numToString(triangle.center.y));
-
-    // turn angle
-    posInfo.append(numToString(triangle.turnAngle));
-
-    m_dataStream->push(posInfo);
+    TableRecord posInfo({
+        static_cast<double>(time.count()),
+        static_cast<double>(triangle.red.x),
+        static_cast<double>(triangle.red.y),
+        static_cast<double>(triangle.green.x),
+        static_cast<double>(triangle.green.y),
+        static_cast<double>(triangle.blue.x),
+        static_cast<double>(triangle.blue.y),
+        static_cast<double>(triangle.center.x),
+        static_cast<double>(triangle.center.y),
+        triangle.turnAngle});
+
+    m_dataStream->push(std::move(posInfo));
 }
 
 MetaStringMap Tracker::finalize()
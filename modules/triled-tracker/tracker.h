@@ -41,7 +41,7 @@ public:
         double turnAngle; // triangle turn angle
     };
 
-    explicit Tracker(std::shared_ptr<DataStream<TableRow>> dataStream, const QString &subjectId);
+    explicit Tracker(std::shared_ptr<DataStream<TableRecord>> dataStream, const QString &subjectId);
     ~Tracker();
 
     QString lastError() const;
@@ -60,7 +60,7 @@ private:
     QString m_lastError;
 
     QString m_subjectId;
-    std::shared_ptr<DataStream<TableRow>> m_dataStream;
+    std::shared_ptr<DataStream<TableRecord>> m_dataStream;
 
     std::vector<cv::Point2f> m_mazeRect;
     uint m_mazeFindTrialCount;
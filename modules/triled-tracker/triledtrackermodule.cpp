@@ -31,7 +31,7 @@ private:
     std::shared_ptr<StreamInputPort<Frame>> m_inPort;
     std::shared_ptr<DataStream<Frame>> m_trackStream;
     std::shared_ptr<DataStream<Frame>> m_animalStream;
-    std::shared_ptr<DataStream<TableRow>> m_dataStream;
+    std::shared_ptr<DataStream<TableRecord>> m_dataStream;
 
     QString m_subjectId;
 
@@ -46,7 +46,7 @@ public:
         m_animalStream = registerOutputPort<Frame>(
             QStringLiteral("animal-video"),
             QStringLiteral("Animal Visualization"));
-        m_dataStream = registerOutputPort<TableRow>(QStringLiteral("track-data"), QStringLiteral("Tracking Data"));
+        m_dataStream = registerOutputPort<TableRecord>(QStringLiteral("track-data"), QStringLiteral("Tracking Data"));
     }
 
     ModuleDriverKind driver() const override
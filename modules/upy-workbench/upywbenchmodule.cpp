@@ -560,17 +560,21 @@ public:
 
             if (isIntBlock) {
                 SignalBlockI32 block(arrayLen);
+                auto &blockData = block.mutableData();
+                auto &blockTs = block.mutableTimestamps();
                 for (int i = 0; i < arrayLen; i++) {
-                    block.data(i, 0) = array[i].toInt();
-                    block.timestamps(i, 0) = recvMasterTime.count();
+                    blockData(i, 0) = array[i].toInt();
+                    blockTs(i, 0) = recvMasterTime.count();
                 }
 
                 std::static_pointer_cast<DataStream<SignalBlockI32>>(stream)->push(block);
             } else {
                 SignalBlockF32 block(arrayLen);
+                auto &blockData = block.mutableData();
+                auto &blockTs = block.mutableTimestamps();
                 for (int i = 0; i < arrayLen; i++) {
-                    block.data(i, 0) = array[i].toDouble();
-                    block.timestamps(i, 0) = recvMasterTime.count();
+                    blockData(i, 0) = array[i].toDouble();
+                    blockTs(i, 0) = recvMasterTime.count();
                 }
 
                 std::static_pointer_cast<DataStream<SignalBlockF32>>(stream)->push(block);
@@ -22,10 +22,18 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QScopeGuard>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <filesystem>
 #include <optional>
+#include <thread>
+extern "C" {
+#include <libavformat/avformat.h>
+}
 
+#include "../framespool.h"
 #include "../videowriter.h"
 #include "videoreader.h"
 #include "queuemodel.h"
@@ -36,6 +44,121 @@
 
 using namespace Syntalos;
 
+/// Minimum number of frames a spool segment must have to be worth encoding separately
+static constexpr size_t SPOOL_MIN_SEGMENT_FRAMES = 1000;
+/// Maximum number of spool segments that are encoded in parallel
+static constexpr int SPOOL_MAX_SEGMENTS = 16;
+
+/**
+ * Join video files encoded with identical codec settings into one file, without re-encoding them.
+ */
+static std::expected<void, QString> concatVideoSegments(const QStringList &segmentFnames, const QString &destFname)
+{
+    AVFormatContext *octx = nullptr;
+    AVStream *ostrm = nullptr;
+    int64_t tsOffset = 0;
+    int64_t lastDts = AV_NOPTS_VALUE;
+
+    if (avformat_alloc_output_context2(&octx, nullptr, nullptr, qPrintable(destFname)) < 0 || octx == nullptr)
+        return std::unexpected(QStringLiteral("Unable to create output context for %1").arg(destFname));
+
+    AVPacket *pkt = av_packet_alloc();
+    const auto appendSegment = [&](const QString &segFname) -> std::expected<void, QString> {
+        AVFormatContext *ictx = nullptr;
+        if (avformat_open_input(&ictx, qPrintable(segFname), nullptr, nullptr) != 0)
+            return std::unexpected(QStringLiteral("Unable to open video segment %1").arg(segFname));
+        const auto closeInput = qScopeGuard([&] {
+            avformat_close_input(&ictx);
+        });
+        if (avformat_find_stream_info(ictx, nullptr) < 0)
+            return std::unexpected(QStringLiteral("Unable to read stream info of %1").arg(segFname));
+
+        const auto streamIdx = av_find_best_stream(ictx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (streamIdx < 0)
+            return std::unexpected(QStringLiteral("No video stream found in %1").arg(segFname));
+        const auto istrm = ictx->streams[streamIdx];
+
+        if (ostrm == nullptr) {
+            // the first segment defines the stream parameters and metadata of the joined file
+            ostrm = avformat_new_stream(octx, nullptr);
+            if (ostrm == nullptr || avcodec_parameters_copy(ostrm->codecpar, istrm->codecpar) < 0)
+                return std::unexpected(QStringLiteral("Unable to create output video stream."));
+            ostrm->codecpar->codec_tag = 0;
+            ostrm->time_base = istrm->time_base;
+            ostrm->avg_frame_rate = istrm->avg_frame_rate;
+            ostrm->r_frame_rate = istrm->r_frame_rate;
+            av_dict_copy(&octx->metadata, ictx->metadata, 0);
+            av_dict_copy(&ostrm->metadata, istrm->metadata, 0);
+
+            if (avio_open(&octx->pb, qPrintable(destFname), AVIO_FLAG_WRITE) < 0)
+                return std::unexpected(QStringLiteral("Unable to open %1 for writing.").arg(destFname));
+            if (avformat_write_header(octx, nullptr) < 0)
+                return std::unexpected(QStringLiteral("Unable to write header of %1").arg(destFname));
+        } else {
+            const auto ipar = istrm->codecpar;
+            const auto opar = ostrm->codecpar;
+            const bool sameExtradata = ipar->extradata_size == opar->extradata_size
+                                       && (ipar->extradata_size == 0
+                                           || std::memcmp(ipar->extradata, opar->extradata, ipar->extradata_size) == 0);
+            if (ipar->codec_id != opar->codec_id || ipar->width != opar->width || ipar->height != opar->height
+                || !sameExtradata)
+                return std::unexpected(
+                    QStringLiteral("Video segment %1 has incompatible codec parameters.").arg(segFname));
+        }
+
+        int64_t segmentEnd = tsOffset;
+        bool firstPacket = true;
+        while (av_read_frame(ictx, pkt) >= 0) {
+            if (pkt->stream_index != streamIdx) {
+                av_packet_unref(pkt);
+                continue;
+            }
+            av_packet_rescale_ts(pkt, istrm->time_base, ostrm->time_base);
+
+            // encoders with B-frames start segments with negative DTS, which must not overlap the previous segment
+            if (firstPacket && pkt->dts != AV_NOPTS_VALUE && lastDts != AV_NOPTS_VALUE
+                && pkt->dts + tsOffset <= lastDts)
+                tsOffset = lastDts + 1 - pkt->dts;
+            firstPacket = false;
+
+            if (pkt->pts != AV_NOPTS_VALUE) {
+                pkt->pts += tsOffset;
+                segmentEnd = std::max(segmentEnd, pkt->pts + std::max<int64_t>(pkt->duration, 1));
+            }
+            if (pkt->dts != AV_NOPTS_VALUE) {
+                pkt->dts += tsOffset;
+                lastDts = pkt->dts;
+            }
+            pkt->stream_index = ostrm->index;
+            pkt->pos = -1;
+
+            if (av_interleaved_write_frame(octx, pkt) < 0)
+                return std::unexpected(QStringLiteral("Unable to write packet to %1").arg(destFname));
+        }
+        tsOffset = segmentEnd;
+
+        return {};
+    };
+
+    std::expected<void, QString> result;
+    if (pkt == nullptr)
+        result = std::unexpected(QStringLiteral("Unable to allocate packet."));
+    for (const auto &segFname : segmentFnames) {
+        if (!result)
+            break;
+        result = appendSegment(segFname);
+    }
+    if (result && av_write_trailer(octx) < 0)
+        result = std::unexpected(QStringLiteral("Unable to write trailer of %1").arg(destFname));
+
+    av_packet_free(&pkt);
+    if (octx->pb != nullptr)
+        avio_closep(&octx->pb);
+    avformat_free_context(octx);
+
+    return result;
+}
+
 EncodeTask::EncodeTask(QueueItem *item, bool updateAttrs, int codecThreadN)
     : QRunnable(),
       m_log(getLogger("encoder.task")),
@@ -55,12 +178,22 @@ bool EncodeTask::prepareSourceFiles()
     }
 
     m_destFname = m_item->fname();
-    m_srcFname = fi.dir().filePath(QStringLiteral("srcraw_") + fi.fileName());
     m_datasetRoot = fi.dir().path();
 
-    if (!QFile::rename(m_destFname, m_srcFname)) {
-        m_item->setError(QStringLiteral("Unable to rename source video file."));
-        return false;
+    // frames recorded for deferred encoding are stored in a spool file next to the final video
+    const auto spoolFname = m_item->mdata().value("spool-file").toString();
+    if (!spoolFname.isEmpty()) {
+        m_srcFname = spoolFname;
+        if (!QFile::exists(m_srcFname)) {
+            m_item->setError(QStringLiteral("Frame spool file %1 does not exist.").arg(m_srcFname));
+            return false;
+        }
+    } else {
+        m_srcFname = fi.dir().filePath(QStringLiteral("srcraw_") + fi.fileName());
+        if (!QFile::rename(m_destFname, m_srcFname)) {
+            m_item->setError(QStringLiteral("Unable to rename source video file."));
+            return false;
+        }
     }
 
     const auto tmpTsyncFname = fi.dir().filePath(fi.completeBaseName() + QStringLiteral("_timestamps.tsync"));
@@ -138,6 +271,7 @@ void EncodeTask::run()
         tsyncTimeUnit = tfr.timeUnits().second;
         const auto creationTime = std::chrono::system_clock::from_time_t(tfr.creationTime());
         vwriter.setTsyncFileCreationTimeOverride(EdlDateTime{std::chrono::current_zone(), creationTime});
+        m_tsyncCreationTime = creationTime;
 
         // Prefer the UUID encoded in the tsync file when available.
         collectionId = tfr.collectionId();
@@ -150,6 +284,9 @@ void EncodeTask::run()
     int frameHeight = -1;
     bool useColor = true;
     int progress = 0;
+    ssize_t decoded = 0;
+    QString encoderName;
+    CodecProperties usedCodecProps = cprops;
 
     // The tsync file holds exactly one entry per recorded frame, so it is the authoritative
     // count of frames we should re-encode. libav's totalFrames() is only an estimate for raw
@@ -160,73 +297,105 @@ void EncodeTask::run()
     const ssize_t progressTotal = expectedFrames > 0 ? expectedFrames : (hintFrames > 0 ? hintFrames : 0);
     const double onePerc = progressTotal > 0 ? 100.0 / static_cast<double>(progressTotal) : 0.0;
 
-    while (true) {
-        auto maybeFrame = vsrc.readFrame();
-        if (!maybeFrame.has_value())
-            break;
-        auto frame = maybeFrame.value().first;
-        auto frameNo = maybeFrame.value().second;
+    // frame spools can be split into segments which are encoded in parallel
+    bool encodedSegments = false;
+    if (const auto spool = vsrc.spool(); spool != nullptr && spool->frameCount() > 0) {
+        const auto segmentCount = static_cast<int>(std::clamp<size_t>(
+            std::min<size_t>(m_codecThreadCount / 2, spool->frameCount() / SPOOL_MIN_SEGMENT_FRAMES),
+            1,
+            SPOOL_MAX_SEGMENTS));
+        if (segmentCount > 1) {
+            const auto res = encodeSpoolSegments(*spool, usedCodecProps, collectionId.value(), segmentCount);
+            if (res) {
+                encodedSegments = true;
+                encoderName = res.value();
+                decoded = static_cast<ssize_t>(spool->frameCount());
+                frameWidth = spool->entry(0).width;
+                frameHeight = spool->entry(0).height;
+                useColor = CV_MAT_CN(spool->entry(0).type) > 1;
+            } else {
+                LOG_WARNING(
+                    m_log,
+                    "Unable to encode {} in segments, encoding it sequentially: {}",
+                    m_srcFname,
+                    res.error());
+                usedCodecProps = cprops;
+            }
+        }
+    }
 
-        if (firstFrame || frameWidth <= 0) {
-            firstFrame = false;
-            frameWidth = frame.cols;
-            frameHeight = frame.rows;
+    if (!encodedSegments) {
+        while (true) {
+            auto maybeFrame = vsrc.readFrame();
+            if (!maybeFrame.has_value())
+                break;
+            auto frame = maybeFrame.value().first;
+            auto frameNo = maybeFrame.value().second;
+
+            if (firstFrame || frameWidth <= 0) {
+                firstFrame = false;
+                frameWidth = frame.cols;
+                frameHeight = frame.rows;
+
+                useColor = frame.channels() > 1;
+                try {
+                    vwriter.initialize(
+                        m_destFname,
+                        md["mod-name"].toString(),
+                        md["src-mod-name"].toString(),
+                        collectionId.value(),
+                        md["subject-name"].toString(),
+                        frameWidth,
+                        frameHeight,
+                        vsrc.framerate(),
+                        frame.depth(),
+                        useColor,
+                        m_writeTsync);
+                } catch (const std::runtime_error &e) {
+                    m_item->setError(QStringLiteral("Unable to initialize recording: %1").arg(e.what()));
+                    success = false;
+                    break;
+                }
+            }
 
-            useColor = frame.channels() > 1;
-            try {
-                vwriter.initialize(
-                    m_destFname,
-                    md["mod-name"].toString(),
-                    md["src-mod-name"].toString(),
-                    collectionId.value(),
-                    md["subject-name"].toString(),
-                    frameWidth,
-                    frameHeight,
-                    vsrc.framerate(),
-                    frame.depth(),
-                    useColor,
-                    m_writeTsync);
-            } catch (const std::runtime_error &e) {
-                m_item->setError(QStringLiteral("Unable to initialize recording: %1").arg(e.what()));
+            // write timestamp info
+            auto timestamp = microseconds_t(0);
+            if (m_writeTsync) {
+                if (frameNo < tsyncTimes.size()) {
+                    if (tsyncTimeUnit == TSyncFileTimeUnit::MILLISECONDS)
+                        timestamp = msecToUsec(milliseconds_t(tsyncTimes[frameNo].second));
+                    else if (tsyncTimeUnit == TSyncFileTimeUnit::MICROSECONDS)
+                        timestamp = microseconds_t(tsyncTimes[frameNo].second);
+                    else if (tsyncTimeUnit == TSyncFileTimeUnit::NANOSECONDS)
+                        timestamp = nsecToUsec(nanoseconds_t(tsyncTimes[frameNo].second));
+                }
+            }
+
+            if (!vwriter.encodeFrame(frame, timestamp)) {
+                m_item->setError(
+                    QStringLiteral("Unable to reencode video: %1").arg(QString::fromStdString(vwriter.lastError())));
                 success = false;
                 break;
             }
-        }
 
-        // write timestamp info
-        auto timestamp = microseconds_t(0);
-        if (m_writeTsync) {
-            if (frameNo < tsyncTimes.size()) {
-                if (tsyncTimeUnit == TSyncFileTimeUnit::MILLISECONDS)
-                    timestamp = msecToUsec(milliseconds_t(tsyncTimes[frameNo].second));
-                else if (tsyncTimeUnit == TSyncFileTimeUnit::MICROSECONDS)
-                    timestamp = microseconds_t(tsyncTimes[frameNo].second);
-                else if (tsyncTimeUnit == TSyncFileTimeUnit::NANOSECONDS)
-                    timestamp = nsecToUsec(nanoseconds_t(tsyncTimes[frameNo].second));
+            if (onePerc > 0.0) {
+                const int newProgress = std::clamp(static_cast<int>(frameNo * onePerc), 0, 100);
+                if (newProgress != progress) {
+                    m_item->setProgress(newProgress);
+                    progress = newProgress;
+                }
             }
         }
 
-        if (!vwriter.encodeFrame(frame, timestamp)) {
+        const auto res = vwriter.finalize();
+        if (success && !res) {
             m_item->setError(
-                QStringLiteral("Unable to reencode video: %1").arg(QString::fromStdString(vwriter.lastError())));
+                QStringLiteral("Failed to finalize the re-encoded video: %1").arg(QString::fromStdString(res.error())));
             success = false;
-            break;
-        }
-
-        if (onePerc > 0.0) {
-            const int newProgress = std::clamp(static_cast<int>(frameNo * onePerc), 0, 100);
-            if (newProgress != progress) {
-                m_item->setProgress(newProgress);
-                progress = newProgress;
-            }
         }
-    }
-
-    const auto res = vwriter.finalize();
-    if (success && !res) {
-        m_item->setError(
-            QStringLiteral("Failed to finalize the re-encoded video: %1").arg(QString::fromStdString(res.error())));
-        success = false;
+        decoded = vsrc.lastFrameIndex();
+        encoderName = vwriter.selectedEncoderName();
+        usedCodecProps = vwriter.codecProps();
     }
 
     // Validate completeness against the authoritative tsync frame count (if available).
@@ -234,7 +403,6 @@ void EncodeTask::run()
     // recorder actually wrote (truncation). We never fail on a mismatch with libav's frame
     // estimate, which is unreliable for short recordings.
     if (success) {
-        const ssize_t decoded = vsrc.lastFrameIndex();
         if (decoded == 0) {
             m_item->setError(QStringLiteral("No frames could be decoded from the recorded video file."));
             success = false;
@@ -267,7 +435,7 @@ void EncodeTask::run()
         const auto attrFnameTmp = m_datasetRoot + QStringLiteral("/attributes.tmp%1").arg(createRandomString(6));
         auto attrs = parseTomlFile(attrFname, errorMsg);
         if (errorMsg.isEmpty()) {
-            if (attrs.value("encoder").toHash().value("name").toString() != vwriter.selectedEncoderName()) {
+            if (attrs.value("encoder").toHash().value("name").toString() != encoderName) {
                 QVariantHash vInfo;
                 vInfo.insert("frame_width", frameWidth);
                 vInfo.insert("frame_height", frameHeight);
@@ -275,15 +443,15 @@ void EncodeTask::run()
                 vInfo.insert("colored", useColor);
 
                 QVariantHash encInfo;
-                encInfo.insert("name", vwriter.selectedEncoderName());
-                encInfo.insert("lossless", vwriter.codecProps().isLossless());
-                encInfo.insert("thread_count", vwriter.codecProps().threadCount());
-                if (vwriter.codecProps().useVaapi())
+                encInfo.insert("name", encoderName);
+                encInfo.insert("lossless", usedCodecProps.isLossless());
+                encInfo.insert("thread_count", usedCodecProps.threadCount());
+                if (usedCodecProps.useVaapi())
                     encInfo.insert("vaapi_enabled", true);
-                if (vwriter.codecProps().mode() == CodecProperties::ConstantBitrate)
-                    encInfo.insert("target_bitrate_kbps", vwriter.codecProps().bitrateKbps());
+                if (usedCodecProps.mode() == CodecProperties::ConstantBitrate)
+                    encInfo.insert("target_bitrate_kbps", usedCodecProps.bitrateKbps());
                 else
-                    encInfo.insert("target_quality", vwriter.codecProps().quality());
+                    encInfo.insert("target_quality", usedCodecProps.quality());
                 attrs["video"] = vInfo;
                 attrs["encoder"] = encInfo;
 
@@ -320,3 +488,135 @@ void EncodeTask::run()
             QFile::remove(m_tsyncSrcFname);
     }
 }
+
+std::expected<QString, QString> EncodeTask::encodeSpoolSegments(
+    const FrameSpoolReader &spool,
+    CodecProperties &cprops,
+    const Uuid &collectionId,
+    int segmentCount)
+{
+    const auto md = m_item->mdata();
+    const auto container = static_cast<VideoContainer>(md["video-container"].toInt());
+    const auto frameCount = spool.frameCount();
+    const auto &firstEntry = spool.entry(0);
+    const bool useColor = CV_MAT_CN(firstEntry.type) > 1;
+
+    // all segments must be encoded with identical settings, so their streams can be joined
+    cprops.setThreadCount(std::max(1, m_codecThreadCount / segmentCount));
+
+    QFileInfo destFi(m_destFname);
+    const auto segmentExt = container == VideoContainer::AVI ? QStringLiteral(".avi") : QStringLiteral(".mkv");
+    QStringList segmentFnames;
+    for (int i = 0; i < segmentCount; i++)
+        segmentFnames.append(
+            destFi.dir().filePath(QStringLiteral("srcseg%1_%2%3").arg(i).arg(destFi.completeBaseName(), segmentExt)));
+    const auto removeSegments = [&] {
+        for (const auto &fname : segmentFnames)
+            QFile::remove(fname);
+    };
+
+    std::atomic_size_t framesDone = 0;
+    std::atomic_int segmentsRunning = segmentCount;
+    std::vector<QString> errors(segmentCount);
+    QString encoderName;
+    auto usedCodecProps = cprops;
+
+    std::vector<std::thread> workers;
+    workers.reserve(segmentCount);
+    for (int seg = 0; seg < segmentCount; seg++) {
+        const size_t begin = frameCount * seg / segmentCount;
+        const size_t end = frameCount * (seg + 1) / segmentCount;
+        workers.emplace_back([&, seg, begin, end] {
+            const auto finished = qScopeGuard([&] {
+                segmentsRunning--;
+            });
+
+            VideoWriter vwriter;
+            vwriter.setFileSliceInterval(0);
+            vwriter.setContainer(container);
+            vwriter.setCodecProps(cprops);
+            try {
+                vwriter.initialize(
+                    segmentFnames[seg],
+                    md["mod-name"].toString(),
+                    md["src-mod-name"].toString(),
+                    collectionId,
+                    md["subject-name"].toString(),
+                    firstEntry.width,
+                    firstEntry.height,
+                    spool.framerate(),
+                    CV_MAT_DEPTH(firstEntry.type),
+                    useColor,
+                    false);
+            } catch (const std::runtime_error &e) {
+                errors[seg] = QStringLiteral("Unable to initialize segment encoder: %1").arg(e.what());
+                return;
+            }
+
+            for (size_t i = begin; i < end; i++) {
+                if (!vwriter.encodeFrame(spool.frame(i), microseconds_t(spool.entry(i).timestampUsec))) {
+                    errors[seg] = QString::fromStdString(vwriter.lastError());
+                    break;
+                }
+                framesDone++;
+            }
+
+            const auto res = vwriter.finalize();
+            if (!res && errors[seg].isEmpty())
+                errors[seg] = QString::fromStdString(res.error());
+            if (seg == 0) {
+                encoderName = vwriter.selectedEncoderName();
+                usedCodecProps = vwriter.codecProps();
+            }
+        });
+    }
+
+    int progress = -1;
+    while (segmentsRunning > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        const int newProgress = std::clamp(static_cast<int>(framesDone * 100 / frameCount), 0, 100);
+        if (newProgress != progress) {
+            m_item->setProgress(newProgress);
+            progress = newProgress;
+        }
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    for (const auto &error : errors) {
+        if (!error.isEmpty()) {
+            removeSegments();
+            return std::unexpected(error);
+        }
+    }
+
+    const auto concatRes = concatVideoSegments(segmentFnames, m_destFname);
+    removeSegments();
+    if (!concatRes) {
+        QFile::remove(m_destFname);
+        return std::unexpected(concatRes.error());
+    }
+
+    // the segment encoders do not write timestamps, so we write them for the whole video here
+    if (m_writeTsync) {
+        TimeSyncFileWriter tsfWriter;
+        if (m_tsyncCreationTime.has_value())
+            tsfWriter.setCreationTimeOverride(m_tsyncCreationTime.value());
+        if (!openVideoTimestampFile(
+                tsfWriter,
+                m_tsyncDestFname.toStdString(),
+                spool.framerate(),
+                md["mod-name"].toString().toStdString(),
+                collectionId)) {
+            QFile::remove(m_destFname);
+            return std::unexpected(
+                QStringLiteral("Unable to open timesync file: %1").arg(QString::fromStdString(tsfWriter.lastError())));
+        }
+        for (size_t i = 0; i < frameCount; i++)
+            tsfWriter.writeTimes(static_cast<int64_t>(i), spool.entry(i).timestampUsec);
+        tsfWriter.close();
+    }
+
+    cprops = usedCodecProps;
+    return encoderName;
+}
@@ -22,8 +22,15 @@
 #include "logging.h"
 
 #include <QRunnable>
+#include <chrono>
+#include <expected>
+#include <optional>
+
+#include "datactl/uuid.h"
 
 class QueueItem;
+class CodecProperties;
+class FrameSpoolReader;
 
 class EncodeTask : public QRunnable
 {
@@ -34,6 +41,11 @@ public:
 
 private:
     bool prepareSourceFiles();
+    std::expected<QString, QString> encodeSpoolSegments(
+        const FrameSpoolReader &spool,
+        CodecProperties &cprops,
+        const Syntalos::Uuid &collectionId,
+        int segmentCount);
 
 private:
     Syntalos::QuillLogger *m_log;
@@ -47,4 +59,5 @@ private:
     bool m_writeTsync;
     QString m_tsyncSrcFname;
     QString m_tsyncDestFname;
+    std::optional<std::chrono::system_clock::time_point> m_tsyncCreationTime;
 };
@@ -30,6 +30,7 @@ extern "C" {
 }
 
 #include "../ffmpeg-utils.h"
+#include "../framespool.h"
 
 static double r2d(AVRational r)
 {
@@ -48,6 +49,9 @@ public:
     int videoStreamIndex = -1;
     size_t frameIndex = 0;
 
+    // set if we are reading from a frame spool instead of a video file
+    std::unique_ptr<FrameSpoolReader> spool;
+
     // cached swscale state
     SwsContext *swsCtx = nullptr;
     AVPixelFormat swsSrcFmt = AV_PIX_FMT_NONE;
@@ -83,6 +87,17 @@ QString VideoReader::lastError() const
 bool VideoReader::open(const QString &filename)
 {
     d->frameIndex = 0;
+    if (FrameSpoolReader::isSpoolFile(filename.toStdString())) {
+        d->spool = std::make_unique<FrameSpoolReader>();
+        const auto res = d->spool->open(filename.toStdString());
+        if (!res) {
+            d->lastError = QString::fromStdString(res.error());
+            d->spool.reset();
+            return false;
+        }
+        return true;
+    }
+
     if (avformat_open_input(&d->formatCtx, qPrintable(filename), nullptr, nullptr) != 0) {
         d->lastError = "Could not open video file.";
         return false;
@@ -145,6 +160,14 @@ failure:
 
 double VideoReader::durationSec() const
 {
+    if (d->spool) {
+        const auto count = d->spool->frameCount();
+        if (count == 0)
+            return 0;
+        return static_cast<double>(d->spool->entry(count - 1).timestampUsec - d->spool->entry(0).timestampUsec)
+               / 1000000.0;
+    }
+
     double sec = (double)d->formatCtx->duration / (double)AV_TIME_BASE;
 
     if (sec < 0.000025) {
@@ -157,6 +180,8 @@ double VideoReader::durationSec() const
 
 ssize_t VideoReader::totalFrames() const
 {
+    if (d->spool)
+        return static_cast<ssize_t>(d->spool->frameCount());
     if (d->videoStreamIndex == -1 || d->formatCtx == nullptr)
         return -1;
 
@@ -177,6 +202,8 @@ ssize_t VideoReader::totalFrames() const
 
 double VideoReader::framerate() const
 {
+    if (d->spool)
+        return d->spool->framerate();
     if (d->videoStreamIndex == -1 || d->formatCtx == nullptr)
         return -1;
 
@@ -191,6 +218,16 @@ double VideoReader::framerate() const
 
 std::optional<std::pair<cv::Mat, size_t>> VideoReader::readFrame()
 {
+    if (d->spool) {
+        // frames are read directly from the mapped spool file, without any copy
+        if (d->frameIndex >= d->spool->frameCount()) {
+            d->lastError = "Could not read frame.";
+            return std::nullopt;
+        }
+        const auto idx = d->frameIndex++;
+        return std::make_pair(d->spool->frame(idx), idx);
+    }
+
     AVFrame *frame = av_frame_alloc();
     AVPacket *packet = av_packet_alloc();
     while (av_read_frame(d->formatCtx, packet) >= 0) {
@@ -298,3 +335,8 @@ ssize_t VideoReader::lastFrameIndex() const
 {
     return d->frameIndex;
 }
+
+const FrameSpoolReader *VideoReader::spool() const
+{
+    return d->spool.get();
+}
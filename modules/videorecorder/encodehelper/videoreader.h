@@ -26,6 +26,7 @@
 #include "datactl/frametype.h"
 
 struct AVFrame;
+class FrameSpoolReader;
 
 /**
  * @brief The VideoReader class
@@ -51,6 +52,8 @@ public:
 
     std::optional<std::pair<cv::Mat, size_t>> readFrame();
 
+    const FrameSpoolReader *spool() const;
+
 private:
     class Private;
     std::unique_ptr<Private> d;
@@ -0,0 +1,623 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framespool.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <format>
+#include <mutex>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * Spool file layout:
+ *
+ *   [file header, one page]
+ *   [frame record: 64 byte header + pixel rows, padded to a page boundary] ...
+ *   [index: index header + FrameSpoolEntry array + trailer, padded to a page boundary]
+ *
+ * The trailer occupies the last bytes of the file and points to the index.
+ * All offsets are multiples of the page size, which permits O_DIRECT writes.
+ */
+static constexpr size_t SPOOL_PAGE_SIZE = 4096;
+static constexpr uint32_t SPOOL_FORMAT_VERSION = 1;
+static constexpr char SPOOL_FILE_MAGIC[8] = {'S', 'Y', 'S', 'P', 'O', 'O', 'L', '\0'};
+static constexpr char SPOOL_INDEX_MAGIC[8] = {'S', 'Y', 'S', 'P', 'I', 'D', 'X', '\0'};
+static constexpr uint32_t SPOOL_RECORD_MAGIC = 0x52465953; // "SYFR"
+
+/// Number of frame buffers that may be queued for writing
+static constexpr size_t SPOOL_WRITE_BUFFER_COUNT = 4;
+
+struct SpoolFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    double framerate;
+};
+
+struct SpoolRecordHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t index;
+    int64_t timestampUsec;
+    int32_t width;
+    int32_t height;
+    int32_t type;
+    uint32_t step;
+    uint64_t dataSize;
+    uint64_t recordSize;
+    uint64_t reserved;
+};
+static_assert(sizeof(SpoolRecordHeader) == 64, "SpoolRecordHeader must be 64 bytes.");
+
+struct SpoolIndexTrailer {
+    char magic[8];
+    uint64_t indexOffset;
+    uint64_t frameCount;
+    uint64_t reserved;
+};
+static_assert(sizeof(SpoolIndexTrailer) == 32, "SpoolIndexTrailer must be 32 bytes.");
+
+static inline size_t alignToPage(size_t size)
+{
+    return (size + SPOOL_PAGE_SIZE - 1) & ~(SPOOL_PAGE_SIZE - 1);
+}
+
+/**
+ * Page-aligned buffer, suitable for O_DIRECT I/O.
+ */
+struct SpoolBuffer {
+    uint8_t *data = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+    uint64_t fileOffset = 0;
+
+    ~SpoolBuffer()
+    {
+        free(data);
+    }
+
+    bool reserve(size_t newCapacity)
+    {
+        if (newCapacity <= capacity)
+            return true;
+        free(data);
+        data = nullptr;
+        capacity = 0;
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, SPOOL_PAGE_SIZE, newCapacity) != 0)
+            return false;
+        data = static_cast<uint8_t *>(ptr);
+        capacity = newCapacity;
+        return true;
+    }
+};
+
+static std::string writeBufferToFile(int fd, const SpoolBuffer &buf)
+{
+    size_t written = 0;
+    while (written < buf.size) {
+        const auto ret = pwrite(fd, buf.data + written, buf.size - written, buf.fileOffset + written);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return std::format("Unable to write to frame spool file: {}", std::strerror(errno));
+        }
+        written += static_cast<size_t>(ret);
+    }
+
+    return {};
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+class FrameSpoolWriter::Private
+{
+public:
+    int fd = -1;
+    bool directIO = false;
+    uint64_t nextOffset = 0;
+    std::vector<FrameSpoolEntry> index;
+
+    // all frames of a spool must have the geometry and type of the first one
+    int width = 0;
+    int height = 0;
+    int type = -1;
+
+    std::thread ioThread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::unique_ptr<SpoolBuffer>> buffers;
+    std::deque<SpoolBuffer *> freeBuffers;
+    std::deque<SpoolBuffer *> writeQueue;
+    bool stopThread = false;
+    std::string ioError;
+};
+#pragma GCC diagnostic pop
+
+FrameSpoolWriter::FrameSpoolWriter()
+    : d(new FrameSpoolWriter::Private)
+{
+}
+
+FrameSpoolWriter::~FrameSpoolWriter()
+{
+    close();
+}
+
+std::expected<void, std::string> FrameSpoolWriter::open(const std::string &fname, double framerate)
+{
+    if (d->fd >= 0)
+        return std::unexpected("Frame spool file is already open.");
+
+    // try to bypass the page cache, not all filesystems support this though
+    d->directIO = true;
+    d->fd = ::open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+    if (d->fd < 0 && errno == EINVAL) {
+        d->directIO = false;
+        d->fd = ::open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
+    if (d->fd < 0)
+        return std::unexpected(std::format("Unable to open frame spool file '{}': {}", fname, std::strerror(errno)));
+
+    SpoolBuffer header;
+    if (!header.reserve(SPOOL_PAGE_SIZE)) {
+        ::close(d->fd);
+        d->fd = -1;
+        return std::unexpected("Unable to allocate frame spool buffer.");
+    }
+    memset(header.data, 0, SPOOL_PAGE_SIZE);
+    SpoolFileHeader fileHdr;
+    memcpy(fileHdr.magic, SPOOL_FILE_MAGIC, sizeof(fileHdr.magic));
+    fileHdr.version = SPOOL_FORMAT_VERSION;
+    fileHdr.pageSize = SPOOL_PAGE_SIZE;
+    fileHdr.framerate = framerate;
+    memcpy(header.data, &fileHdr, sizeof(fileHdr));
+    header.size = SPOOL_PAGE_SIZE;
+    header.fileOffset = 0;
+
+    const auto error = writeBufferToFile(d->fd, header);
+    if (!error.empty()) {
+        ::close(d->fd);
+        d->fd = -1;
+        return std::unexpected(error);
+    }
+
+    d->nextOffset = SPOOL_PAGE_SIZE;
+    d->index.clear();
+    d->width = 0;
+    d->height = 0;
+    d->type = -1;
+    d->ioError.clear();
+    d->stopThread = false;
+    d->buffers.clear();
+    d->freeBuffers.clear();
+    d->writeQueue.clear();
+    for (size_t i = 0; i < SPOOL_WRITE_BUFFER_COUNT; i++) {
+        d->buffers.push_back(std::make_unique<SpoolBuffer>());
+        d->freeBuffers.push_back(d->buffers.back().get());
+    }
+    d->ioThread = std::thread(&FrameSpoolWriter::ioThreadMain, this);
+
+    return {};
+}
+
+std::expected<void, std::string> FrameSpoolWriter::close()
+{
+    if (d->fd < 0)
+        return {};
+
+    {
+        // wait for all pending frames to be written
+        std::unique_lock<std::mutex> lock(d->mutex);
+        d->cond.wait(lock, [this] {
+            return d->writeQueue.empty();
+        });
+        d->stopThread = true;
+    }
+    d->cond.notify_all();
+    d->ioThread.join();
+
+    std::string error = d->ioError;
+    if (error.empty()) {
+        // append the frame index, with its trailer at the very end of the file
+        const size_t indexSize = sizeof(uint64_t) + (d->index.size() * sizeof(FrameSpoolEntry))
+                                 + sizeof(SpoolIndexTrailer);
+        SpoolBuffer buf;
+        if (buf.reserve(alignToPage(indexSize))) {
+            buf.size = alignToPage(indexSize);
+            buf.fileOffset = d->nextOffset;
+            memset(buf.data, 0, buf.size);
+
+            const uint64_t count = d->index.size();
+            memcpy(buf.data, &count, sizeof(count));
+            if (!d->index.empty())
+                memcpy(buf.data + sizeof(count), d->index.data(), d->index.size() * sizeof(FrameSpoolEntry));
+
+            SpoolIndexTrailer trailer;
+            memcpy(trailer.magic, SPOOL_INDEX_MAGIC, sizeof(trailer.magic));
+            trailer.indexOffset = d->nextOffset;
+            trailer.frameCount = count;
+            trailer.reserved = 0;
+            memcpy(buf.data + buf.size - sizeof(trailer), &trailer, sizeof(trailer));
+
+            error = writeBufferToFile(d->fd, buf);
+        } else {
+            error = "Unable to allocate frame spool index buffer.";
+        }
+    }
+
+    ::close(d->fd);
+    d->fd = -1;
+    d->buffers.clear();
+    d->freeBuffers.clear();
+
+    if (!error.empty())
+        return std::unexpected(error);
+    return {};
+}
+
+bool FrameSpoolWriter::isOpen() const
+{
+    return d->fd >= 0;
+}
+
+std::expected<void, std::string> FrameSpoolWriter::appendFrame(
+    const cv::Mat &mat,
+    const std::chrono::microseconds &timestamp)
+{
+    if (d->fd < 0)
+        return std::unexpected("Frame spool file is not open.");
+    if (mat.empty())
+        return std::unexpected("Can not write an empty frame to the frame spool.");
+    if (d->index.empty()) {
+        d->width = mat.cols;
+        d->height = mat.rows;
+        d->type = mat.type();
+    } else if (mat.cols != d->width || mat.rows != d->height || mat.type() != d->type) {
+        return std::unexpected(
+            std::format(
+                "Frame of size {}x{} (type {}) does not match the other spooled frames of size {}x{} (type {}).",
+                mat.cols,
+                mat.rows,
+                mat.type(),
+                d->width,
+                d->height,
+                d->type));
+    }
+
+    SpoolBuffer *buf;
+    {
+        std::unique_lock<std::mutex> lock(d->mutex);
+        d->cond.wait(lock, [this] {
+            return !d->freeBuffers.empty() || !d->ioError.empty();
+        });
+        if (!d->ioError.empty())
+            return std::unexpected(d->ioError);
+        buf = d->freeBuffers.front();
+        d->freeBuffers.pop_front();
+    }
+
+    const size_t rowSize = mat.cols * mat.elemSize();
+    const size_t dataSize = rowSize * mat.rows;
+    const size_t recordSize = alignToPage(sizeof(SpoolRecordHeader) + dataSize);
+    if (!buf->reserve(recordSize)) {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        d->freeBuffers.push_back(buf);
+        return std::unexpected("Unable to allocate frame spool buffer.");
+    }
+
+    SpoolRecordHeader hdr;
+    hdr.magic = SPOOL_RECORD_MAGIC;
+    hdr.version = SPOOL_FORMAT_VERSION;
+    hdr.index = d->index.size();
+    hdr.timestampUsec = timestamp.count();
+    hdr.width = mat.cols;
+    hdr.height = mat.rows;
+    hdr.type = mat.type();
+    hdr.step = static_cast<uint32_t>(rowSize);
+    hdr.dataSize = dataSize;
+    hdr.recordSize = recordSize;
+    hdr.reserved = 0;
+    memcpy(buf->data, &hdr, sizeof(hdr));
+
+    uint8_t *pixels = buf->data + sizeof(SpoolRecordHeader);
+    if (mat.isContinuous()) {
+        memcpy(pixels, mat.data, dataSize);
+    } else {
+        for (int y = 0; y < mat.rows; y++)
+            memcpy(pixels + y * rowSize, mat.ptr(y), rowSize);
+    }
+    memset(pixels + dataSize, 0, recordSize - sizeof(SpoolRecordHeader) - dataSize);
+
+    buf->size = recordSize;
+    buf->fileOffset = d->nextOffset;
+    d->index.push_back(
+        FrameSpoolEntry{d->nextOffset, hdr.timestampUsec, hdr.width, hdr.height, hdr.type, hdr.step});
+    d->nextOffset += recordSize;
+
+    {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        d->writeQueue.push_back(buf);
+    }
+    d->cond.notify_all();
+
+    return {};
+}
+
+size_t FrameSpoolWriter::frameCount() const
+{
+    return d->index.size();
+}
+
+bool FrameSpoolWriter::directIO() const
+{
+    return d->directIO;
+}
+
+void FrameSpoolWriter::ioThreadMain()
+{
+    pthread_setname_np(pthread_self(), "spool_io");
+
+    while (true) {
+        SpoolBuffer *buf;
+        {
+            std::unique_lock<std::mutex> lock(d->mutex);
+            d->cond.wait(lock, [this] {
+                return d->stopThread || !d->writeQueue.empty();
+            });
+            if (d->writeQueue.empty())
+                break;
+            buf = d->writeQueue.front();
+        }
+
+        // once we have failed, we just discard all data
+        std::string error;
+        if (d->ioError.empty())
+            error = writeBufferToFile(d->fd, *buf);
+
+        {
+            std::lock_guard<std::mutex> lock(d->mutex);
+            if (!error.empty())
+                d->ioError = error;
+            d->writeQueue.pop_front();
+            d->freeBuffers.push_back(buf);
+        }
+        d->cond.notify_all();
+    }
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+class FrameSpoolReader::Private
+{
+public:
+    int fd = -1;
+    uint8_t *map = nullptr;
+    size_t mapSize = 0;
+    double framerate = 0;
+    std::vector<FrameSpoolEntry> index;
+    bool indexRecovered = false;
+    size_t skippedFrames = 0;
+
+    bool readIndex();
+    void scanRecords();
+};
+#pragma GCC diagnostic pop
+
+/**
+ * Check that an index entry describes a valid image that lies entirely
+ * within a mapped file of @p mapSize bytes.
+ */
+static bool isValidSpoolEntry(const FrameSpoolEntry &e, size_t mapSize)
+{
+    if (e.width <= 0 || e.height <= 0 || e.type < 0 || (e.type & ~CV_MAT_TYPE_MASK) != 0)
+        return false;
+
+    // rows may be padded, but never shorter than the pixels they hold
+    const auto rowSize = static_cast<uint64_t>(e.width) * static_cast<uint64_t>(CV_ELEM_SIZE(e.type));
+    if (e.step < rowSize)
+        return false;
+
+    if (e.offset < SPOOL_PAGE_SIZE || e.offset > mapSize || mapSize - e.offset < sizeof(SpoolRecordHeader))
+        return false;
+    const auto available = mapSize - e.offset - sizeof(SpoolRecordHeader);
+    return static_cast<uint64_t>(e.step) <= available / static_cast<uint64_t>(e.height);
+}
+
+/**
+ * Read the index written when the file was closed. Returns false if
+ * there is no usable index.
+ */
+bool FrameSpoolReader::Private::readIndex()
+{
+    SpoolIndexTrailer trailer;
+    memcpy(&trailer, map + mapSize - sizeof(trailer), sizeof(trailer));
+    if (memcmp(trailer.magic, SPOOL_INDEX_MAGIC, sizeof(trailer.magic)) != 0)
+        return false;
+
+    // the index must fit between its offset and the trailer, checked without overflowing
+    const size_t indexSpace = mapSize - sizeof(trailer) - sizeof(uint64_t);
+    if (trailer.indexOffset < SPOOL_PAGE_SIZE || trailer.indexOffset > indexSpace
+        || trailer.frameCount > (indexSpace - trailer.indexOffset) / sizeof(FrameSpoolEntry))
+        return false;
+
+    const auto entries = reinterpret_cast<const FrameSpoolEntry *>(map + trailer.indexOffset + sizeof(uint64_t));
+    index.assign(entries, entries + trailer.frameCount);
+    return true;
+}
+
+/**
+ * Rebuild the index from the frame records, stopping at the first
+ * damaged or incomplete one.
+ */
+void FrameSpoolReader::Private::scanRecords()
+{
+    index.clear();
+    size_t offset = SPOOL_PAGE_SIZE;
+    while (offset + sizeof(SpoolRecordHeader) <= mapSize) {
+        SpoolRecordHeader hdr;
+        memcpy(&hdr, map + offset, sizeof(hdr));
+        if (hdr.magic != SPOOL_RECORD_MAGIC || hdr.recordSize == 0 || hdr.recordSize % SPOOL_PAGE_SIZE != 0
+            || hdr.recordSize > mapSize - offset)
+            break;
+
+        const FrameSpoolEntry entry{offset, hdr.timestampUsec, hdr.width, hdr.height, hdr.type, hdr.step};
+        if (!isValidSpoolEntry(entry, offset + hdr.recordSize))
+            break;
+        index.push_back(entry);
+        offset += hdr.recordSize;
+    }
+}
+
+FrameSpoolReader::FrameSpoolReader()
+    : d(new FrameSpoolReader::Private)
+{
+}
+
+FrameSpoolReader::~FrameSpoolReader()
+{
+    close();
+}
+
+bool FrameSpoolReader::isSpoolFile(const std::string &fname)
+{
+    const int fd = ::open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    char magic[sizeof(SPOOL_FILE_MAGIC)];
+    const auto ret = pread(fd, magic, sizeof(magic), 0);
+    ::close(fd);
+
+    return ret == sizeof(magic) && memcmp(magic, SPOOL_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+std::expected<void, std::string> FrameSpoolReader::open(const std::string &fname)
+{
+    close();
+
+    d->fd = ::open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (d->fd < 0)
+        return std::unexpected(std::format("Unable to open frame spool file '{}': {}", fname, std::strerror(errno)));
+
+    struct stat st;
+    if (fstat(d->fd, &st) != 0 || static_cast<size_t>(st.st_size) < SPOOL_PAGE_SIZE) {
+        close();
+        return std::unexpected(std::format("Frame spool file '{}' is truncated.", fname));
+    }
+
+    // map privately and copy-on-write, so frames handed out by us may be modified freely
+    d->mapSize = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, d->mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, d->fd, 0);
+    if (map == MAP_FAILED) {
+        d->mapSize = 0;
+        close();
+        return std::unexpected(std::format("Unable to map frame spool file: {}", std::strerror(errno)));
+    }
+    d->map = static_cast<uint8_t *>(map);
+    madvise(map, d->mapSize, MADV_SEQUENTIAL);
+
+    SpoolFileHeader fileHdr;
+    memcpy(&fileHdr, d->map, sizeof(fileHdr));
+    if (memcmp(fileHdr.magic, SPOOL_FILE_MAGIC, sizeof(fileHdr.magic)) != 0) {
+        close();
+        return std::unexpected(std::format("File '{}' is not a frame spool file.", fname));
+    }
+    if (fileHdr.version != SPOOL_FORMAT_VERSION || fileHdr.pageSize != SPOOL_PAGE_SIZE) {
+        close();
+        return std::unexpected(std::format("Frame spool file version {} is not supported.", fileHdr.version));
+    }
+    d->framerate = fileHdr.framerate;
+
+    // read the index if the file was closed properly, and scan all frame records otherwise
+    d->indexRecovered = !d->readIndex();
+    if (d->indexRecovered)
+        d->scanRecords();
+
+    // skip damaged entries, so we never read outside of the mapped file or build invalid images
+    std::vector<FrameSpoolEntry> entries;
+    entries.reserve(d->index.size());
+    for (const auto &e : d->index) {
+        if (!isValidSpoolEntry(e, d->mapSize)
+            || (!entries.empty()
+                && (e.width != entries[0].width || e.height != entries[0].height || e.type != entries[0].type))) {
+            d->skippedFrames++;
+            continue;
+        }
+        entries.push_back(e);
+    }
+    d->index = std::move(entries);
+
+    return {};
+}
+
+void FrameSpoolReader::close()
+{
+    if (d->map != nullptr)
+        munmap(d->map, d->mapSize);
+    d->map = nullptr;
+    d->mapSize = 0;
+    if (d->fd >= 0)
+        ::close(d->fd);
+    d->fd = -1;
+    d->framerate = 0;
+    d->index.clear();
+    d->indexRecovered = false;
+    d->skippedFrames = 0;
+}
+
+double FrameSpoolReader::framerate() const
+{
+    return d->framerate;
+}
+
+size_t FrameSpoolReader::frameCount() const
+{
+    return d->index.size();
+}
+
+const FrameSpoolEntry &FrameSpoolReader::entry(size_t index) const
+{
+    return d->index.at(index);
+}
+
+cv::Mat FrameSpoolReader::frame(size_t index) const
+{
+    const auto &e = d->index.at(index);
+    return cv::Mat(e.height, e.width, e.type, d->map + e.offset + sizeof(SpoolRecordHeader), e.step);
+}
+
+bool FrameSpoolReader::indexRecovered() const
+{
+    return d->indexRecovered;
+}
+
+size_t FrameSpoolReader::skippedFrameCount() const
+{
+    return d->skippedFrames;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+/**
+ * File extension of frame spool files.
+ */
+static constexpr const char *FRAME_SPOOL_FILE_EXT = ".syspool";
+
+/**
+ * @brief Index entry of a frame in a spool file.
+ *
+ * This is also the on-disk layout of the index that is appended
+ * to a spool file when it is closed.
+ */
+struct FrameSpoolEntry {
+    uint64_t offset;       /// Offset of the frame record in the file
+    int64_t timestampUsec; /// Frame timestamp in microseconds
+    int32_t width;
+    int32_t height;
+    int32_t type; /// OpenCV matrix type
+    uint32_t step;
+};
+static_assert(sizeof(FrameSpoolEntry) == 32, "FrameSpoolEntry must have no padding.");
+
+/**
+ * @brief Write frames to an uncompressed, append-only spool file.
+ *
+ * Every frame is stored as a page-aligned record, so the file can be written
+ * with O_DIRECT (bypassing the page cache) and replayed via mmap later.
+ * Frames are copied into aligned buffers on the calling thread and written
+ * to disk by a dedicated I/O thread. All frames of a spool must have the same
+ * size and type.
+ * An index of all frames is appended when the file is closed. If that never
+ * happens, e.g. due to a crash, readers rebuild the index from the record headers.
+ */
+class FrameSpoolWriter
+{
+public:
+    explicit FrameSpoolWriter();
+    ~FrameSpoolWriter();
+
+    std::expected<void, std::string> open(const std::string &fname, double framerate);
+    std::expected<void, std::string> close();
+    bool isOpen() const;
+
+    std::expected<void, std::string> appendFrame(const cv::Mat &mat, const std::chrono::microseconds &timestamp);
+
+    size_t frameCount() const;
+    bool directIO() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+
+    void ioThreadMain();
+};
+
+/**
+ * @brief Read frames from a spool file.
+ *
+ * The file is memory-mapped, frames returned by this class are views into the
+ * mapped file and are only valid as long as the reader stays open. The mapping is
+ * private, so modifying a frame never changes the file.
+ * Damaged frame records are skipped, and a file without index is read up to
+ * its first incomplete record.
+ * Reading frames is thread-safe, so multiple workers can replay different
+ * segments of the same file at once.
+ */
+class FrameSpoolReader
+{
+public:
+    explicit FrameSpoolReader();
+    ~FrameSpoolReader();
+
+    static bool isSpoolFile(const std::string &fname);
+
+    std::expected<void, std::string> open(const std::string &fname);
+    void close();
+
+    double framerate() const;
+    size_t frameCount() const;
+    const FrameSpoolEntry &entry(size_t index) const;
+    cv::Mat frame(size_t index) const;
+
+    /**
+     * True if the file was not closed properly, and its index was
+     * recovered from the frame records.
+     */
+    bool indexRecovered() const;
+
+    /**
+     * Number of damaged frames that were skipped when opening the file.
+     */
+    size_t skippedFrameCount() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
@@ -27,12 +27,14 @@
 #include <QDBusMetaType>
 #include <QDBusReply>
 #include <QDBusServiceWatcher>
+#include <QDir>
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QProcess>
 #include <QTimer>
 
 #include "equeueshared.h"
+#include "framespool.h"
 #include "utils/misc.h"
 #include "recordersettingsdialog.h"
 #include "videowriter.h"
@@ -68,6 +70,7 @@ private:
     bool m_checkCommands;
 
     QString m_subjectName;
+    std::string m_dataBasename;
 
 public:
     explicit VideoRecorderModule(QObject *parent = nullptr)
@@ -139,13 +142,17 @@ public:
         codecProps.setThreadCount((potentialNoaffinityCPUCount() >= 2) ? potentialNoaffinityCPUCount() : 2);
 
         if (m_settingsDialog->deferredEncoding()) {
-            // deferred encoding is enabled, so we actually have to save a raw video file
-            m_videoWriter->setContainer(VideoContainer::Matroska);
+            // deferred encoding is enabled, so we just spool the raw frames to disk
+            m_videoWriter->setSpoolOutput(true);
             CodecProperties cprops(VideoCodec::Raw);
             codecProps = cprops;
         }
         m_videoWriter->setCodecProps(codecProps);
 
+        // convert pixel formats in a pipeline in parallel to encoding, so a single recorder can keep up
+        // with high resolution & framerate input
+        m_videoWriter->setConversionThreads(std::clamp(static_cast<int>(potentialNoaffinityCPUCount()) / 4, 1, 4));
+
         // copy codec properties so the worker thread has direct access to a copy
         m_activeCodecProps = codecProps;
 
@@ -356,6 +363,7 @@ public:
                         m_vidDataset->collectionShortTag(),
                         simplifyStrForFileBasename(m_vidDataset->name(), true, 22)));
                 vidSavePathBase = m_vidDataset->pathForDataBasename(dataBasename);
+                m_dataBasename = dataBasename;
                 m_vidDataset->setDataScanPattern(
                     dataBasename + "*",
                     inSubSrcModName.empty() ? std::string() : std::format("Video recording from {}", inSubSrcModName));
@@ -518,25 +526,51 @@ public:
                                                                    QString::fromStdString(m_vidDataset->name()),
                                                                    time.toString("HH:mm yy-MM-dd"));
 
+        // Each spool file will be replaced by an encoded video of the same name, so we register the
+        // final video files as our data right away.
+        const auto srcModName = m_inSub->metadataValue(CommonMetadataKey::SrcModName, std::string{});
+        const auto spoolFiles = QDir(QString::fromStdString(m_vidDataset->path().string()))
+                                    .entryList(
+                                        {QStringLiteral("%1*%2").arg(
+                                            QString::fromStdString(m_dataBasename),
+                                            QString::fromUtf8(FRAME_SPOOL_FILE_EXT))},
+                                        QDir::Files,
+                                        QDir::Name);
+        const auto videoExt = m_settingsDialog->videoContainer() == VideoContainer::AVI ? QStringLiteral(".avi")
+                                                                                        : QStringLiteral(".mkv");
+        m_vidDataset->setDataScanPattern({}, {});
+        for (int i = 0; i < spoolFiles.size(); i++) {
+            const auto videoFname = spoolFiles[i].left(spoolFiles[i].lastIndexOf('.')) + videoExt;
+            if (i == 0)
+                m_vidDataset->setDataFile(
+                    videoFname.toStdString(),
+                    srcModName.empty() ? std::string() : std::format("Video recording from {}", srcModName));
+            else
+                m_vidDataset->addDataFilePart(videoFname.toStdString(), i);
+        }
+
         // we need to explicitly save the dataset here to ensure any globs are finalized into
         // actual data- and aux file parts.
         m_vidDataset->save();
 
         // schedule encoding jobs in the external encoder process
         for (auto &dataPart : m_vidDataset->dataFile().parts) {
+            const auto videoPath = QString::fromStdString(m_vidDataset->pathForDataPart(dataPart));
+            const auto spoolPath = videoPath.left(videoPath.lastIndexOf('.')) + QString::fromUtf8(FRAME_SPOOL_FILE_EXT);
+
             QVariantHash mdata;
             mdata["mod-name"] = QVariant::fromValue(name());
-            mdata["src-mod-name"] = QString::fromStdString(
-                m_inSub->metadataValue(CommonMetadataKey::SrcModName, std::string{}));
+            mdata["src-mod-name"] = QString::fromStdString(srcModName);
             mdata["collection-id"] = QString::fromStdString(m_vidDataset->collectionId().toHex());
             mdata["subject-name"] = m_subjectName;
             mdata["save-timestamps"] = m_settingsDialog->saveTimestamps();
             mdata["video-container"] = static_cast<int>(m_settingsDialog->videoContainer());
+            mdata["spool-file"] = spoolPath;
 
             QDBusReply<bool> reply = iface->call(
                 "enqueueVideo",
                 projectName,
-                QString::fromStdString(m_vidDataset->pathForDataPart(dataPart)),
+                videoPath,
                 m_settingsDialog->codecProps().toVariant(),
                 mdata);
             if (!reply.isValid() || !reply.value())
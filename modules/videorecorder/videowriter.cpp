@@ -21,10 +21,15 @@
 
 #include <QDateTime>
 #include <QFileInfo>
+#include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <pthread.h>
 #include <queue>
 #include <string.h>
 #include <systemd/sd-device.h>
@@ -43,6 +48,7 @@ extern "C" {
 
 #include "datactl/tsyncfile.h"
 #include "ffmpeg-utils.h"
+#include "framespool.h"
 
 using namespace Syntalos;
 
@@ -418,6 +424,255 @@ void CodecProperties::setBitrateKbps(int bitrate)
     d->bitrate = bitrate;
 }
 
+/**
+ * Ensure image data is safe to be read by FFmpeg.
+ *
+ * FFmpeg contains SIMD optimizations which can sometimes read data past
+ * the supplied input buffer. To ensure that doesn't happen, we pad the
+ * step to a multiple of 32 (that's the minimal alignment for which Valgrind
+ * doesn't raise any warnings), copying the data to the given buffer if needed.
+ */
+static const uint8_t *vw_align_input(
+    const uint8_t *data,
+    size_t &step,
+    int height,
+    uchar **alignedBuf,
+    size_t *alignedBufSize)
+{
+    const size_t CV_STEP_ALIGNMENT = 32;
+    const size_t CV_SIMD_SIZE = 32;
+    const size_t CV_PAGE_MASK = ~(size_t)(4096 - 1);
+    const unsigned char *dataend = data + ((size_t)height * step);
+    if (step % CV_STEP_ALIGNMENT == 0
+        && (((size_t)dataend - CV_SIMD_SIZE) & CV_PAGE_MASK) == (((size_t)dataend + CV_SIMD_SIZE) & CV_PAGE_MASK))
+        return data;
+
+    auto alignedStep = (step + CV_STEP_ALIGNMENT - 1) & ~(CV_STEP_ALIGNMENT - 1);
+
+    // reallocate alignment buffer if needed
+    size_t newSize = (alignedStep * height + CV_SIMD_SIZE);
+    if (*alignedBuf == nullptr || *alignedBufSize < newSize) {
+        if (*alignedBuf != nullptr)
+            av_freep(alignedBuf);
+        *alignedBufSize = newSize;
+        *alignedBuf = (unsigned char *)av_mallocz(*alignedBufSize);
+    }
+
+    for (size_t y = 0; y < static_cast<size_t>(height); y++)
+        memcpy(*alignedBuf + y * alignedStep, data + y * step, step);
+
+    step = alignedStep;
+    return *alignedBuf;
+}
+
+/**
+ * Convert OpenCV matrices to the color format of an encoder frame.
+ *
+ * Image color conversion and scaling is split into horizontal slices, which are
+ * processed concurrently: The calling thread converts the first slice, while
+ * worker threads take care of the remaining ones.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+class FrameConverter
+{
+public:
+    explicit FrameConverter(AVPixelFormat inFormat, AVPixelFormat outFormat, int width, int height, int sliceCount)
+        : m_inFormat(inFormat),
+          m_width(width),
+          m_generation(0),
+          m_pending(0),
+          m_stop(false),
+          m_image(nullptr),
+          m_frame(nullptr)
+    {
+        const auto outDesc = av_pix_fmt_desc_get(outFormat);
+        m_chromaShift = outDesc->log2_chroma_h;
+        m_planeCount = av_pix_fmt_count_planes(outFormat);
+
+        // slices must start on a row that has its own chroma samples
+        const int rowAlign = 1 << m_chromaShift;
+        sliceCount = std::clamp(sliceCount, 1, std::max(1, height / 64));
+        const int sliceHeight = ((height / sliceCount) / rowAlign) * rowAlign;
+
+        m_slices.resize(sliceCount);
+        for (int i = 0; i < sliceCount; i++) {
+            auto &slice = m_slices[i];
+            slice.y = i * sliceHeight;
+            slice.height = (i == sliceCount - 1) ? height - slice.y : sliceHeight;
+            slice.sws = sws_getContext(
+                width,
+                slice.height,
+                inFormat,
+                width,
+                slice.height,
+                outFormat,
+                SWS_BICUBIC,
+                nullptr,
+                nullptr,
+                nullptr);
+            if (slice.sws == nullptr) {
+                freeSlices();
+                throw std::runtime_error("Failed to initialize sample scaler for frame slice.");
+            }
+        }
+
+        for (size_t i = 1; i < m_slices.size(); i++)
+            m_threads.emplace_back(&FrameConverter::workerMain, this, i);
+    }
+
+    ~FrameConverter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_workCond.notify_all();
+        for (auto &t : m_threads)
+            t.join();
+        freeSlices();
+    }
+
+    int sliceCount() const
+    {
+        return static_cast<int>(m_slices.size());
+    }
+
+    /**
+     * Convert a full-sized image into the preallocated encoder frame.
+     */
+    bool convert(const cv::Mat &image, AVFrame *frame, std::string &error)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_image = &image;
+            m_frame = frame;
+            m_pending = m_slices.size() - 1;
+            m_generation++;
+        }
+        m_workCond.notify_all();
+
+        convertSlice(m_slices[0]);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCond.wait(lock, [this] {
+            return m_pending == 0;
+        });
+        m_image = nullptr;
+        m_frame = nullptr;
+
+        for (const auto &slice : m_slices) {
+            if (!slice.error.empty()) {
+                error = slice.error;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Slice {
+        int y = 0;
+        int height = 0;
+        SwsContext *sws = nullptr;
+        cv::Mat colorConverted;
+        uchar *alignedInput = nullptr;
+        size_t alignedInputSize = 0;
+        std::string error;
+    };
+
+    void freeSlices()
+    {
+        for (auto &slice : m_slices) {
+            if (slice.sws != nullptr)
+                sws_freeContext(slice.sws);
+            slice.sws = nullptr;
+            if (slice.alignedInput != nullptr)
+                av_freep(&slice.alignedInput);
+        }
+    }
+
+    void workerMain(size_t sliceIdx)
+    {
+        pthread_setname_np(pthread_self(), "vw_convert");
+        uint64_t lastGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_workCond.wait(lock, [&] {
+                    return m_stop || m_generation != lastGeneration;
+                });
+                if (m_stop)
+                    break;
+                lastGeneration = m_generation;
+            }
+
+            convertSlice(m_slices[sliceIdx]);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0)
+                m_doneCond.notify_one();
+        }
+    }
+
+    void convertSlice(Slice &slice)
+    {
+        slice.error.clear();
+        cv::Mat image = m_image->rowRange(slice.y, slice.y + slice.height);
+
+        // Convert color formats around to match what was actually selected as
+        // input pixel format
+        const auto channels = image.channels();
+        if (m_inFormat == AV_PIX_FMT_GRAY8 && channels != 1) {
+            cv::cvtColor(image, slice.colorConverted, cv::COLOR_BGR2GRAY);
+            image = slice.colorConverted;
+        } else if (m_inFormat == AV_PIX_FMT_BGR24 && channels == 4) {
+            cv::cvtColor(image, slice.colorConverted, cv::COLOR_BGRA2BGR);
+            image = slice.colorConverted;
+        } else if (m_inFormat == AV_PIX_FMT_BGR24 && channels == 1) {
+            cv::cvtColor(image, slice.colorConverted, cv::COLOR_GRAY2BGR);
+            image = slice.colorConverted;
+        }
+
+        size_t step = image.step[0];
+        const auto data = vw_align_input(image.ptr(), step, slice.height, &slice.alignedInput, &slice.alignedInputSize);
+
+        uint8_t *srcData[4];
+        int srcLinesize[4];
+        av_image_fill_arrays(srcData, srcLinesize, data, m_inFormat, m_width, slice.height, 1);
+        srcLinesize[0] = static_cast<int>(step);
+
+        // point to the rows of this slice in every plane of the output frame
+        uint8_t *dstData[4] = {nullptr, nullptr, nullptr, nullptr};
+        int dstLinesize[4] = {0, 0, 0, 0};
+        for (int p = 0; p < m_planeCount; p++) {
+            const int planeRow = (p == 1 || p == 2) ? (slice.y >> m_chromaShift) : slice.y;
+            dstData[p] = m_frame->data[p] + static_cast<ptrdiff_t>(planeRow) * m_frame->linesize[p];
+            dstLinesize[p] = m_frame->linesize[p];
+        }
+
+        if (sws_scale(slice.sws, srcData, srcLinesize, 0, slice.height, dstData, dstLinesize) < 0)
+            slice.error = "Unable to scale image in pixel format conversion.";
+    }
+
+    AVPixelFormat m_inFormat;
+    int m_width;
+    int m_chromaShift;
+    int m_planeCount;
+    std::vector<Slice> m_slices;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workCond;
+    std::condition_variable m_doneCond;
+    uint64_t m_generation;
+    size_t m_pending;
+    bool m_stop;
+    const cv::Mat *m_image;
+    AVFrame *m_frame;
+};
+#pragma GCC diagnostic pop
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpadded"
 class VideoWriter::Private
@@ -445,6 +700,13 @@ public:
         hwFrameCtx = nullptr;
         hwFrame = nullptr;
 
+        spoolOutput = false;
+        conversionThreads = 0;
+        framePool = nullptr;
+        framesInFlight = 0;
+        pipelineStop = false;
+        pipelineFailed = false;
+
         selectedEncoderName = QStringLiteral("No encoder selected yet");
     }
 
@@ -489,6 +751,36 @@ public:
     AVBufferRef *hwDevCtx;
     AVBufferRef *hwFrameCtx;
     AVFrame *hwFrame;
+
+    bool spoolOutput;
+    std::unique_ptr<FrameSpoolWriter> spool;
+
+    // pipelined encoding, used if conversionThreads > 0
+    struct QueuedImage {
+        cv::Mat mat;
+        std::chrono::microseconds timestamp;
+    };
+    struct ConvertedFrame {
+        AVFrame *frame;
+        std::chrono::microseconds timestamp;
+    };
+    static constexpr size_t PIPELINE_QUEUE_LIMIT = 3;
+
+    int conversionThreads;
+    std::unique_ptr<FrameConverter> converter;
+    AVBufferPool *framePool;
+    size_t framePoolBufSize;
+    std::thread conversionThread;
+    std::thread encoderThread;
+    std::mutex pipelineMutex;
+    std::condition_variable pipelineCond;
+    std::deque<QueuedImage> conversionQueue;
+    std::deque<ConvertedFrame> encoderQueue;
+    std::vector<AVFrame *> freeFrames;
+    size_t framesInFlight;
+    bool pipelineStop;
+    std::atomic_bool pipelineFailed;
+    std::string pipelineError;
 };
 #pragma GCC diagnostic pop
 
@@ -555,6 +847,23 @@ static AVFrame *vw_alloc_frame(AVPixelFormat pix_fmt, int width, int height, boo
     return aframe;
 }
 
+bool openVideoTimestampFile(
+    TimeSyncFileWriter &tsfWriter,
+    const std::string &fname,
+    double fps,
+    const std::string &modName,
+    const Uuid &collectionId)
+{
+    tsfWriter.close(); // ensure file is closed
+    tsfWriter.setSyncMode(TSyncFileMode::CONTINUOUS);
+    tsfWriter.setTimeNames("frame-no", "master-time");
+    tsfWriter.setTimeUnits(TSyncFileTimeUnit::INDEX, TSyncFileTimeUnit::MICROSECONDS);
+    tsfWriter.setTimeDataTypes(TSyncFileDataType::UINT32, TSyncFileDataType::UINT64);
+    tsfWriter.setChunkSize(std::lround(fps * 60.0)); // new chunk about every minute
+    tsfWriter.setFileName(fname);
+    return tsfWriter.open(modName, collectionId);
+}
+
 void VideoWriter::initializeHWAccell()
 {
     // DRI node for HW acceleration
@@ -613,6 +922,32 @@ void VideoWriter::initializeInternal()
     // prepare timestamp filename
     auto timestampFname = fname + "_timestamps.tsync";
 
+    if (d->spoolOutput) {
+        // we just store the raw frames for deferred encoding
+        d->spool = std::make_unique<FrameSpoolWriter>();
+        const auto res = d->spool->open((fname + FRAME_SPOOL_FILE_EXT).toStdString(), av_q2d(d->fps));
+        if (!res) {
+            d->spool.reset();
+            throw std::runtime_error(res.error());
+        }
+        d->selectedEncoderName = QStringLiteral("Frame Spool");
+        d->framePts = 0;
+
+        if (d->saveTimestamps
+            && !openVideoTimestampFile(
+                d->tsfWriter,
+                timestampFname.toStdString(),
+                av_q2d(d->fps),
+                d->modName.toStdString(),
+                d->collectionId)) {
+            finalizeInternal(false);
+            throw std::runtime_error(std::format("Unable to initialize timesync file: {}", d->tsfWriter.lastError()));
+        }
+
+        d->initialized = true;
+        return;
+    }
+
     // set container format
     switch (d->container) {
     case VideoContainer::Matroska:
@@ -980,14 +1315,12 @@ void VideoWriter::initializeInternal()
     d->framePts = 0;
 
     if (d->saveTimestamps) {
-        d->tsfWriter.close(); // ensure file is closed
-        d->tsfWriter.setSyncMode(TSyncFileMode::CONTINUOUS);
-        d->tsfWriter.setTimeNames("frame-no", "master-time");
-        d->tsfWriter.setTimeUnits(TSyncFileTimeUnit::INDEX, TSyncFileTimeUnit::MICROSECONDS);
-        d->tsfWriter.setTimeDataTypes(TSyncFileDataType::UINT32, TSyncFileDataType::UINT64);
-        d->tsfWriter.setChunkSize(std::lround(av_q2d(d->fps) * 60.0)); // new chunk about every minute
-        d->tsfWriter.setFileName(timestampFname.toStdString());
-        if (!d->tsfWriter.open(d->modName.toStdString(), d->collectionId)) {
+        if (!openVideoTimestampFile(
+                d->tsfWriter,
+                timestampFname.toStdString(),
+                av_q2d(d->fps),
+                d->modName.toStdString(),
+                d->collectionId)) {
             finalizeInternal(false);
             throw std::runtime_error(std::format("Unable to initialize timesync file: {}", d->tsfWriter.lastError()));
         }
@@ -1003,6 +1336,15 @@ std::expected<void, std::string> VideoWriter::finalizeInternal(bool writeTrailer
     // so callers are aware of the broken file.
     std::optional<std::string> finalizeError;
 
+    if (d->spool) {
+        const auto res = d->spool->close();
+        if (!res) {
+            LOG_CRITICAL(d->log, "Unable to finalize frame spool: {}", res.error());
+            finalizeError = res.error();
+        }
+        d->spool.reset();
+    }
+
     if (d->initialized) {
         AVPacket *pkt = av_packet_alloc();
         if (pkt == nullptr) {
@@ -1169,11 +1511,23 @@ void VideoWriter::initialize(
 
     // initialize encoder
     initializeInternal();
+    try {
+        startPipeline();
+    } catch (const std::exception &) {
+        finalizeInternal(false);
+        throw;
+    }
 }
 
 std::expected<void, std::string> VideoWriter::finalize()
 {
-    return finalizeInternal(true);
+    // write out all frames that are still queued
+    const auto pipelineRes = stopPipeline();
+
+    const auto res = finalizeInternal(true);
+    if (!res)
+        return res;
+    return pipelineRes;
 }
 
 bool VideoWriter::initialized() const
@@ -1189,6 +1543,13 @@ bool VideoWriter::startNewSection(const QString &fname)
     }
 
     try {
+        // write out all queued frames before closing the current file
+        const auto pipelineRes = stopPipeline();
+        if (!pipelineRes) {
+            d->lastError = pipelineRes.error();
+            return false;
+        }
+
         // finalize the current file
         const auto res = finalizeInternal(true);
         if (!res) {
@@ -1205,6 +1566,7 @@ bool VideoWriter::startNewSection(const QString &fname)
         // set slice number to one, since we are starting fresh
         d->currentSliceNo = 1;
         initializeInternal();
+        startPipeline();
     } catch (const std::exception &e) {
         // propagate error and stop, we can not really recover from this
         d->lastError = e.what();
@@ -1252,8 +1614,8 @@ inline bool VideoWriter::prepareFrame(const cv::Mat &inImage)
         image = inImage;
     }
 
-    auto step = image.step[0];
-    auto data = image.ptr();
+    size_t step = image.step[0];
+    const uint8_t *data = image.ptr();
     channels = image.channels();
 
     const auto height = image.rows;
@@ -1281,33 +1643,8 @@ inline bool VideoWriter::prepareFrame(const cv::Mat &inImage)
         return false;
     }
 
-    // FFmpeg contains SIMD optimizations which can sometimes read data past
-    // the supplied input buffer. To ensure that doesn't happen, we pad the
-    // step to a multiple of 32 (that's the minimal alignment for which Valgrind
-    // doesn't raise any warnings).
-    const size_t CV_STEP_ALIGNMENT = 32;
-    const size_t CV_SIMD_SIZE = 32;
-    const size_t CV_PAGE_MASK = ~(size_t)(4096 - 1);
-    const unsigned char *dataend = data + ((size_t)height * step);
-    if (step % CV_STEP_ALIGNMENT != 0
-        || (((size_t)dataend - CV_SIMD_SIZE) & CV_PAGE_MASK) != (((size_t)dataend + CV_SIMD_SIZE) & CV_PAGE_MASK)) {
-        auto alignedStep = (step + CV_STEP_ALIGNMENT - 1) & ~(CV_STEP_ALIGNMENT - 1);
-
-        // reallocate alignment buffer if needed
-        size_t newSize = (alignedStep * height + CV_SIMD_SIZE);
-        if (d->alignedInput == nullptr || d->alignedInputSize < newSize) {
-            if (d->alignedInput != nullptr)
-                av_freep(&d->alignedInput);
-            d->alignedInputSize = newSize;
-            d->alignedInput = (unsigned char *)av_mallocz(d->alignedInputSize);
-        }
-
-        for (size_t y = 0; y < static_cast<size_t>(height); y++)
-            memcpy(d->alignedInput + y * alignedStep, data + y * step, step);
-
-        data = d->alignedInput;
-        step = alignedStep;
-    }
+    // ensure FFmpeg's SIMD code can not read past the end of the image
+    data = vw_align_input(data, step, height, &d->alignedInput, &d->alignedInputSize);
 
     // let input_picture point to the raw data buffer of 'image'
     av_image_fill_arrays(
@@ -1337,85 +1674,115 @@ inline bool VideoWriter::prepareFrame(const cv::Mat &inImage)
         return false;
     }
 
-    d->encFrame->pts = d->framePts++;
     return true;
 }
 
 bool VideoWriter::encodeFrame(const cv::Mat &frame, const std::chrono::microseconds &timestamp)
 {
-    int ret;
-    bool success = false;
-    bool havePacket = false;
+    if (d->converter)
+        return enqueueFrame(frame, timestamp);
+
+    if (d->spool) {
+        auto res = d->spool->appendFrame(frame, timestamp);
+        if (res) {
+            d->framePts++;
+            res = finishFrame(timestamp);
+        }
+        if (!res) {
+            d->lastError = res.error();
+            return false;
+        }
+        return true;
+    }
 
     if (!prepareFrame(frame)) {
         std::cerr << "Unable to prepare frame. N: " << d->framesN + 1 << "(" << d->lastError << ")" << std::endl;
         return false;
     }
 
-    AVPacket *pkt = av_packet_alloc();
-    if (!pkt) {
-        d->lastError = QStringLiteral("Unable to allocate packet.").toStdString();
+    const auto res = writeFrame(d->encFrame, timestamp);
+    if (!res) {
+        d->lastError = res.error();
+        std::cerr << d->lastError << std::endl;
         return false;
     }
 
-    AVBufferRef *savedBuf0 = nullptr;
-    auto outputFrame = d->encFrame;
+    return true;
+}
 
-    const auto tsUsec = timestamp.count();
+std::expected<void, std::string> VideoWriter::writeFrame(AVFrame *frame, const std::chrono::microseconds &timestamp)
+{
+    int ret;
+    std::expected<void, std::string> result;
 
-    if (d->hwDevCtx == nullptr) {
-        // force FFmpeg to create a copy of the frame, if the codec needs it
-        savedBuf0 = d->encFrame->buf[0];
-        d->encFrame->buf[0] = nullptr;
-    } else {
+    AVPacket *pkt = av_packet_alloc();
+    if (!pkt)
+        return std::unexpected("Unable to allocate packet.");
+
+    frame->pts = d->framePts++;
+    auto outputFrame = frame;
+
+    if (d->hwDevCtx != nullptr) {
         // we are GPU accelerated! Copy frame to the GPU.
-        if (av_hwframe_transfer_data(d->hwFrame, d->encFrame, 0)) {
-            d->lastError = QStringLiteral("Failed to upload data to the GPU").toStdString();
-            std::cerr << d->lastError << std::endl;
+        if (av_hwframe_transfer_data(d->hwFrame, frame, 0)) {
+            result = std::unexpected("Failed to upload data to the GPU");
             goto out;
         }
-        d->hwFrame->pts = d->encFrame->pts;
+        d->hwFrame->pts = frame->pts;
         outputFrame = d->hwFrame;
     }
 
-    // encode video frame
-    ret = avcodec_send_frame(d->cctx, outputFrame);
+    if (outputFrame == d->encFrame) {
+        // force FFmpeg to create a copy of the frame, if the codec needs it, as we will reuse
+        // the buffer for the next frame
+        AVBufferRef *savedBuf0 = d->encFrame->buf[0];
+        d->encFrame->buf[0] = nullptr;
+        ret = avcodec_send_frame(d->cctx, outputFrame);
+        d->encFrame->buf[0] = savedBuf0;
+    } else {
+        ret = avcodec_send_frame(d->cctx, outputFrame);
+    }
     if (ret < 0) {
-        d->lastError = QStringLiteral("Unable to send frame to encoder. N: %1").arg(d->framesN + 1).toStdString();
-        std::cerr << d->lastError << std::endl;
+        result = std::unexpected(std::format("Unable to send frame to encoder. N: {}", d->framesN + 1));
         goto out;
     }
 
-    ret = avcodec_receive_packet(d->cctx, pkt);
-    if (ret != 0) {
-        if (ret == AVERROR(EAGAIN)) {
-            // Some encoders need to be fed a few frames before they produce a packet, but the
-            // frames are still saved. So we encounter for that fact.
-            havePacket = false;
-        } else {
+    // Some encoders need to be fed a few frames before they produce a packet, but the
+    // frames are still saved. So we write whatever packets are ready right now.
+    while (true) {
+        ret = avcodec_receive_packet(d->cctx, pkt);
+        if (ret == AVERROR(EAGAIN))
+            break;
+        if (ret < 0) {
             // we have a real error and can not continue
-            d->lastError = std::format("Unable to send packet to codec: {}", averrorToString(ret));
-            std::cerr << d->lastError << std::endl;
+            result = std::unexpected(std::format("Unable to send packet to codec: {}", averrorToString(ret)));
             goto out;
         }
-    } else {
-        havePacket = true;
-    }
 
-    if (havePacket) {
         // rescale packet timestamp
         pkt->duration = 1;
         av_packet_rescale_ts(pkt, d->cctx->time_base, d->vstrm->time_base);
 
         // write packet
         ret = av_write_frame(d->octx, pkt);
+        av_packet_unref(pkt);
         if (ret < 0) {
-            d->lastError = std::format("Unable to write frame packet to output: {}", averrorToString(ret));
-            std::cerr << d->lastError << std::endl;
+            result = std::unexpected(std::format("Unable to write frame packet to output: {}", averrorToString(ret)));
             goto out;
         }
     }
 
+    result = finishFrame(timestamp);
+
+out:
+    av_packet_free(&pkt);
+    return result;
+}
+
+std::expected<void, std::string> VideoWriter::finishFrame(const std::chrono::microseconds &timestamp)
+{
+    const auto tsUsec = timestamp.count();
+
     // store timestamp (if necessary)
     if (d->saveTimestamps) {
         // framePts - 1 is used because the counter has already advanced to the next index
@@ -1430,39 +1797,251 @@ bool VideoWriter::encodeFrame(const cv::Mat &frame, const std::chrono::microseco
                 // we need to start a new file now since the maximum time for this file has elapsed,
                 // so finalize this one
                 const auto res = finalizeInternal(true);
-                if (!res) {
-                    d->lastError = res.error();
-                    goto out;
-                }
+                if (!res)
+                    return std::unexpected(res.error());
 
                 // increment current slice number and attempt to reinitialize recording.
                 d->currentSliceNo += 1;
                 initializeInternal();
             } catch (const std::exception &e) {
                 // propagate error and stop encoding thread, as we can not really recover from this
-                d->lastError = e.what();
-                goto out;
+                return std::unexpected(e.what());
             }
         }
     }
 
-    success = true;
-out:
-    av_packet_free(&pkt);
+    return {};
+}
+
+void VideoWriter::startPipeline()
+{
+    if (d->conversionThreads <= 0 || d->spool)
+        return;
+
+    d->converter = std::make_unique<FrameConverter>(
+        d->inputPixFormat, d->encPixFormat, d->width, d->height, d->conversionThreads);
+
+    // encoder frames are allocated from a pool, so the encoder can keep references to them
+    // for as long as it needs without us having to copy the frame data
+    d->framePoolBufSize = av_image_get_buffer_size(
+        d->encPixFormat, d->width, d->height, ffmpeg_get_buffer_alignment());
+    d->framePool = av_buffer_pool_init(d->framePoolBufSize, nullptr);
+    if (d->framePool == nullptr) {
+        d->converter.reset();
+        throw std::runtime_error("Unable to allocate encoder frame pool.");
+    }
+
+    d->framesInFlight = 0;
+    d->pipelineStop = false;
+    d->pipelineFailed = false;
+    d->pipelineError.clear();
+    d->conversionThread = std::thread(&VideoWriter::conversionThreadMain, this);
+    d->encoderThread = std::thread(&VideoWriter::encoderThreadMain, this);
+
+    LOG_DEBUG(
+        d->log, "Using pipelined video encoding with {} conversion slice(s)", d->converter->sliceCount());
+}
+
+std::expected<void, std::string> VideoWriter::stopPipeline()
+{
+    if (!d->converter)
+        return {};
+
+    {
+        // wait for all queued frames to be written, then stop the pipeline threads
+        std::unique_lock<std::mutex> lock(d->pipelineMutex);
+        d->pipelineCond.wait(lock, [this] {
+            return d->framesInFlight == 0;
+        });
+        d->pipelineStop = true;
+    }
+    d->pipelineCond.notify_all();
+    d->conversionThread.join();
+    d->encoderThread.join();
+
+    for (auto frame : d->freeFrames)
+        av_frame_free(&frame);
+    d->freeFrames.clear();
+    av_buffer_pool_uninit(&d->framePool);
+    d->converter.reset();
+
+    if (d->pipelineFailed)
+        return std::unexpected(d->pipelineError);
+    return {};
+}
+
+bool VideoWriter::enqueueFrame(const cv::Mat &frame, const std::chrono::microseconds &timestamp)
+{
+    if (d->pipelineFailed) {
+        std::lock_guard<std::mutex> lock(d->pipelineMutex);
+        d->lastError = d->pipelineError;
+        return false;
+    }
+
+    // sanity checks, so we can report bad frames immediately
+    if ((frame.rows > d->height) || (frame.cols > d->width))
+        throw std::runtime_error(
+            QStringLiteral("Received bigger frame than we expected for %1 (%2x%3 instead of %4x%5)")
+                .arg(d->modName)
+                .arg(frame.cols)
+                .arg(frame.rows)
+                .arg(d->width)
+                .arg(d->height)
+                .toStdString());
+    if (d->inputPixFormat == AV_PIX_FMT_GRAY16LE && frame.channels() != 1) {
+        d->lastError = QStringLiteral("Expected grayscale image, but received image has %1 channels")
+                           .arg(frame.channels())
+                           .toStdString();
+        return false;
+    }
+
+    // we only hold a reference to the image data, producers never modify frames they have emitted
+    Private::QueuedImage item{frame, timestamp};
+    if ((frame.rows != d->height) || (frame.cols != d->width)) {
+        // the converter works on fixed-size slices, so we pad smaller images
+        item.mat = cv::Mat::zeros(d->height, d->width, frame.type());
+        frame.copyTo(item.mat(cv::Rect(0, 0, frame.cols, frame.rows)));
+    }
+
+    std::unique_lock<std::mutex> lock(d->pipelineMutex);
+    d->pipelineCond.wait(lock, [this] {
+        return d->conversionQueue.size() < Private::PIPELINE_QUEUE_LIMIT || d->pipelineFailed;
+    });
+    if (d->pipelineFailed) {
+        d->lastError = d->pipelineError;
+        return false;
+    }
+    d->conversionQueue.push_back(std::move(item));
+    d->framesInFlight++;
+    lock.unlock();
+    d->pipelineCond.notify_all();
+
+    return true;
+}
+
+void VideoWriter::failPipeline(const std::string &message)
+{
+    {
+        std::lock_guard<std::mutex> lock(d->pipelineMutex);
+        if (d->pipelineFailed)
+            return;
+        d->pipelineError = message;
+        d->pipelineFailed = true;
+    }
+    LOG_CRITICAL(d->log, "Video encoding failed: {}", message);
+    d->pipelineCond.notify_all();
+}
+
+void VideoWriter::conversionThreadMain()
+{
+    pthread_setname_np(pthread_self(), "vw_convert");
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(d->pipelineMutex);
+        d->pipelineCond.wait(lock, [this] {
+            return d->pipelineStop || !d->conversionQueue.empty();
+        });
+        if (d->conversionQueue.empty())
+            break;
+        auto item = std::move(d->conversionQueue.front());
+        d->conversionQueue.pop_front();
 
-    // restore frame buffer, so that it can be properly freed in the end
-    if (savedBuf0) {
-        if (d->encFrame != nullptr) {
-            d->encFrame->buf[0] = savedBuf0;
+        AVFrame *frame = nullptr;
+        if (!d->freeFrames.empty()) {
+            frame = d->freeFrames.back();
+            d->freeFrames.pop_back();
+        }
+        lock.unlock();
+        d->pipelineCond.notify_all();
+
+        // if anything went wrong already, we just drop all remaining frames
+        if (d->pipelineFailed) {
+            lock.lock();
+            if (frame != nullptr)
+                d->freeFrames.push_back(frame);
+            d->framesInFlight--;
+            lock.unlock();
+            d->pipelineCond.notify_all();
+            continue;
+        }
+
+        std::string error;
+        if (frame == nullptr)
+            frame = av_frame_alloc();
+        AVBufferRef *buf = av_buffer_pool_get(d->framePool);
+        if (frame == nullptr || buf == nullptr) {
+            error = "Unable to allocate encoder frame.";
         } else {
-            // the frame was already freed (e.g. a failed slice-boundary finalize jumped here);
-            // release the buffer ourselves to avoid leaking it, since av_frame_free() skipped it
-            // (buf[0] had been nulled out above).
-            av_buffer_unref(&savedBuf0);
+            frame->format = d->encPixFormat;
+            frame->width = d->width;
+            frame->height = d->height;
+            frame->buf[0] = buf;
+            av_image_fill_arrays(
+                frame->data,
+                frame->linesize,
+                buf->data,
+                d->encPixFormat,
+                d->width,
+                d->height,
+                ffmpeg_get_buffer_alignment());
+            d->converter->convert(item.mat, frame, error);
+        }
+
+        lock.lock();
+        if (!error.empty()) {
+            if (frame != nullptr) {
+                av_frame_unref(frame);
+                d->freeFrames.push_back(frame);
+            } else if (buf != nullptr) {
+                av_buffer_unref(&buf);
+            }
+            d->framesInFlight--;
+            lock.unlock();
+            failPipeline(error);
+            continue;
         }
+
+        // hand the frame over to the encoder, blocking if it can not keep up
+        d->pipelineCond.wait(lock, [this] {
+            return d->encoderQueue.size() < Private::PIPELINE_QUEUE_LIMIT;
+        });
+        d->encoderQueue.push_back({frame, item.timestamp});
+        lock.unlock();
+        d->pipelineCond.notify_all();
     }
+}
+
+void VideoWriter::encoderThreadMain()
+{
+    pthread_setname_np(pthread_self(), "vw_encode");
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(d->pipelineMutex);
+        d->pipelineCond.wait(lock, [this] {
+            return d->pipelineStop || !d->encoderQueue.empty();
+        });
+        if (d->encoderQueue.empty())
+            break;
+        auto item = d->encoderQueue.front();
+        d->encoderQueue.pop_front();
+        lock.unlock();
+        d->pipelineCond.notify_all();
+
+        if (!d->pipelineFailed) {
+            const auto res = writeFrame(item.frame, item.timestamp);
+            if (!res)
+                failPipeline(res.error());
+        }
+
+        // the encoder holds its own reference to the pooled buffer, if it still needs it
+        av_frame_unref(item.frame);
 
-    return success;
+        lock.lock();
+        d->freeFrames.push_back(item.frame);
+        d->framesInFlight--;
+        lock.unlock();
+        d->pipelineCond.notify_all();
+    }
 }
 
 CodecProperties VideoWriter::codecProps() const
@@ -1518,6 +2097,40 @@ void VideoWriter::setFileSliceInterval(uint minutes)
     d->fileSliceIntervalMin = minutes;
 }
 
+bool VideoWriter::spoolOutput() const
+{
+    return d->spoolOutput;
+}
+
+/**
+ * Write frames to a frame spool file instead of a video.
+ *
+ * Frames are stored uncompressed, without any format conversion, for
+ * later encoding. The codec and container settings are ignored in this
+ * mode. Takes effect on the next initialization of the writer.
+ */
+void VideoWriter::setSpoolOutput(bool enabled)
+{
+    d->spoolOutput = enabled;
+}
+
+int VideoWriter::conversionThreads() const
+{
+    return d->conversionThreads;
+}
+
+/**
+ * Set the number of threads used for pixel format conversion.
+ *
+ * If set to zero (the default), frames are converted and encoded synchronously in
+ * encodeFrame(). Otherwise, the encoding pipeline is used. Takes effect on the next
+ * initialization of the writer.
+ */
+void VideoWriter::setConversionThreads(int count)
+{
+    d->conversionThreads = std::max(count, 0);
+}
+
 std::string VideoWriter::lastError() const
 {
     return d->lastError;
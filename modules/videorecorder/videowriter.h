@@ -29,6 +29,12 @@
 #include "datactl/edlstorage.h"
 #include "datactl/frametype.h"
 
+struct AVFrame;
+namespace Syntalos
+{
+class TimeSyncFileWriter;
+}
+
 using namespace Syntalos;
 
 /**
@@ -143,6 +149,13 @@ private:
 
 QMap<QString, QString> findVideoRenderNodes();
 
+bool openVideoTimestampFile(
+    TimeSyncFileWriter &tsfWriter,
+    const std::string &fname,
+    double fps,
+    const std::string &modName,
+    const Uuid &collectionId);
+
 /**
  * @brief The VideoWriter class
  *
@@ -150,6 +163,10 @@ QMap<QString, QString> findVideoRenderNodes();
  * with a pleasant but very simplified API and all the nasty video encoding
  * issues hidden away.
  * This class intentionally supports only few container/codec formats and options.
+ *
+ * If conversion threads are set, frames are encoded in a pipeline: Pixel format conversion
+ * runs sliced on a small worker pool, while a dedicated thread feeds the encoder and writes
+ * the container, so encodeFrame() only has to queue the image.
  */
 class VideoWriter
 {
@@ -196,6 +213,12 @@ public:
     uint fileSliceInterval() const;
     void setFileSliceInterval(uint minutes);
 
+    bool spoolOutput() const;
+    void setSpoolOutput(bool enabled);
+
+    int conversionThreads() const;
+    void setConversionThreads(int count);
+
     std::string lastError() const;
 
 private:
@@ -207,6 +230,15 @@ private:
     void initializeInternal();
     std::expected<void, std::string> finalizeInternal(bool writeTrailer);
     bool prepareFrame(const cv::Mat &inImage);
+    std::expected<void, std::string> writeFrame(AVFrame *frame, const std::chrono::microseconds &timestamp);
+    std::expected<void, std::string> finishFrame(const std::chrono::microseconds &timestamp);
+
+    void startPipeline();
+    std::expected<void, std::string> stopPipeline();
+    bool enqueueFrame(const cv::Mat &frame, const std::chrono::microseconds &timestamp);
+    void failPipeline(const std::string &message);
+    void conversionThreadMain();
+    void encoderThreadMain();
 };
 
 #endif // VIDEOWRITER_H
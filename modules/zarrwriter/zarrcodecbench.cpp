@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark the Zarr writer's codec chains.
+ *
+ * Usage: zarr-codec-bench [ZARR_ARRAY_DIR]
+ *
+ * If an array directory is given (e.g. the "data" array of an Intan RHX recording
+ * made with the Zarr writer), its chunks are decoded and used as benchmark input.
+ * Only arrays written with the default zstd codec chain can be read.
+ * Without an argument, synthetic Intan-like amplifier data is used.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "zarrv3writer.h"
+
+using namespace Syntalos;
+
+struct BenchInput {
+    ZarrV3Array::DType dtype;
+    int nCols;
+    std::vector<ByteVector> chunks;
+};
+
+static std::expected<BenchInput, QString> loadZarrArray(const QString &arrayDir)
+{
+    QFile metaFile(arrayDir + "/zarr.json");
+    if (!metaFile.open(QIODevice::ReadOnly))
+        return std::unexpected(QStringLiteral("Unable to open %1").arg(metaFile.fileName()));
+    const auto meta = QJsonDocument::fromJson(metaFile.readAll()).object();
+
+    BenchInput input;
+    const auto dtypeStr = meta["data_type"].toString();
+    if (dtypeStr == "int32")
+        input.dtype = ZarrV3Array::DType::Int32;
+    else if (dtypeStr == "uint16")
+        input.dtype = ZarrV3Array::DType::UInt16;
+    else if (dtypeStr == "uint32")
+        input.dtype = ZarrV3Array::DType::UInt32;
+    else if (dtypeStr == "uint64")
+        input.dtype = ZarrV3Array::DType::UInt64;
+    else if (dtypeStr == "float32")
+        input.dtype = ZarrV3Array::DType::Float32;
+    else if (dtypeStr == "float64")
+        input.dtype = ZarrV3Array::DType::Float64;
+    else
+        return std::unexpected(QStringLiteral("Unsupported data type: %1").arg(dtypeStr));
+
+    const auto shape = meta["shape"].toArray();
+    input.nCols = shape.size() > 1 ? shape[1].toInt() : 1;
+
+    const auto shardConf = meta["codecs"].toArray().first().toObject()["configuration"].toObject();
+    for (const auto &codec : shardConf["codecs"].toArray()) {
+        const auto name = codec.toObject()["name"].toString();
+        if (name != "bytes" && name != "zstd")
+            return std::unexpected(QStringLiteral("Unsupported codec in input array: %1").arg(name));
+    }
+
+    const auto innerRows = shardConf["chunk_shape"].toArray().first().toInteger();
+    const auto outerRows = meta["chunk_grid"].toObject()["configuration"].toObject()["chunk_shape"]
+                               .toArray()
+                               .first()
+                               .toInteger();
+    if (innerRows <= 0)
+        return std::unexpected(QStringLiteral("Invalid chunk shape"));
+    const auto nChunks = outerRows / innerRows;
+    const size_t chunkBytes = static_cast<size_t>(innerRows) * input.nCols * zarrDTypeSize(input.dtype);
+
+    QFile shardFile(arrayDir + (input.nCols > 1 ? "/c/0/0" : "/c/0"));
+    if (!shardFile.open(QIODevice::ReadOnly))
+        return std::unexpected(QStringLiteral("Unable to open %1").arg(shardFile.fileName()));
+    const auto shard = shardFile.readAll();
+
+    // the shard index (offset, length pairs) is located at the very end of the shard
+    const auto indexSize = static_cast<qsizetype>(nChunks * 2 * sizeof(uint64_t));
+    if (shard.size() < indexSize)
+        return std::unexpected(QStringLiteral("Shard is truncated"));
+    const auto *index = reinterpret_cast<const uint64_t *>(shard.constData() + shard.size() - indexSize);
+
+    for (int64_t i = 0; i < nChunks; ++i) {
+        const auto offset = index[i * 2];
+        const auto length = index[i * 2 + 1];
+        if (offset + length > static_cast<uint64_t>(shard.size() - indexSize))
+            return std::unexpected(QStringLiteral("Invalid shard index entry for chunk %1").arg(i));
+
+        ByteVector chunk(chunkBytes);
+        const auto dsize = ZSTD_decompress(chunk.data(), chunk.size(), shard.constData() + offset, length);
+        if (ZSTD_isError(dsize) || dsize != chunkBytes)
+            return std::unexpected(QStringLiteral("Failed to decompress chunk %1").arg(i));
+        input.chunks.push_back(std::move(chunk));
+    }
+
+    return input;
+}
+
+static BenchInput createSyntheticIntanData()
+{
+    // 64 amplifier channels at 30 kHz, one chunk per second: raw Intan values
+    // (offset-binary around 32768) with a shared LFP-like oscillation and noise
+    constexpr int nCols = 64;
+    constexpr int rows = 30000;
+    constexpr int nChunks = 10;
+
+    BenchInput input;
+    input.dtype = ZarrV3Array::DType::Int32;
+    input.nCols = nCols;
+
+    std::mt19937 rng(42);
+    std::normal_distribution<double> noise(0.0, 40.0);
+    for (int c = 0; c < nChunks; ++c) {
+        ByteVector chunk(static_cast<size_t>(rows) * nCols * sizeof(int32_t));
+        auto *data = reinterpret_cast<int32_t *>(chunk.data());
+        for (int r = 0; r < rows; ++r) {
+            const double t = static_cast<double>(c * rows + r) / 30000.0;
+            const double lfp = 300.0 * std::sin(2.0 * M_PI * 8.0 * t);
+            for (int ch = 0; ch < nCols; ++ch)
+                data[r * nCols + ch] = static_cast<int32_t>(32768.0 + lfp * (1.0 + ch * 0.01) + noise(rng));
+        }
+        input.chunks.push_back(std::move(chunk));
+    }
+
+    return input;
+}
+
+int main(int argc, char **argv)
+{
+    BenchInput input;
+    if (argc > 1) {
+        auto res = loadZarrArray(QString::fromUtf8(argv[1]));
+        if (!res) {
+            std::cerr << "Unable to load input array: " << res.error().toStdString() << std::endl;
+            return 1;
+        }
+        input = std::move(*res);
+    } else {
+        input = createSyntheticIntanData();
+    }
+
+    if (input.chunks.empty()) {
+        std::cerr << "No data to benchmark with." << std::endl;
+        return 1;
+    }
+
+    const bool isFloat = input.dtype == ZarrV3Array::DType::Float32 || input.dtype == ZarrV3Array::DType::Float64;
+    std::vector<ZarrCodecConfig> configs;
+    for (const auto comp :
+         {ZarrCodecConfig::Compressor::Zstd,
+          ZarrCodecConfig::Compressor::Lz4,
+          ZarrCodecConfig::Compressor::BloscLz4,
+          ZarrCodecConfig::Compressor::BloscZstd}) {
+        for (const bool shuffle : {false, true}) {
+            for (const bool delta : {false, true}) {
+                if (delta && isFloat)
+                    continue;
+                configs.push_back({comp, -1, shuffle, delta});
+            }
+        }
+    }
+    configs.push_back({ZarrCodecConfig::Compressor::Zstd, 1, true, !isFloat});
+    configs.push_back({ZarrCodecConfig::Compressor::Zstd, 9, true, !isFloat});
+
+    size_t rawBytes = 0;
+    for (const auto &chunk : input.chunks)
+        rawBytes += chunk.size();
+    std::cout << std::format(
+        "Input: {} chunk(s), {} column(s), {:.1f} MiB\n\n",
+        input.chunks.size(),
+        input.nCols,
+        rawBytes / (1024.0 * 1024.0));
+    std::cout << std::format(
+        "{:<20} {:>6} {:>8} {:>6} {:>12} {:>8}\n", "Compressor", "Level", "Shuffle", "Delta", "MB/s", "Ratio");
+
+    for (const auto &config : configs) {
+        ZarrChunkEncoder encoder(config, input.dtype, input.nCols);
+        if (auto res = encoder.validate(); !res)
+            continue;
+
+        ByteVector output(encoder.maxEncodedSize(input.chunks.front().size()));
+        size_t encodedBytes = 0;
+        bool failed = false;
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto &chunk : input.chunks) {
+            const auto csize = encoder.encode(chunk.data(), chunk.size(), output.data(), output.size());
+            if (!csize) {
+                std::cerr << csize.error().toStdString() << std::endl;
+                failed = true;
+                break;
+            }
+            encodedBytes += *csize;
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (failed)
+            continue;
+
+        std::cout << std::format(
+            "{:<20} {:>6} {:>8} {:>6} {:>12.1f} {:>8.2f}\n",
+            zarrCompressorToHumanString(config.compressor).toStdString(),
+            config.effectiveLevel(),
+            config.shuffle ? "yes" : "no",
+            config.delta ? "yes" : "no",
+            rawBytes / elapsed / 1.0e6,
+            static_cast<double>(rawBytes) / static_cast<double>(encodedBytes));
+    }
+
+    return 0;
+}
@@ -23,8 +23,15 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <algorithm>
+#include <cstring>
+#include <pthread.h>
+#include <type_traits>
 #include <utility>
 
+#include <blosc.h>
+#include <lz4.h>
+
 using namespace Syntalos;
 
 ZarrV3Array::ZarrV3Array(
@@ -39,8 +46,10 @@ ZarrV3Array::ZarrV3Array(
       m_chunkSize(chunkSize),
       m_nCols(nCols),
       m_dimNames(std::move(dimNames)),
-      m_typeSize(0),
-      m_cctx(nullptr),
+      m_typeSize(zarrDTypeSize(dtype)),
+      m_maxJobsInFlight(0),
+      m_jobsRunning(0),
+      m_stopJobs(false),
       m_shardOffset(0),
       m_totalRows(0),
       m_chunkIdx(0),
@@ -54,27 +63,26 @@ ZarrV3Array::ZarrV3Array(
     // we assume double is 64-bit, so, just make sure the compiler doesn't do weird things
     static_assert(sizeof(double) == 8, "This writer requires 64-bit double for Zarr float64");
     static_assert(std::numeric_limits<double>::is_iec559, "This writer requires IEEE-754 doubles");
+}
 
-    switch (dtype) {
-    case DType::Int32:
-        m_typeSize = sizeof(int32_t);
-        break;
-    case DType::UInt16:
-        m_typeSize = sizeof(uint16_t);
-        break;
-    case DType::UInt32:
-        m_typeSize = sizeof(uint32_t);
-        break;
-    case DType::UInt64:
-        m_typeSize = sizeof(uint64_t);
-        break;
-    case DType::Float32:
-        m_typeSize = sizeof(float);
-        break;
-    case DType::Float64:
-        m_typeSize = sizeof(double);
-        break;
-    }
+ZarrV3Array::~ZarrV3Array()
+{
+    stopCompressionJobs();
+}
+
+void ZarrV3Array::setCompressionPool(std::shared_ptr<ZarrCompressionPool> pool)
+{
+    m_compressionPool = std::move(pool);
+}
+
+void ZarrV3Array::setCodecConfig(const ZarrCodecConfig &config)
+{
+    m_codecConfig = config;
+}
+
+ZarrCodecConfig ZarrV3Array::codecConfig() const
+{
+    return m_codecConfig;
 }
 
 std::expected<void, QString> ZarrV3Array::open()
@@ -92,26 +100,30 @@ std::expected<void, QString> ZarrV3Array::open()
         shardPath = m_arrayDir + "/c/0/0";
     }
 
-    m_shardFile.setFileName(shardPath);
-    if (!m_shardFile.open(QIODevice::WriteOnly))
+    if (auto res = m_shardFile.open(shardPath.toStdString()); !res)
         return std::unexpected(
-            QStringLiteral("Failed to open shard file for writing: ") + shardPath + ": " + m_shardFile.errorString());
+            QStringLiteral("Failed to open shard file for writing: ") + QString::fromStdString(res.error()));
 
-    m_cctx = ZSTD_createCCtx();
-    if (!m_cctx)
-        return std::unexpected(QStringLiteral("Failed to create ZSTD compression context"));
-    ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_compressionLevel, 3);
-    ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_checksumFlag, 1);
+    m_encoder = std::make_unique<ZarrChunkEncoder>(m_codecConfig, m_dtype, m_nCols);
+    if (auto res = m_encoder->validate(); !res) {
+        m_encoder.reset();
+        return std::unexpected(res.error());
+    }
 
-    // Size the reusable ZSTD output buffer once - chunkBytes is constant for the run.
+    // Size the reusable output buffer once - chunkBytes is constant for the run.
     const size_t chunkBytes = static_cast<size_t>(m_chunkSize) * m_nCols * m_typeSize;
-    m_compressedScratch.resize(ZSTD_compressBound(chunkBytes));
+    m_compressedScratch.resize(m_encoder->maxEncodedSize(chunkBytes));
 
     m_chunksSinceMeta = 0;
     m_lastMetaCheckpoint = std::chrono::steady_clock::now();
     m_hasError = false;
     m_errorMessage.clear();
 
+    if (m_compressionPool) {
+        m_stopJobs = false;
+        m_maxJobsInFlight = static_cast<size_t>(m_compressionPool->threadCount()) * 2;
+    }
+
     return {};
 }
 
@@ -130,15 +142,32 @@ void ZarrV3Array::appendBytes(const void *data, int64_t nRows)
     m_buffer.insert(m_buffer.end(), src, src + byteCount);
 
     const int64_t chunkBytes = m_chunkSize * m_nCols * m_typeSize;
-    while ((int64_t)m_buffer.size() >= chunkBytes) {
-        if (!writeChunk(m_buffer.data(), m_chunkSize))
-            return; // setError() already called inside writeChunk on failure
-        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + chunkBytes);
+    int64_t consumed = 0;
+    while ((int64_t)m_buffer.size() - consumed >= chunkBytes) {
+        if (!m_compressionPool) {
+            if (!writeChunk(m_buffer.data() + consumed, m_chunkSize))
+                return; // setError() already called inside writeChunk on failure
+        } else {
+            submitChunk(m_buffer.data() + consumed, m_chunkSize);
+
+            // append everything the workers have finished so far, and throttle
+            // ourselves if the pool can not keep up
+            if (!commitFinishedChunks(m_maxJobsInFlight))
+                return;
+        }
+        consumed += chunkBytes;
     }
+    if (consumed > 0)
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + consumed);
 }
 
 bool ZarrV3Array::finalize()
 {
+    // commit all chunks that are still being compressed before we touch the shard tail
+    if (!m_hasError && m_compressionPool)
+        commitFinishedChunks(0);
+    stopCompressionJobs();
+
     if (m_hasError) {
         // If an earlier write failed, the file cursor may be inside a corrupt region
         // (a partial chunk that never reached its full size) and our in-memory counters
@@ -146,10 +175,7 @@ bool ZarrV3Array::finalize()
         // Tier-A/B checkpoint left - already self-consistent - so the safest thing is
         // to release resources and not touch the file any further.
         m_buffer.clear();
-        if (m_cctx != nullptr) {
-            ZSTD_freeCCtx(m_cctx);
-            m_cctx = nullptr;
-        }
+        m_encoder.reset();
         if (m_shardFile.isOpen())
             m_shardFile.close();
         m_indexBuffer.clear();
@@ -188,22 +214,18 @@ bool ZarrV3Array::finalize()
                 m_chunkIdx = prevChunkIdx;
 
                 if (m_shardFile.isOpen()) {
-                    if (m_shardFile.resize(static_cast<qint64>(prevShardOffset))
-                        && m_shardFile.seek(static_cast<qint64>(prevShardOffset))) {
-                        const qint64 idxWritten = m_shardFile.write(
-                            reinterpret_cast<const char *>(m_indexBuffer.data()),
-                            static_cast<qint64>(m_indexBuffer.size()));
-                        if (idxWritten == static_cast<qint64>(m_indexBuffer.size()))
-                            m_shardFile.flush();
+                    // best effort: this only succeeds if the writer itself has not
+                    // failed yet, otherwise the last checkpoint stays on disk as-is
+                    if (m_shardFile.truncate(prevShardOffset)) {
+                        auto index = m_shardFile.takeBuffer();
+                        index.assign(m_indexBuffer.begin(), m_indexBuffer.end());
+                        m_shardFile.append(std::move(index));
                     }
                     m_shardFile.close();
                 }
 
                 m_buffer.clear();
-                if (m_cctx != nullptr) {
-                    ZSTD_freeCCtx(m_cctx);
-                    m_cctx = nullptr;
-                }
+                m_encoder.reset();
                 m_indexBuffer.clear();
                 return false;
             }
@@ -212,20 +234,16 @@ bool ZarrV3Array::finalize()
     }
 
     m_buffer.clear();
-
-    if (m_cctx != nullptr) {
-        ZSTD_freeCCtx(m_cctx);
-        m_cctx = nullptr;
-    }
+    m_encoder.reset();
 
     // Write the final shard index, then close the file.
     if (m_shardFile.isOpen()) {
-        const qint64 idxWritten = m_shardFile.write(
-            reinterpret_cast<const char *>(m_indexBuffer.data()),
-            static_cast<qint64>(m_indexBuffer.size()));
-        if (idxWritten != static_cast<qint64>(m_indexBuffer.size()))
-            setError(QStringLiteral("Short write of final shard index: ") + m_shardFile.errorString());
-        m_shardFile.close();
+        auto index = m_shardFile.takeBuffer();
+        index.assign(m_indexBuffer.begin(), m_indexBuffer.end());
+        m_shardFile.writeAt(m_shardOffset, std::move(index));
+        if (!m_shardFile.close())
+            setError(
+                QStringLiteral("Failed to write shard file: ") + QString::fromStdString(m_shardFile.lastError()));
     }
     m_indexBuffer.clear();
 
@@ -270,20 +288,31 @@ bool ZarrV3Array::writeChunk(const void *data, int64_t nRows)
     }
 
     const size_t srcSize = static_cast<size_t>(nRows) * m_nCols * m_typeSize;
-    const size_t csize = ZSTD_compress2(m_cctx, m_compressedScratch.data(), m_compressedScratch.size(), data, srcSize);
-    if (ZSTD_isError(csize)) {
-        setError(QStringLiteral("ZSTD compression failed: ") + QString::fromUtf8(ZSTD_getErrorName(csize)));
+    const auto csize = m_encoder->encode(
+        static_cast<const std::byte *>(data), srcSize, m_compressedScratch.data(), m_compressedScratch.size());
+    if (!csize.has_value()) {
+        setError(csize.error());
         return false;
     }
 
-    // Write compressed data first
-    const qint64 written = m_shardFile.write(
-        reinterpret_cast<const char *>(m_compressedScratch.data()),
-        static_cast<qint64>(csize));
-    if (written != static_cast<qint64>(csize)) {
+    return commitChunk(m_compressedScratch.data(), *csize, nRows);
+}
+
+bool ZarrV3Array::commitChunk(const std::byte *cdata, size_t csize, int64_t nRows)
+{
+    if (!m_shardFile.isOpen()) {
+        setError(QStringLiteral("commitChunk called with shard file closed"));
+        return false;
+    }
+
+    // Write compressed data first. The write completes in the background, failures
+    // of earlier writes are reported here.
+    auto chunk = m_shardFile.takeBuffer();
+    chunk.assign(cdata, cdata + csize);
+    if (!m_shardFile.append(std::move(chunk))) {
         setError(
-            QStringLiteral("Short write to shard file (%1 of %2 bytes): ").arg(written).arg(csize)
-            + m_shardFile.errorString());
+            QStringLiteral("Failed to write %1 bytes to shard file: ").arg(csize)
+            + QString::fromStdString(m_shardFile.lastError()));
         return false;
     }
 
@@ -303,26 +332,139 @@ bool ZarrV3Array::writeChunk(const void *data, int64_t nRows)
     return !m_hasError;
 }
 
+void ZarrV3Array::stopCompressionJobs()
+{
+    if (!m_compressionPool)
+        return;
+
+    {
+        // jobs not yet picked up by a worker are discarded, but we must wait for all of them
+        // to be released, as they reference this array
+        std::unique_lock<std::mutex> lock(m_jobMutex);
+        m_stopJobs = true;
+        m_doneCond.wait(lock, [this] {
+            return m_jobsRunning == 0;
+        });
+    }
+
+    m_pendingJobs.clear();
+    m_freeJobs.clear();
+    m_idleEncoders.clear();
+    m_compressionPool.reset();
+}
+
+void ZarrV3Array::compressJob(CompressJob &job)
+{
+    std::unique_ptr<ZarrChunkEncoder> encoder;
+    bool discard;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        discard = m_stopJobs;
+        if (!discard && !m_idleEncoders.empty()) {
+            encoder = std::move(m_idleEncoders.back());
+            m_idleEncoders.pop_back();
+        }
+    }
+
+    if (!discard) {
+        if (!encoder)
+            encoder = std::make_unique<ZarrChunkEncoder>(m_codecConfig, m_dtype, m_nCols);
+
+        const auto csize = encoder->encode(
+            job.raw.data(), job.raw.size(), job.compressed.data(), job.compressed.size());
+        if (csize.has_value())
+            job.csize = *csize;
+        else
+            job.error = csize.error();
+    }
+
+    // notify while holding the lock, the array may be destroyed as soon as it is released
+    std::lock_guard<std::mutex> lock(m_jobMutex);
+    job.done = true;
+    if (encoder)
+        m_idleEncoders.push_back(std::move(encoder));
+    m_jobsRunning--;
+    m_doneCond.notify_all();
+}
+
+void ZarrV3Array::submitChunk(const std::byte *data, int64_t nRows)
+{
+    const size_t srcSize = static_cast<size_t>(nRows) * m_nCols * m_typeSize;
+
+    std::shared_ptr<CompressJob> job;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (!m_freeJobs.empty()) {
+            job = std::move(m_freeJobs.back());
+            m_freeJobs.pop_back();
+        }
+    }
+    if (!job) {
+        job = std::make_shared<CompressJob>();
+        job->compressed.resize(m_compressedScratch.size());
+    }
+
+    job->nRows = nRows;
+    job->raw.assign(data, data + srcSize);
+    job->csize = 0;
+    job->done = false;
+    job->error.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_pendingJobs.push_back(job);
+        m_jobsRunning++;
+    }
+    m_compressionPool->submit([this, job = std::move(job)]() {
+        compressJob(*job);
+    });
+}
+
+bool ZarrV3Array::commitFinishedChunks(size_t maxPending)
+{
+    // Chunks are committed strictly in submission order, so the shard layout and
+    // the Tier-A/Tier-B checkpoints are identical to synchronous compression.
+    for (;;) {
+        std::shared_ptr<CompressJob> job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            if (m_pendingJobs.empty())
+                return !m_hasError;
+            if (m_pendingJobs.size() > maxPending)
+                m_doneCond.wait(lock, [this] {
+                    return m_pendingJobs.front()->done;
+                });
+            else if (!m_pendingJobs.front()->done)
+                return !m_hasError;
+
+            job = std::move(m_pendingJobs.front());
+            m_pendingJobs.pop_front();
+        }
+
+        if (!job->error.isEmpty()) {
+            setError(job->error);
+            return false;
+        }
+        if (!commitChunk(job->compressed.data(), job->csize, job->nRows))
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_freeJobs.push_back(std::move(job));
+    }
+}
+
 void ZarrV3Array::writeCheckpoint()
 {
     // Tier A: write the current shard index immediately after the compressed
-    // data so the shard is always self-consistent on disk. We then seek back
-    // to m_shardOffset so the cursor invariant holds.
+    // data so the shard is always self-consistent on disk. The next chunk is
+    // appended at m_shardOffset again and overwrites it; the writer executes
+    // operations in order, so this is safe even while they are still in flight.
     if (m_shardFile.isOpen()) {
-        if (!m_shardFile.seek(static_cast<qint64>(m_shardOffset))) {
-            setError(QStringLiteral("Failed to seek shard file for index write: ") + m_shardFile.errorString());
-            return;
-        }
-        const qint64 idxWritten = m_shardFile.write(
-            reinterpret_cast<const char *>(m_indexBuffer.data()),
-            static_cast<qint64>(m_indexBuffer.size()));
-        if (idxWritten != static_cast<qint64>(m_indexBuffer.size())) {
-            setError(QStringLiteral("Invalid amount of bytes written to shard index: ") + m_shardFile.errorString());
-            return;
-        }
-        m_shardFile.flush();
-        if (!m_shardFile.seek(static_cast<qint64>(m_shardOffset))) {
-            setError(QStringLiteral("Failed to restore shard cursor after checkpoint: ") + m_shardFile.errorString());
+        auto index = m_shardFile.takeBuffer();
+        index.assign(m_indexBuffer.begin(), m_indexBuffer.end());
+        if (!m_shardFile.writeAt(m_shardOffset, std::move(index))) {
+            setError(
+                QStringLiteral("Failed to write shard index: ") + QString::fromStdString(m_shardFile.lastError()));
             return;
         }
     }
@@ -415,24 +557,15 @@ bool ZarrV3Array::writeMetadata()
     if (m_nCols > 1)
         innerChunkShape.append(static_cast<qint64>(m_nCols));
 
-    // Codec chain for each inner chunk: bytes (little-endian, C-order) -> zstd
+    // Codec chain for each inner chunk: [transpose -> delta] -> bytes (little-endian) -> [shuffle] -> compressor
+    QJsonArray innerCodecs = ZarrChunkEncoder(m_codecConfig, m_dtype, m_nCols).codecMetadata();
+
     QJsonObject bytesConf;
     bytesConf["endian"] = QStringLiteral("little");
     QJsonObject bytesCodec;
     bytesCodec["name"] = QStringLiteral("bytes");
     bytesCodec["configuration"] = bytesConf;
 
-    QJsonObject zstdConf;
-    zstdConf["level"] = 3;
-    zstdConf["checksum"] = true;
-    QJsonObject zstdCodec;
-    zstdCodec["name"] = QStringLiteral("zstd");
-    zstdCodec["configuration"] = zstdConf;
-
-    QJsonArray innerCodecs;
-    innerCodecs.append(bytesCodec);
-    innerCodecs.append(zstdCodec);
-
     // Index codec: raw little-endian bytes (no additional transformation)
     QJsonArray indexCodecs;
     indexCodecs.append(bytesCodec);
@@ -472,6 +605,417 @@ bool ZarrV3Array::writeMetadata()
     return true;
 }
 
+ZarrCompressionPool::ZarrCompressionPool(int threadCount)
+    : m_stop(false)
+{
+    const auto count = std::max(threadCount, 1);
+    m_workers.reserve(count);
+    for (int i = 0; i < count; ++i)
+        m_workers.emplace_back(&ZarrCompressionPool::workerMain, this);
+}
+
+ZarrCompressionPool::~ZarrCompressionPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+
+    for (auto &worker : m_workers)
+        worker.join();
+}
+
+std::shared_ptr<ZarrCompressionPool> ZarrCompressionPool::shared(int threadCount)
+{
+    static std::mutex mutex;
+    static std::weak_ptr<ZarrCompressionPool> sharedPool;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto pool = sharedPool.lock();
+    if (!pool) {
+        pool = std::make_shared<ZarrCompressionPool>(threadCount);
+        sharedPool = pool;
+    }
+
+    return pool;
+}
+
+int ZarrCompressionPool::threadCount() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+void ZarrCompressionPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cond.notify_one();
+}
+
+void ZarrCompressionPool::workerMain()
+{
+    pthread_setname_np(pthread_self(), "zarr-compress");
+
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] {
+                return m_stop || !m_tasks.empty();
+            });
+            if (m_tasks.empty())
+                break;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+int zarrDTypeSize(ZarrV3Array::DType dtype)
+{
+    switch (dtype) {
+    case ZarrV3Array::DType::Int32:
+        return sizeof(int32_t);
+    case ZarrV3Array::DType::UInt16:
+        return sizeof(uint16_t);
+    case ZarrV3Array::DType::UInt32:
+        return sizeof(uint32_t);
+    case ZarrV3Array::DType::UInt64:
+        return sizeof(uint64_t);
+    case ZarrV3Array::DType::Float32:
+        return sizeof(float);
+    case ZarrV3Array::DType::Float64:
+        return sizeof(double);
+    }
+
+    return 0;
+}
+
+int ZarrCodecConfig::effectiveLevel() const
+{
+    switch (compressor) {
+    case Compressor::Zstd:
+        return std::clamp(level < 0 ? 3 : level, 1, ZSTD_maxCLevel());
+    case Compressor::Lz4:
+        // the "level" is the LZ4 acceleration factor, higher is faster
+        return std::clamp(level < 1 ? 1 : level, 1, 65537);
+    case Compressor::BloscLz4:
+    case Compressor::BloscZstd:
+        return std::clamp(level < 0 ? 5 : level, 0, 9);
+    }
+
+    return level;
+}
+
+QString zarrCompressorToString(ZarrCodecConfig::Compressor compressor)
+{
+    switch (compressor) {
+    case ZarrCodecConfig::Compressor::Zstd:
+        return QStringLiteral("zstd");
+    case ZarrCodecConfig::Compressor::Lz4:
+        return QStringLiteral("lz4");
+    case ZarrCodecConfig::Compressor::BloscLz4:
+        return QStringLiteral("blosc-lz4");
+    case ZarrCodecConfig::Compressor::BloscZstd:
+        return QStringLiteral("blosc-zstd");
+    }
+
+    return QStringLiteral("zstd");
+}
+
+ZarrCodecConfig::Compressor zarrCompressorFromString(const QString &str)
+{
+    if (str == QStringLiteral("lz4"))
+        return ZarrCodecConfig::Compressor::Lz4;
+    if (str == QStringLiteral("blosc-lz4"))
+        return ZarrCodecConfig::Compressor::BloscLz4;
+    if (str == QStringLiteral("blosc-zstd"))
+        return ZarrCodecConfig::Compressor::BloscZstd;
+    return ZarrCodecConfig::Compressor::Zstd;
+}
+
+QString zarrCompressorToHumanString(ZarrCodecConfig::Compressor compressor)
+{
+    switch (compressor) {
+    case ZarrCodecConfig::Compressor::Zstd:
+        return QStringLiteral("Zstandard");
+    case ZarrCodecConfig::Compressor::Lz4:
+        return QStringLiteral("LZ4");
+    case ZarrCodecConfig::Compressor::BloscLz4:
+        return QStringLiteral("Blosc (LZ4)");
+    case ZarrCodecConfig::Compressor::BloscZstd:
+        return QStringLiteral("Blosc (Zstandard)");
+    }
+
+    return zarrCompressorToString(compressor);
+}
+
+/**
+ * Store each channel of a row-major [rows, nCols] chunk contiguously (i.e. transposed)
+ * as differences between consecutive values. This matches a "transpose" codec followed
+ * by "numcodecs.delta" on the flattened result; the arithmetic wraps like NumPy's does.
+ */
+template<typename T>
+static void deltaEncodeChannels(const std::byte *src, std::byte *dst, int64_t rows, int nCols)
+{
+    using U = std::make_unsigned_t<T>;
+    const auto *in = reinterpret_cast<const U *>(src);
+    auto *out = reinterpret_cast<U *>(dst);
+
+    U prev = 0;
+    for (int c = 0; c < nCols; ++c) {
+        auto *outCol = out + static_cast<size_t>(c) * rows;
+        for (int64_t r = 0; r < rows; ++r) {
+            const U value = in[r * nCols + c];
+            outCol[r] = static_cast<U>(value - prev);
+            prev = value;
+        }
+    }
+}
+
+/**
+ * Group the n-th bytes of all elements together, like "numcodecs.shuffle".
+ */
+static void byteShuffle(const std::byte *src, std::byte *dst, size_t size, int elementSize)
+{
+    const size_t count = size / elementSize;
+    for (size_t i = 0; i < count; ++i) {
+        const auto *elem = src + i * elementSize;
+        for (int b = 0; b < elementSize; ++b)
+            dst[b * count + i] = elem[b];
+    }
+
+    // trailing bytes that do not form a full element are kept as-is
+    const size_t tail = count * elementSize;
+    if (tail < size)
+        std::memcpy(dst + tail, src + tail, size - tail);
+}
+
+static bool isBloscCompressor(ZarrCodecConfig::Compressor compressor)
+{
+    return compressor == ZarrCodecConfig::Compressor::BloscLz4 || compressor == ZarrCodecConfig::Compressor::BloscZstd;
+}
+
+ZarrChunkEncoder::ZarrChunkEncoder(const ZarrCodecConfig &config, ZarrV3Array::DType dtype, int nCols)
+    : m_config(config),
+      m_dtype(dtype),
+      m_nCols(nCols),
+      m_typeSize(zarrDTypeSize(dtype)),
+      m_cctx(nullptr)
+{
+}
+
+ZarrChunkEncoder::~ZarrChunkEncoder()
+{
+    if (m_cctx != nullptr)
+        ZSTD_freeCCtx(m_cctx);
+}
+
+std::expected<void, QString> ZarrChunkEncoder::validate() const
+{
+    if (m_config.delta && (m_dtype == ZarrV3Array::DType::Float32 || m_dtype == ZarrV3Array::DType::Float64))
+        return std::unexpected(QStringLiteral("Delta filtering is only supported for integer data"));
+    return {};
+}
+
+size_t ZarrChunkEncoder::maxEncodedSize(size_t srcSize) const
+{
+    switch (m_config.compressor) {
+    case ZarrCodecConfig::Compressor::Zstd:
+        return ZSTD_compressBound(srcSize);
+    case ZarrCodecConfig::Compressor::Lz4:
+        return sizeof(uint32_t) + static_cast<size_t>(LZ4_compressBound(static_cast<int>(srcSize)));
+    case ZarrCodecConfig::Compressor::BloscLz4:
+    case ZarrCodecConfig::Compressor::BloscZstd:
+        return srcSize + BLOSC_MAX_OVERHEAD;
+    }
+
+    return srcSize;
+}
+
+std::expected<size_t, QString> ZarrChunkEncoder::encode(
+    const std::byte *src,
+    size_t srcSize,
+    std::byte *dst,
+    size_t dstCapacity)
+{
+    const std::byte *data = src;
+
+    if (m_config.delta) {
+        m_deltaBuffer.resize(srcSize);
+        const auto rows = static_cast<int64_t>(srcSize / (static_cast<size_t>(m_typeSize) * m_nCols));
+        switch (m_dtype) {
+        case ZarrV3Array::DType::Int32:
+            deltaEncodeChannels<int32_t>(data, m_deltaBuffer.data(), rows, m_nCols);
+            break;
+        case ZarrV3Array::DType::UInt16:
+            deltaEncodeChannels<uint16_t>(data, m_deltaBuffer.data(), rows, m_nCols);
+            break;
+        case ZarrV3Array::DType::UInt32:
+            deltaEncodeChannels<uint32_t>(data, m_deltaBuffer.data(), rows, m_nCols);
+            break;
+        case ZarrV3Array::DType::UInt64:
+            deltaEncodeChannels<uint64_t>(data, m_deltaBuffer.data(), rows, m_nCols);
+            break;
+        default:
+            return std::unexpected(QStringLiteral("Delta filtering is only supported for integer data"));
+        }
+        data = m_deltaBuffer.data();
+    }
+
+    // Blosc shuffles internally, as part of its own frame
+    if (m_config.shuffle && !isBloscCompressor(m_config.compressor)) {
+        m_shuffleBuffer.resize(srcSize);
+        byteShuffle(data, m_shuffleBuffer.data(), srcSize, m_typeSize);
+        data = m_shuffleBuffer.data();
+    }
+
+    const int level = m_config.effectiveLevel();
+    switch (m_config.compressor) {
+    case ZarrCodecConfig::Compressor::Zstd: {
+        if (m_cctx == nullptr) {
+            m_cctx = ZSTD_createCCtx();
+            if (m_cctx == nullptr)
+                return std::unexpected(QStringLiteral("Failed to create ZSTD compression context"));
+            ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_compressionLevel, level);
+            ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_checksumFlag, 1);
+        }
+
+        const size_t csize = ZSTD_compress2(m_cctx, dst, dstCapacity, data, srcSize);
+        if (ZSTD_isError(csize))
+            return std::unexpected(
+                QStringLiteral("ZSTD compression failed: ") + QString::fromUtf8(ZSTD_getErrorName(csize)));
+        return csize;
+    }
+    case ZarrCodecConfig::Compressor::Lz4: {
+        // numcodecs' LZ4 framing: uncompressed size as little-endian uint32, then the raw LZ4 block
+        if (srcSize > LZ4_MAX_INPUT_SIZE || dstCapacity < sizeof(uint32_t))
+            return std::unexpected(QStringLiteral("Chunk is too large for LZ4 compression"));
+        const auto srcSize32 = static_cast<uint32_t>(srcSize);
+        std::memcpy(dst, &srcSize32, sizeof(srcSize32));
+
+        const int csize = LZ4_compress_fast(
+            reinterpret_cast<const char *>(data),
+            reinterpret_cast<char *>(dst + sizeof(uint32_t)),
+            static_cast<int>(srcSize),
+            static_cast<int>(dstCapacity - sizeof(uint32_t)),
+            level);
+        if (csize <= 0)
+            return std::unexpected(QStringLiteral("LZ4 compression failed"));
+        return sizeof(uint32_t) + static_cast<size_t>(csize);
+    }
+    case ZarrCodecConfig::Compressor::BloscLz4:
+    case ZarrCodecConfig::Compressor::BloscZstd: {
+        const int csize = blosc_compress_ctx(
+            level,
+            m_config.shuffle ? BLOSC_SHUFFLE : BLOSC_NOSHUFFLE,
+            static_cast<size_t>(m_typeSize),
+            srcSize,
+            data,
+            dst,
+            dstCapacity,
+            m_config.compressor == ZarrCodecConfig::Compressor::BloscLz4 ? "lz4" : "zstd",
+            0,
+            1);
+        if (csize <= 0)
+            return std::unexpected(QStringLiteral("Blosc compression failed (code %1)").arg(csize));
+        return static_cast<size_t>(csize);
+    }
+    }
+
+    return std::unexpected(QStringLiteral("Unknown compressor selected"));
+}
+
+QJsonArray ZarrChunkEncoder::codecMetadata() const
+{
+    QJsonArray codecs;
+
+    if (m_config.delta) {
+        // delta runs along the time axis of each channel, so channels are stored contiguously first
+        if (m_nCols > 1) {
+            QJsonObject transposeConf;
+            transposeConf["order"] = QJsonArray{1, 0};
+            QJsonObject transposeCodec;
+            transposeCodec["name"] = QStringLiteral("transpose");
+            transposeCodec["configuration"] = transposeConf;
+            codecs.append(transposeCodec);
+        }
+
+        QString deltaDType;
+        switch (m_dtype) {
+        case ZarrV3Array::DType::Int32:
+            deltaDType = QStringLiteral("<i4");
+            break;
+        case ZarrV3Array::DType::UInt16:
+            deltaDType = QStringLiteral("<u2");
+            break;
+        case ZarrV3Array::DType::UInt32:
+            deltaDType = QStringLiteral("<u4");
+            break;
+        case ZarrV3Array::DType::UInt64:
+            deltaDType = QStringLiteral("<u8");
+            break;
+        default:
+            break;
+        }
+        QJsonObject deltaConf;
+        deltaConf["dtype"] = deltaDType;
+        QJsonObject deltaCodec;
+        deltaCodec["name"] = QStringLiteral("numcodecs.delta");
+        deltaCodec["configuration"] = deltaConf;
+        codecs.append(deltaCodec);
+    }
+
+    QJsonObject bytesConf;
+    bytesConf["endian"] = QStringLiteral("little");
+    QJsonObject bytesCodec;
+    bytesCodec["name"] = QStringLiteral("bytes");
+    bytesCodec["configuration"] = bytesConf;
+    codecs.append(bytesCodec);
+
+    if (m_config.shuffle && !isBloscCompressor(m_config.compressor)) {
+        QJsonObject shuffleConf;
+        shuffleConf["elementsize"] = m_typeSize;
+        QJsonObject shuffleCodec;
+        shuffleCodec["name"] = QStringLiteral("numcodecs.shuffle");
+        shuffleCodec["configuration"] = shuffleConf;
+        codecs.append(shuffleCodec);
+    }
+
+    QJsonObject compConf;
+    QJsonObject compCodec;
+    switch (m_config.compressor) {
+    case ZarrCodecConfig::Compressor::Zstd:
+        compConf["level"] = m_config.effectiveLevel();
+        compConf["checksum"] = true;
+        compCodec["name"] = QStringLiteral("zstd");
+        break;
+    case ZarrCodecConfig::Compressor::Lz4:
+        compConf["acceleration"] = m_config.effectiveLevel();
+        compCodec["name"] = QStringLiteral("numcodecs.lz4");
+        break;
+    case ZarrCodecConfig::Compressor::BloscLz4:
+    case ZarrCodecConfig::Compressor::BloscZstd:
+        compConf["cname"] = m_config.compressor == ZarrCodecConfig::Compressor::BloscLz4 ? QStringLiteral("lz4")
+                                                                                          : QStringLiteral("zstd");
+        compConf["clevel"] = m_config.effectiveLevel();
+        compConf["shuffle"] = m_config.shuffle ? QStringLiteral("shuffle") : QStringLiteral("noshuffle");
+        compConf["typesize"] = m_typeSize;
+        compConf["blocksize"] = 0;
+        compCodec["name"] = QStringLiteral("blosc");
+        break;
+    }
+    compCodec["configuration"] = compConf;
+    codecs.append(compCodec);
+
+    return codecs;
+}
+
 bool zarrWriteRootGroupMetadata(const fs::path &storePath)
 {
     std::error_code ec;
@@ -20,10 +20,18 @@
 #pragma once
 
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <QFile>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QString>
 #include <QStringList>
@@ -32,9 +40,81 @@
 #include <zstd.h>
 
 #include "datactl/binarystream.h"
+#include "datactl/priv/asyncio.h"
 
 namespace fs = std::filesystem;
 
+class ZarrChunkEncoder;
+
+/**
+ * @brief Codec chain settings for the inner chunks of a Zarr array.
+ *
+ * Chunks are always serialized as little-endian bytes, then optionally
+ * filtered (delta, byte-shuffle) and finally compressed. The resulting
+ * chain is declared in the array's zarr.json.
+ */
+struct ZarrCodecConfig {
+    enum class Compressor {
+        Zstd,
+        Lz4,
+        BloscLz4,
+        BloscZstd
+    };
+
+    Compressor compressor{Compressor::Zstd};
+    int level{-1};      /// Compression level (acceleration for LZ4), -1 selects the compressor's default
+    bool shuffle{false}; /// Byte-shuffle elements before compression
+    bool delta{false};   /// Store differences between consecutive samples of each channel (integer data only)
+
+    /**
+     * The level that will actually be used, with defaults resolved and
+     * the value clamped to what the compressor supports.
+     */
+    [[nodiscard]] int effectiveLevel() const;
+};
+
+/**
+ * @brief Worker threads compressing chunks for any number of Zarr arrays.
+ *
+ * All arrays written in a run share one pool (see shared()), so adding more
+ * arrays or writer modules does not add more compression threads.
+ */
+class ZarrCompressionPool
+{
+public:
+    explicit ZarrCompressionPool(int threadCount);
+    ~ZarrCompressionPool();
+
+    ZarrCompressionPool(const ZarrCompressionPool &) = delete;
+    ZarrCompressionPool &operator=(const ZarrCompressionPool &) = delete;
+
+    /**
+     * Get the pool shared by all Zarr writers, creating it with @p threadCount
+     * workers if no writer is using one at the moment.
+     */
+    static std::shared_ptr<ZarrCompressionPool> shared(int threadCount);
+
+    [[nodiscard]] int threadCount() const;
+
+    /**
+     * Run @p task on one of the worker threads.
+     */
+    void submit(std::function<void()> task);
+
+private:
+    void workerMain();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stop;
+};
+
+QString zarrCompressorToString(ZarrCodecConfig::Compressor compressor);
+ZarrCodecConfig::Compressor zarrCompressorFromString(const QString &str);
+QString zarrCompressorToHumanString(ZarrCodecConfig::Compressor compressor);
+
 /**
  * @brief Incrementally write a single Zarr v3 array to a filesystem store.
  *
@@ -45,6 +125,10 @@ namespace fs = std::filesystem;
  * On I/O failure the array enters a sticky error state (hasError() / errorMessage());
  * subsequent appendBytes() calls become no-ops so the caller can detect the
  * failure and propagate it.
+ *
+ * Inner chunks can optionally be compressed on a ZarrCompressionPool (see
+ * setCompressionPool()). Compressed chunks are still appended to the shard and
+ * checkpointed strictly in order, on the thread calling appendBytes().
  */
 class ZarrV3Array
 {
@@ -65,6 +149,24 @@ public:
         int64_t chunkSize,
         int nCols,
         QStringList dimNames = {});
+    ~ZarrV3Array();
+
+    ZarrV3Array(const ZarrV3Array &) = delete;
+    ZarrV3Array &operator=(const ZarrV3Array &) = delete;
+
+    /**
+     * Set the pool used to compress chunks concurrently.
+     * Without a pool, chunks are compressed synchronously in appendBytes().
+     * Must be called before open().
+     */
+    void setCompressionPool(std::shared_ptr<ZarrCompressionPool> pool);
+
+    /**
+     * Select the codec chain used for the inner chunks.
+     * Must be called before open().
+     */
+    void setCodecConfig(const ZarrCodecConfig &config);
+    [[nodiscard]] ZarrCodecConfig codecConfig() const;
 
     /**
      * Create the on-disk directory layout and open the shard file for writing.
@@ -98,11 +200,26 @@ public:
     [[nodiscard]] QString errorMessage() const;
 
 private:
+    struct CompressJob {
+        int64_t nRows = 0;
+        Syntalos::ByteVector raw;
+        Syntalos::ByteVector compressed;
+        size_t csize = 0;
+        bool done = false;
+        QString error;
+    };
+
     bool writeChunk(const void *data, int64_t nRows);
+    bool commitChunk(const std::byte *cdata, size_t csize, int64_t nRows);
     bool writeMetadata();
     void writeCheckpoint();
     void setError(const QString &msg);
 
+    void stopCompressionJobs();
+    void compressJob(CompressJob &job);
+    void submitChunk(const std::byte *data, int64_t nRows);
+    bool commitFinishedChunks(size_t maxPending);
+
     // Checkpoints so we don't lose Zarr data in a crash (of course, Syntalos never crashes,
     // but just in case...): Tier-A (index flush): every chunk. Tier-B (zarr.json rewrite):
     // every kJsonCheckpointEveryChunks chunks OR kJsonCheckpointEverySecs seconds.
@@ -116,13 +233,28 @@ private:
     QStringList m_dimNames;
     int m_typeSize;
 
-    // Shard file kept open for the entire write lifecycle.
+    // Shard file kept open for the entire write lifecycle, written asynchronously.
     // 1-D arrays: <arrayDir>/c/0
     // 2-D arrays: <arrayDir>/c/0/0
-    QFile m_shardFile;
+    Syntalos::AsyncFileWriter m_shardFile;
 
-    // ZSTD compression context
-    ZSTD_CCtx *m_cctx;
+    // Codec chain for chunks compressed on the appending thread
+    ZarrCodecConfig m_codecConfig;
+    std::unique_ptr<ZarrChunkEncoder> m_encoder;
+
+    // Shared compression pool. Jobs are committed in submission order from m_pendingJobs,
+    // m_jobsRunning counts the jobs a pool worker may still touch. Committed jobs are
+    // recycled via m_freeJobs to keep their buffers allocated, and encoders via m_idleEncoders,
+    // as compression contexts must not be used by two workers at once.
+    std::shared_ptr<ZarrCompressionPool> m_compressionPool;
+    size_t m_maxJobsInFlight;
+    std::mutex m_jobMutex;
+    std::condition_variable m_doneCond;
+    std::deque<std::shared_ptr<CompressJob>> m_pendingJobs;
+    std::vector<std::shared_ptr<CompressJob>> m_freeJobs;
+    std::vector<std::unique_ptr<ZarrChunkEncoder>> m_idleEncoders;
+    size_t m_jobsRunning;
+    bool m_stopJobs;
 
     // Shard index: one (byte_offset, byte_length) pair per inner chunk
     // stored as raw little-endian uint64_t pairs. Written incrementally after
@@ -140,8 +272,8 @@ private:
     int64_t m_chunksSinceMeta;
     std::chrono::steady_clock::time_point m_lastMetaCheckpoint;
 
-    // Reusable destination buffer for ZSTD output, sized once in open() to
-    // ZSTD_compressBound(chunkBytes). Avoids per-chunk malloc/free churn.
+    // Reusable destination buffer for compressed output, sized once in open() to
+    // the encoder's worst-case output size. Avoids per-chunk malloc/free churn.
     Syntalos::ByteVector m_compressedScratch;
 
     bool m_hasError;
@@ -150,6 +282,59 @@ private:
     QJsonObject m_attributes;
 };
 
+/**
+ * @brief Encode inner chunks of a Zarr array with a given codec chain.
+ *
+ * Instances keep their own compression contexts and scratch buffers, so
+ * each thread compressing chunks needs its own encoder.
+ */
+class ZarrChunkEncoder
+{
+public:
+    ZarrChunkEncoder(const ZarrCodecConfig &config, ZarrV3Array::DType dtype, int nCols);
+    ~ZarrChunkEncoder();
+
+    ZarrChunkEncoder(const ZarrChunkEncoder &) = delete;
+    ZarrChunkEncoder &operator=(const ZarrChunkEncoder &) = delete;
+
+    /**
+     * Check whether the codec chain can be used for this array.
+     */
+    [[nodiscard]] std::expected<void, QString> validate() const;
+
+    /**
+     * Worst-case size of an encoded chunk of @p srcSize bytes.
+     */
+    [[nodiscard]] size_t maxEncodedSize(size_t srcSize) const;
+
+    /**
+     * Encode a complete chunk of @p srcSize row-major bytes into @p dst, which must
+     * hold at least maxEncodedSize() bytes. Returns the encoded size.
+     */
+    std::expected<size_t, QString> encode(const std::byte *src, size_t srcSize, std::byte *dst, size_t dstCapacity);
+
+    /**
+     * The codec chain as Zarr v3 codec metadata, starting with the array-to-array codecs.
+     */
+    [[nodiscard]] QJsonArray codecMetadata() const;
+
+private:
+    ZarrCodecConfig m_config;
+    ZarrV3Array::DType m_dtype;
+    int m_nCols;
+    int m_typeSize;
+
+    ZSTD_CCtx *m_cctx; // created on first use
+
+    Syntalos::ByteVector m_deltaBuffer;
+    Syntalos::ByteVector m_shuffleBuffer;
+};
+
+/**
+ * @brief Size of a single element of @p dtype in bytes.
+ */
+int zarrDTypeSize(ZarrV3Array::DType dtype);
+
 /**
  * @brief Write the Zarr v3 root group metadata file (zarr.json) into @p storePath.
  *
@@ -22,8 +22,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include <QCheckBox>
+#include <QComboBox>
 #include <QDialog>
 #include <QFormLayout>
 #include <QGroupBox>
@@ -32,6 +34,7 @@
 #include <QJsonObject>
 #include <QLineEdit>
 #include <QDialogButtonBox>
+#include <QSpinBox>
 #include <QUuid>
 
 #include <Eigen/Core>
@@ -104,6 +107,40 @@ public:
         nameLayout->addRow(QStringLiteral("Dataset name:"), m_nameEdit);
 
         layout->addWidget(nameGroup);
+
+        auto codecGroup = new QGroupBox(QStringLiteral("Compression"), this);
+        auto codecLayout = new QFormLayout(codecGroup);
+        codecLayout->setContentsMargins(4, 4, 4, 4);
+
+        m_compressorComboBox = new QComboBox(this);
+        for (const auto comp :
+             {ZarrCodecConfig::Compressor::Zstd,
+              ZarrCodecConfig::Compressor::Lz4,
+              ZarrCodecConfig::Compressor::BloscLz4,
+              ZarrCodecConfig::Compressor::BloscZstd})
+            m_compressorComboBox->addItem(
+                zarrCompressorToHumanString(comp), QVariant::fromValue(static_cast<int>(comp)));
+        codecLayout->addRow(QStringLiteral("Compressor:"), m_compressorComboBox);
+
+        m_levelSpinBox = new QSpinBox(this);
+        m_levelSpinBox->setRange(-1, 22);
+        m_levelSpinBox->setValue(-1);
+        m_levelSpinBox->setSpecialValueText(QStringLiteral("Default"));
+        m_levelSpinBox->setToolTip(
+            QStringLiteral("Compression level. For LZ4 this is the acceleration factor, higher values are faster."));
+        codecLayout->addRow(QStringLiteral("Level:"), m_levelSpinBox);
+
+        m_cbShuffle = new QCheckBox(QStringLiteral("Byte-shuffle samples"), this);
+        m_cbShuffle->setToolTip(QStringLiteral("Group bytes of equal significance before compression."));
+        codecLayout->addRow(m_cbShuffle);
+
+        m_cbDelta = new QCheckBox(QStringLiteral("Delta-encode integer samples"), this);
+        m_cbDelta->setToolTip(
+            QStringLiteral("Store the difference between consecutive samples of each channel. "
+                           "Has no effect on floating-point data."));
+        codecLayout->addRow(m_cbDelta);
+
+        layout->addWidget(codecGroup);
         layout->addStretch();
 
         auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
@@ -121,6 +158,10 @@ public:
         m_sourceSel->setEnabled(!running);
         m_cbNameFromSrc->setEnabled(!running);
         m_nameEdit->setEnabled(!running && !m_cbNameFromSrc->isChecked());
+        m_compressorComboBox->setEnabled(!running);
+        m_levelSpinBox->setEnabled(!running);
+        m_cbShuffle->setEnabled(!running);
+        m_cbDelta->setEnabled(!running);
     }
 
     int selectedTypeId() const
@@ -155,6 +196,24 @@ public:
         m_nameEdit->setText(name);
     }
 
+    ZarrCodecConfig codecConfig() const
+    {
+        ZarrCodecConfig config;
+        config.compressor = static_cast<ZarrCodecConfig::Compressor>(m_compressorComboBox->currentData().toInt());
+        config.level = m_levelSpinBox->value();
+        config.shuffle = m_cbShuffle->isChecked();
+        config.delta = m_cbDelta->isChecked();
+        return config;
+    }
+    void setCodecConfig(const ZarrCodecConfig &config)
+    {
+        const auto idx = m_compressorComboBox->findData(QVariant::fromValue(static_cast<int>(config.compressor)));
+        m_compressorComboBox->setCurrentIndex(idx >= 0 ? idx : 0);
+        m_levelSpinBox->setValue(config.level);
+        m_cbShuffle->setChecked(config.shuffle);
+        m_cbDelta->setChecked(config.delta);
+    }
+
 Q_SIGNALS:
     void settingsChanged();
 
@@ -162,6 +221,10 @@ private:
     DataTypeSelector *m_sourceSel;
     QCheckBox *m_cbNameFromSrc;
     QLineEdit *m_nameEdit;
+    QComboBox *m_compressorComboBox;
+    QSpinBox *m_levelSpinBox;
+    QCheckBox *m_cbShuffle;
+    QCheckBox *m_cbDelta;
 };
 
 class ZarrWriterModule : public AbstractModule
@@ -188,6 +251,8 @@ private:
     bool m_writeData;
     int m_expectedChannels; // 0 = not advertised by upstream, skip channel count validation
     int64_t m_chunkCount;
+    std::shared_ptr<ZarrCompressionPool> m_compressionPool;
+    ZarrCodecConfig m_codecConfig;
 
     std::shared_ptr<EDLDataset> m_currentDSet;
     std::string m_storePath;
@@ -203,6 +268,10 @@ private:
     std::unique_ptr<ZarrV3Array> m_tsArray;
     std::unique_ptr<ZarrV3Array> m_dataArray;
 
+    // reused buffers for writing LineReading batches
+    std::vector<uint64_t> m_lineTsScratch;
+    std::vector<uint32_t> m_lineRowScratch;
+
     ZarrSettingsDialog *m_settingsDlg;
 
 public:
@@ -294,28 +363,28 @@ public:
         if (m_floatIn && m_floatIn->hasSubscription()) {
             m_floatSub = m_floatIn->subscription();
             m_isrcKind = InputSourceKind::FLOAT;
-            registerDataReceivedEvent(&ZarrWriterModule::onFloatSignalBlockReceived, m_floatSub);
+            registerDataBatchReceivedEvent(&ZarrWriterModule::onFloatSignalBlockReceived, m_floatSub);
         }
 
         m_intSub.reset();
         if (m_intIn && m_intIn->hasSubscription()) {
             m_intSub = m_intIn->subscription();
             m_isrcKind = InputSourceKind::INT;
-            registerDataReceivedEvent(&ZarrWriterModule::onIntSignalBlockReceived, m_intSub);
+            registerDataBatchReceivedEvent(&ZarrWriterModule::onIntSignalBlockReceived, m_intSub);
         }
 
         m_uint16Sub.reset();
         if (m_uint16In && m_uint16In->hasSubscription()) {
             m_uint16Sub = m_uint16In->subscription();
             m_isrcKind = InputSourceKind::UINT16;
-            registerDataReceivedEvent(&ZarrWriterModule::onUInt16SignalBlockReceived, m_uint16Sub);
+            registerDataBatchReceivedEvent(&ZarrWriterModule::onUInt16SignalBlockReceived, m_uint16Sub);
         }
 
         m_lineSub.reset();
         if (m_lineIn && m_lineIn->hasSubscription()) {
             m_lineSub = m_lineIn->subscription();
             m_isrcKind = InputSourceKind::LINE_READING;
-            registerDataReceivedEvent(&ZarrWriterModule::onLineReadingReceived, m_lineSub);
+            registerDataBatchReceivedEvent(&ZarrWriterModule::onLineReadingReceived, m_lineSub);
         }
 
         if (m_isrcKind == InputSourceKind::NONE) {
@@ -399,6 +468,12 @@ public:
 
         m_srcModType = QString::fromStdString(mdata.valueOr<std::string>("src_mod_type", std::string{}));
 
+        // Compress chunks on the CPU cores no other module thread claimed, leaving some headroom.
+        // All arrays of all Zarr writers share one pool, so this is the total amount of threads.
+        const auto compressionThreads = std::clamp(static_cast<int>(potentialNoaffinityCPUCount()) / 2, 1, 8);
+        m_compressionPool = compressionThreads > 1 ? ZarrCompressionPool::shared(compressionThreads) : nullptr;
+        m_codecConfig = m_settingsDlg->codecConfig();
+
         // create EDL dataset for this recording
         if (m_settingsDlg->useNameFromSource())
             m_currentDSet = createDefaultDataset(name(), mdata);
@@ -454,6 +529,7 @@ public:
     void stop() override
     {
         m_settingsDlg->setRunning(false);
+        m_compressionPool.reset();
 
         if (!m_writeData)
             return;
@@ -483,6 +559,12 @@ public:
         settings.insert(QStringLiteral("input_type"), m_settingsDlg->selectedTypeName());
         settings.insert(QStringLiteral("use_name_from_source"), m_settingsDlg->useNameFromSource());
         settings.insert(QStringLiteral("data_name"), m_settingsDlg->dataName());
+
+        const auto codec = m_settingsDlg->codecConfig();
+        settings.insert(QStringLiteral("compressor"), zarrCompressorToString(codec.compressor));
+        settings.insert(QStringLiteral("compression_level"), codec.level);
+        settings.insert(QStringLiteral("shuffle"), codec.shuffle);
+        settings.insert(QStringLiteral("delta"), codec.delta);
     }
 
     bool loadSettings(const QString &, const QVariantHash &settings, const QByteArray &) override
@@ -491,6 +573,13 @@ public:
         updatePortConfiguration();
         m_settingsDlg->setUseNameFromSource(settings.value(QStringLiteral("use_name_from_source"), true).toBool());
         m_settingsDlg->setDataName(settings.value(QStringLiteral("data_name")).toString());
+
+        ZarrCodecConfig codec;
+        codec.compressor = zarrCompressorFromString(settings.value(QStringLiteral("compressor")).toString());
+        codec.level = settings.value(QStringLiteral("compression_level"), -1).toInt();
+        codec.shuffle = settings.value(QStringLiteral("shuffle"), false).toBool();
+        codec.delta = settings.value(QStringLiteral("delta"), false).toBool();
+        m_settingsDlg->setCodecConfig(codec);
         return true;
     }
 
@@ -546,6 +635,8 @@ private:
             m_chunkCount,
             1,
             QStringList{QStringLiteral("time")});
+        m_tsArray->setCompressionPool(m_compressionPool);
+        m_tsArray->setCodecConfig(m_codecConfig);
 
         if (!m_timeUnit.isEmpty()) {
             QJsonObject tsAttrs;
@@ -569,6 +660,10 @@ private:
             m_chunkCount,
             nCols,
             dataDimNames);
+        m_dataArray->setCompressionPool(m_compressionPool);
+        auto dataCodec = m_codecConfig;
+        dataCodec.delta = dataCodec.delta && dataDtype != ZarrV3Array::DType::Float32;
+        m_dataArray->setCodecConfig(dataCodec);
 
         // embed signal metadata as Zarr array attributes. time_unit lives on
         // the timestamps array (which it describes), not here.
@@ -619,6 +714,8 @@ private:
             m_chunkCount,
             1,
             QStringList{QStringLiteral("event")});
+        m_tsArray->setCompressionPool(m_compressionPool);
+        m_tsArray->setCodecConfig(m_codecConfig);
         if (!m_timeUnit.isEmpty()) {
             QJsonObject tsAttrs;
             tsAttrs["time_unit"] = m_timeUnit;
@@ -638,6 +735,8 @@ private:
             m_chunkCount,
             2,
             QStringList{QStringLiteral("line"), QStringLiteral("value")});
+        m_dataArray->setCompressionPool(m_compressionPool);
+        m_dataArray->setCodecConfig(m_codecConfig);
         QJsonObject dataAttrs;
         dataAttrs["signal_names"] = QJsonArray{QStringLiteral("line_id"), QStringLiteral("value")};
         if (!m_dataUnit.isEmpty())
@@ -654,75 +753,74 @@ private:
         }
     }
 
-    template<typename SubPtr>
-    void handleSignalBlock(SubPtr &sub)
+    template<typename BlockT>
+    void handleSignalBlocks(const std::vector<BlockT> &batch)
     {
-        const auto maybeData = sub->peekNext();
-        if (!maybeData.has_value() || !m_writeData)
-            return;
-        const auto &block = maybeData.value();
-
-        ensureArraysInitialized(static_cast<int>(block.data.cols()));
-        if (!m_writeData)
-            return; // ensureArraysInitialized hit a fatal condition (channel mismatch, etc.)
-
         // Syntalos signal-block matrices are row-major.
         // Verify at compile time so we can write the storage directly without a copy.
-        static_assert(
-            std::remove_reference_t<decltype(block.data)>::IsRowMajor,
-            "SignalBlock data matrix must be row-major");
+        static_assert(BlockT::DataMatrix::IsRowMajor, "SignalBlock data matrix must be row-major");
 
-        m_tsArray->appendBytes(block.timestamps.data(), block.timestamps.rows());
-        m_dataArray->appendBytes(block.data.data(), block.data.rows());
+        for (const auto &block : batch) {
+            if (!m_writeData)
+                return;
 
-        // Surface any sticky I/O error from the writer back to the user.
-        if (m_tsArray->hasError() || m_dataArray->hasError()) {
-            const QString msg = m_tsArray->hasError() ? m_tsArray->errorMessage() : m_dataArray->errorMessage();
-            raiseError(QStringLiteral("Zarr writer I/O error: ") + msg);
-            m_writeData = false;
+            ensureArraysInitialized(static_cast<int>(block.cols()));
+            if (!m_writeData)
+                return; // ensureArraysInitialized hit a fatal condition (channel mismatch, etc.)
+
+            m_tsArray->appendBytes(block.timestamps().data(), block.timestamps().rows());
+            m_dataArray->appendBytes(block.data().data(), block.data().rows());
+
+            // Surface any sticky I/O error from the writer back to the user.
+            if (m_tsArray->hasError() || m_dataArray->hasError()) {
+                const QString msg = m_tsArray->hasError() ? m_tsArray->errorMessage() : m_dataArray->errorMessage();
+                raiseError(QStringLiteral("Zarr writer I/O error: ") + msg);
+                m_writeData = false;
+            }
         }
     }
 
-    void onFloatSignalBlockReceived()
+    void onFloatSignalBlockReceived(std::vector<SignalBlockF32> &batch)
     {
-        handleSignalBlock(m_floatSub);
+        handleSignalBlocks(batch);
     }
 
-    void onIntSignalBlockReceived()
+    void onIntSignalBlockReceived(std::vector<SignalBlockI32> &batch)
     {
-        handleSignalBlock(m_intSub);
+        handleSignalBlocks(batch);
     }
 
-    void onUInt16SignalBlockReceived()
+    void onUInt16SignalBlockReceived(std::vector<SignalBlockU16> &batch)
     {
-        handleSignalBlock(m_uint16Sub);
+        handleSignalBlocks(batch);
     }
 
-    void onLineReadingReceived()
+    void onLineReadingReceived(std::vector<LineReading> &batch)
     {
-        // Drain all queued events; append the timestamp and the [line_id, value]
-        // row in lockstep so they stay aligned by index.
-        while (auto maybeData = m_lineSub->peekNext()) {
-            // Always drain the queue, even when not saving or after
-            // a fatal error - otherwise events pile up unbounded.
-            if (!m_writeData)
-                continue;
-
-            const auto &ev = maybeData.value();
-            ensureLineArraysInitialized();
-            if (!m_writeData)
-                continue;
+        // The batch is always fully consumed, even when not saving or after
+        // a fatal error - otherwise events would pile up unbounded.
+        if (!m_writeData)
+            return;
+        ensureLineArraysInitialized();
+        if (!m_writeData)
+            return;
 
-            const uint64_t t = static_cast<uint64_t>(ev.time.count());
-            const uint32_t row[2] = {static_cast<uint32_t>(ev.lineId), static_cast<uint32_t>(ev.value)};
-            m_tsArray->appendBytes(&t, 1);
-            m_dataArray->appendBytes(row, 1);
+        // Gather the whole batch, then append the timestamps and the
+        // [line_id, value] rows in lockstep so they stay aligned by index.
+        m_lineTsScratch.clear();
+        m_lineRowScratch.clear();
+        for (const auto &ev : batch) {
+            m_lineTsScratch.push_back(static_cast<uint64_t>(ev.time.count()));
+            m_lineRowScratch.push_back(static_cast<uint32_t>(ev.lineId));
+            m_lineRowScratch.push_back(static_cast<uint32_t>(ev.value));
+        }
+        m_tsArray->appendBytes(m_lineTsScratch.data(), m_lineTsScratch.size());
+        m_dataArray->appendBytes(m_lineRowScratch.data(), m_lineTsScratch.size());
 
-            if (m_tsArray->hasError() || m_dataArray->hasError()) {
-                const QString msg = m_tsArray->hasError() ? m_tsArray->errorMessage() : m_dataArray->errorMessage();
-                raiseError(QStringLiteral("Zarr writer I/O error: ") + msg);
-                m_writeData = false; // keep draining the rest; do not return
-            }
+        if (m_tsArray->hasError() || m_dataArray->hasError()) {
+            const QString msg = m_tsArray->hasError() ? m_tsArray->errorMessage() : m_dataArray->errorMessage();
+            raiseError(QStringLiteral("Zarr writer I/O error: ") + msg);
+            m_writeData = false;
         }
     }
 };
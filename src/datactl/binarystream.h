@@ -201,13 +201,11 @@ public:
     {
         uint64_t size;
         read(size);
-        vec.clear();
-        vec.reserve(size);
-        for (uint64_t i = 0; i < size; ++i) {
-            std::string str;
+
+        // strings already present in the vector are overwritten, so their buffers are reused
+        vec.resize(size);
+        for (auto &str : vec)
             read(str);
-            vec.push_back(std::move(str));
-        }
     }
 
     void read(ByteVector &blob);
@@ -104,36 +104,98 @@ BaseDataType::TypeId BaseDataType::typeIdFromString(const std::string &str)
     return result;
 }
 
+std::string toString(TableColumnType type)
+{
+    switch (type) {
+    case TableColumnType::Float:
+        return "float";
+    case TableColumnType::Integer:
+        return "int";
+    case TableColumnType::Bool:
+        return "bool";
+    default:
+        return "float";
+    }
+}
+
+TableColumnType tableColumnTypeFromString(const std::string &str)
+{
+    if (str == "int")
+        return TableColumnType::Integer;
+    if (str == "bool")
+        return TableColumnType::Bool;
+    return TableColumnType::Float;
+}
+
+std::string formatTableCell(double value, TableColumnType type)
+{
+    if (!std::isfinite(value))
+        return numToString(value);
+
+    switch (type) {
+    case TableColumnType::Integer:
+        return numToString(static_cast<int64_t>(value));
+    case TableColumnType::Bool:
+        return numToString(value != 0.0);
+    default:
+        // whole numbers (e.g. timestamps) would otherwise switch to exponent notation once they get large
+        if (std::trunc(value) == value && std::fabs(value) < 9007199254740992.0)
+            return numToString(static_cast<int64_t>(value));
+        return numToString(value);
+    }
+}
+
+TableRow::TableRow(const struct TableRecord &record)
+{
+    // consumers of plain rows have no column types, so all cells are formatted as plain numbers
+    data.reserve(record.values.size());
+    for (const auto v : record.values)
+        data.push_back(formatTableCell(v, TableColumnType::Float));
+}
+
+/**
+ * Take the timestamps out of a signal block that is about to be converted,
+ * moving them if the block is the sole owner of its payload.
+ */
+template<typename MatrixT>
+static VectorXu64 takeTimestamps(SignalBlockBase<MatrixT> &src)
+{
+    if (src.isShared())
+        return src.timestamps();
+    return std::move(src.mutableTimestamps());
+}
+
 SignalBlockI32::SignalBlockI32(struct SignalBlockU16 &&src)
 {
     // The data matrix has a different scalar type, so the cast must read every
     // element anyway; only the timestamps can actually be moved.
-    timestamps = std::move(src.timestamps);
-    data = src.data.cast<int32_t>();
+    setTimestamps(takeTimestamps(src));
+    setData(src.data().cast<int32_t>());
 }
 
 SignalBlockF32::SignalBlockF32(struct SignalBlockU16 &&src)
 {
-    timestamps = std::move(src.timestamps);
-    data = src.data.cast<float>();
+    setTimestamps(takeTimestamps(src));
+    setData(src.data().cast<float>());
 }
 
 SignalBlockF32::SignalBlockF32(struct SignalBlockI32 &&src)
 {
-    timestamps = std::move(src.timestamps);
-    data = src.data.cast<float>();
+    setTimestamps(takeTimestamps(src));
+    setData(src.data().cast<float>());
 }
 
 SignalBlockI32::SignalBlockI32(struct SignalBlockF32 &&src)
 {
-    timestamps = std::move(src.timestamps);
+    setTimestamps(takeTimestamps(src));
 
     // Clamp data before casting, to protect a little bit against unexpected surprises
     // for users who don't know too much about the implications of different data types.
     // float(INT32_MAX) rounds up to 2^31 (out of range), so the safe upper
     // bound is the largest float that still fits, 2^31 - 128.
     constexpr float maxF = 2147483520.0f; // largest float <= INT32_MAX
-    data = src.data.array().isNaN().select(0.0f, src.data.array()).max(INT32_MIN).min(maxF).cast<int32_t>().matrix();
+    const auto &srcData = src.data();
+    setData(srcData.array().isNaN().select(0.0f, srcData.array()).max(INT32_MIN).min(maxF).cast<int32_t>().matrix());
 }
 
 } // namespace Syntalos
@@ -26,6 +26,7 @@
 #include <charconv>
 #include <cstdint>
 #include <cassert>
+#include <cstring>
 #include <array>
 #include <cmath>
 #include <type_traits>
@@ -66,6 +67,20 @@ template<>
 struct supports_buffer_reuse<Frame> : std::true_type {
 };
 
+// signal blocks share a reference-counted payload whose matrices can be reused
+struct SignalBlockI32;
+struct SignalBlockU16;
+struct SignalBlockF32;
+template<>
+struct supports_buffer_reuse<SignalBlockI32> : std::true_type {
+};
+template<>
+struct supports_buffer_reuse<SignalBlockU16> : std::true_type {
+};
+template<>
+struct supports_buffer_reuse<SignalBlockF32> : std::true_type {
+};
+
 /**
  * @brief The ModuleState enum
  *
@@ -120,6 +135,7 @@ public:
         SignalBlockI32,
         SignalBlockU16,
         SignalBlockF32,
+        TableRecord,
         Last
     };
 
@@ -246,6 +262,31 @@ T deserializeFromMemory(const void *memory, size_t size)
     return T::fromMemory(memory, size);
 }
 
+/**
+ * @brief Check if a type can be deserialized into an existing object.
+ */
+template<typename T>
+concept supports_deserialize_into = requires(const void *memory, size_t size, T &obj) {
+    { T::fromMemoryInto(memory, size, obj) };
+};
+
+/**
+ * @brief Deserialize a data type from memory into @p obj
+ *
+ * Types implementing fromMemoryInto() reuse the heap memory @p obj already holds
+ * where possible, so calling this repeatedly with the same object does not
+ * allocate in steady state. Other types are deserialized into a new value.
+ */
+template<typename T>
+void deserializeFromMemoryInto(const void *memory, size_t size, T &obj)
+    requires std::is_base_of_v<BaseDataType, T>
+{
+    if constexpr (supports_deserialize_into<T>)
+        T::fromMemoryInto(memory, size, obj);
+    else
+        obj = T::fromMemory(memory, size);
+}
+
 /**
  * @brief The ControlCommandKind enum
  *
@@ -263,6 +304,7 @@ enum class ControlCommandKind {
 // Forward declarations
 struct Frame;
 struct SignalBlockU16;
+struct TableRecord;
 
 /**
  * @brief A control command to a module.
@@ -343,6 +385,8 @@ struct TableRow final : BaseDataType {
     {
     }
 
+    explicit TableRow(const struct TableRecord &record);
+
     void reserve(int size)
     {
         data.reserve(size);
@@ -370,11 +414,18 @@ struct TableRow final : BaseDataType {
     static TableRow fromMemory(const void *memory, size_t size)
     {
         TableRow obj;
+        fromMemoryInto(memory, size, obj);
+        return obj;
+    }
+
+    /**
+     * @brief Deserialize a row into @p obj, reusing the strings it already holds.
+     */
+    static void fromMemoryInto(const void *memory, size_t size, TableRow &obj)
+    {
         BinaryStreamReader stream(memory, size);
 
         stream.read(obj.data);
-
-        return obj;
     }
 
     [[nodiscard]] size_t approxMemorySize() const override
@@ -384,6 +435,91 @@ struct TableRow final : BaseDataType {
     }
 };
 
+/**
+ * @brief Type of a column in a stream of TableRecord items.
+ *
+ * Streams carrying table records list the type of every column in their
+ * "table_column_types" metadata, next to the column names in "table_header".
+ * The type only decides how a cell is presented, all cells are stored as doubles.
+ */
+enum class TableColumnType {
+    Float,   /// Floating-point number
+    Integer, /// Integral number, exact up to 2^53
+    Bool     /// Zero or one
+};
+
+std::string toString(TableColumnType type);
+TableColumnType tableColumnTypeFromString(const std::string &str);
+
+/**
+ * @brief A row of numeric table cells.
+ *
+ * Typed counterpart to TableRow for tables that only hold numbers, e.g. tracking
+ * results or event timestamps. All cells have a fixed width, so a record is
+ * serialized with a single copy and no string formatting happens on the producer
+ * side. The column names and types are set once per stream in its metadata.
+ */
+struct TableRecord final : BaseDataType {
+    SY_DEFINE_DATA_TYPE(TableRecord)
+
+    std::vector<double> values;
+
+    explicit TableRecord() = default;
+    explicit TableRecord(std::vector<double> cells)
+        : values(std::move(cells))
+    {
+    }
+
+    [[nodiscard]] int length() const
+    {
+        return static_cast<int>(values.size());
+    }
+
+    [[nodiscard]] ssize_t memorySize() const override
+    {
+        return static_cast<ssize_t>(sizeof(uint64_t) + values.size() * sizeof(double));
+    }
+
+    bool writeToMemory(void *memory, ssize_t size = -1) const override
+    {
+        if (size >= 0 && size < memorySize())
+            return false;
+
+        const uint64_t count = values.size();
+        auto ptr = static_cast<std::byte *>(memory);
+        std::memcpy(ptr, &count, sizeof(count));
+        if (count > 0)
+            std::memcpy(ptr + sizeof(count), values.data(), count * sizeof(double));
+
+        return true;
+    }
+
+    bool toBytes(ByteVector &output) const override
+    {
+        output.resize(static_cast<size_t>(memorySize()));
+        return writeToMemory(output.data(), static_cast<ssize_t>(output.size()));
+    }
+
+    static TableRecord fromMemory(const void *memory, size_t size)
+    {
+        TableRecord obj;
+
+        uint64_t count;
+        if (size < sizeof(count))
+            throw std::runtime_error("TableRecord data is truncated");
+        std::memcpy(&count, memory, sizeof(count));
+        if (count > (size - sizeof(count)) / sizeof(double))
+            throw std::runtime_error("TableRecord data is truncated");
+
+        obj.values.resize(count);
+        if (count > 0)
+            std::memcpy(
+                obj.values.data(), static_cast<const std::byte *>(memory) + sizeof(count), count * sizeof(double));
+
+        return obj;
+    }
+};
+
 /**
  * @brief The LineCommandKind enum
  *
@@ -466,6 +602,15 @@ struct LineCommand final : BaseDataType {
     static LineCommand fromMemory(const void *memory, size_t size)
     {
         LineCommand obj;
+        fromMemoryInto(memory, size, obj);
+        return obj;
+    }
+
+    /**
+     * @brief Deserialize a command into @p obj, reusing its payload buffer.
+     */
+    static void fromMemoryInto(const void *memory, size_t size, LineCommand &obj)
+    {
         BinaryStreamReader stream(memory, size);
 
         int64_t durationUs;
@@ -478,8 +623,6 @@ struct LineCommand final : BaseDataType {
         stream.read(obj.extra);
         obj.duration = microseconds_t(durationUs);
         obj.flags = LineModeFlags(flagsRaw);
-
-        return obj;
     }
 };
 
@@ -513,6 +656,12 @@ struct LineReading final : BaseDataType {
     static LineReading fromMemory(const void *memory, size_t size)
     {
         LineReading obj;
+        fromMemoryInto(memory, size, obj);
+        return obj;
+    }
+
+    static void fromMemoryInto(const void *memory, size_t size, LineReading &obj)
+    {
         BinaryStreamReader stream(memory, size);
 
         int64_t timeUs;
@@ -520,8 +669,6 @@ struct LineReading final : BaseDataType {
         stream.read(obj.value);
         stream.read(timeUs);
         obj.time = microseconds_t(timeUs);
-
-        return obj;
     }
 };
 
@@ -540,210 +687,330 @@ enum class SignalDataType {
 };
 
 /**
- * @brief A block of 32-bit signed integer signal data with timestamps.
+ * @brief Common base for all signal block types.
+ *
+ * A signal block holds a vector of timestamps and a row-major data matrix with
+ * one row per sample and one column per channel. Both live in a reference-counted,
+ * copy-on-write payload: copying a block (e.g. via clone() when a stream fans out
+ * to multiple subscribers) only shares the payload, similar to how Frame shares
+ * its pixel buffer via cv::Mat.
+ * The const accessors never copy. The mutable*() accessors detach the payload first
+ * if any other block still references it, so a deep copy only happens when a shared
+ * block is actually modified. Producers reusing one block should therefore move it into
+ * the stream (or replace its arrays via setData() / setTimestamps()), instead of pushing
+ * a copy and modifying the block that subscribers still share.
  */
-struct SignalBlockI32 final : BaseDataType {
-    SY_DEFINE_DATA_TYPE(SignalBlockI32)
+template<typename MatrixT>
+struct SignalBlockBase : BaseDataType {
+public:
+    using DataMatrix = MatrixT;
+    using Scalar = typename MatrixT::Scalar;
 
-    VectorXu64 timestamps;
-    MatrixXi32 data;
+    [[nodiscard]] const VectorXu64 &timestamps() const
+    {
+        return m_d->timestamps;
+    }
 
-    explicit SignalBlockI32(uint sampleCount = 60, uint channelCount = 1)
+    [[nodiscard]] const MatrixT &data() const
     {
-        assert(channelCount > 0);
-        timestamps.resize(sampleCount);
-        data.resize(sampleCount, channelCount);
+        return m_d->data;
     }
 
-    explicit SignalBlockI32(struct SignalBlockU16 &&src);
-    explicit SignalBlockI32(struct SignalBlockF32 &&src);
+    /**
+     * @brief Writable access to the timestamps, detaching them from other blocks if shared.
+     */
+    [[nodiscard]] VectorXu64 &mutableTimestamps()
+    {
+        detach();
+        return m_d->timestamps;
+    }
+
+    /**
+     * @brief Writable access to the data matrix, detaching it from other blocks if shared.
+     */
+    [[nodiscard]] MatrixT &mutableData()
+    {
+        detach();
+        return m_d->data;
+    }
+
+    /**
+     * @brief Replace the timestamps. A shared payload is detached without copying the old timestamps.
+     */
+    void setTimestamps(VectorXu64 timestamps)
+    {
+        if (m_d.use_count() != 1) {
+            auto payload = std::make_shared<Payload>();
+            payload->data = m_d->data;
+            m_d = std::move(payload);
+        }
+        m_d->timestamps = std::move(timestamps);
+    }
+
+    /**
+     * @brief Replace the data matrix. A shared payload is detached without copying the old data.
+     */
+    void setData(MatrixT data)
+    {
+        if (m_d.use_count() != 1) {
+            auto payload = std::make_shared<Payload>();
+            payload->timestamps = m_d->timestamps;
+            m_d = std::move(payload);
+        }
+        m_d->data = std::move(data);
+    }
+
+    /**
+     * @brief Check if the payload of this block is currently shared with other blocks.
+     */
+    [[nodiscard]] bool isShared() const
+    {
+        return m_d.use_count() > 1;
+    }
 
     [[nodiscard]] size_t length() const
     {
-        return timestamps.size();
+        return m_d->timestamps.size();
     }
 
     [[nodiscard]] size_t rows() const
     {
-        return data.rows();
+        return m_d->data.rows();
     }
 
     [[nodiscard]] size_t cols() const
     {
-        return data.cols();
+        return m_d->data.cols();
     }
 
     [[nodiscard]] ssize_t memorySize() const override
     {
         // exact serialized size, matching serializeEigen() used in writeToMemory()
-        return serializedEigenSize(timestamps) + serializedEigenSize(data);
+        return serializedEigenSize(m_d->timestamps) + serializedEigenSize(m_d->data);
     }
 
     bool writeToMemory(void *memory, ssize_t size = -1) const override
     {
-        return writeEigenPairToMemory(memory, size, timestamps, data);
+        return writeEigenPairToMemory(memory, size, m_d->timestamps, m_d->data);
     }
 
     bool toBytes(ByteVector &output) const override
     {
         BinaryStreamWriter stream(output);
 
-        serializeEigen(stream, timestamps);
-        serializeEigen(stream, data);
+        serializeEigen(stream, m_d->timestamps);
+        serializeEigen(stream, m_d->data);
 
         return true;
     }
 
-    static SignalBlockI32 fromMemory(const void *memory, size_t size)
-    {
-        SignalBlockI32 obj;
-        BinaryStreamReader stream(memory, size);
+    /**
+     * @brief Location of the arrays of a serialized block inside a memory block.
+     *
+     * The pointers are not necessarily aligned for their element type,
+     * the data matrix is stored in row-major order.
+     */
+    struct MemoryView {
+        const void *timestamps;
+        size_t length;
+        const void *data;
+        size_t rows;
+        size_t cols;
+    };
 
-        obj.timestamps = deserializeEigen<VectorXu64>(stream);
-        obj.data = deserializeEigen<MatrixXi32>(stream);
+    /**
+     * @brief Locate timestamps and data of a serialized block without copying them.
+     *
+     * Returns false if the memory block is truncated.
+     */
+    static bool viewFromMemory(const void *memory, size_t size, MemoryView &view)
+    {
+        const auto *ptr = static_cast<const unsigned char *>(memory);
+        constexpr size_t dimsSize = 2 * sizeof(uint64_t);
+        uint64_t dims[2];
+
+        // timestamps are a column vector
+        if (size < dimsSize)
+            return false;
+        std::memcpy(dims, ptr, dimsSize);
+        size_t offset = dimsSize;
+        if (dims[1] != 1 || dims[0] > (size - offset) / sizeof(uint64_t))
+            return false;
+        view.timestamps = ptr + offset;
+        view.length = dims[0];
+        offset += view.length * sizeof(uint64_t);
+
+        if (size - offset < dimsSize)
+            return false;
+        std::memcpy(dims, ptr + offset, dimsSize);
+        offset += dimsSize;
+        if (dims[1] != 0 && dims[0] > (size - offset) / sizeof(Scalar) / dims[1])
+            return false;
+        view.data = ptr + offset;
+        view.rows = dims[0];
+        view.cols = dims[1];
 
-        return obj;
+        return true;
     }
-};
 
-/**
- * @brief A block of 16-bit unsigned integer signal data with timestamps.
- *
- * Used by DAQ hardware that natively produces 16-bit samples.
- */
-struct SignalBlockU16 final : BaseDataType {
-    SY_DEFINE_DATA_TYPE(SignalBlockU16)
+protected:
+    struct Payload {
+        VectorXu64 timestamps;
+        MatrixT data;
+    };
 
-    VectorXu64 timestamps;
-    MatrixXu16 data;
+    explicit SignalBlockBase()
+        : m_d(std::make_shared<Payload>())
+    {
+    }
 
-    explicit SignalBlockU16(uint sampleCount = 60, uint channelCount = 1)
+    SignalBlockBase(uint sampleCount, uint channelCount)
+        : m_d(std::make_shared<Payload>())
     {
         assert(channelCount > 0);
-        timestamps.resize(sampleCount);
-        data.resize(sampleCount, channelCount);
+        m_d->timestamps.resize(sampleCount);
+        m_d->data.resize(sampleCount, channelCount);
     }
 
-    [[nodiscard]] size_t length() const
+    SignalBlockBase(const SignalBlockBase &) = default;
+    SignalBlockBase &operator=(const SignalBlockBase &) = default;
+
+    // moved-from blocks keep pointing to a valid (empty) payload
+    SignalBlockBase(SignalBlockBase &&other) noexcept
+        : BaseDataType(std::move(other)),
+          m_d(std::exchange(other.m_d, emptyPayload()))
     {
-        return timestamps.size();
     }
 
-    [[nodiscard]] size_t rows() const
+    SignalBlockBase &operator=(SignalBlockBase &&other) noexcept
     {
-        return data.rows();
+        BaseDataType::operator=(std::move(other));
+        m_d = std::exchange(other.m_d, emptyPayload());
+        return *this;
     }
 
-    [[nodiscard]] size_t cols() const
+    /**
+     * Replace the payload with the serialized block in @p stream. The matrices of
+     * an exclusively owned payload are reused, a shared one is replaced without
+     * copying its old contents.
+     */
+    void readPayload(BinaryStreamReader &stream)
     {
-        return data.cols();
+        if (m_d.use_count() != 1)
+            m_d = std::make_shared<Payload>();
+        deserializeEigenInto(stream, m_d->timestamps);
+        deserializeEigenInto(stream, m_d->data);
     }
 
-    [[nodiscard]] ssize_t memorySize() const override
+private:
+    std::shared_ptr<Payload> m_d;
+
+    static const std::shared_ptr<Payload> &emptyPayload()
     {
-        // exact serialized size, matching serializeEigen() used in writeToMemory()
-        return serializedEigenSize(timestamps) + serializedEigenSize(data);
+        static const auto empty = std::make_shared<Payload>();
+        return empty;
     }
 
-    bool writeToMemory(void *memory, ssize_t size = -1) const override
+    void detach()
     {
-        return writeEigenPairToMemory(memory, size, timestamps, data);
+        // the empty payload is always held by emptyPayload() too, so it is never written to
+        if (m_d.use_count() != 1)
+            m_d = std::make_shared<Payload>(*m_d);
     }
+};
 
-    bool toBytes(ByteVector &output) const override
+/**
+ * @brief A block of 32-bit signed integer signal data with timestamps.
+ */
+struct SignalBlockI32 final : SignalBlockBase<MatrixXi32> {
+    SY_DEFINE_DATA_TYPE(SignalBlockI32)
+
+    explicit SignalBlockI32(uint sampleCount = 60, uint channelCount = 1)
+        : SignalBlockBase(sampleCount, channelCount)
     {
-        BinaryStreamWriter stream(output);
+    }
 
-        serializeEigen(stream, timestamps);
-        serializeEigen(stream, data);
+    explicit SignalBlockI32(struct SignalBlockU16 &&src);
+    explicit SignalBlockI32(struct SignalBlockF32 &&src);
 
-        return true;
+    static SignalBlockI32 fromMemory(const void *memory, size_t size)
+    {
+        SignalBlockI32 obj(0);
+        fromMemoryInto(memory, size, obj);
+        return obj;
     }
 
-    static SignalBlockU16 fromMemory(const void *memory, size_t size)
+    static void fromMemoryInto(const void *memory, size_t size, SignalBlockI32 &obj)
     {
-        SignalBlockU16 obj;
         BinaryStreamReader stream(memory, size);
 
-        obj.timestamps = deserializeEigen<VectorXu64>(stream);
-        obj.data = deserializeEigen<MatrixXu16>(stream);
-
-        return obj;
+        obj.readPayload(stream);
     }
 };
 
 /**
- * @brief A block of 32-bit floating-point timestamped signal data.
+ * @brief A block of 16-bit unsigned integer signal data with timestamps.
+ *
+ * Used by DAQ hardware that natively produces 16-bit samples.
  */
-struct SignalBlockF32 final : BaseDataType {
-    SY_DEFINE_DATA_TYPE(SignalBlockF32)
-
-    VectorXu64 timestamps;
-    MatrixXf data;
+struct SignalBlockU16 final : SignalBlockBase<MatrixXu16> {
+    SY_DEFINE_DATA_TYPE(SignalBlockU16)
 
-    explicit SignalBlockF32(uint sampleCount = 60, uint channelCount = 1)
+    explicit SignalBlockU16(uint sampleCount = 60, uint channelCount = 1)
+        : SignalBlockBase(sampleCount, channelCount)
     {
-        assert(channelCount > 0);
-        timestamps.resize(sampleCount);
-        data.resize(sampleCount, channelCount);
     }
 
-    explicit SignalBlockF32(const std::vector<float> &floatVec, uint timestamp)
+    static SignalBlockU16 fromMemory(const void *memory, size_t size)
     {
-        timestamps.array() += timestamp;
-        data.resize(1, floatVec.size());
-        for (size_t i = 0; i < floatVec.size(); ++i)
-            data(0, i) = floatVec[i];
+        SignalBlockU16 obj(0);
+        fromMemoryInto(memory, size, obj);
+        return obj;
     }
 
-    explicit SignalBlockF32(struct SignalBlockU16 &&src);
-    explicit SignalBlockF32(struct SignalBlockI32 &&src);
-
-    [[nodiscard]] size_t length() const
+    static void fromMemoryInto(const void *memory, size_t size, SignalBlockU16 &obj)
     {
-        return timestamps.size();
-    }
+        BinaryStreamReader stream(memory, size);
 
-    [[nodiscard]] size_t rows() const
-    {
-        return data.rows();
+        obj.readPayload(stream);
     }
+};
 
-    [[nodiscard]] size_t cols() const
-    {
-        return data.cols();
-    }
+/**
+ * @brief A block of 32-bit floating-point timestamped signal data.
+ */
+struct SignalBlockF32 final : SignalBlockBase<MatrixXf> {
+    SY_DEFINE_DATA_TYPE(SignalBlockF32)
 
-    [[nodiscard]] ssize_t memorySize() const override
+    explicit SignalBlockF32(uint sampleCount = 60, uint channelCount = 1)
+        : SignalBlockBase(sampleCount, channelCount)
     {
-        // exact serialized size, matching serializeEigen() used in writeToMemory()
-        return serializedEigenSize(timestamps) + serializedEigenSize(data);
     }
 
-    bool writeToMemory(void *memory, ssize_t size = -1) const override
+    explicit SignalBlockF32(const std::vector<float> &floatVec, uint timestamp)
     {
-        return writeEigenPairToMemory(memory, size, timestamps, data);
+        auto &d = mutableData();
+        mutableTimestamps().array() += timestamp;
+        d.resize(1, floatVec.size());
+        for (size_t i = 0; i < floatVec.size(); ++i)
+            d(0, i) = floatVec[i];
     }
 
-    bool toBytes(ByteVector &output) const override
-    {
-        BinaryStreamWriter stream(output);
-
-        serializeEigen(stream, timestamps);
-        serializeEigen(stream, data);
+    explicit SignalBlockF32(struct SignalBlockU16 &&src);
+    explicit SignalBlockF32(struct SignalBlockI32 &&src);
 
-        return true;
+    static SignalBlockF32 fromMemory(const void *memory, size_t size)
+    {
+        SignalBlockF32 obj(0);
+        fromMemoryInto(memory, size, obj);
+        return obj;
     }
 
-    static SignalBlockF32 fromMemory(const void *memory, size_t size)
+    static void fromMemoryInto(const void *memory, size_t size, SignalBlockF32 &obj)
     {
-        SignalBlockF32 obj;
         BinaryStreamReader stream(memory, size);
 
-        obj.timestamps = deserializeEigen<VectorXu64>(stream);
-        obj.data = deserializeEigen<MatrixXf>(stream);
-
-        return obj;
+        obj.readPayload(stream);
     }
 };
 
@@ -752,8 +1019,16 @@ struct SignalBlockF32 final : BaseDataType {
  *
  * Append a new type here when adding it to the TypeId enum.
  */
-using StreamTypeList = std::
-    tuple<ControlCommand, TableRow, Frame, LineCommand, LineReading, SignalBlockI32, SignalBlockU16, SignalBlockF32>;
+using StreamTypeList = std::tuple<
+    ControlCommand,
+    TableRow,
+    Frame,
+    LineCommand,
+    LineReading,
+    SignalBlockI32,
+    SignalBlockU16,
+    SignalBlockF32,
+    TableRecord>;
 
 /**
  * @brief Call `fn(std::type_identity<T>{})` for every T in StreamTypeList.
@@ -824,4 +1099,9 @@ inline std::string numToString(T x)
     }
 }
 
+/**
+ * @brief Format a TableRecord cell for display or text output, according to its column type.
+ */
+std::string formatTableCell(double value, TableColumnType type);
+
 } // namespace Syntalos
@@ -137,15 +137,18 @@ inline bool writeEigenPairToMemory(void *memory, ssize_t size, const TsType &tim
     return true;
 }
 
+/**
+ * Deserialize a matrix written by serializeEigen() into @p matrix,
+ * reusing its storage if it already has the right dimensions.
+ */
 template<typename EigenType>
-EigenType deserializeEigen(BinaryStreamReader &stream)
+void deserializeEigenInto(BinaryStreamReader &stream, EigenType &matrix)
 {
-    EigenType matrix;
-
     uint64_t rows, cols;
     stream.read(rows);
     stream.read(cols);
 
+    // resize() keeps the existing allocation if the dimensions are unchanged
     matrix.resize(rows, cols);
     for (uint64_t i = 0; i < rows; ++i) {
         for (uint64_t j = 0; j < cols; ++j) {
@@ -154,7 +157,13 @@ EigenType deserializeEigen(BinaryStreamReader &stream)
             matrix(i, j) = value;
         }
     }
+}
 
+template<typename EigenType>
+EigenType deserializeEigen(BinaryStreamReader &stream)
+{
+    EigenType matrix;
+    deserializeEigenInto(stream, matrix);
     return matrix;
 }
 
@@ -68,58 +68,42 @@ struct Frame final : BaseDataType {
         return mat.clone();
     }
 
+    /**
+     * @brief Size of the serialized frame header (index, timestamp and image metadata)
+     *
+     * The tightly packed pixel data immediately follows the header in serialized memory.
+     */
+    static constexpr size_t headerSize = sizeof(uint64_t) + sizeof(int64_t) + (sizeof(int) * 4);
+
+    /**
+     * @brief Serialized size of a frame with the given dimensions and OpenCV type.
+     */
+    static ssize_t memorySizeFor(int width, int height, int type)
+    {
+        const size_t dataSize = CV_ELEM_SIZE(type) * static_cast<size_t>(width) * static_cast<size_t>(height);
+        return static_cast<ssize_t>(headerSize + dataSize);
+    }
+
     ssize_t memorySize() const override
     {
-        // Calculate data size based on the format
-        size_t dataSize = mat.elemSize() * mat.cols * mat.rows;
-
-        // Calculate total buffer size:
-        // 1x uint64 + 1x int64 for index and timestamp
-        // 4x int for image metadata
-        // + size of image data itself
-        return static_cast<ssize_t>(sizeof(uint64_t) + sizeof(int64_t) + (sizeof(int) * 4) + dataSize);
+        return memorySizeFor(mat.cols, mat.rows, mat.type());
     }
 
     bool writeToMemory(void *buffer, ssize_t size = -1) const override
     {
-        // fetch metadata
-        int width = mat.cols;
-        int height = mat.rows;
-        int channels = mat.channels();
-        int type = mat.type();
-
-        // Calculate data size based on the format
-        size_t dataSize = mat.elemSize() * width * height;
+        const int width = mat.cols;
+        const int height = mat.rows;
 
         // calculate our memory segment size, if it wasn't passed
         if (size < 0)
             size = memorySize();
 
-        // copy metadata to buffer
-        size_t offset = 0;
-
-        // copy index and timestamp
-        std::memcpy(static_cast<unsigned char *>(buffer) + offset, &index, sizeof(index));
-        offset += sizeof(index);
-
-        const int64_t timeC = time.count();
-        std::memcpy(static_cast<unsigned char *>(buffer) + offset, &timeC, sizeof(timeC));
-        offset += sizeof(timeC);
-
-        // copy image metadata
-        std::memcpy(static_cast<unsigned char *>(buffer) + offset, &width, sizeof(width));
-        offset += sizeof(width);
-        std::memcpy(static_cast<unsigned char *>(buffer) + offset, &height, sizeof(height));
-        offset += sizeof(height);
-        std::memcpy(static_cast<unsigned char *>(buffer) + offset, &channels, sizeof(channels));
-        offset += sizeof(channels);
-        std::memcpy(static_cast<unsigned char *>(buffer) + offset, &type, sizeof(type));
-        offset += sizeof(type);
+        writeHeaderToMemory(buffer, index, time, width, height, mat.type());
 
         // copy image data as tightly packed rows
-        auto dst = static_cast<unsigned char *>(buffer) + offset;
+        auto dst = static_cast<unsigned char *>(buffer) + headerSize;
         if (mat.isContinuous()) {
-            std::memcpy(dst, mat.data, dataSize);
+            std::memcpy(dst, mat.data, mat.elemSize() * width * height);
         } else {
             const size_t rowBytes = static_cast<size_t>(width) * mat.elemSize();
             for (int y = 0; y < height; ++y) {
@@ -160,27 +144,10 @@ struct Frame final : BaseDataType {
      */
     static void fromMemoryInto(const void *buffer, size_t size, Frame &frame)
     {
-        const auto *ptr = static_cast<const unsigned char *>(buffer);
-        int width, height, channels, type;
-        int64_t timeC;
-        size_t offset = 0;
-
-        // unpack index and timestamp
-        std::memcpy(&frame.index, ptr + offset, sizeof(frame.index));
-        offset += sizeof(frame.index);
-        std::memcpy(&timeC, ptr + offset, sizeof(timeC));
-        offset += sizeof(timeC);
-        frame.time = microseconds_t(timeC);
-
-        // unpack image metadata
-        std::memcpy(&width, ptr + offset, sizeof(width));
-        offset += sizeof(width);
-        std::memcpy(&height, ptr + offset, sizeof(height));
-        offset += sizeof(height);
-        std::memcpy(&channels, ptr + offset, sizeof(channels));
-        offset += sizeof(channels);
-        std::memcpy(&type, ptr + offset, sizeof(type));
-        offset += sizeof(type);
+        MemoryView header;
+        readHeaderFromMemory(static_cast<const unsigned char *>(buffer), header);
+        frame.index = header.index;
+        frame.time = header.time;
 
         // Reuse the existing cv::Mat pixel buffer when:
         // - same dimensions and type (no reallocation needed), AND
@@ -190,12 +157,100 @@ struct Frame final : BaseDataType {
         // refcount (keeping their copies valid) and allocates a fresh buffer
         // so we never overwrite data that is still in use downstream.
         const bool canReuse = (frame.mat.data != nullptr) && (frame.mat.u != nullptr && frame.mat.u->refcount == 1)
-                              && (frame.mat.rows == height) && (frame.mat.cols == width) && (frame.mat.type() == type);
+                              && (frame.mat.rows == header.height) && (frame.mat.cols == header.width)
+                              && (frame.mat.type() == header.type);
         if (!canReuse)
-            frame.mat = cv::Mat(height, width, type);
+            frame.mat = cv::Mat(header.height, header.width, header.type);
 
-        const size_t dataSize = frame.mat.elemSize() * static_cast<size_t>(width * height);
-        std::memcpy(frame.mat.data, ptr + offset, dataSize);
+        const size_t dataSize = frame.mat.elemSize() * static_cast<size_t>(header.width * header.height);
+        std::memcpy(frame.mat.data, header.pixels, dataSize);
+    }
+
+    /**
+     * @brief Location and layout of the pixels of a serialized frame inside a memory block.
+     *
+     * The pixel rows are tightly packed, and the memory is not owned by the view.
+     */
+    struct MemoryView {
+        uint64_t index;
+        microseconds_t time;
+        int width;
+        int height;
+        int type;
+        const void *pixels;
+    };
+
+    /**
+     * @brief Locate the pixels of a serialized frame without copying them.
+     *
+     * The view is only valid for as long as @p buffer is, and grants read-only access,
+     * as the buffer may be memory that we are not allowed to write to (e.g. a received
+     * shared-memory sample).
+     *
+     * @return false if @p size is too small to hold the frame described by the header.
+     */
+    static bool viewFromMemory(const void *buffer, size_t size, MemoryView &view)
+    {
+        if (size < headerSize)
+            return false;
+
+        readHeaderFromMemory(static_cast<const unsigned char *>(buffer), view);
+        if (view.width < 0 || view.height < 0
+            || static_cast<size_t>(memorySizeFor(view.width, view.height, view.type)) > size)
+            return false;
+        return true;
+    }
+
+private:
+    static void writeHeaderToMemory(
+        void *buffer,
+        uint64_t index,
+        const microseconds_t &time,
+        int width,
+        int height,
+        int type)
+    {
+        auto ptr = static_cast<unsigned char *>(buffer);
+        const int channels = CV_MAT_CN(type);
+        const int64_t timeC = time.count();
+        size_t offset = 0;
+
+        std::memcpy(ptr + offset, &index, sizeof(index));
+        offset += sizeof(index);
+        std::memcpy(ptr + offset, &timeC, sizeof(timeC));
+        offset += sizeof(timeC);
+
+        std::memcpy(ptr + offset, &width, sizeof(width));
+        offset += sizeof(width);
+        std::memcpy(ptr + offset, &height, sizeof(height));
+        offset += sizeof(height);
+        std::memcpy(ptr + offset, &channels, sizeof(channels));
+        offset += sizeof(channels);
+        std::memcpy(ptr + offset, &type, sizeof(type));
+    }
+
+    static void readHeaderFromMemory(const unsigned char *ptr, MemoryView &header)
+    {
+        int channels;
+        int64_t timeC;
+        size_t offset = 0;
+
+        // unpack index and timestamp
+        std::memcpy(&header.index, ptr + offset, sizeof(header.index));
+        offset += sizeof(header.index);
+        std::memcpy(&timeC, ptr + offset, sizeof(timeC));
+        offset += sizeof(timeC);
+        header.time = microseconds_t(timeC);
+
+        // unpack image metadata
+        std::memcpy(&header.width, ptr + offset, sizeof(header.width));
+        offset += sizeof(header.width);
+        std::memcpy(&header.height, ptr + offset, sizeof(header.height));
+        offset += sizeof(header.height);
+        std::memcpy(&channels, ptr + offset, sizeof(channels));
+        offset += sizeof(channels);
+        std::memcpy(&header.type, ptr + offset, sizeof(header.type));
+        header.pixels = ptr + headerSize;
     }
 };
 
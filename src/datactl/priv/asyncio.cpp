@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "asyncio.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <format>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#ifdef SY_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include "datactl/loginternal.h"
+
+SY_DEFINE_LOG_CATEGORY(logAsyncIO, "asyncio");
+
+namespace Syntalos
+{
+
+enum class AsyncOpKind {
+    Write = 0,
+    Sync = 1
+};
+
+struct AsyncOp {
+    AsyncOpKind kind{AsyncOpKind::Write};
+    uint64_t offset{0};
+    ByteVector data;
+    size_t done{0}; /// Bytes of data already written, writes may complete partially
+    uint64_t tag{0};
+};
+
+/**
+ * @brief Shared state of one file written through the AsyncIOService
+ *
+ * Only one operation per file is executed at a time, which keeps writes ordered.
+ * The operation in `current` is owned by the I/O backend while `busy` is set,
+ * everything else is protected by `mutex`.
+ */
+struct AsyncFileState {
+    int fd{-1};
+    size_t maxInFlight{16};
+    std::function<void(const AsyncWriteCompletion &)> callback;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<AsyncOp> queue;
+    AsyncOp current;
+    bool busy{false};
+    size_t pending{0}; /// Queued operations plus the one being executed
+    bool failed{false};
+    std::string error;
+    std::vector<ByteVector> spareBuffers;
+};
+
+/**
+ * Conclude the current operation of @p file with result @p res, and start its next one.
+ * The file state must not be touched anymore once `busy` was cleared, as the
+ * writer may then close and destroy it.
+ */
+static void finishOperation(AsyncIOService *service, AsyncFileState *file, int64_t res)
+{
+    std::unique_lock<std::mutex> lock(file->mutex);
+    auto &op = file->current;
+
+    if (res == -EINTR || res == -EAGAIN) {
+        lock.unlock();
+        service->dispatch(file);
+        return;
+    }
+    if (op.kind == AsyncOpKind::Write && res >= 0) {
+        op.done += static_cast<size_t>(res);
+        if (res > 0 && op.done < op.data.size()) {
+            // short write, continue with the remainder
+            lock.unlock();
+            service->dispatch(file);
+            return;
+        }
+        res = (op.done < op.data.size()) ? -EIO : static_cast<int64_t>(op.done);
+    }
+
+    if (res < 0 && !file->failed) {
+        file->failed = true;
+        file->error = std::strerror(static_cast<int>(-res));
+        SY_LOG_ERROR(logAsyncIO, "Asynchronous write to fd {} failed: {}", file->fd, file->error);
+    }
+
+    const AsyncWriteCompletion completion{op.tag, res};
+    if (op.kind == AsyncOpKind::Write && file->spareBuffers.size() < file->maxInFlight) {
+        op.data.clear();
+        file->spareBuffers.push_back(std::move(op.data));
+    }
+    op.data = ByteVector();
+    file->pending--;
+    file->cond.notify_all();
+
+    // we are still busy while the callback runs, so completions are reported in order
+    if (file->callback) {
+        lock.unlock();
+        file->callback(completion);
+        lock.lock();
+    }
+
+    if (file->failed) {
+        file->pending -= file->queue.size();
+        file->queue.clear();
+    }
+    if (!file->queue.empty()) {
+        file->current = std::move(file->queue.front());
+        file->queue.pop_front();
+        lock.unlock();
+        service->dispatch(file);
+        return;
+    }
+
+    file->busy = false;
+    file->cond.notify_all();
+}
+
+/**
+ * Execute the current operation of @p file synchronously.
+ * @return Bytes written, or a negative errno value.
+ */
+static int64_t executeOperationSync(AsyncFileState *file)
+{
+    const auto &op = file->current;
+    if (op.kind == AsyncOpKind::Sync)
+        return (fdatasync(file->fd) == 0) ? 0 : -errno;
+
+    const auto res = pwrite(
+        file->fd,
+        op.data.data() + op.done,
+        op.data.size() - op.done,
+        static_cast<off_t>(op.offset + op.done));
+    return (res >= 0) ? res : -errno;
+}
+
+class AsyncIOService::Private
+{
+public:
+    bool useUring{false};
+#ifdef SY_HAVE_LIBURING
+    io_uring ring{};
+    std::mutex sqMutex;
+    std::thread completionThread;
+#endif
+
+    // fallback thread pool
+    std::mutex poolMutex;
+    std::condition_variable poolCond;
+    std::deque<AsyncFileState *> poolQueue;
+    std::vector<std::thread> poolThreads;
+    bool stopPool{false};
+};
+
+AsyncIOService *AsyncIOService::instance()
+{
+    static AsyncIOService service;
+    return &service;
+}
+
+AsyncIOService::AsyncIOService()
+    : d(new AsyncIOService::Private)
+{
+#ifdef SY_HAVE_LIBURING
+    const auto ret = io_uring_queue_init(256, &d->ring, 0);
+    if (ret == 0) {
+        d->useUring = true;
+        d->completionThread = std::thread([this]() {
+            pthread_setname_np(pthread_self(), "sy-asyncio");
+            for (;;) {
+                io_uring_cqe *cqe = nullptr;
+                const auto wret = io_uring_wait_cqe(&d->ring, &cqe);
+                if (wret == -EINTR)
+                    continue;
+                if (wret < 0) {
+                    SY_LOG_ERROR(logAsyncIO, "Waiting for io_uring completions failed: {}", std::strerror(-wret));
+                    break;
+                }
+
+                auto file = static_cast<AsyncFileState *>(io_uring_cqe_get_data(cqe));
+                const int64_t res = cqe->res;
+                io_uring_cqe_seen(&d->ring, cqe);
+
+                // a completion without file is our request to shut down
+                if (file == nullptr)
+                    break;
+                finishOperation(this, file, res);
+            }
+        });
+        SY_LOG_DEBUG(logAsyncIO, "Using io_uring for asynchronous writes");
+        return;
+    }
+    SY_LOG_INFO(logAsyncIO, "Unable to set up io_uring ({}), using I/O threads instead", std::strerror(-ret));
+#endif
+
+    const auto threadCount = std::clamp(std::thread::hardware_concurrency() / 4, 2U, 4U);
+    for (uint i = 0; i < threadCount; i++) {
+        d->poolThreads.emplace_back([this]() {
+            pthread_setname_np(pthread_self(), "sy-asyncio");
+            for (;;) {
+                AsyncFileState *file;
+                {
+                    std::unique_lock<std::mutex> lock(d->poolMutex);
+                    d->poolCond.wait(lock, [this] {
+                        return d->stopPool || !d->poolQueue.empty();
+                    });
+                    if (d->poolQueue.empty())
+                        break;
+                    file = d->poolQueue.front();
+                    d->poolQueue.pop_front();
+                }
+
+                finishOperation(this, file, executeOperationSync(file));
+            }
+        });
+    }
+}
+
+AsyncIOService::~AsyncIOService()
+{
+#ifdef SY_HAVE_LIBURING
+    if (d->useUring) {
+        {
+            std::lock_guard<std::mutex> lock(d->sqMutex);
+            auto sqe = io_uring_get_sqe(&d->ring);
+            while (sqe == nullptr) {
+                io_uring_submit(&d->ring);
+                sqe = io_uring_get_sqe(&d->ring);
+            }
+            io_uring_prep_nop(sqe);
+            io_uring_sqe_set_data(sqe, nullptr);
+            io_uring_submit(&d->ring);
+        }
+        d->completionThread.join();
+        io_uring_queue_exit(&d->ring);
+        return;
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(d->poolMutex);
+        d->stopPool = true;
+    }
+    d->poolCond.notify_all();
+    for (auto &thread : d->poolThreads)
+        thread.join();
+}
+
+const char *AsyncIOService::backendName() const
+{
+    return d->useUring ? "io_uring" : "threadpool";
+}
+
+void AsyncIOService::dispatch(AsyncFileState *file)
+{
+#ifdef SY_HAVE_LIBURING
+    if (d->useUring) {
+        const auto &op = file->current;
+        std::lock_guard<std::mutex> lock(d->sqMutex);
+        auto sqe = io_uring_get_sqe(&d->ring);
+        while (sqe == nullptr) {
+            // submission queue is full, hand its contents to the kernel to make room
+            io_uring_submit(&d->ring);
+            sqe = io_uring_get_sqe(&d->ring);
+        }
+
+        if (op.kind == AsyncOpKind::Sync)
+            io_uring_prep_fsync(sqe, file->fd, IORING_FSYNC_DATASYNC);
+        else
+            io_uring_prep_write(
+                sqe,
+                file->fd,
+                op.data.data() + op.done,
+                static_cast<unsigned>(op.data.size() - op.done),
+                op.offset + op.done);
+        io_uring_sqe_set_data(sqe, file);
+        io_uring_submit(&d->ring);
+        return;
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(d->poolMutex);
+        d->poolQueue.push_back(file);
+    }
+    d->poolCond.notify_one();
+}
+
+AsyncFileWriter::AsyncFileWriter(size_t maxInFlight)
+    : m_maxInFlight(std::max<size_t>(maxInFlight, 1)),
+      m_appendOffset(0)
+{
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    close();
+}
+
+void AsyncFileWriter::setMaxInFlight(size_t count)
+{
+    m_maxInFlight = std::max<size_t>(count, 1);
+}
+
+size_t AsyncFileWriter::maxInFlight() const
+{
+    return m_maxInFlight;
+}
+
+void AsyncFileWriter::setCompletionCallback(const std::function<void(const AsyncWriteCompletion &)> &callback)
+{
+    m_callback = callback;
+}
+
+std::expected<void, std::string> AsyncFileWriter::open(const std::string &fname, bool truncate)
+{
+    close();
+
+    const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    const int fd = ::open(fname.c_str(), flags, 0644);
+    if (fd < 0)
+        return std::unexpected(std::format("Unable to open {}: {}", fname, std::strerror(errno)));
+
+    m_state = std::make_shared<AsyncFileState>();
+    m_state->fd = fd;
+    m_state->maxInFlight = m_maxInFlight;
+    m_state->callback = m_callback;
+    m_fname = fname;
+
+    const auto end = truncate ? 0 : lseek(fd, 0, SEEK_END);
+    m_appendOffset = (end > 0) ? static_cast<uint64_t>(end) : 0;
+
+    // make sure the service (and its threads) exist before the first write
+    AsyncIOService::instance();
+    return {};
+}
+
+bool AsyncFileWriter::isOpen() const
+{
+    return m_state && m_state->fd >= 0;
+}
+
+std::string AsyncFileWriter::fileName() const
+{
+    return m_fname;
+}
+
+bool AsyncFileWriter::close()
+{
+    if (!isOpen())
+        return !hasError();
+
+    const auto ok = drain();
+    if (::close(m_state->fd) != 0 && ok) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->failed = true;
+        m_state->error = std::strerror(errno);
+    }
+    m_state->fd = -1;
+    m_state->spareBuffers.clear();
+
+    return !hasError();
+}
+
+ByteVector AsyncFileWriter::takeBuffer()
+{
+    if (!m_state)
+        return {};
+
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (m_state->spareBuffers.empty())
+        return {};
+    auto buffer = std::move(m_state->spareBuffers.back());
+    m_state->spareBuffers.pop_back();
+    return buffer;
+}
+
+bool AsyncFileWriter::submit(int kind, uint64_t offset, ByteVector &&data, uint64_t tag)
+{
+    if (!isOpen())
+        return false;
+
+    auto file = m_state.get();
+    std::unique_lock<std::mutex> lock(file->mutex);
+    file->cond.wait(lock, [file] {
+        return file->failed || file->pending < file->maxInFlight;
+    });
+    if (file->failed)
+        return false;
+
+    AsyncOp op;
+    op.kind = static_cast<AsyncOpKind>(kind);
+    op.offset = offset;
+    op.data = std::move(data);
+    op.tag = tag;
+
+    file->pending++;
+    if (file->busy) {
+        file->queue.push_back(std::move(op));
+        return true;
+    }
+
+    file->busy = true;
+    file->current = std::move(op);
+    lock.unlock();
+    AsyncIOService::instance()->dispatch(file);
+    return true;
+}
+
+bool AsyncFileWriter::append(ByteVector &&data, uint64_t tag)
+{
+    const auto size = data.size();
+    if (!submit(static_cast<int>(AsyncOpKind::Write), m_appendOffset, std::move(data), tag))
+        return false;
+    m_appendOffset += size;
+    return true;
+}
+
+bool AsyncFileWriter::writeAt(uint64_t offset, ByteVector &&data, uint64_t tag)
+{
+    return submit(static_cast<int>(AsyncOpKind::Write), offset, std::move(data), tag);
+}
+
+bool AsyncFileWriter::sync(uint64_t tag)
+{
+    return submit(static_cast<int>(AsyncOpKind::Sync), 0, ByteVector(), tag);
+}
+
+bool AsyncFileWriter::drain()
+{
+    if (!m_state)
+        return true;
+
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->cond.wait(lock, [this] {
+        return !m_state->busy;
+    });
+    return !m_state->failed;
+}
+
+bool AsyncFileWriter::truncate(uint64_t size)
+{
+    if (!isOpen() || !drain())
+        return false;
+
+    if (ftruncate(m_state->fd, static_cast<off_t>(size)) != 0) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->failed = true;
+        m_state->error = std::strerror(errno);
+        return false;
+    }
+    m_appendOffset = size;
+    return true;
+}
+
+uint64_t AsyncFileWriter::appendOffset() const
+{
+    return m_appendOffset;
+}
+
+bool AsyncFileWriter::hasError() const
+{
+    if (!m_state)
+        return false;
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->failed;
+}
+
+std::string AsyncFileWriter::lastError() const
+{
+    if (!m_state)
+        return {};
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->error;
+}
+
+} // namespace Syntalos
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "datactl/binarystream.h"
+
+namespace Syntalos
+{
+
+struct AsyncFileState;
+
+/**
+ * @brief Result of one asynchronous file operation
+ */
+struct AsyncWriteCompletion {
+    uint64_t tag;   /// Tag the operation was submitted with
+    int64_t result; /// Bytes written (0 for syncs), or a negative errno value
+};
+
+/**
+ * @brief Process-wide service that performs file writes off the calling thread
+ *
+ * Writes are executed via io_uring if it is available, otherwise (or if the kernel
+ * refuses to set up a ring) by a small pool of I/O threads.
+ * Writers do not use this class directly, but submit their data through an
+ * AsyncFileWriter.
+ */
+class AsyncIOService
+{
+public:
+    static AsyncIOService *instance();
+    ~AsyncIOService();
+
+    /**
+     * Name of the active backend, "io_uring" or "threadpool".
+     */
+    [[nodiscard]] const char *backendName() const;
+
+    /// Start executing the current operation of @p file (internal)
+    void dispatch(AsyncFileState *file);
+
+private:
+    explicit AsyncIOService();
+    AsyncIOService(const AsyncIOService &) = delete;
+    AsyncIOService &operator=(const AsyncIOService &) = delete;
+
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+/**
+ * @brief A file that is written asynchronously by the AsyncIOService
+ *
+ * Operations are executed strictly in submission order, so overlapping writes
+ * (e.g. an index that is rewritten at the end of a growing file) behave exactly
+ * like they would with synchronous writes.
+ * Submitting only blocks if the configured amount of operations is still in
+ * flight for this file, which throttles producers that are faster than the disk.
+ *
+ * Errors are sticky: once an operation failed, all further operations on the file
+ * are discarded and hasError() returns true.
+ */
+class AsyncFileWriter
+{
+public:
+    explicit AsyncFileWriter(size_t maxInFlight = 16);
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter &) = delete;
+    AsyncFileWriter &operator=(const AsyncFileWriter &) = delete;
+
+    /**
+     * Set the maximum amount of operations that may be queued or in flight for this file.
+     * Must be called before open().
+     */
+    void setMaxInFlight(size_t count);
+    [[nodiscard]] size_t maxInFlight() const;
+
+    /**
+     * Set a function that is called for every finished operation, in submission order.
+     * It is invoked on an I/O thread and must not block.
+     * Must be called before open().
+     */
+    void setCompletionCallback(const std::function<void(const AsyncWriteCompletion &)> &callback);
+
+    std::expected<void, std::string> open(const std::string &fname, bool truncate = true);
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] std::string fileName() const;
+
+    /**
+     * Wait for all pending operations and close the file.
+     * Returns false if any operation failed.
+     */
+    bool close();
+
+    /**
+     * Get an empty buffer to fill with data for the next write. Buffers of
+     * completed writes are recycled, so their memory is reused.
+     */
+    ByteVector takeBuffer();
+
+    /**
+     * Write @p data at the current end of the data appended so far.
+     */
+    bool append(ByteVector &&data, uint64_t tag = 0);
+
+    /**
+     * Write @p data at the absolute file position @p offset.
+     */
+    bool writeAt(uint64_t offset, ByteVector &&data, uint64_t tag = 0);
+
+    /**
+     * Flush all previously submitted data to the storage device (fdatasync),
+     * without waiting for it.
+     */
+    bool sync(uint64_t tag = 0);
+
+    /**
+     * Block until all submitted operations have completed.
+     * Returns false if any operation failed.
+     */
+    bool drain();
+
+    /**
+     * Wait for all pending writes, then truncate the file to @p size bytes
+     * and continue appending at that position.
+     */
+    bool truncate(uint64_t size);
+
+    /**
+     * Position at which the next append() will write.
+     */
+    [[nodiscard]] uint64_t appendOffset() const;
+
+    [[nodiscard]] bool hasError() const;
+    [[nodiscard]] std::string lastError() const;
+
+private:
+    bool submit(int kind, uint64_t offset, ByteVector &&data, uint64_t tag);
+
+    std::shared_ptr<AsyncFileState> m_state;
+    std::string m_fname;
+    size_t m_maxInFlight;
+    uint64_t m_appendOffset;
+    std::function<void(const AsyncWriteCompletion &)> m_callback;
+};
+
+} // namespace Syntalos
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "perfprofile.h"
+
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <xxhash.h>
+
+using namespace Syntalos;
+
+// SPROF file magic number (saved as LE, UTF-8 encoded after 0x8A guard): 8A S P R O F
+#define SPROF_FILE_MAGIC         UINT64_C(0x0000464F5250538A)
+#define SPROF_FILE_VERSION_MAJOR 1
+#define SPROF_FILE_VERSION_MINOR 0
+
+std::string Syntalos::perfSeriesKindToString(PerfSeriesKind kind)
+{
+    switch (kind) {
+    case PerfSeriesKind::CPU_USAGE:
+        return "cpu-usage";
+    case PerfSeriesKind::RESIDENT_MEMORY:
+        return "resident-memory";
+    case PerfSeriesKind::QUEUE_DEPTH:
+        return "queue-depth";
+    case PerfSeriesKind::QUEUE_BYTES:
+        return "queue-bytes";
+    case PerfSeriesKind::ITEM_RATE:
+        return "item-rate";
+    case PerfSeriesKind::DROPPED_ITEMS:
+        return "dropped";
+    case PerfSeriesKind::THROTTLED_ITEMS:
+        return "throttled";
+    default:
+        return "unknown";
+    }
+}
+
+std::string Syntalos::perfSeriesKindUnit(PerfSeriesKind kind)
+{
+    switch (kind) {
+    case PerfSeriesKind::CPU_USAGE:
+        return "%";
+    case PerfSeriesKind::RESIDENT_MEMORY:
+    case PerfSeriesKind::QUEUE_BYTES:
+        return "bytes";
+    case PerfSeriesKind::ITEM_RATE:
+        return "items/s";
+    case PerfSeriesKind::QUEUE_DEPTH:
+    case PerfSeriesKind::DROPPED_ITEMS:
+    case PerfSeriesKind::THROTTLED_ITEMS:
+        return "items";
+    default:
+        return "?";
+    }
+}
+
+template<class T>
+static void appendLE(ByteVector &buf, T val)
+{
+    static_assert(std::is_arithmetic_v<T>);
+    if constexpr (std::is_floating_point_v<T>) {
+        appendLE(buf, std::bit_cast<uint32_t>(static_cast<float>(val)));
+    } else {
+        if constexpr (std::endian::native == std::endian::big)
+            val = std::byteswap(val);
+        const auto bytes = reinterpret_cast<const std::byte *>(&val);
+        buf.insert(buf.end(), bytes, bytes + sizeof(val));
+    }
+}
+
+static void appendString(ByteVector &buf, const std::string &str)
+{
+    appendLE<uint32_t>(buf, static_cast<uint32_t>(str.size()));
+    const auto bytes = reinterpret_cast<const std::byte *>(str.data());
+    buf.insert(buf.end(), bytes, bytes + str.size());
+}
+
+static void appendChecksum(ByteVector &buf, size_t start)
+{
+    appendLE<uint64_t>(buf, XXH3_64bits(buf.data() + start, buf.size() - start));
+}
+
+// ============================================================
+// PerfProfileWriter
+// ============================================================
+
+PerfProfileWriter::PerfProfileWriter()
+    : m_file(8),
+      m_seriesCount(0)
+{
+}
+
+PerfProfileWriter::~PerfProfileWriter()
+{
+    close();
+}
+
+std::string PerfProfileWriter::lastError() const
+{
+    return m_lastError;
+}
+
+bool PerfProfileWriter::open(
+    const std::string &fname,
+    const Uuid &collectionId,
+    const std::vector<PerfProfileSeries> &series,
+    const milliseconds_t &interval)
+{
+    close();
+    if (auto res = m_file.open(fname); !res) {
+        m_lastError = res.error();
+        return false;
+    }
+    m_seriesCount = series.size();
+
+    const auto creationTimeSecs = std::chrono::duration_cast<std::chrono::seconds>(
+                                      std::chrono::system_clock::now().time_since_epoch())
+                                      .count();
+
+    // file header - everything after the magic number is checksummed
+    auto header = m_file.takeBuffer();
+    appendLE<uint64_t>(header, SPROF_FILE_MAGIC);
+    appendLE<uint16_t>(header, SPROF_FILE_VERSION_MAJOR);
+    appendLE<uint16_t>(header, SPROF_FILE_VERSION_MINOR);
+    appendLE<int64_t>(header, static_cast<int64_t>(creationTimeSecs));
+    appendString(header, collectionId.toHex());
+    appendLE<uint32_t>(header, static_cast<uint32_t>(interval.count()));
+    appendLE<uint32_t>(header, static_cast<uint32_t>(series.size()));
+    for (const auto &s : series) {
+        appendLE<uint16_t>(header, static_cast<uint16_t>(s.kind));
+        appendString(header, s.source);
+    }
+    appendChecksum(header, sizeof(uint64_t));
+
+    if (!m_file.append(std::move(header))) {
+        m_lastError = m_file.lastError();
+        return false;
+    }
+
+    return true;
+}
+
+bool PerfProfileWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+void PerfProfileWriter::close()
+{
+    if (!m_file.isOpen())
+        return;
+    if (!m_file.close())
+        m_lastError = m_file.lastError();
+}
+
+bool PerfProfileWriter::writeSample(const microseconds_t &time, const std::vector<float> &values)
+{
+    if (values.size() != m_seriesCount) {
+        m_lastError = std::format("Expected {} values for profile sample, got {}", m_seriesCount, values.size());
+        return false;
+    }
+
+    // every sample is a fixed-size record: time, one value per series and a checksum
+    auto record = m_file.takeBuffer();
+    record.reserve(sizeof(int64_t) + (values.size() * sizeof(float)) + sizeof(uint64_t));
+    appendLE<int64_t>(record, time.count());
+    for (const auto v : values)
+        appendLE<float>(record, v);
+    appendChecksum(record, 0);
+
+    if (!m_file.append(std::move(record))) {
+        m_lastError = m_file.lastError();
+        return false;
+    }
+
+    return true;
+}
+
+// ============================================================
+// PerfProfileReader
+// ============================================================
+
+namespace
+{
+
+/**
+ * Sequential little-endian reader for a memory buffer.
+ */
+class ProfileDataReader
+{
+public:
+    explicit ProfileDataReader(const std::string &data)
+        : m_data(data),
+          m_pos(0),
+          m_ok(true)
+    {
+    }
+
+    template<class T>
+    T read()
+    {
+        T val{};
+        if (m_pos + sizeof(T) > m_data.size()) {
+            m_ok = false;
+            return val;
+        }
+        std::memcpy(&val, m_data.data() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        if constexpr (std::endian::native == std::endian::big)
+            val = std::byteswap(val);
+        return val;
+    }
+
+    std::string readString()
+    {
+        const auto len = read<uint32_t>();
+        if (!m_ok || m_pos + len > m_data.size()) {
+            m_ok = false;
+            return {};
+        }
+        auto str = m_data.substr(m_pos, len);
+        m_pos += len;
+        return str;
+    }
+
+    bool checksumValid(size_t start)
+    {
+        const auto expected = XXH3_64bits(m_data.data() + start, m_pos - start);
+        return read<uint64_t>() == expected && m_ok;
+    }
+
+    size_t pos() const
+    {
+        return m_pos;
+    }
+
+    size_t remaining() const
+    {
+        return m_data.size() - m_pos;
+    }
+
+    bool ok() const
+    {
+        return m_ok;
+    }
+
+private:
+    const std::string &m_data;
+    size_t m_pos;
+    bool m_ok;
+};
+
+} // namespace
+
+PerfProfileReader::PerfProfileReader()
+    : m_creationTime(0),
+      m_interval(0),
+      m_truncated(false)
+{
+}
+
+bool PerfProfileReader::open(const std::string &fname)
+{
+    std::ifstream file(fname, std::ios::binary);
+    if (!file) {
+        m_lastError = std::format("Unable to open file '{}' for reading.", fname);
+        return false;
+    }
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ProfileDataReader reader(data);
+    if (reader.read<uint64_t>() != SPROF_FILE_MAGIC) {
+        m_lastError = "Unable to read data: This file is not a valid performance profile.";
+        return false;
+    }
+
+    const auto formatVMajor = reader.read<uint16_t>();
+    const auto formatVMinor = reader.read<uint16_t>();
+    if (formatVMajor != SPROF_FILE_VERSION_MAJOR) {
+        m_lastError = std::format(
+            "Unable to read data: This file is using an incompatible format version: file {}.{} vs "
+            "supported {}.{}",
+            formatVMajor,
+            formatVMinor,
+            SPROF_FILE_VERSION_MAJOR,
+            SPROF_FILE_VERSION_MINOR);
+        return false;
+    }
+
+    m_creationTime = reader.read<int64_t>();
+    m_collectionId = Uuid::fromHex(reader.readString()).value_or(Uuid());
+    m_interval = milliseconds_t(reader.read<uint32_t>());
+
+    const auto seriesCount = reader.read<uint32_t>();
+    m_series.clear();
+    for (uint32_t i = 0; i < seriesCount && reader.ok(); i++) {
+        PerfProfileSeries s;
+        s.kind = static_cast<PerfSeriesKind>(reader.read<uint16_t>());
+        s.source = reader.readString();
+        m_series.push_back(std::move(s));
+    }
+
+    if (!reader.checksumValid(sizeof(uint64_t))) {
+        m_lastError = "Unable to read data: The profile header is damaged.";
+        return false;
+    }
+
+    // read samples until we hit the end, or the incomplete last sample of an aborted run
+    const size_t recordSize = sizeof(int64_t) + (m_series.size() * sizeof(float)) + sizeof(uint64_t);
+    m_times.clear();
+    m_values.clear();
+    m_truncated = false;
+    while (reader.remaining() > 0) {
+        if (reader.remaining() < recordSize) {
+            m_truncated = true;
+            break;
+        }
+
+        const auto start = reader.pos();
+        const auto time = microseconds_t(reader.read<int64_t>());
+        std::vector<float> values;
+        values.reserve(m_series.size());
+        for (size_t i = 0; i < m_series.size(); i++)
+            values.push_back(std::bit_cast<float>(reader.read<uint32_t>()));
+        if (!reader.checksumValid(start)) {
+            m_truncated = true;
+            break;
+        }
+
+        m_times.push_back(time);
+        m_values.push_back(std::move(values));
+    }
+
+    return true;
+}
+
+std::string PerfProfileReader::lastError() const
+{
+    return m_lastError;
+}
+
+Uuid PerfProfileReader::collectionId() const
+{
+    return m_collectionId;
+}
+
+time_t PerfProfileReader::creationTime() const
+{
+    return static_cast<time_t>(m_creationTime);
+}
+
+milliseconds_t PerfProfileReader::interval() const
+{
+    return m_interval;
+}
+
+std::vector<PerfProfileSeries> PerfProfileReader::series() const
+{
+    return m_series;
+}
+
+std::vector<microseconds_t> PerfProfileReader::times() const
+{
+    return m_times;
+}
+
+std::vector<std::vector<float>> PerfProfileReader::values() const
+{
+    return m_values;
+}
+
+bool PerfProfileReader::truncated() const
+{
+    return m_truncated;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "datactl/priv/asyncio.h"
+#include "datactl/syclock.h"
+#include "datactl/uuid.h"
+
+namespace Syntalos
+{
+
+/**
+ * @brief The quantity a performance profile series was sampled for
+ */
+enum class PerfSeriesKind : uint16_t {
+    UNKNOWN = 0,
+    CPU_USAGE = 1,       /// CPU time used in the sample interval, in percent of one core
+    RESIDENT_MEMORY = 2, /// Resident set size, in bytes
+    QUEUE_DEPTH = 3,     /// Items waiting in a connection queue
+    QUEUE_BYTES = 4,     /// Estimated memory held by the queued items of a connection, in bytes
+    ITEM_RATE = 5,       /// Items enqueued on a connection per second
+    DROPPED_ITEMS = 6,   /// Items discarded by the queue limit in the sample interval
+    THROTTLED_ITEMS = 7  /// Items skipped by the connection throttle in the sample interval
+};
+
+std::string perfSeriesKindToString(PerfSeriesKind kind);
+std::string perfSeriesKindUnit(PerfSeriesKind kind);
+
+/**
+ * @brief Description of one time series of a performance profile
+ */
+struct PerfProfileSeries {
+    PerfSeriesKind kind{PerfSeriesKind::UNKNOWN};
+    std::string source; /// Module, connection or process the series belongs to
+};
+
+/**
+ * @brief Writes a performance profile (.sprof) file
+ *
+ * A profile holds a fixed set of series that are sampled together at a regular
+ * interval. Every sample is checksummed individually, so a profile of a run that
+ * ended abruptly remains readable up to its last complete sample.
+ */
+class PerfProfileWriter
+{
+public:
+    explicit PerfProfileWriter();
+    ~PerfProfileWriter();
+
+    PerfProfileWriter(const PerfProfileWriter &) = delete;
+    PerfProfileWriter &operator=(const PerfProfileWriter &) = delete;
+
+    [[nodiscard]] std::string lastError() const;
+
+    bool open(
+        const std::string &fname,
+        const Uuid &collectionId,
+        const std::vector<PerfProfileSeries> &series,
+        const milliseconds_t &interval);
+    bool isOpen() const;
+    void close();
+
+    /**
+     * Write one sample, @p values must hold one value for every series.
+     */
+    bool writeSample(const microseconds_t &time, const std::vector<float> &values);
+
+private:
+    AsyncFileWriter m_file;
+    size_t m_seriesCount;
+    std::string m_lastError;
+};
+
+/**
+ * @brief Reads a performance profile (.sprof) file
+ */
+class PerfProfileReader
+{
+public:
+    explicit PerfProfileReader();
+
+    bool open(const std::string &fname);
+    [[nodiscard]] std::string lastError() const;
+
+    Uuid collectionId() const;
+    time_t creationTime() const;
+    milliseconds_t interval() const;
+    std::vector<PerfProfileSeries> series() const;
+
+    /**
+     * Time of each sample, relative to the start of the run.
+     */
+    std::vector<microseconds_t> times() const;
+
+    /**
+     * Values of each sample, in the order of series().
+     */
+    std::vector<std::vector<float>> values() const;
+
+    /**
+     * True if the file ended with an incomplete or damaged sample, which was skipped.
+     */
+    bool truncated() const;
+
+private:
+    std::string m_lastError;
+    Uuid m_collectionId;
+    int64_t m_creationTime;
+    milliseconds_t m_interval;
+    std::vector<PerfProfileSeries> m_series;
+    std::vector<microseconds_t> m_times;
+    std::vector<std::vector<float>> m_values;
+    bool m_truncated;
+};
+
+} // namespace Syntalos
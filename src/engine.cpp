@@ -43,6 +43,7 @@
 #include <QDBusReply>
 #include <QDBusUnixFileDescriptor>
 #include <QDateTime>
+#include <QEventLoop>
 #include <QMessageBox>
 #include <QStandardPaths>
 #include <QStorageInfo>
@@ -60,8 +61,10 @@
 #include "logging.h"
 
 #include "globalconfig.h"
+#include "moduleeventpool.h"
 #include "moduleeventthread.h"
 #include "networkcontroller.h"
+#include "perfprofiler.h"
 #include "modulelibrary.h"
 #include "mlinkmodule.h"
 #include "sysinfo.h"
@@ -193,11 +196,17 @@ public:
         }
     }
 
+    const ThreadCpuClock *cpuClock() const
+    {
+        return &m_cpuClock;
+    }
+
 private:
     bool m_created;
     Backend m_threadBackend;
     pthread_t m_pThread;
     std::unique_ptr<QThread> m_qThread;
+    ThreadCpuClock m_cpuClock;
 
     bool m_joined;
     ThreadDetails m_td;
@@ -211,6 +220,7 @@ private:
     {
         auto self = static_cast<SyThread *>(udata);
         pthread_setname_np(pthread_self(), qPrintable(self->m_td.name.mid(0, 15)));
+        self->m_cpuClock.captureCurrentThread();
 
         // set CPU affinity
         if (!self->m_td.cpuAffinity.empty())
@@ -246,6 +256,8 @@ public:
 
         size_t estBytesPerItem;  // O(1) per-item memory estimate
         size_t prevPendingCount; // previous tick's queue length
+        uint64_t prevDroppedCount; // items discarded by the queue limit at the previous tick
+        uint64_t prevLatencyCount; // items with traced queueing latency at the previous tick
     };
 
     std::vector<SubscriptionBufferWatchData> monitoredSubscriptions;
@@ -254,12 +266,16 @@ public:
     bool diskSpaceWarningEmitted;
     bool memoryWarningEmitted;
     bool subBufferWarningEmitted;
+    bool traceConnectionLatency;
     double prevMemAvailablePercent;
     bool emergencyOOMStop;
 
     QTimer diskSpaceCheckTimer;
     QTimer memCheckTimer;
     QTimer subBufferCheckTimer;
+
+    std::unique_ptr<PerfProfiler> perfProfiler;
+    QTimer perfProfileTimer;
 };
 
 class Engine::Private
@@ -284,6 +300,7 @@ public:
     ModuleLibrary *modLibrary;
     std::shared_ptr<SyncTimer> timer;
     std::vector<uint> mainThreadCoreAffinity;
+    uint eventPoolSize; // worker count of the shared event pool, 0 if evented modules use event threads
 
     QString exportBaseDir;
     QString exportDir;
@@ -359,9 +376,11 @@ Engine::Engine(QWidget *parentWidget)
     d->timer = std::make_shared<SyncTimer>();
     d->runIsEphemeral = false;
     d->mainThreadCoreAffinity.clear();
+    d->eventPoolSize = 0;
     d->runCount = 0;
     d->runCountPadding = 1;
     d->monitoring->emergencyOOMStop = d->gconf->emergencyOOMStop();
+    d->monitoring->traceConnectionLatency = false;
 
 #if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x0100010A)
     if (libusb_init_context(&d->usbCtx, nullptr, 0) != 0)
@@ -673,25 +692,32 @@ void Engine::setRunCountExpectedMax(int maxValue)
         d->runCountPadding = 3;
 }
 
-AbstractModule *Engine::createModule(const QString &id, const QString &name)
+std::expected<AbstractModule *, QString> Engine::createModule(const QString &id, const QString &name)
 {
     auto modInfo = d->modLibrary->moduleInfo(id);
     if (modInfo == nullptr)
-        return nullptr;
+        return std::unexpected(QStringLiteral("Module '%1' was not found.").arg(id));
 
     // Ensure we don't register a module twice that should only exist once
     if (modInfo->singleton()) {
         for (auto &emod : d->presentModules) {
             if (emod->id() == id)
-                return nullptr;
+                return std::unexpected(QStringLiteral("Module '%1' can only be added once.").arg(modInfo->name()));
         }
     }
 
     // notify others that we started to create & initialize a module
     emit moduleInitStarted();
 
+    // this loads the module's library, if that did not happen already
     auto mod = modInfo->createModule();
-    assert(mod);
+    if (mod == nullptr) {
+        auto reason = d->modLibrary->moduleLoadError(id);
+        if (reason.isEmpty())
+            reason = QStringLiteral("See the module loader log for details.");
+        emit moduleInitDone();
+        return std::unexpected(QStringLiteral("Failed to load module '%1': %2").arg(id, reason));
+    }
 
     // Ensure the module has exactly the ID we think it should have, and also
     // assign a sequential index to distinguish it.
@@ -715,15 +741,10 @@ AbstractModule *Engine::createModule(const QString &id, const QString &name)
     mod->setState(ModuleState::INITIALIZING);
     qApp->processEvents();
     if (!mod->initialize()) {
-        QMessageBox::critical(
-            d->parentWidget,
-            QStringLiteral("Module initialization failed"),
-            QStringLiteral("Failed to initialize module '%1', it can not be added. %2")
-                .arg(mod->id(), mod->lastError()),
-            QMessageBox::Ok);
+        const auto error = QStringLiteral("Failed to initialize module '%1': %2").arg(mod->id(), mod->lastError());
         removeModule(mod);
         emit moduleInitDone();
-        return nullptr;
+        return std::unexpected(error);
     }
     // Ensure modules are marked as initialized at this point, to make the initialize() guards
     // work. This call is inert if the module has already set it by itself.
@@ -1096,6 +1117,35 @@ static QList<AbstractModule *> computeModuleOrder(
     return result;
 }
 
+/**
+ * @brief Find the modules each module has to wait for before it can be prepared.
+ *
+ * A module needs the final stream metadata of every module it receives data from,
+ * so those have to be fully prepared first. Only upstream modules placed earlier
+ * in the start order are considered, which resolves cycles the same way the start
+ * order itself does.
+ */
+static QHash<AbstractModule *, QSet<AbstractModule *>> computePrepareDependencies(
+    const QList<AbstractModule *> &startOrder)
+{
+    QHash<AbstractModule *, QSet<AbstractModule *>> deps;
+    deps.reserve(startOrder.size());
+    for (qsizetype i = 0; i < startOrder.size(); i++) {
+        auto mod = startOrder[i];
+        auto &modDeps = deps[mod];
+        for (const auto &iport : mod->inPorts()) {
+            if (!iport->hasSubscription())
+                continue;
+            auto up = iport->outPort()->owner();
+            const auto upIdx = startOrder.indexOf(up);
+            if (upIdx >= 0 && upIdx < i)
+                modDeps.insert(up);
+        }
+    }
+
+    return deps;
+}
+
 /**
  * @brief Compute both the start order and stop order for all active modules.
  *
@@ -1494,10 +1544,35 @@ void Engine::onBufferMonitorEvent()
     constexpr size_t kTrendMinCount = 50; // ignore trend on trivial backlogs
 
     for (auto &msd : d->monitoring->monitoredSubscriptions) {
+        // a bounded queue discarding data is always worth a notice
+        const auto droppedCount = msd.sub->droppedCount();
+        const bool droppingData = droppedCount != msd.prevDroppedCount;
+        if (droppingData) {
+            if (msd.prevDroppedCount == 0)
+                LOG_WARNING(
+                    d->log,
+                    "Input queue limit reached for {}:{}[◁{}], data is being discarded ({})",
+                    msd.port->owner()->name(),
+                    msd.port->title(),
+                    msd.port->dataTypeName(),
+                    overflowPolicyToHumanString(msd.sub->overflowPolicy()));
+            msd.prevDroppedCount = droppedCount;
+            Q_EMIT connectionDropsChangedAtPort(msd.port, droppedCount);
+        }
+
+        // update the queueing latency display, if we are tracing it
+        if (d->monitoring->traceConnectionLatency) {
+            const auto latency = msd.sub->queueLatencyStats();
+            if (latency.count != msd.prevLatencyCount) {
+                msd.prevLatencyCount = latency.count;
+                Q_EMIT connectionLatencyChangedAtPort(msd.port, latency);
+            }
+        }
+
         const auto approxPending = msd.sub->approxPendingCount();
         if (approxPending == 0) {
             // check if there is anything to do
-            if (msd.heat == ConnectionHeatLevel::NONE)
+            if (msd.heat == ConnectionHeatLevel::NONE && !droppingData)
                 continue;
         } else {
             // only guess the size if we have some items pending and don't know it already
@@ -1532,7 +1607,12 @@ void Engine::onBufferMonitorEvent()
         }
         msd.prevPendingCount = approxPending;
 
-        // 4. emit only on level change
+        // 4. a queue that is actively discarding data is at its limit, even if
+        //    that limit is small enough to not cause memory pressure
+        if (droppingData)
+            heat = std::max(heat, ConnectionHeatLevel::LOW);
+
+        // 5. emit only on level change
         if (heat != msd.heat) {
             msd.heat = heat;
             Q_EMIT connectionHeatChangedAtPort(msd.port, heat);
@@ -1570,6 +1650,14 @@ void Engine::onBufferMonitorEvent()
     d->monitoring->subBufferWarningEmitted = subBufferWarningEmitted;
 }
 
+void Engine::onPerfProfileEvent()
+{
+    // only sample once the master timer is running
+    if (!d->running || !d->monitoring->perfProfiler)
+        return;
+    d->monitoring->perfProfiler->sample(d->timer->timeSinceStartUsec());
+}
+
 void Engine::startResourceMonitoring(QList<AbstractModule *> activeModules, const QString &exportDirPath)
 {
     // watcher for disk space
@@ -1586,6 +1674,7 @@ void Engine::startResourceMonitoring(QList<AbstractModule *> activeModules, cons
     connect(&d->monitoring->memCheckTimer, &QTimer::timeout, this, &Engine::onMemoryMonitorEvent);
 
     // watcher for subscription buffer
+    d->monitoring->traceConnectionLatency = d->gconf->traceConnectionLatency();
     d->monitoring->monitoredSubscriptions.clear();
     for (auto &mod : activeModules) {
         for (auto &port : mod->inPorts()) {
@@ -1597,10 +1686,15 @@ void Engine::startResourceMonitoring(QList<AbstractModule *> activeModules, cons
             data.heat = ConnectionHeatLevel::NONE;
             data.estBytesPerItem = 0; // once, when needed
             data.prevPendingCount = 0;
+            data.prevDroppedCount = 0;
+            data.prevLatencyCount = 0;
+            data.sub->setLatencyTracing(d->monitoring->traceConnectionLatency);
             d->monitoring->monitoredSubscriptions.push_back(data);
 
-            // reset all connection heat levels
+            // reset all connection heat levels, drop counters and latencies
             Q_EMIT connectionHeatChangedAtPort(port.get(), ConnectionHeatLevel::NONE);
+            Q_EMIT connectionDropsChangedAtPort(port.get(), 0);
+            Q_EMIT connectionLatencyChangedAtPort(port.get(), QueueLatencyStats());
         }
     }
 
@@ -1608,10 +1702,16 @@ void Engine::startResourceMonitoring(QList<AbstractModule *> activeModules, cons
     d->monitoring->subBufferCheckTimer.setInterval(5 * MS_PER_S); // check every 5sec
     connect(&d->monitoring->subBufferCheckTimer, &QTimer::timeout, this, &Engine::onBufferMonitorEvent);
 
+    // sampler for the performance profile, if we record one
+    d->monitoring->perfProfileTimer.setInterval(1 * MS_PER_S);
+    connect(&d->monitoring->perfProfileTimer, &QTimer::timeout, this, &Engine::onPerfProfileEvent);
+
     // start resource watchers
     d->monitoring->diskSpaceCheckTimer.start();
     d->monitoring->memCheckTimer.start();
     d->monitoring->subBufferCheckTimer.start();
+    if (d->monitoring->perfProfiler)
+        d->monitoring->perfProfileTimer.start();
     LOG_INFO(d->log, "Started system resource monitoring.");
 }
 
@@ -1626,12 +1726,67 @@ void Engine::stopResourceMonitoring()
     d->monitoring->subBufferCheckTimer.stop();
     d->monitoring->subBufferCheckTimer.disconnect(this);
 
+    // the profiler references module threads, so it must be gone before they are joined
+    d->monitoring->perfProfileTimer.stop();
+    d->monitoring->perfProfileTimer.disconnect(this);
+    if (d->monitoring->perfProfiler) {
+        d->monitoring->perfProfiler->close();
+        d->monitoring->perfProfiler.reset();
+    }
+
     d->monitoring->monitoredSubscriptions.clear();
     d->monitoring->exportDirPath = QString();
 
     LOG_INFO(d->log, "Stopped monitoring system resources.");
 }
 
+void Engine::finalizeConnectionLatencyStats(const QList<AbstractModule *> &activeModules)
+{
+    if (!d->monitoring->traceConnectionLatency)
+        return;
+
+    MetaArray latencyList;
+    for (auto &mod : activeModules) {
+        for (auto &iport : mod->inPorts()) {
+            if (!iport->hasSubscription())
+                continue;
+            auto sub = iport->subscriptionVar();
+            if (!sub->latencyTracingEnabled())
+                continue;
+
+            // show the final values, the monitor may not have caught the last items
+            const auto latency = sub->queueLatencyStats();
+            Q_EMIT connectionLatencyChangedAtPort(iport.get(), latency);
+
+            MetaStringMap info;
+            if (auto oport = iport->outPort())
+                info["source"] = QStringLiteral("%1:%2").arg(oport->owner()->name(), oport->title()).toStdString();
+            info["target"] = QStringLiteral("%1:%2").arg(mod->name(), iport->title()).toStdString();
+            info["data_type"] = iport->dataTypeName().toStdString();
+            info["count"] = static_cast<int64_t>(latency.count);
+            info["p50_nsec"] = static_cast<int64_t>(latency.p50.count());
+            info["p99_nsec"] = static_cast<int64_t>(latency.p99.count());
+            info["max_nsec"] = static_cast<int64_t>(latency.max.count());
+            latencyList.push_back(info);
+
+            LOG_DEBUG(
+                d->log,
+                "Queueing latency for {}:{}[◁{}]: p50 {} ns, p99 {} ns, max {} ns ({} items)",
+                mod->name(),
+                iport->title(),
+                iport->dataTypeName(),
+                latency.p50.count(),
+                latency.p99.count(),
+                latency.max.count(),
+                latency.count);
+        }
+    }
+
+    // store the latencies with the other diagnostic data of this run
+    if (d->saveInternal && d->edlInternalData)
+        d->edlInternalData->insertAttribute("connection_queue_latency", latencyList);
+}
+
 bool Engine::finalizeExperimentMetadata(
     std::shared_ptr<EDLCollection> storageCollection,
     qint64 finishTimestamp,
@@ -1822,6 +1977,35 @@ static QHash<QString, QList<AbstractModule *>> computeEventThreadGroups(const QL
     return groups;
 }
 
+/**
+ * @brief Take all modules that can run on the event worker pool out of their event thread groups.
+ *
+ * Modules with precise timed events stay on their event thread, as only a dedicated
+ * thread can keep their deadlines. Groups that became empty are removed.
+ */
+static QList<AbstractModule *> takeEventPoolModules(QHash<QString, QList<AbstractModule *>> &evGroups)
+{
+    QList<AbstractModule *> poolMods;
+    for (auto it = evGroups.begin(); it != evGroups.end();) {
+        auto &groupMods = it.value();
+        for (auto modIt = groupMods.begin(); modIt != groupMods.end();) {
+            if ((*modIt)->preciseIntervalEventCallbacks().isEmpty()) {
+                poolMods.append(*modIt);
+                modIt = groupMods.erase(modIt);
+            } else {
+                ++modIt;
+            }
+        }
+
+        if (groupMods.isEmpty())
+            it = evGroups.erase(it);
+        else
+            ++it;
+    }
+
+    return poolMods;
+}
+
 /**
  * @brief Distribute the shared RtKit elevation budget across all module threads for a run.
  *
@@ -1889,10 +2073,13 @@ void Engine::allocatePriorityBudget(const ModuleRunOrder &modOrder, uint maxRtTh
     // thread. An event thread is elevated as a whole if at least one of its modules is
     // eligible, so all modules on it benefit from a single slot. The unit is elevated to
     // the strongest tier any of its modules asks for.
+    // If evented modules run on the event worker pool, all of them form a single unit
+    // which costs one slot per pool worker.
     struct ElevUnit {
         QList<AbstractModule *> mods; // modules sharing this unit's thread
         bool realtime;                // realtime (SCHED_RR) vs. niceness
         bool explicitReq;             // a module explicitly requested REALTIME (served first)
+        size_t cost{1};               // number of OS threads, and therefore budget slots, of this unit
     };
     QList<ElevUnit> units;
 
@@ -1910,7 +2097,14 @@ void Engine::allocatePriorityBudget(const ModuleRunOrder &modOrder, uint maxRtTh
     }
 
     // shared event threads: one thread per group, elevated for the whole group
-    const auto evGroups = computeEventThreadGroups(modOrder.start);
+    auto evGroups = computeEventThreadGroups(modOrder.start);
+    const auto poolGroupId = QStringLiteral("pool");
+    if (d->eventPoolSize > 0) {
+        // the pool dispatches events of all groups, so they share one (more expensive) unit
+        const auto poolMods = takeEventPoolModules(evGroups);
+        if (!poolMods.isEmpty())
+            evGroups.insert(poolGroupId, poolMods);
+    }
     for (auto it = evGroups.constBegin(); it != evGroups.constEnd(); ++it) {
         bool wantsRt = false;
         bool wantsNice = false;
@@ -1931,7 +2125,8 @@ void Engine::allocatePriorityBudget(const ModuleRunOrder &modOrder, uint maxRtTh
         }
         if (!wantsRt && !wantsNice)
             continue;
-        units.append(ElevUnit{it.value(), wantsRt, explicitReq});
+        const size_t cost = (d->eventPoolSize > 0 && it.key() == poolGroupId) ? d->eventPoolSize : 1;
+        units.append(ElevUnit{it.value(), wantsRt, explicitReq, cost});
     }
 
     if (units.isEmpty())
@@ -1952,26 +2147,32 @@ void Engine::allocatePriorityBudget(const ModuleRunOrder &modOrder, uint maxRtTh
     // Reserve one slot for the main engine thread (niced separately, starts first).
     size_t remaining = (maxRtThreads > 1) ? (maxRtThreads - 1) : 0;
 
-    if (static_cast<size_t>(units.length()) > remaining)
+    size_t requested = 0;
+    for (const auto &unit : units)
+        requested += unit.cost;
+    if (requested > remaining)
         LOG_WARNING(
             d->log,
             "Concurrent priority-elevation limit is {} (1 main + {} requested). Only the first {} threads "
             "will be elevated; the remaining {} will run at default priority.",
             maxRtThreads,
-            units.length(),
+            requested,
             remaining,
-            (units.length() - remaining));
+            (requested - remaining));
 
     for (const auto &unit : units) {
         if (remaining == 0)
             break;
+        // a worker pool is elevated as a whole or not at all, smaller units may still fit
+        if (unit.cost > remaining)
+            continue;
         for (auto *mod : unit.mods) {
             if (unit.realtime)
                 mod->setRealtimeApproved(true);
             else
                 mod->setDefaultThreadNiceness(defaultThreadNice);
         }
-        --remaining;
+        remaining -= unit.cost;
     }
 }
 
@@ -2006,6 +2207,19 @@ bool Engine::validateModuleNames(const ModuleRunOrder &modOrder)
     return true;
 }
 
+/**
+ * Process events until any of the given modules changes its state, or until the timeout
+ * has passed. The timeout catches changes that happened before we started waiting.
+ */
+static void waitForModuleStateChange(const QList<AbstractModule *> &mods, int timeoutMsec)
+{
+    QEventLoop loop;
+    for (auto mod : mods)
+        QObject::connect(mod, &AbstractModule::stateChanged, &loop, &QEventLoop::quit);
+    QTimer::singleShot(timeoutMsec, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
 bool Engine::waitForModulesReady(const ModuleRunOrder &modOrder)
 {
     // ensure all modules are in the READY state
@@ -2021,8 +2235,7 @@ bool Engine::waitForModulesReady(const ModuleRunOrder &modOrder)
             continue;
         emitStatusMessage(QStringLiteral("Waiting for '%1' to get ready...").arg(mod->name()));
         while (mod->state() != ModuleState::READY) {
-            QThread::msleep(250);
-            qApp->processEvents();
+            waitForModuleStateChange({mod}, 250);
             if (mod->state() == ModuleState::ERROR) {
                 emitStatusMessage(QStringLiteral("Module '%1' failed to initialize.").arg(mod->name()));
                 return false;
@@ -2136,12 +2349,15 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
         return false;
     }
 
-    // if we should save internal diagnostic data, create a group for it!
-    if (d->saveInternal) {
+    // if we should save internal diagnostic data or a performance profile, create a group for it!
+    const bool recordPerfProfile = d->gconf->recordPerfProfile();
+    d->edlInternalData.reset();
+    if (d->saveInternal || recordPerfProfile) {
         d->edlInternalData = std::make_shared<EDLGroup>();
         d->edlInternalData->setName("syntalos_internal");
         storageCollection->addChild(d->edlInternalData);
-        LOG_INFO(d->log, "Writing some internal data to datasets for debugging and analysis");
+        if (d->saveInternal)
+            LOG_INFO(d->log, "Writing some internal data to datasets for debugging and analysis");
     }
     d->internalTSyncWriters.clear();
 
@@ -2184,6 +2400,8 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
     // special event threads and their assigned modules, with a specific identifier string as hash key
     QHash<QString, QList<AbstractModule *>> eventModules;
     QHash<QString, std::shared_ptr<ModuleEventThread>> evThreads;
+    std::unique_ptr<ModuleEventPool> evPool;
+    QList<AbstractModule *> evPoolModules;
 
     // filter out dedicated-thread modules, those get special treatment
     for (auto &mod : modOrder.start) {
@@ -2204,6 +2422,15 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
     for (auto &mod : modOrder.start)
         mod->setPotentialNoaffinityCPUCount(potentialNoaffinityCPUCount);
 
+    // if requested, run evented modules on a worker pool sized to the cores we expect to be free,
+    // but never larger than the number of event threads it replaces
+    d->eventPoolSize = 0;
+    if (d->gconf->eventWorkerPool()) {
+        const auto evGroupCount = computeEventThreadGroups(modOrder.start).size();
+        if (evGroupCount > 1)
+            d->eventPoolSize = std::clamp<uint>(potentialNoaffinityCPUCount, 1, evGroupCount);
+    }
+
     qApp->processEvents();
 
     // distribute niceness slots across all module threads before preparing any module
@@ -2222,11 +2449,10 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
     }
 
     // prepare modules
-    for (auto &mod : modOrder.start) {
+    auto beginModulePrepare = [&](AbstractModule *mod) -> bool {
         // Prepare module. At this point it should have a timer,
         // the location where data is saved and be in the PREPARING state.
         emitStatusMessage(QStringLiteral("Preparing '%1'...").arg(mod->name()));
-        lastPhaseTimepoint = currentTimePoint();
 
         const auto modInfo = d->modLibrary->moduleInfo(mod->id());
 
@@ -2266,13 +2492,17 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
         mod->clearDataReceivedEventRegistrations();
 
         // prepare the module
-        if (!mod->prepare(d->testSubject)) {
-            initSuccessful = false;
-            d->failed = true;
-            d->runFailedReason = QStringLiteral("Prepare step failed for: %1(%2)").arg(mod->id(), mod->name());
-            emitStatusMessage(QStringLiteral("Module '%1' failed to prepare.").arg(mod->name()));
-            break;
-        }
+        return mod->prepare(d->testSubject);
+    };
+
+    auto failModulePrepare = [&](AbstractModule *mod) {
+        initSuccessful = false;
+        d->failed = true;
+        d->runFailedReason = QStringLiteral("Prepare step failed for: %1(%2)").arg(mod->id(), mod->name());
+        emitStatusMessage(QStringLiteral("Module '%1' failed to prepare.").arg(mod->name()));
+    };
+
+    auto finishModulePrepare = [&](AbstractModule *mod, const symaster_timepoint &prepareStartTime) {
         // If the module hasn't set itself to ready yet and is idle or preparing,
         // assume it is actually ready. Otherwise flag it as dormant.
         if (mod->state() == ModuleState::IDLE || mod->state() == ModuleState::PREPARING)
@@ -2295,7 +2525,105 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
             }
         }
 
-        LOG_INFO(d->log, "Module '{}' prepared in {} msec", mod->name(), timeDiffToNowMsec(lastPhaseTimepoint).count());
+        LOG_INFO(d->log, "Module '{}' prepared in {} msec", mod->name(), timeDiffToNowMsec(prepareStartTime).count());
+    };
+
+    if (d->gconf->concurrentPrepare()) {
+        // Out-of-process modules only get asked to prepare here, and finish while we continue with
+        // other modules, so their workers can prepare in parallel. A module is only prepared once all
+        // modules it receives data from are done, so it still sees their final stream metadata.
+        // In-process modules are prepared right away, as their prepare() may touch the UI.
+        const auto prepareDeps = computePrepareDependencies(modOrder.start);
+        QList<AbstractModule *> waitingMods = modOrder.start;
+        QHash<MLinkModule *, symaster_timepoint> preparingMods;
+        QSet<AbstractModule *> preparedMods;
+        qsizetype reportedPendingCount = 0;
+        const auto overallPrepareStart = currentTimePoint();
+
+        while (initSuccessful && (!waitingMods.isEmpty() || !preparingMods.isEmpty())) {
+            bool progress = false;
+
+            // begin preparing every module that no longer waits for others
+            for (auto it = waitingMods.begin(); it != waitingMods.end();) {
+                auto mod = *it;
+                if (!preparedMods.contains(prepareDeps[mod])) {
+                    ++it;
+                    continue;
+                }
+                it = waitingMods.erase(it);
+                progress = true;
+
+                const auto prepareStartTime = currentTimePoint();
+                auto mlinkMod = qobject_cast<MLinkModule *>(mod);
+                if (mlinkMod != nullptr)
+                    mlinkMod->setConcurrentPrepare(true);
+                const bool ok = beginModulePrepare(mod);
+                if (mlinkMod != nullptr)
+                    mlinkMod->setConcurrentPrepare(false);
+                if (!ok) {
+                    failModulePrepare(mod);
+                    break;
+                }
+
+                if (mlinkMod != nullptr && mlinkMod->prepareInProgress()) {
+                    preparingMods.insert(mlinkMod, prepareStartTime);
+                } else {
+                    finishModulePrepare(mod, prepareStartTime);
+                    preparedMods.insert(mod);
+                }
+            }
+            if (!initSuccessful)
+                break;
+
+            // check on the modules that are still preparing
+            for (auto it = preparingMods.begin(); it != preparingMods.end();) {
+                const auto res = it.key()->pollPrepare();
+                if (!res.has_value()) {
+                    ++it;
+                    continue;
+                }
+                auto mod = it.key();
+                const auto prepareStartTime = it.value();
+                it = preparingMods.erase(it);
+                progress = true;
+
+                if (!res.value()) {
+                    failModulePrepare(mod);
+                    break;
+                }
+                finishModulePrepare(mod, prepareStartTime);
+                preparedMods.insert(mod);
+            }
+            if (!initSuccessful || progress)
+                continue;
+
+            // nothing can happen until a module changes its state
+            QList<AbstractModule *> pendingMods;
+            pendingMods.reserve(preparingMods.size());
+            for (auto it = preparingMods.cbegin(); it != preparingMods.cend(); ++it)
+                pendingMods.append(it.key());
+            if (pendingMods.size() != reportedPendingCount) {
+                reportedPendingCount = pendingMods.size();
+                emitStatusMessage(QStringLiteral("Waiting for %1 module(s) to prepare...").arg(reportedPendingCount));
+            }
+            waitForModuleStateChange(pendingMods, 100);
+        }
+
+        if (initSuccessful)
+            LOG_INFO(
+                d->log,
+                "Prepared {} modules concurrently in {} msec",
+                modOrder.start.size(),
+                timeDiffToNowMsec(overallPrepareStart).count());
+    } else {
+        for (auto &mod : modOrder.start) {
+            const auto prepareStartTime = currentTimePoint();
+            if (!beginModulePrepare(mod)) {
+                failModulePrepare(mod);
+                break;
+            }
+            finishModulePrepare(mod, prepareStartTime);
+        }
     }
 
     // suspend input to and output from to all inactive modules
@@ -2413,6 +2741,43 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
         for (auto &mod : modOrder.start)
             mod->updateStartWaitCondition(startWaitCondition.get());
 
+        // run the event worker pool for all modules that selected an event-based driver, if enabled
+        // (modules with precise timers keep their event threads)
+        if (d->eventPoolSize > 0) {
+            const auto poolMods = takeEventPoolModules(eventModules);
+            bool evRealtime = false;
+            int evRtPriority = 0;
+            int evNiceness = 0;
+            for (auto *mod : poolMods) {
+                if (mod->isRealtimeApproved()) {
+                    evRealtime = true;
+                    evRtPriority = std::max(evRtPriority, mod->defaultRealtimePriority());
+                }
+                evNiceness = std::min(evNiceness, mod->defaultThreadNiceness());
+            }
+
+            // keep the workers off the cores that were given to dedicated module threads
+            std::vector<uint> poolAffinity;
+            if (!modCPUMap.isEmpty()) {
+                QSet<uint> usedCores;
+                for (const auto &cores : modCPUMap)
+                    usedCores.unite(QSet<uint>(cores.cbegin(), cores.cend()));
+                for (uint i = 0; i < cpuCoreCount; i++) {
+                    if (!usedCores.contains(i))
+                        poolAffinity.push_back(i);
+                }
+            }
+
+            evPool = std::make_unique<ModuleEventPool>(d->eventPoolSize);
+            evPool->run(poolMods, startWaitCondition.get(), poolAffinity, evRealtime, evRtPriority, evNiceness);
+            LOG_INFO(
+                d->log,
+                "Started event worker pool with {} workers for {} participating modules",
+                evPool->workerCount(),
+                poolMods.length());
+            evPoolModules = poolMods;
+        }
+
         // run special threads with built-in event loops for modules that selected an event-based driver
         for (auto it = eventModules.constBegin(); it != eventModules.constEnd(); ++it) {
             const auto &evThreadKey = it.key();
@@ -2462,6 +2827,39 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
             }
         }
 
+        // register everything we want to have in the performance profile of this run
+        if (recordPerfProfile && d->edlInternalData) {
+            auto profiler = std::make_unique<PerfProfiler>();
+            for (size_t i = 0; i < dThreads.size(); i++) {
+                if (dThreads[i])
+                    profiler->addThread(QString(), {threadedModules[i]}, dThreads[i]->cpuClock());
+            }
+            for (auto it = evThreads.constBegin(); it != evThreads.constEnd(); ++it)
+                profiler->addThread(it.value()->threadName(), eventModules.value(it.key()), it.value()->cpuClock());
+            if (evPool)
+                profiler->addThreadPool(QStringLiteral("event worker pool"), evPoolModules, evPool->workerCpuClocks());
+            for (auto &mod : modOrder.start) {
+                if (auto mlinkMod = qobject_cast<MLinkModule *>(mod))
+                    profiler->addProcess(mod, mlinkMod->workerProcessId());
+                for (auto &iport : mod->inPorts()) {
+                    if (iport->hasSubscription())
+                        profiler->addConnection(iport.get(), guessStreamItemSizeBytes(iport->subscriptionVar().get()));
+                }
+            }
+
+            auto ds = std::make_shared<EDLDataset>();
+            ds->setName("perf_profile");
+            d->edlInternalData->addChild(ds);
+            const auto res = profiler->open(
+                QString::fromStdString(ds->setDataFile("profile.sprof", "Performance profile of this run").string()),
+                storageCollection->collectionId(),
+                milliseconds_t(1000));
+            if (res.has_value())
+                d->monitoring->perfProfiler = std::move(profiler);
+            else
+                LOG_WARNING(d->log, "Unable to record performance profile: {}", res.error());
+        }
+
         // start monitoring resource issues during this run; the matching stop is
         // a scope guard so that an aborted start barrier (network timeout, user
         // stop, etc.) below cannot leave the monitoring timers running.
@@ -2629,6 +3027,10 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
         emitStatusMessage(QStringLiteral("Waiting for event thread `%1`...").arg(evThread->threadName()));
         evThread->stop();
     }
+    if (evPool) {
+        emitStatusMessage(QStringLiteral("Waiting for event worker pool..."));
+        evPool->stop();
+    }
     LOG_INFO(d->log, "Waited {} msec for event threads to stop.", timeDiffToNowMsec(lastPhaseTimepoint).count());
 
     // send stop command to all active modules in their designated stop order
@@ -2813,6 +3215,7 @@ bool Engine::runInternal(const QString &exportDirPath, const Uuid &recordingId)
         for (auto &tsw : d->internalTSyncWriters.values())
             tsw->close();
     }
+    finalizeConnectionLatencyStats(modOrder.start);
 
     if (initSuccessful) {
         finalizeExperimentMetadata(storageCollection, finishTimestamp, modOrder.start);
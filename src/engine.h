@@ -20,6 +20,7 @@
 #pragma once
 
 #include <QObject>
+#include <expected>
 #include <memory>
 
 #include "datactl/uuid.h"
@@ -124,7 +125,11 @@ public:
     int successRunsCount();
     void setRunCountExpectedMax(int maxValue);
 
-    AbstractModule *createModule(const QString &id, const QString &name = QString());
+    /**
+     * Create and initialize a new instance of module @p id.
+     * @return The new module, or a description of why it could not be created.
+     */
+    std::expected<AbstractModule *, QString> createModule(const QString &id, const QString &name = QString());
     bool removeModule(AbstractModule *mod);
     void removeAllModules();
 
@@ -195,6 +200,8 @@ signals:
 
     void resourceWarningUpdate(SystemResource kind, bool resolved, const QString &message);
     void connectionHeatChangedAtPort(VarStreamInputPort *iport, ConnectionHeatLevel hlevel);
+    void connectionDropsChangedAtPort(VarStreamInputPort *iport, quint64 droppedCount);
+    void connectionLatencyChangedAtPort(VarStreamInputPort *iport, const QueueLatencyStats &stats);
 
 private slots:
     void onModuleError(const QString &message);
@@ -207,6 +214,7 @@ private slots:
     void onDiskspaceMonitorEvent();
     void onMemoryMonitorEvent();
     void onBufferMonitorEvent();
+    void onPerfProfileEvent();
 
 private:
     class Private;
@@ -230,6 +238,7 @@ private:
     size_t guessStreamItemSizeBytes(VariantStreamSubscription *sub);
     void startResourceMonitoring(QList<AbstractModule *> activeModules, const QString &exportDirPath);
     void stopResourceMonitoring();
+    void finalizeConnectionLatencyStats(const QList<AbstractModule *> &activeModules);
 
     bool finalizeExperimentMetadata(
         std::shared_ptr<EDLCollection> storageCollection,
@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framepool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "logging.h"
+
+namespace Syntalos
+{
+
+static size_t pageRoundedSize(size_t size)
+{
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return ((size + pageSize - 1) / pageSize) * pageSize;
+}
+
+/**
+ * @brief OpenCV Mat allocator that recycles buffers
+ *
+ * The UMatData of a returned buffer is kept alongside it, so serving a buffer
+ * from the idle list does not touch the heap at all.
+ *
+ * cv::Mat headers keep a pointer to their allocator, even after their data was
+ * released. Therefore allocator instances are never deleted: once their pool is
+ * destroyed they only free the buffers that are still returned to them, and are
+ * handed to the next pool that is created.
+ */
+class FrameBufferPoolAllocator final : public cv::MatAllocator
+{
+public:
+    explicit FrameBufferPoolAllocator(const QString &name, uint maxIdlePerClass)
+    {
+        revive(name, maxIdlePerClass);
+    }
+
+    static FrameBufferPoolAllocator *create(const QString &name, uint maxIdlePerClass)
+    {
+        std::lock_guard<std::mutex> lock(s_orphansMutex);
+        if (s_orphans.empty())
+            return new FrameBufferPoolAllocator(name, maxIdlePerClass);
+
+        auto alloc = s_orphans.back();
+        s_orphans.pop_back();
+        alloc->revive(name, maxIdlePerClass);
+        return alloc;
+    }
+
+    void orphan()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            LOG_DEBUG(
+                m_log,
+                "Frame pool '{}' closed: {} hits, {} misses, {} evictions, {} buffers still in use",
+                m_name,
+                m_stats.hits,
+                m_stats.misses,
+                m_stats.evictions,
+                m_stats.buffersInUse);
+            m_orphaned = true;
+            trimLocked();
+        }
+
+        std::lock_guard<std::mutex> lock(s_orphansMutex);
+        s_orphans.push_back(this);
+    }
+
+    cv::UMatData *allocate(
+        int dims,
+        const int *sizes,
+        int type,
+        void *data0,
+        size_t *step,
+        cv::AccessFlag /*flags*/,
+        cv::UMatUsageFlags /*usageFlags*/) const override
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--) {
+            if (step) {
+                if (data0 && step[i] != CV_AUTOSTEP) {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                } else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+
+        if (data0) {
+            auto *u = new cv::UMatData(this);
+            u->data = u->origdata = static_cast<uchar *>(data0);
+            u->size = total;
+            u->flags |= cv::UMatData::USER_ALLOCATED;
+            return u;
+        }
+
+        auto u = takeBuffer(pageRoundedSize(total));
+        u->size = total;
+        return u;
+    }
+
+    bool allocate(cv::UMatData *u, cv::AccessFlag /*accessFlags*/, cv::UMatUsageFlags /*usageFlags*/) const override
+    {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData *u) const override
+    {
+        if (!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if (u->flags & cv::UMatData::USER_ALLOCATED) {
+            delete u;
+            return;
+        }
+
+        const auto classSize = pageRoundedSize(u->size);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.buffersInUse--;
+
+        if (!m_orphaned) {
+            auto &idle = m_idle[classSize];
+            if (idle.size() < m_maxIdlePerClass) {
+                idle.push_back(u);
+                m_stats.buffersIdle++;
+                return;
+            }
+            m_stats.evictions++;
+        }
+
+        unmapBuffer(u, classSize);
+    }
+
+    QString name() const
+    {
+        return m_name;
+    }
+
+    void setLockMemory(bool lock)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_lockMemory = lock;
+    }
+
+    bool lockMemory() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_lockMemory;
+    }
+
+    void reserve(size_t size, uint count)
+    {
+        const auto classSize = pageRoundedSize(size);
+        std::vector<cv::UMatData *> fresh;
+        fresh.reserve(count);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto target = std::min<size_t>(count, m_maxIdlePerClass);
+        while (m_idle[classSize].size() + fresh.size() < target) {
+            lock.unlock();
+            auto u = mapBuffer(classSize);
+            lock.lock();
+            if (!u)
+                break;
+            fresh.push_back(u);
+        }
+
+        auto &idle = m_idle[classSize];
+        idle.reserve(m_maxIdlePerClass);
+        for (auto u : fresh)
+            idle.push_back(u);
+        m_stats.buffersIdle += fresh.size();
+    }
+
+    void trim()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        trimLocked();
+    }
+
+    FrameBufferPoolStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    void resetStats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.hits = 0;
+        m_stats.misses = 0;
+        m_stats.evictions = 0;
+    }
+
+private:
+    QuillLogger *m_log;
+    QString m_name;
+    uint m_maxIdlePerClass;
+    bool m_lockMemory;
+    bool m_orphaned;
+    mutable bool m_lockFailed;
+
+    mutable std::mutex m_mutex;
+    mutable std::unordered_map<size_t, std::vector<cv::UMatData *>> m_idle;
+    mutable FrameBufferPoolStats m_stats;
+
+    static inline std::mutex s_orphansMutex;
+    static inline std::vector<FrameBufferPoolAllocator *> s_orphans;
+
+    void revive(const QString &name, uint maxIdlePerClass)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_log = getLogger("framepool");
+        m_name = name;
+        m_maxIdlePerClass = maxIdlePerClass;
+        m_lockMemory = false;
+        m_orphaned = false;
+        m_lockFailed = false;
+
+        // buffers of the previous owner that are still in flight stay accounted for,
+        // and join our idle lists once they are released
+        const auto inUse = m_stats.buffersInUse;
+        const auto bytesMapped = m_stats.bytesMapped;
+        m_stats = FrameBufferPoolStats();
+        m_stats.buffersInUse = inUse;
+        m_stats.bytesMapped = bytesMapped;
+    }
+
+    cv::UMatData *takeBuffer(size_t classSize) const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_idle.find(classSize);
+        if (it != m_idle.end() && !it->second.empty()) {
+            auto u = it->second.back();
+            it->second.pop_back();
+            m_stats.hits++;
+            m_stats.buffersIdle--;
+            m_stats.buffersInUse++;
+            lock.unlock();
+
+            // reset all bookkeeping OpenCV may have done on the previous use
+            auto data = u->origdata;
+            u->~UMatData();
+            new (u) cv::UMatData(this);
+            u->data = u->origdata = data;
+            return u;
+        }
+        m_stats.misses++;
+        m_stats.buffersInUse++;
+
+        // reserve the idle list for this class now, so returning buffers never allocates
+        if (it == m_idle.end())
+            m_idle[classSize].reserve(m_maxIdlePerClass);
+        lock.unlock();
+
+        auto u = mapBuffer(classSize);
+        if (!u) {
+            lock.lock();
+            m_stats.buffersInUse--;
+            throw std::bad_alloc();
+        }
+        return u;
+    }
+
+    cv::UMatData *mapBuffer(size_t classSize) const
+    {
+        // map and pre-fault the whole buffer at once, so the first frame written
+        // into it does not take a page fault for every page
+        auto data = mmap(nullptr, classSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (data == MAP_FAILED) {
+            LOG_ERROR(m_log, "Unable to map {} bytes for frame pool '{}': {}", classSize, m_name, std::strerror(errno));
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_lockMemory && !m_lockFailed && mlock(data, classSize) != 0) {
+            // this usually means RLIMIT_MEMLOCK is too low, we only complain about it once
+            m_lockFailed = true;
+            LOG_WARNING(m_log, "Unable to lock buffers of frame pool '{}' in memory: {}", m_name, std::strerror(errno));
+        }
+        m_stats.bytesMapped += classSize;
+
+        auto u = new cv::UMatData(this);
+        u->data = u->origdata = static_cast<uchar *>(data);
+        u->size = classSize;
+        return u;
+    }
+
+    // must be called with m_mutex held
+    void unmapBuffer(cv::UMatData *u, size_t classSize) const
+    {
+        munmap(u->origdata, classSize);
+        u->origdata = nullptr;
+        delete u;
+        m_stats.bytesMapped -= classSize;
+    }
+
+    void trimLocked()
+    {
+        for (auto &[classSize, idle] : m_idle) {
+            for (auto u : idle)
+                unmapBuffer(u, classSize);
+            idle.clear();
+        }
+        m_idle.clear();
+        m_stats.buffersIdle = 0;
+    }
+};
+
+FrameBufferPool::FrameBufferPool(const QString &name, uint maxIdlePerClass)
+    : m_alloc(FrameBufferPoolAllocator::create(name, maxIdlePerClass))
+{
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    m_alloc->orphan();
+}
+
+QString FrameBufferPool::name() const
+{
+    return m_alloc->name();
+}
+
+void FrameBufferPool::setLockMemory(bool lock)
+{
+    m_alloc->setLockMemory(lock);
+}
+
+bool FrameBufferPool::lockMemory() const
+{
+    return m_alloc->lockMemory();
+}
+
+cv::MatAllocator *FrameBufferPool::allocator() const
+{
+    return m_alloc;
+}
+
+cv::Mat FrameBufferPool::acquire(int rows, int cols, int type)
+{
+    cv::Mat mat;
+    mat.allocator = m_alloc;
+    mat.create(rows, cols, type);
+    return mat;
+}
+
+void FrameBufferPool::reserve(int rows, int cols, int type, uint count)
+{
+    m_alloc->reserve(static_cast<size_t>(rows) * static_cast<size_t>(cols) * CV_ELEM_SIZE(type), count);
+}
+
+void FrameBufferPool::trim()
+{
+    m_alloc->trim();
+}
+
+FrameBufferPoolStats FrameBufferPool::stats() const
+{
+    return m_alloc->stats();
+}
+
+void FrameBufferPool::resetStats()
+{
+    m_alloc->resetStats();
+}
+
+} // namespace Syntalos
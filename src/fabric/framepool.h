@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+namespace Syntalos
+{
+
+/**
+ * @brief Usage statistics of a FrameBufferPool
+ */
+struct FrameBufferPoolStats {
+    uint64_t hits{0};      /// allocations that were served from an idle buffer
+    uint64_t misses{0};    /// allocations that had to map a new buffer
+    uint64_t evictions{0}; /// returned buffers that were unmapped because their size class was full
+    size_t buffersInUse{0};
+    size_t buffersIdle{0};
+    size_t bytesMapped{0}; /// memory currently held by the pool, in use or idle
+};
+
+class FrameBufferPoolAllocator;
+
+/**
+ * @brief Recycling allocator for frame pixel buffers
+ *
+ * Matrices allocated through this pool return their buffer to the pool once the
+ * last cv::Mat referencing it is released, instead of freeing it. The next frame
+ * of the same size then reuses that buffer, so a steady-state acquisition loop
+ * does not allocate (or page-fault) any memory per frame.
+ *
+ * Buffers are binned into size classes by their page-rounded size, so frames of
+ * the same geometry and type always share a class. New buffers are mapped and
+ * pre-faulted in one go, and may optionally be locked into RAM.
+ *
+ * The pool may be destroyed while frames allocated from it are still in flight
+ * downstream; their buffers are then freed once they are released.
+ */
+class FrameBufferPool
+{
+public:
+    explicit FrameBufferPool(const QString &name, uint maxIdlePerClass = 8);
+    ~FrameBufferPool();
+
+    QString name() const;
+
+    /**
+     * Lock all buffers of this pool into RAM (mlock), so they can never be swapped out.
+     * Only affects buffers mapped after this setting was changed.
+     */
+    void setLockMemory(bool lock);
+    bool lockMemory() const;
+
+    /**
+     * The allocator of this pool. It can be assigned to cv::Mat::allocator to have
+     * OpenCV functions create their output matrices from this pool.
+     */
+    cv::MatAllocator *allocator() const;
+
+    /**
+     * Create a new matrix with its pixel buffer taken from this pool.
+     * The contents of the matrix are undefined.
+     */
+    cv::Mat acquire(int rows, int cols, int type);
+
+    /**
+     * Map @p count idle buffers for frames of the given geometry in advance.
+     */
+    void reserve(int rows, int cols, int type, uint count);
+
+    /**
+     * Unmap all idle buffers.
+     */
+    void trim();
+
+    FrameBufferPoolStats stats() const;
+    void resetStats();
+
+private:
+    Q_DISABLE_COPY(FrameBufferPool)
+    FrameBufferPoolAllocator *m_alloc;
+};
+
+} // namespace Syntalos
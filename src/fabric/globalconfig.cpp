@@ -156,6 +156,16 @@ void GlobalConfig::setExplicitCoreAffinities(bool enabled)
     m_s->setValue("engine/explicit_core_affinities", enabled);
 }
 
+bool GlobalConfig::eventWorkerPool() const
+{
+    return m_s->value("engine/event_worker_pool", false).toBool();
+}
+
+void GlobalConfig::setEventWorkerPool(bool enabled)
+{
+    m_s->setValue("engine/event_worker_pool", enabled);
+}
+
 bool GlobalConfig::showDevelModules() const
 {
     return m_s->value("devel/show_devel_modules", false).toBool();
@@ -221,6 +231,36 @@ void GlobalConfig::setEmergencyOOMStop(bool enabled)
     m_s->setValue("engine/emergency_oom_stop", enabled);
 }
 
+bool GlobalConfig::traceConnectionLatency() const
+{
+    return m_s->value("engine/trace_connection_latency", false).toBool();
+}
+
+void GlobalConfig::setTraceConnectionLatency(bool enabled)
+{
+    m_s->setValue("engine/trace_connection_latency", enabled);
+}
+
+bool GlobalConfig::recordPerfProfile() const
+{
+    return m_s->value("engine/record_perf_profile", true).toBool();
+}
+
+void GlobalConfig::setRecordPerfProfile(bool enabled)
+{
+    m_s->setValue("engine/record_perf_profile", enabled);
+}
+
+bool GlobalConfig::concurrentPrepare() const
+{
+    return m_s->value("engine/concurrent_prepare", false).toBool();
+}
+
+void GlobalConfig::setConcurrentPrepare(bool enabled)
+{
+    m_s->setValue("engine/concurrent_prepare", enabled);
+}
+
 bool GlobalConfig::netControlEnabled() const
 {
     return m_s->value("net_control/enabled", true).toBool();
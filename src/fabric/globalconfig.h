@@ -71,6 +71,9 @@ public:
     bool explicitCoreAffinities() const;
     void setExplicitCoreAffinities(bool enabled);
 
+    bool eventWorkerPool() const;
+    void setEventWorkerPool(bool enabled);
+
     bool showDevelModules() const;
     void setShowDevelModules(bool enabled);
 
@@ -90,6 +93,15 @@ public:
     bool emergencyOOMStop() const;
     void setEmergencyOOMStop(bool enabled);
 
+    bool traceConnectionLatency() const;
+    void setTraceConnectionLatency(bool enabled);
+
+    bool recordPerfProfile() const;
+    void setRecordPerfProfile(bool enabled);
+
+    bool concurrentPrepare() const;
+    void setConcurrentPrepare(bool enabled);
+
     bool netControlEnabled() const;
     void setNetControlEnabled(bool enabled);
 
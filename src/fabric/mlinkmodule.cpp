@@ -26,6 +26,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QCoreApplication>
+#include <expected>
 #include <iox2/iceoryx2.hpp>
 
 #include "mlink/ipc-types-private.h"
@@ -58,6 +59,63 @@ enum class IpcCallFlag {
 Q_DECLARE_FLAGS(IpcCallFlags, IpcCallFlag)
 Q_DECLARE_OPERATORS_FOR_FLAGS(IpcCallFlags)
 
+/**
+ * A request that was sent to the worker, but whose "Done" response
+ * has not been received yet.
+ */
+class PendingDoneCall
+{
+public:
+    explicit PendingDoneCall(const std::string &channel)
+        : m_channel(channel)
+    {
+    }
+    virtual ~PendingDoneCall() = default;
+
+    [[nodiscard]] std::string channel() const
+    {
+        return m_channel;
+    }
+
+    /**
+     * Check for a response without blocking.
+     * Returns the result of the call once a response has arrived, std::nullopt otherwise,
+     * or an error message if receiving failed.
+     */
+    virtual std::expected<std::optional<bool>, QString> tryReceive() = 0;
+
+private:
+    std::string m_channel;
+};
+
+template<typename Client, typename Pending>
+class PendingDoneCallImpl : public PendingDoneCall
+{
+public:
+    PendingDoneCallImpl(const std::string &channel, Client client, Pending pending)
+        : PendingDoneCall(channel),
+          m_client(std::move(client)),
+          m_pending(std::move(pending))
+    {
+    }
+
+    std::expected<std::optional<bool>, QString> tryReceive() override
+    {
+        auto maybeResponse = m_pending.receive();
+        if (!maybeResponse.has_value())
+            return std::unexpected(qstr(iox2::bb::into<const char *>(maybeResponse.error())));
+
+        auto response = std::move(maybeResponse).value();
+        if (response.has_value())
+            return response->payload().success;
+        return std::nullopt;
+    }
+
+private:
+    Client m_client;
+    Pending m_pending;
+};
+
 class MLinkModule::Private
 {
 public:
@@ -110,6 +168,12 @@ public:
     std::atomic_bool threadStopped = true;
     std::atomic_bool threadHandlingEvents = false;
 
+    // Preparation of the worker, while it is in progress
+    bool concurrentPrepare = false;
+    bool prepareInProgress = false;
+    std::unique_ptr<PendingDoneCall> pendingPrepare;
+    QElapsedTimer prepareTimer;
+
     /**
      * Construct service name for a channel on this module.
      */
@@ -362,17 +426,18 @@ public:
         return res->success;
     }
 
+    /**
+     * Send a request to the client, without waiting for its "Done" response.
+     */
     template<typename ReqData>
-    bool callSliceClientSimple(
+    std::unique_ptr<PendingDoneCall> sendSliceRequest(
         MLinkModule *self,
         const std::string &channel,
-        const ReqData &reqEntity,
-        int timeoutSec = 5,
-        IpcCallFlags flags = IpcCallFlag::TimeoutIsError)
+        const ReqData &reqEntity)
     {
         if (!node.has_value()) {
             LOG_CRITICAL(log, "callClientSimple: IOX node not initialized, failing call on channel: {}", channel);
-            return false;
+            return nullptr;
         }
 
         auto client = makeSliceClient<DoneResponse>(*node, svcName(channel));
@@ -382,7 +447,7 @@ public:
         if (!maybeSlice.has_value()) {
             self->raiseError(QStringLiteral("Failed to loan shared memory for request on '%1': %2")
                                  .arg(qstr(channel), iox2::bb::into<const char *>(maybeSlice.error())));
-            return false;
+            return nullptr;
         }
         auto rawSlice = std::move(maybeSlice).value();
         std::memmove(rawSlice.payload_mut().data(), bytes.data(), bytes.size());
@@ -390,11 +455,42 @@ public:
         if (!sendRes.has_value()) {
             self->raiseError(QStringLiteral("Failed to send request on '%1': %2")
                                  .arg(qstr(channel), qstr(iox2::bb::into<const char *>(sendRes.error()))));
-            return false;
+            return nullptr;
         }
         auto pending = std::move(sendRes).value();
         notifyClient();
 
+        return std::make_unique<PendingDoneCallImpl<decltype(client), decltype(pending)>>(
+            channel, std::move(client), std::move(pending));
+    }
+
+    /**
+     * Check whether a response to a pending call has arrived.
+     * Returns std::nullopt if we are still waiting.
+     */
+    std::optional<bool> pollPendingCall(MLinkModule *self, PendingDoneCall &call)
+    {
+        const auto res = call.tryReceive();
+        if (!res.has_value()) {
+            self->raiseError(
+                QStringLiteral("Failed to receive response on '%1': %2").arg(qstr(call.channel()), res.error()));
+            return false;
+        }
+        return res.value();
+    }
+
+    template<typename ReqData>
+    bool callSliceClientSimple(
+        MLinkModule *self,
+        const std::string &channel,
+        const ReqData &reqEntity,
+        int timeoutSec = 5,
+        IpcCallFlags flags = IpcCallFlag::TimeoutIsError)
+    {
+        auto call = sendSliceRequest(self, channel, reqEntity);
+        if (!call)
+            return false;
+
         QElapsedTimer timer;
         timer.start();
         while (true) {
@@ -404,15 +500,9 @@ public:
                 if (timeoutSec > 4)
                     qApp->processEvents();
             }
-            auto maybeResponse = pending.receive();
-            if (!maybeResponse.has_value()) {
-                self->raiseError(QStringLiteral("Failed to receive response on '%1': %2")
-                                     .arg(qstr(channel), qstr(iox2::bb::into<const char *>(maybeResponse.error()))));
-                return false;
-            }
-            auto response = std::move(maybeResponse).value();
-            if (response.has_value())
-                return response->payload().success;
+            const auto res = pollPendingCall(self, *call);
+            if (res.has_value())
+                return res.value();
 
             // quit immediately if an error was already emitted
             if (flags.testFlag(IpcCallFlag::SkipWaitOnError) && self->state() == ModuleState::ERROR)
@@ -859,6 +949,11 @@ void MLinkModule::setModuleBinaryWorkDir(const QString &wdir)
     d->proc->setWorkingDirectory(wdir);
 }
 
+qint64 MLinkModule::workerProcessId() const
+{
+    return d->proc->processId();
+}
+
 QProcessEnvironment MLinkModule::moduleBinaryEnv() const
 {
     const auto env = d->proc->processEnvironment();
@@ -1346,6 +1441,9 @@ void MLinkModule::shutdownOutputPorts()
 
 bool MLinkModule::prepare(const TestSubject &subject)
 {
+    d->pendingPrepare.reset();
+    d->prepareInProgress = false;
+
     // ensure we are reading any messages from the module process
     d->ctlEventTimer->start();
 
@@ -1400,27 +1498,86 @@ bool MLinkModule::prepare(const TestSubject &subject)
         .edlRootPath = sg ? sg->path().string() : std::string{},
         .moduleName = name().toStdString(),
     };
-    if (!d->callSliceClientSimple(
-            this,
-            PREPARE_RUN_CALL_ID,
-            prepReq,
-            15,
-            IpcCallFlag::TimeoutIsError | IpcCallFlag::SkipWaitOnError))
+    d->pendingPrepare = d->sendSliceRequest(this, PREPARE_RUN_CALL_ID, prepReq);
+    if (!d->pendingPrepare)
         return false;
+    d->prepareInProgress = true;
+    d->prepareTimer.start();
+
+    // the engine completes the preparation via pollPrepare(), while it prepares other modules
+    if (d->concurrentPrepare)
+        return true;
+
+    while (true) {
+        const auto res = pollPrepare();
+        if (res.has_value())
+            return res.value();
 
-    QElapsedTimer timer;
-    timer.start();
-    while (state() != ModuleState::READY) {
-        handleIncomingControl();
         qApp->processEvents();
-        if (state() == ModuleState::ERROR)
-            return false;
+        std::this_thread::sleep_for(microseconds_t(75));
+    }
+}
+
+void MLinkModule::setConcurrentPrepare(bool enabled)
+{
+    d->concurrentPrepare = enabled;
+}
+
+bool MLinkModule::prepareInProgress() const
+{
+    return d->prepareInProgress;
+}
+
+std::optional<bool> MLinkModule::pollPrepare()
+{
+    if (!d->prepareInProgress)
+        return state() != ModuleState::ERROR;
+
+    auto finishPrepare = [this](bool success) -> bool {
+        d->pendingPrepare.reset();
+        d->prepareInProgress = false;
+        return success;
+    };
+
+    d->checkClientError(this);
+    handleIncomingControl();
+
+    // the worker replies once its own startup preparations are done
+    if (d->pendingPrepare) {
+        const auto res = d->pollPendingCall(this, *d->pendingPrepare);
+        if (!res.has_value()) {
+            // quit immediately if an error was already emitted
+            if (state() == ModuleState::ERROR)
+                return finishPrepare(false);
 
+            // if we stopped running (crashed or exited) we no longer need to wait
+            if (!isProcessRunning())
+                return finishPrepare(false);
+
+            if (d->prepareTimer.elapsed() > 15 * MS_PER_S) {
+                raiseError(QStringLiteral("Timeout while waiting for response on: %1").arg(qstr(PREPARE_RUN_CALL_ID)));
+                return finishPrepare(false);
+            }
+
+            return std::nullopt;
+        }
+
+        d->pendingPrepare.reset();
+        if (!res.value())
+            return finishPrepare(false);
+        d->prepareTimer.restart();
+    }
+
+    if (state() == ModuleState::ERROR)
+        return finishPrepare(false);
+    if (state() != ModuleState::READY) {
         // we give modules 30sec to prepare, in case they are very slow
-        if (timer.elapsed() > 30 * MS_PER_S) {
+        if (d->prepareTimer.elapsed() > 30 * MS_PER_S) {
             raiseError("Timeout while waiting for module. Module did not transition to 'ready' state in 30 seconds.");
-            return false;
+            return finishPrepare(false);
         }
+
+        return std::nullopt;
     }
 
     // Final drain to pick up any control events (e.g. settings changes) that arrived
@@ -1430,15 +1587,15 @@ bool MLinkModule::prepare(const TestSubject &subject)
 
     // register output port forwarding from exported data streams to internal data transmission
     if (!registerOutPortForwarders())
-        return false;
+        return finishPrepare(false);
     if (state() == ModuleState::ERROR)
-        return false;
+        return finishPrepare(false);
 
     // ensure common metadata on the output ports is up-to-date
     updateCommonStreamMetadata();
 
     d->portChangesAllowed = false;
-    return true;
+    return finishPrepare(true);
 }
 
 void MLinkModule::start()
@@ -1593,6 +1750,10 @@ void MLinkModule::stop()
     d->sentMetadata.clear();
     d->portChangesAllowed = true;
 
+    // a run may be stopped before our preparation was completed
+    d->pendingPrepare.reset();
+    d->prepareInProgress = false;
+
     // start reading client responses in the GUI thread again
     d->ctlEventTimer->start();
 }
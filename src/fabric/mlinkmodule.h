@@ -22,6 +22,7 @@
 #include <QEventLoop>
 #include <QObject>
 #include <QProcessEnvironment>
+#include <optional>
 
 #include "moduleapi.h"
 #include "streamexporter.h"
@@ -69,6 +70,11 @@ public:
     QProcessEnvironment moduleBinaryEnv() const;
     void setModuleBinaryEnv(const QProcessEnvironment &env);
 
+    /**
+     * Process ID of the running worker, or 0 if no worker is running.
+     */
+    qint64 workerProcessId() const;
+
     ModuleWorkerMode workerMode() const;
     void setWorkerMode(ModuleWorkerMode mode);
 
@@ -96,6 +102,24 @@ public:
 
     void markIncomingForExport(StreamExporter *exporter);
     bool prepare(const TestSubject &subject) override;
+
+    /**
+     * Do not wait for the worker in prepare().
+     *
+     * If enabled, prepare() returns as soon as the worker was asked to prepare
+     * the run. The preparation must then be completed by calling pollPrepare()
+     * until it returns a result, which allows several workers to prepare
+     * themselves at the same time.
+     */
+    void setConcurrentPrepare(bool enabled);
+    bool prepareInProgress() const;
+
+    /**
+     * Continue an unfinished preparation without blocking.
+     * @return The result of prepare() once the worker is ready or failed, std::nullopt while it is still preparing.
+     */
+    std::optional<bool> pollPrepare();
+
     void start() override;
     void stop() override;
     void runThread(OptionalWaitCondition *startWaitCondition) override;
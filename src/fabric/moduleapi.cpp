@@ -259,6 +259,9 @@ public:
     QString title;
     AbstractModule *owner;
     StreamOutputPort *outPort;
+
+    size_t queueCapacity;
+    SubscriptionOverflowPolicy overflowPolicy;
 };
 
 VarStreamInputPort::VarStreamInputPort(AbstractModule *owner, const QString &id, const QString &title)
@@ -268,6 +271,8 @@ VarStreamInputPort::VarStreamInputPort(AbstractModule *owner, const QString &id,
     d->title = title;
     d->owner = owner;
     d->outPort = nullptr;
+    d->queueCapacity = 0;
+    d->overflowPolicy = SubscriptionOverflowPolicy::DropNewest;
 }
 
 VarStreamInputPort::~VarStreamInputPort()
@@ -285,6 +290,8 @@ void VarStreamInputPort::setSubscription(StreamOutputPort *src, std::shared_ptr<
     d->outPort = src;
     if (sub && sub->dataTypeId() != dataTypeId())
         sub = wrapSubscriptionForType(sub, dataTypeId());
+    if (sub)
+        sub->setQueueLimit(d->queueCapacity, d->overflowPolicy);
     m_sub = sub;
     src->addSubscriberPort(this);
 
@@ -322,6 +329,24 @@ std::shared_ptr<VariantStreamSubscription> VarStreamInputPort::subscriptionVar()
     return sub;
 }
 
+void VarStreamInputPort::setQueueLimit(size_t capacity, SubscriptionOverflowPolicy policy)
+{
+    d->queueCapacity = capacity;
+    d->overflowPolicy = policy;
+    if (m_sub.has_value() && m_sub.value())
+        m_sub.value()->setQueueLimit(capacity, policy);
+}
+
+size_t VarStreamInputPort::queueCapacity() const
+{
+    return d->queueCapacity;
+}
+
+SubscriptionOverflowPolicy VarStreamInputPort::overflowPolicy() const
+{
+    return d->overflowPolicy;
+}
+
 bool VarStreamInputPort::isDormant() const
 {
     if (hasSubscription())
@@ -991,6 +1016,11 @@ QList<QPair<intervalEventFunc_t, int>> AbstractModule::intervalEventCallbacks()
     return m_intervalEventCBList;
 }
 
+QList<QPair<intervalEventFunc_t, int>> AbstractModule::preciseIntervalEventCallbacks() const
+{
+    return m_preciseIntervalEventCBList;
+}
+
 QList<QPair<recvDataEventFunc_t, std::shared_ptr<VariantStreamSubscription>>> AbstractModule::recvDataEventCallbacks()
     const
 {
@@ -1395,6 +1425,7 @@ void AbstractModule::setStorageGroup(std::shared_ptr<EDLGroup> edlGroup)
 void AbstractModule::resetEventCallbacks()
 {
     m_intervalEventCBList.clear();
+    m_preciseIntervalEventCBList.clear();
 }
 
 void AbstractModule::setPotentialNoaffinityCPUCount(uint coreN)
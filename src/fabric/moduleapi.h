@@ -312,6 +312,16 @@ public:
 
     std::shared_ptr<VariantStreamSubscription> subscriptionVar();
 
+    /**
+     * @brief Limit the amount of data that may queue up on this port.
+     *
+     * The limit is retained across (re)connections of this port.
+     * A capacity of 0 removes the limit.
+     */
+    void setQueueLimit(size_t capacity, SubscriptionOverflowPolicy policy);
+    size_t queueCapacity() const;
+    SubscriptionOverflowPolicy overflowPolicy() const;
+
     /**
      * A dormant port will not receive data during the current run.
      * @return
@@ -792,6 +802,7 @@ public:
     std::shared_ptr<StreamOutputPort> outPortById(const QString &id) const;
 
     QList<QPair<intervalEventFunc_t, int>> intervalEventCallbacks() const;
+    QList<QPair<intervalEventFunc_t, int>> preciseIntervalEventCallbacks() const;
     QList<QPair<recvDataEventFunc_t, std::shared_ptr<VariantStreamSubscription>>> recvDataEventCallbacks() const;
 
     QVariant serializeDisplayUiGeometry() const;
@@ -986,6 +997,29 @@ protected:
         m_intervalEventCBList.append(qMakePair(amFn, interval.count()));
     }
 
+    /**
+     * @brief Request a member function of this module to be called at a precise interval
+     *
+     * Works like registerTimedEvent(), but the interval is set in microseconds, and the
+     * function is run by a timer with absolute deadlines on the monotonic clock. The period
+     * therefore does not drift, and intervals down to about 100µs can be kept.
+     * The interval passed to the callback is in microseconds as well.
+     *
+     * Deadlines that were missed, and how late the function was called, are recorded for
+     * every timer and logged at the end of a run.
+     * Modules using precise timed events always run on an event thread, never on the
+     * event worker pool.
+     */
+    template<typename T>
+    void registerPreciseTimedEvent(void (T::*fn)(int &), const microseconds_t &interval)
+    {
+        static_assert(
+            std::is_base_of<AbstractModule, T>::value,
+            "Callback needs to point to a member function of a class derived from AbstractModule");
+        const auto amFn = static_cast<intervalEventFunc_t>(fn);
+        m_preciseIntervalEventCBList.append(qMakePair(amFn, static_cast<int>(interval.count())));
+    }
+
     /**
      * @brief Request a member function of this module to be called when a subscription has new data.
      *
@@ -1024,6 +1058,57 @@ protected:
         m_recvDataEventCBList.append(qMakePair(recvDataEventFunc_t(std::forward<Callable>(fn)), subscription));
     }
 
+    /**
+     * @brief Request a member function of this module to be called with batches of new subscription data.
+     *
+     * Works like registerDataReceivedEvent(), but all elements that are pending when the event
+     * fires (up to @p maxBatchSize) are dequeued at once and passed to the callback. This amortizes
+     * the per-element dispatch overhead for streams delivering many small items.
+     * The batch vector is reused between calls, so the callback may move elements out of it, but
+     * must not keep references to it.
+     */
+    template<typename T, typename D>
+    void registerDataBatchReceivedEvent(
+        void (T::*fn)(std::vector<D> &),
+        std::shared_ptr<StreamSubscription<D>> subscription,
+        size_t maxBatchSize = 256)
+    {
+        static_assert(
+            std::is_base_of<AbstractModule, T>::value,
+            "Callback needs to point to a member function of a class derived from AbstractModule");
+        auto self = static_cast<T *>(this);
+        registerDataBatchReceivedEvent(
+            [self, fn](std::vector<D> &batch) {
+                (self->*fn)(batch);
+            },
+            std::move(subscription),
+            maxBatchSize);
+    }
+
+    /**
+     * @brief Request an arbitrary callable to be called with batches of new subscription data.
+     *
+     * Overload accepting any callable instead of a member function pointer.
+     */
+    template<typename D, typename Callable>
+        requires std::invocable<Callable, std::vector<D> &>
+    void registerDataBatchReceivedEvent(
+        Callable &&fn,
+        std::shared_ptr<StreamSubscription<D>> subscription,
+        size_t maxBatchSize = 256)
+    {
+        auto batch = std::make_shared<std::vector<D>>();
+        m_recvDataEventCBList.append(qMakePair(
+            recvDataEventFunc_t([cb = std::forward<Callable>(fn), sub = subscription.get(), batch, maxBatchSize]() {
+                if (sub->drainInto(*batch, maxBatchSize) == 0)
+                    return;
+                cb(*batch);
+                // keep the capacity, but release the data right away
+                batch->clear();
+            }),
+            std::static_pointer_cast<VariantStreamSubscription>(subscription)));
+    }
+
     /**
      * @brief Remove all registered data-received event callbacks.
      */
@@ -1142,6 +1227,7 @@ private:
     QMap<QString, std::shared_ptr<VarStreamInputPort>> m_inPorts;
 
     QList<QPair<intervalEventFunc_t, int>> m_intervalEventCBList;
+    QList<QPair<intervalEventFunc_t, int>> m_preciseIntervalEventCBList;
     QList<QPair<recvDataEventFunc_t, std::shared_ptr<VariantStreamSubscription>>> m_recvDataEventCBList;
 
     std::shared_ptr<EDLGroup> storageGroup() const;
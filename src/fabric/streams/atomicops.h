@@ -734,6 +734,20 @@ namespace moodycamel
 				return tryWait() || waitWithPartialSpinning(timeout_usecs);
 			}
 
+		    // Acquires up to `max` available units at once without blocking, and
+		    // returns how many were acquired. Only valid for a single waiting thread.
+		    ssize_t tryWaitMany(ssize_t max) AE_NO_TSAN
+		    {
+		        assert(max >= 0);
+		        ssize_t count = m_count.load();
+		        if (count <= 0)
+		            return 0;
+		        if (count > max)
+		            count = max;
+		        m_count.fetch_add_acquire(-count);
+		        return count;
+		    }
+
 		    void signal(ssize_t count = 1) AE_NO_TSAN
 		    {
 		    	assert(count >= 0);
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace Syntalos
+{
+
+/**
+ * @brief Mailbox that only ever holds the most recent value
+ *
+ * This is a lock-free triple buffer for a single producer and a single consumer.
+ * The producer writes a value into its own back slot and publishes it by swapping
+ * that slot with the shared middle slot, the consumer takes a published value by
+ * swapping the middle slot with its own front slot.
+ * Neither side ever waits for the other: a new value simply replaces one that was
+ * not taken yet, and the memory used stays fixed at three values.
+ * The end of the data is signalled with close(), separately from the values, so the
+ * last value is never replaced by an end marker.
+ */
+template<typename T>
+class LatestValueMailbox
+{
+public:
+    LatestValueMailbox()
+        : m_middle(1),
+          m_backIdx(0),
+          m_frontIdx(2)
+    {
+    }
+
+    /**
+     * Publish a new value, constructed in place from @p args. Producer side only.
+     * @return True if a value that was not taken yet got replaced.
+     */
+    template<typename... Args>
+    bool put(Args &&...args)
+    {
+        auto &slot = m_slots[m_backIdx];
+        std::destroy_at(&slot);
+        std::construct_at(&slot, std::forward<Args>(args)...);
+
+        const auto prev = m_middle.exchange(m_backIdx | FreshFlag, std::memory_order_acq_rel);
+        m_backIdx = prev & IndexMask;
+        if ((prev & ClosedFlag) != 0) [[unlikely]]
+            m_middle.fetch_or(ClosedFlag, std::memory_order_release);
+        if ((prev & FreshFlag) != 0)
+            return true;
+
+        // only a consumer blocked in wait() needs this, which is cheap to check if there is none
+        m_middle.notify_one();
+        return false;
+    }
+
+    /**
+     * Take the most recent value, if one was published since the last call. Consumer side only.
+     */
+    std::optional<T> take()
+    {
+        auto prev = m_middle.load(std::memory_order_relaxed);
+        do {
+            if ((prev & FreshFlag) == 0)
+                return std::nullopt;
+        } while (!m_middle.compare_exchange_weak(
+            prev, m_frontIdx | (prev & ClosedFlag), std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        m_frontIdx = prev & IndexMask;
+        return std::optional<T>(std::in_place, std::move(m_slots[m_frontIdx]));
+    }
+
+    /**
+     * Mark the end of the data and wake a consumer blocked in wait().
+     * A value that was not taken yet stays available.
+     */
+    void close()
+    {
+        m_middle.fetch_or(ClosedFlag, std::memory_order_acq_rel);
+        m_middle.notify_all();
+    }
+
+    /**
+     * True once close() was called. Check this after take() came back empty,
+     * the last value may still be waiting to be taken before.
+     */
+    [[nodiscard]] bool isClosed() const
+    {
+        return (m_middle.load(std::memory_order_acquire) & ClosedFlag) != 0;
+    }
+
+    /**
+     * Block until a value is published that was not taken yet, or the mailbox is closed.
+     * Consumer side only.
+     */
+    void wait() const
+    {
+        auto current = m_middle.load(std::memory_order_acquire);
+        while ((current & (FreshFlag | ClosedFlag)) == 0) {
+            m_middle.wait(current, std::memory_order_acquire);
+            current = m_middle.load(std::memory_order_acquire);
+        }
+    }
+
+    [[nodiscard]] bool hasValue() const
+    {
+        return (m_middle.load(std::memory_order_acquire) & FreshFlag) != 0;
+    }
+
+    /**
+     * Discard a value that was not taken yet. Consumer side only.
+     */
+    void clear()
+    {
+        take();
+    }
+
+    /**
+     * Discard a value that was not taken yet and reopen a closed mailbox.
+     * Neither producer nor consumer may use the mailbox meanwhile.
+     */
+    void reset()
+    {
+        m_middle.store(m_middle.load(std::memory_order_relaxed) & IndexMask, std::memory_order_release);
+    }
+
+private:
+    static constexpr uint32_t IndexMask = 0x3;
+    static constexpr uint32_t FreshFlag = 0x4;
+    static constexpr uint32_t ClosedFlag = 0x8;
+
+    std::array<T, 3> m_slots;
+
+    // index of the middle slot, flagged if it holds a value the consumer has not taken yet,
+    // and once the mailbox is closed
+    std::atomic<uint32_t> m_middle;
+
+    // only touched by the producer and the consumer respectively
+    uint32_t m_backIdx;
+    uint32_t m_frontIdx;
+};
+
+} // namespace Syntalos
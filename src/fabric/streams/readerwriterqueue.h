@@ -16,6 +16,7 @@
 #include <cstdlib>		// For malloc/free/abort & size_t
 #include <memory>
 #include <chrono>
+#include <limits>
 
 
 // A lock-free queue for a single-consumer, single-producer architecture.
@@ -869,6 +870,29 @@ public:
 	}
 
 
+	// Attempts to dequeue up to `maxItems` elements in one go, without
+	// blocking. Each dequeued element is moved into `fn`, in queue order.
+	// The semaphore is only touched once for the whole batch.
+	// Returns the number of elements that were dequeued.
+	template<typename F>
+	std::size_t try_dequeue_many(std::size_t maxItems, F&& fn) AE_NO_TSAN
+	{
+		typedef spsc_sema::LightweightSemaphore::ssize_t ssize_t;
+		const ssize_t maxCount = maxItems > static_cast<std::size_t>(std::numeric_limits<ssize_t>::max())
+			? std::numeric_limits<ssize_t>::max()
+			: static_cast<ssize_t>(maxItems);
+		const ssize_t count = sema->tryWaitMany(maxCount);
+		for (ssize_t i = 0; i != count; ++i) {
+			T item;
+			bool success = inner.try_dequeue(item);
+			assert(success);
+			AE_UNUSED(success);
+			fn(std::move(item));
+		}
+		return static_cast<std::size_t>(count);
+	}
+
+
 	// Attempts to dequeue an element; if the queue is empty,
 	// waits until an element is available, then dequeues it.
 	template<typename U>
@@ -76,3 +76,96 @@ std::shared_ptr<VariantStreamSubscription> wrapSubscriptionForType(
     });
     return wrapped ? wrapped : sub;
 }
+
+QString overflowPolicyToString(SubscriptionOverflowPolicy policy)
+{
+    switch (policy) {
+    case SubscriptionOverflowPolicy::Block:
+        return QStringLiteral("block");
+    case SubscriptionOverflowPolicy::DropOldest:
+        return QStringLiteral("drop-oldest");
+    case SubscriptionOverflowPolicy::DropNewest:
+        return QStringLiteral("drop-newest");
+    }
+
+    return QStringLiteral("drop-newest");
+}
+
+SubscriptionOverflowPolicy overflowPolicyFromString(const QString &str)
+{
+    if (str == QStringLiteral("block"))
+        return SubscriptionOverflowPolicy::Block;
+    if (str == QStringLiteral("drop-oldest"))
+        return SubscriptionOverflowPolicy::DropOldest;
+    return SubscriptionOverflowPolicy::DropNewest;
+}
+
+QString overflowPolicyToHumanString(SubscriptionOverflowPolicy policy)
+{
+    switch (policy) {
+    case SubscriptionOverflowPolicy::Block:
+        return QStringLiteral("Block producer");
+    case SubscriptionOverflowPolicy::DropOldest:
+        return QStringLiteral("Drop oldest");
+    case SubscriptionOverflowPolicy::DropNewest:
+        return QStringLiteral("Drop newest");
+    }
+
+    return QStringLiteral("Drop newest");
+}
+
+QString queueLatencyToHumanString(nanoseconds_t latency)
+{
+    const auto ns = static_cast<double>(latency.count());
+    if (ns < 1000)
+        return QStringLiteral("%1 ns").arg(latency.count());
+    if (ns < 1000 * 1000)
+        return QStringLiteral("%1 µs").arg(ns / 1000.0, 0, 'f', 1);
+    if (ns < 1000 * 1000 * 1000)
+        return QStringLiteral("%1 ms").arg(ns / (1000.0 * 1000.0), 0, 'f', 2);
+    return QStringLiteral("%1 s").arg(ns / (1000.0 * 1000.0 * 1000.0), 0, 'f', 2);
+}
+
+void QueueLatencyHistogram::clear()
+{
+    for (auto &bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+QueueLatencyStats QueueLatencyHistogram::stats() const
+{
+    std::array<uint64_t, BucketCount> counts;
+    QueueLatencyStats stats;
+    for (size_t i = 0; i < BucketCount; i++) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        stats.count += counts[i];
+    }
+    const auto maxNs = static_cast<int64_t>(m_maxNs.load(std::memory_order_relaxed));
+    stats.max = nanoseconds_t(maxNs);
+    if (stats.count == 0)
+        return stats;
+
+    const auto percentile = [&](double fraction) {
+        const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * stats.count)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; i++) {
+            if (counts[i] == 0 || seen + counts[i] < rank) {
+                seen += counts[i];
+                continue;
+            }
+
+            // interpolate linearly within the bucket's value range
+            const double lower = i == 0 ? 0.0 : std::ldexp(1.0, static_cast<int>(i) - 1);
+            const double upper = std::ldexp(1.0, static_cast<int>(i));
+            const double pos = static_cast<double>(rank - seen) / static_cast<double>(counts[i]);
+            const auto value = static_cast<int64_t>(lower + (upper - lower) * pos);
+            return nanoseconds_t(std::min(value, maxNs));
+        }
+        return nanoseconds_t(maxNs);
+    };
+
+    stats.p50 = percentile(0.50);
+    stats.p99 = percentile(0.99);
+    return stats;
+}
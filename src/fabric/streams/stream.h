@@ -23,18 +23,24 @@
 
 #include <QVariant>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <functional>
 #include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <limits>
 #include <mutex>
 #include <optional>
 #include <sys/eventfd.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "datactl/datatypes.h"
 #include "datactl/streammeta.h"
 #include "readerwriterqueue.h"
+#include "latestvaluemailbox.h"
 #include "datactl/syclock.h"
 
 using namespace moodycamel;
@@ -70,6 +76,71 @@ Q_GLOBAL_STATIC_WITH_ARGS(CommonMetadataKeyMapType,
  */
 using ProcessVarFn = std::function<void(BaseDataType &)>;
 
+/**
+ * @brief Behavior of a bounded subscription queue once it is full.
+ */
+enum class SubscriptionOverflowPolicy {
+    Block,      /// The producer waits for the consumer to make room (backpressure)
+    DropOldest, /// The oldest queued item is discarded to make room for the new one
+    DropNewest  /// The new item is discarded
+};
+
+QString overflowPolicyToString(SubscriptionOverflowPolicy policy);
+SubscriptionOverflowPolicy overflowPolicyFromString(const QString &str);
+QString overflowPolicyToHumanString(SubscriptionOverflowPolicy policy);
+
+/**
+ * @brief Summary of the time items spent waiting in a subscription queue.
+ */
+struct QueueLatencyStats {
+    uint64_t count{0}; /// Number of traced items
+    nanoseconds_t p50{0};
+    nanoseconds_t p99{0};
+    nanoseconds_t max{0};
+};
+Q_DECLARE_METATYPE(QueueLatencyStats)
+
+QString queueLatencyToHumanString(nanoseconds_t latency);
+
+/**
+ * @brief Lock-free histogram of subscription queueing latencies.
+ *
+ * Latencies are sorted into power-of-two nanosecond buckets, so recording a value
+ * costs a few relaxed atomic operations and percentiles are estimated by interpolating
+ * within a bucket. Values must only be recorded by a single thread (the consumer
+ * of the subscription), while stats() may be called from any thread.
+ */
+class QueueLatencyHistogram
+{
+public:
+    /// bucket 0 holds latencies < 1ns, bucket i holds latencies in [2^(i-1), 2^i) ns
+    static constexpr size_t BucketCount = 48;
+
+    QueueLatencyHistogram()
+    {
+        clear();
+    }
+
+    void record(int64_t latencyNs)
+    {
+        const auto value = static_cast<uint64_t>(std::max<int64_t>(latencyNs, 0));
+        const auto idx = std::min<size_t>(std::bit_width(value), BucketCount - 1);
+
+        // we are the only writer, so we can avoid the more expensive atomic RMW operations
+        auto &bucket = m_buckets[idx];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value > m_maxNs.load(std::memory_order_relaxed))
+            m_maxNs.store(value, std::memory_order_relaxed);
+    }
+
+    void clear();
+    [[nodiscard]] QueueLatencyStats stats() const;
+
+private:
+    std::array<std::atomic_uint64_t, BucketCount> m_buckets;
+    std::atomic_uint64_t m_maxNs;
+};
+
 class VariantStreamSubscription
 {
 public:
@@ -113,6 +184,59 @@ public:
     virtual void rearmNotifyIfPending() = 0;
 
     virtual void setThrottleItemsPerSec(uint itemsPerSec, bool allowMore = true) = 0;
+
+    /**
+     * @brief Limit the amount of items this subscription may queue.
+     *
+     * Once @p capacity items are pending, @p policy decides what happens with
+     * newly pushed data. A capacity of 0 means the queue is unbounded.
+     */
+    virtual void setQueueLimit(size_t capacity, SubscriptionOverflowPolicy policy) = 0;
+    virtual size_t queueCapacity() const = 0;
+    virtual SubscriptionOverflowPolicy overflowPolicy() const = 0;
+
+    /**
+     * @brief Only keep the most recent item for the consumer ("mailbox" mode).
+     *
+     * Instead of being queued, every pushed item replaces the one that is still waiting,
+     * so at most one item is ever pending and memory use stays constant no matter how slow
+     * the consumer is. Replaced items are counted as dropped.
+     * Throttling and the queue limit do not apply in this mode. This is meant for consumers
+     * that only ever display the newest item, and read at their own pace.
+     */
+    virtual void setLatestValueOnly(bool enabled) = 0;
+    virtual bool latestValueOnly() const = 0;
+
+    /**
+     * @brief Number of items discarded due to the queue limit since the run started.
+     */
+    virtual uint64_t droppedCount() const = 0;
+
+    /**
+     * @brief Number of items enqueued since the run started.
+     */
+    virtual uint64_t enqueuedCount() const = 0;
+
+    /**
+     * @brief Number of items skipped by the throttle since the run started.
+     */
+    virtual uint64_t throttledCount() const = 0;
+
+    /**
+     * @brief Record how long items wait in this subscription's queue.
+     *
+     * Pushed items are stamped with the master clock time they were enqueued at, and
+     * their queueing latency is recorded once the consumer dequeues them.
+     * If tracing is disabled (the default), the overhead is a single relaxed atomic load per push.
+     */
+    virtual void setLatencyTracing(bool enabled) = 0;
+    virtual bool latencyTracingEnabled() const = 0;
+
+    /**
+     * @brief Queueing latency of the items traced since the run started.
+     */
+    virtual QueueLatencyStats queueLatencyStats() const = 0;
+
     virtual void suspend() = 0;
     virtual void resume() = 0;
     virtual void clearPending() = 0;
@@ -182,7 +306,7 @@ class StreamSubscription : public VariantStreamSubscription
 public:
     explicit StreamSubscription(DataStream<T> *stream)
         : m_stream(stream),
-          m_queue(BlockingReaderWriterQueue<std::optional<T>>(256)),
+          m_queue(BlockingReaderWriterQueue<QueueSlot>(256)),
           m_eventfd(-1),
           m_notify(false),
           m_notifyPending(false),
@@ -190,6 +314,14 @@ public:
           m_suspended(false),
           m_throttle(0),
           m_skippedElements(0),
+          m_capacity(0),
+          m_overflowPolicy(SubscriptionOverflowPolicy::DropNewest),
+          m_droppedCount(0),
+          m_enqueuedCount(0),
+          m_throttledCount(0),
+          m_latestOnly(false),
+          m_traceLatency(false),
+          m_producerWaiting(false),
           m_log(getLogger("subscription"))
     {
         m_lastItemTime = currentTimePoint();
@@ -215,11 +347,21 @@ public:
      */
     virtual std::optional<T> next()
     {
+        if (m_latestOnly.load(std::memory_order_relaxed))
+            return takeLatest(true);
         if (!m_active && m_queue.peek() == nullptr)
             return std::nullopt;
-        std::optional<T> data;
-        m_queue.wait_dequeue(data);
-        return data;
+        QueueSlot slot;
+        if (consumerNeedsLock()) {
+            std::lock_guard<std::mutex> lock(m_consumerMutex);
+            m_queue.wait_dequeue(slot);
+        } else {
+            m_queue.wait_dequeue(slot);
+        }
+        if (slot.enqueueTimeNs != 0) [[unlikely]]
+            recordLatency(slot.enqueueTimeNs, currentTimeNs());
+        notifyQueueSpace();
+        return std::move(slot.item);
     }
 
     /**
@@ -229,14 +371,83 @@ public:
      */
     virtual std::optional<T> peekNext()
     {
+        if (m_latestOnly.load(std::memory_order_relaxed))
+            return takeLatest(false);
         if (!m_active && m_queue.peek() == nullptr)
             return std::nullopt;
-        std::optional<T> data;
+        QueueSlot slot;
 
-        if (!m_queue.try_dequeue(data))
+        bool ok;
+        if (consumerNeedsLock()) {
+            std::lock_guard<std::mutex> lock(m_consumerMutex);
+            ok = m_queue.try_dequeue(slot);
+        } else {
+            ok = m_queue.try_dequeue(slot);
+        }
+        if (!ok)
             return std::nullopt;
+        if (slot.enqueueTimeNs != 0) [[unlikely]]
+            recordLatency(slot.enqueueTimeNs, currentTimeNs());
+        notifyQueueSpace();
 
-        return data;
+        return std::move(slot.item);
+    }
+
+    /**
+     * @brief Move up to @p maxItems pending stream elements into @p out, without blocking.
+     *
+     * Elements are appended to @p out in stream order. Draining many elements this way
+     * is considerably cheaper than calling peekNext() for each of them.
+     * @return The number of elements that were appended to @p out.
+     */
+    virtual size_t drainInto(std::vector<T> &out, size_t maxItems = std::numeric_limits<size_t>::max())
+    {
+        const auto prevSize = out.size();
+        if (m_latestOnly.load(std::memory_order_relaxed)) {
+            if (maxItems == 0)
+                return 0;
+            if (auto item = takeLatest(false))
+                out.push_back(std::move(*item));
+            return out.size() - prevSize;
+        }
+
+        int64_t dequeueTimeNs = 0;
+        const auto appendFn = [this, &out, &dequeueTimeNs](QueueSlot &&slot) {
+            // the whole batch is dequeued at once, so we only read the clock once
+            if (slot.enqueueTimeNs != 0) [[unlikely]] {
+                if (dequeueTimeNs == 0)
+                    dequeueTimeNs = currentTimeNs();
+                recordLatency(slot.enqueueTimeNs, dequeueTimeNs);
+            }
+
+            // an empty item marks the end of the stream, we just skip it
+            if (slot.item.has_value())
+                out.push_back(std::move(*slot.item));
+        };
+
+        size_t count;
+        if (consumerNeedsLock()) {
+            std::lock_guard<std::mutex> lock(m_consumerMutex);
+            count = m_queue.try_dequeue_many(maxItems, appendFn);
+        } else {
+            count = m_queue.try_dequeue_many(maxItems, appendFn);
+        }
+        if (count > 0)
+            notifyQueueSpace();
+
+        return out.size() - prevSize;
+    }
+
+    /**
+     * @brief Obtain up to @p maxItems pending stream elements at once, without blocking.
+     * @see drainInto
+     */
+    std::vector<T> nextBatch(size_t maxItems)
+    {
+        std::vector<T> batch;
+        batch.reserve(std::min(maxItems, approxPendingCount()));
+        drainInto(batch, maxItems);
+        return batch;
     }
 
     /**
@@ -373,8 +584,7 @@ public:
         m_suspended = true;
 
         // drop currently pending data
-        while (m_queue.pop()) {
-        }
+        dropPending();
     }
 
     /**
@@ -391,13 +601,14 @@ public:
     void clearPending() override
     {
         m_suspended = true;
-        while (m_queue.pop()) {
-        }
+        dropPending();
         m_suspended = false;
     }
 
     size_t approxPendingCount() const override
     {
+        if (m_latestOnly.load(std::memory_order_relaxed))
+            return m_mailbox.hasValue() ? 1 : 0;
         return m_queue.size_approx();
     }
 
@@ -408,6 +619,8 @@ public:
 
     bool hasPending() const override
     {
+        if (m_latestOnly.load(std::memory_order_relaxed))
+            return m_mailbox.hasValue();
         return m_queue.size_approx() > 0;
     }
 
@@ -455,14 +668,106 @@ public:
         m_skippedElements = 0;
     }
 
+    void setQueueLimit(size_t capacity, SubscriptionOverflowPolicy policy) override
+    {
+        m_overflowPolicy = policy;
+        m_capacity = capacity;
+
+        // release a producer that may be waiting for room under the old limit
+        notifyQueueSpace();
+    }
+
+    size_t queueCapacity() const override
+    {
+        return m_capacity;
+    }
+
+    SubscriptionOverflowPolicy overflowPolicy() const override
+    {
+        return m_overflowPolicy;
+    }
+
+    void setLatestValueOnly(bool enabled) override
+    {
+        if (m_latestOnly == enabled)
+            return;
+
+        // items pending in the previous mode would be lost or reordered, so we start over
+        suspend();
+        m_latestOnly = enabled;
+        resume();
+    }
+
+    bool latestValueOnly() const override
+    {
+        return m_latestOnly;
+    }
+
+    uint64_t droppedCount() const override
+    {
+        return m_droppedCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t enqueuedCount() const override
+    {
+        return m_enqueuedCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t throttledCount() const override
+    {
+        return m_throttledCount.load(std::memory_order_relaxed);
+    }
+
+    void setLatencyTracing(bool enabled) override
+    {
+        m_traceLatency = enabled;
+    }
+
+    bool latencyTracingEnabled() const override
+    {
+        return m_traceLatency;
+    }
+
+    QueueLatencyStats queueLatencyStats() const override
+    {
+        return m_latencyHist.stats();
+    }
+
     void forcePushNullopt() override
     {
-        m_queue.emplace(std::nullopt);
+        if (m_latestOnly)
+            m_mailbox.close();
+        else
+            m_queue.emplace(std::nullopt);
     }
 
 private:
+    /**
+     * @brief An element in the subscription queue.
+     *
+     * Carries the master clock time the item was enqueued at if latency
+     * tracing is enabled, or 0 otherwise.
+     */
+    struct QueueSlot {
+        std::optional<T> item;
+        int64_t enqueueTimeNs{0};
+
+        QueueSlot() = default;
+        QueueSlot(std::nullopt_t)
+            : item(std::nullopt)
+        {
+        }
+
+        template<typename U>
+        QueueSlot(int64_t timeNs, std::in_place_t, U &&data)
+            : item(std::in_place, std::forward<U>(data)),
+              enqueueTimeNs(timeNs)
+        {
+        }
+    };
+
     DataStream<T> *m_stream;
-    BlockingReaderWriterQueue<std::optional<T>> m_queue;
+    BlockingReaderWriterQueue<QueueSlot> m_queue;
     int m_eventfd;
     std::atomic_bool m_notify;
     std::atomic_bool m_notifyPending;
@@ -471,6 +776,35 @@ private:
     std::atomic_uint m_throttle;
     std::atomic_uint m_skippedElements;
 
+    std::atomic<size_t> m_capacity;
+    std::atomic<SubscriptionOverflowPolicy> m_overflowPolicy;
+    std::atomic_uint64_t m_droppedCount;
+
+    // Only written by the (single) producer, so they are bumped without a locked
+    // read-modify-write and are merely read from other threads.
+    std::atomic_uint64_t m_enqueuedCount;
+    std::atomic_uint64_t m_throttledCount;
+
+    // Holds only the newest item instead of the queue, if the consumer asked for that
+    std::atomic_bool m_latestOnly;
+    LatestValueMailbox<QueueSlot> m_mailbox;
+
+    std::atomic_bool m_traceLatency;
+    QueueLatencyHistogram m_latencyHist;
+
+    // Serializes consumer-side dequeues with a producer discarding the oldest item
+    // (only used by bounded DropOldest subscriptions, as the queue is single-consumer).
+    std::mutex m_consumerMutex;
+
+    // Used by a producer waiting for room in a bounded, blocking subscription
+    std::mutex m_spaceMutex;
+    std::condition_variable m_spaceCond;
+    std::atomic_bool m_producerWaiting;
+
+    // Maximum time a producer waits for room in a full blocking subscription before
+    // dropping the item, so a stopped or stalled consumer can never wedge the producer.
+    static constexpr auto kMaxBlockingPushStall = std::chrono::milliseconds(1000);
+
     // NOTE: These two variables are intentionally *not* threadsafe and are
     // only ever manipulated by the stream (in case of the time) or only
     // touched once when a stream is started (in case of the metadata).
@@ -493,26 +827,162 @@ private:
         if (m_suspended)
             return;
 
+        // in mailbox mode, the new item simply replaces one the consumer has not taken yet
+        if (m_latestOnly.load(std::memory_order_relaxed)) {
+            const int64_t enqueueTimeNs = m_traceLatency.load(std::memory_order_relaxed) ? currentTimeNs() : 0;
+            if (m_mailbox.put(enqueueTimeNs, std::in_place, std::forward<U>(data)))
+                m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            bumpProducerCounter(m_enqueuedCount);
+
+            if (m_notify)
+                pingNotify();
+            return;
+        }
+
         // check if we can throttle the enqueueing speed of data
         if (m_throttle != 0) {
             const auto timeNow = currentTimePoint();
             const auto durUsec = timeDiffUsec(timeNow, m_lastItemTime);
             if (durUsec.count() < m_throttle) {
                 m_skippedElements++;
+                bumpProducerCounter(m_throttledCount);
                 return;
             }
             m_lastItemTime = timeNow;
         }
 
+        // enforce the queue limit, if we have one
+        const auto capacity = m_capacity.load(std::memory_order_relaxed);
+        if (capacity != 0 && m_queue.size_approx() >= capacity) [[unlikely]] {
+            if (!makeRoomForPush()) {
+                m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
         // Actually send the data to the subscribers
-        // Construct std::optional<T> directly in the ring-buffer slot.
-        m_queue.emplace(std::in_place, std::forward<U>(data));
+        // Construct the item directly in the ring-buffer slot.
+        const int64_t enqueueTimeNs = m_traceLatency.load(std::memory_order_relaxed) ? currentTimeNs() : 0;
+        m_queue.emplace(enqueueTimeNs, std::in_place, std::forward<U>(data));
+        bumpProducerCounter(m_enqueuedCount);
 
         // ping the eventfd, in case anyone is listening for messages
         if (m_notify)
             pingNotify();
     }
 
+    static void bumpProducerCounter(std::atomic_uint64_t &counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static int64_t currentTimeNs() noexcept
+    {
+        return symaster_clock::now().time_since_epoch().count();
+    }
+
+    void recordLatency(int64_t enqueueTimeNs, int64_t dequeueTimeNs)
+    {
+        m_latencyHist.record(dequeueTimeNs - enqueueTimeNs);
+    }
+
+    /**
+     * @brief Take the newest item in mailbox mode, optionally waiting for one.
+     */
+    std::optional<T> takeLatest(bool wait)
+    {
+        auto slot = m_mailbox.take();
+        while (!slot.has_value()) {
+            if (!wait || !m_active || m_mailbox.isClosed())
+                return std::nullopt;
+            m_mailbox.wait();
+            slot = m_mailbox.take();
+        }
+
+        if (slot->enqueueTimeNs != 0) [[unlikely]]
+            recordLatency(slot->enqueueTimeNs, currentTimeNs());
+        return std::move(slot->item);
+    }
+
+    /**
+     * @brief Discard all queued items on the consumer side.
+     */
+    void dropPending()
+    {
+        if (consumerNeedsLock()) {
+            std::lock_guard<std::mutex> lock(m_consumerMutex);
+            while (m_queue.pop()) {
+            }
+        } else {
+            while (m_queue.pop()) {
+            }
+        }
+        m_mailbox.clear();
+        notifyQueueSpace();
+    }
+
+    /**
+     * @brief True if dequeues must be serialized against the producer dropping items.
+     */
+    bool consumerNeedsLock() const
+    {
+        return m_capacity.load(std::memory_order_relaxed) != 0
+               && m_overflowPolicy.load(std::memory_order_relaxed) == SubscriptionOverflowPolicy::DropOldest;
+    }
+
+    /**
+     * @brief Wake a producer waiting for queue space, if there is one.
+     */
+    void notifyQueueSpace()
+    {
+        if (!m_producerWaiting.load(std::memory_order_seq_cst)) [[likely]]
+            return;
+        std::lock_guard<std::mutex> lock(m_spaceMutex);
+        m_spaceCond.notify_all();
+    }
+
+    /**
+     * @brief Handle a push into a full bounded queue according to the overflow policy.
+     * @return True if the new item should be enqueued, false if it has to be dropped.
+     */
+    bool makeRoomForPush()
+    {
+        switch (m_overflowPolicy.load(std::memory_order_relaxed)) {
+        case SubscriptionOverflowPolicy::DropNewest:
+            return false;
+
+        case SubscriptionOverflowPolicy::DropOldest: {
+            // Never wait for the consumer here: if it is dequeuing right now, it
+            // is making room anyway and we overshoot the limit by one item at most.
+            std::unique_lock<std::mutex> lock(m_consumerMutex, std::try_to_lock);
+            if (lock.owns_lock() && m_queue.pop())
+                m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        case SubscriptionOverflowPolicy::Block: {
+            const auto waitStart = currentTimePoint();
+            std::unique_lock<std::mutex> lock(m_spaceMutex);
+            m_producerWaiting = true;
+            bool haveSpace = true;
+            while (m_queue.size_approx() >= m_capacity.load(std::memory_order_relaxed)) {
+                if (!m_active || m_suspended || m_capacity == 0)
+                    break;
+                if (timeDiffToNowMsec(waitStart) >= kMaxBlockingPushStall) {
+                    haveSpace = false;
+                    break;
+                }
+                // the timeout also guards against a missed wakeup
+                m_spaceCond.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            m_producerWaiting = false;
+            return haveSpace && !m_suspended;
+        }
+        }
+
+        return true;
+    }
+
     /**
      * @brief Wake a listening consumer via the eventfd, coalescing repeated calls.
      *
@@ -556,7 +1026,11 @@ private:
     void stop()
     {
         m_active = false;
-        m_queue.emplace(std::nullopt);
+        // the mailbox keeps its last value, the consumer sees the end once it took that
+        if (m_latestOnly)
+            m_mailbox.close();
+        else
+            m_queue.emplace(std::nullopt);
     }
 
     void reset()
@@ -564,10 +1038,15 @@ private:
         m_suspended = false;
         m_active = true;
         m_throttle = 0;
+        m_droppedCount = 0;
+        m_enqueuedCount = 0;
+        m_throttledCount = 0;
+        m_latencyHist.clear();
         m_notifyPending = false;
         m_lastItemTime = currentTimePoint();
         while (m_queue.pop()) {
         } // ensure the queue is empty
+        m_mailbox.reset();
     }
 };
 
@@ -742,6 +1221,9 @@ public:
 
     /**
      * Push data to subscribers, copying it.
+     *
+     * Each subscriber receives a clone() of the data. For types with shared,
+     * copy-on-write payloads (Frame, SignalBlock*) this is a cheap reference copy.
      */
     void push(const T &data)
     {
@@ -932,6 +1414,17 @@ public:
         return std::optional<To>{std::in_place, std::move(*v)};
     }
 
+    size_t drainInto(std::vector<To> &out, size_t maxItems = std::numeric_limits<size_t>::max()) override
+    {
+        m_innerBatch.clear();
+        const auto count = m_inner->drainInto(m_innerBatch, maxItems);
+        out.reserve(out.size() + count);
+        for (auto &v : m_innerBatch)
+            out.emplace_back(std::move(v));
+        m_innerBatch.clear();
+        return count;
+    }
+
     bool callIfNextVar(const ProcessVarFn &fn) override
     {
         auto v = peekNext();
@@ -993,6 +1486,61 @@ public:
         m_inner->setThrottleItemsPerSec(itemsPerSec, allowMore);
     }
 
+    void setQueueLimit(size_t capacity, SubscriptionOverflowPolicy policy) override
+    {
+        m_inner->setQueueLimit(capacity, policy);
+    }
+
+    size_t queueCapacity() const override
+    {
+        return m_inner->queueCapacity();
+    }
+
+    SubscriptionOverflowPolicy overflowPolicy() const override
+    {
+        return m_inner->overflowPolicy();
+    }
+
+    void setLatestValueOnly(bool enabled) override
+    {
+        m_inner->setLatestValueOnly(enabled);
+    }
+
+    bool latestValueOnly() const override
+    {
+        return m_inner->latestValueOnly();
+    }
+
+    uint64_t droppedCount() const override
+    {
+        return m_inner->droppedCount();
+    }
+
+    uint64_t enqueuedCount() const override
+    {
+        return m_inner->enqueuedCount();
+    }
+
+    uint64_t throttledCount() const override
+    {
+        return m_inner->throttledCount();
+    }
+
+    void setLatencyTracing(bool enabled) override
+    {
+        m_inner->setLatencyTracing(enabled);
+    }
+
+    bool latencyTracingEnabled() const override
+    {
+        return m_inner->latencyTracingEnabled();
+    }
+
+    QueueLatencyStats queueLatencyStats() const override
+    {
+        return m_inner->queueLatencyStats();
+    }
+
     void suspend() override
     {
         m_inner->suspend();
@@ -1035,6 +1583,7 @@ public:
 
 private:
     std::shared_ptr<StreamSubscription<From>> m_inner;
+    std::vector<From> m_innerBatch; // scratch space for batched conversions
 };
 
 /**
@@ -1249,16 +1249,28 @@ void FlowGraphEdge::updatePortTypeColors(void)
 
     // Detect a type-converted connection and surface it via a small bicolour
     // indicator near the input end plus a descriptive tooltip.
-    if (m_port1 && m_port2 && m_port1->portType() != m_port2->portType()) {
-        m_hasTypeConversion = true;
+    m_hasTypeConversion = m_port1 && m_port2 && m_port1->portType() != m_port2->portType();
+    updateToolTip();
+    update();
+}
+
+void FlowGraphEdge::updateToolTip()
+{
+    QStringList lines;
+    if (m_hasTypeConversion) {
         const auto srcName = BaseDataType::typeIdToString(m_port1->portType());
         const auto dstName = BaseDataType::typeIdToString(m_port2->portType());
-        setToolTip(QStringLiteral("%1 → %2").arg(QString::fromStdString(srcName), QString::fromStdString(dstName)));
-    } else {
-        m_hasTypeConversion = false;
-        setToolTip(QString());
+        lines.append(QStringLiteral("%1 → %2").arg(QString::fromStdString(srcName), QString::fromStdString(dstName)));
     }
-    update();
+    if (m_droppedCount > 0)
+        lines.append(QStringLiteral("Dropped by input queue limit: %1").arg(m_droppedCount));
+    if (m_queueLatency.count > 0) {
+        const auto p50 = queueLatencyToHumanString(m_queueLatency.p50);
+        const auto p99 = queueLatencyToHumanString(m_queueLatency.p99);
+        lines.append(QStringLiteral("Queueing latency: %1 (p50), %2 (p99)").arg(p50, p99));
+    }
+
+    setToolTip(lines.join(QLatin1Char('\n')));
 }
 
 void FlowGraphEdge::applyRestingShadow()
@@ -1300,6 +1312,20 @@ void FlowGraphEdge::setHeatLevel(ConnectionHeatLevel hlevel)
     update();
 }
 
+void FlowGraphEdge::setDroppedCount(quint64 count)
+{
+    if (m_droppedCount == count)
+        return;
+    m_droppedCount = count;
+    updateToolTip();
+}
+
+void FlowGraphEdge::setQueueLatency(const QueueLatencyStats &stats)
+{
+    m_queueLatency = stats;
+    updateToolTip();
+}
+
 //----------------------------------------------------------------------------
 // FlowGraphView
 
@@ -412,6 +412,8 @@ public:
     void updatePortTypeColors();
 
     void setHeatLevel(ConnectionHeatLevel hlevel);
+    void setDroppedCount(quint64 count);
+    void setQueueLatency(const QueueLatencyStats &stats);
 
     QRectF boundingRect() const override;
 
@@ -422,6 +424,7 @@ protected:
 private:
     FlowGraphView *graphView() const;
     void applyRestingShadow();
+    void updateToolTip();
 
     FlowGraphNodePort *m_port1;
     FlowGraphNodePort *m_port2;
@@ -429,6 +432,8 @@ private:
     bool m_hasTypeConversion{false};
     QPointF m_convIndicatorPos;
     ConnectionHeatLevel m_heatLevel{ConnectionHeatLevel::NONE};
+    quint64 m_droppedCount{0};
+    QueueLatencyStats m_queueLatency;
 };
 
 /**
@@ -54,6 +54,9 @@ GlobalConfigDialog::GlobalConfigDialog(QWidget *parent)
         ui->colorModeComboBox->setCurrentIndex(static_cast<int>(m_gc->appColorMode()));
     }
     ui->cbEmergencyOOMStop->setChecked(m_gc->emergencyOOMStop());
+    ui->cbTraceConnLatency->setChecked(m_gc->traceConnectionLatency());
+    ui->cbRecordPerfProfile->setChecked(m_gc->recordPerfProfile());
+    ui->cbConcurrentPrepare->setChecked(m_gc->concurrentPrepare());
     ui->cbNetEnabled->setChecked(m_gc->netControlEnabled());
     ui->sbNetControlPort->setValue(m_gc->netControlPort());
     ui->sbNetFeedbackPort->setValue(m_gc->netFeedbackPort());
@@ -71,6 +74,7 @@ GlobalConfigDialog::GlobalConfigDialog(QWidget *parent)
 
     ui->cpuAffinityWarnButton->setVisible(false);
     ui->explicitCoreAffinitiesCheckBox->setChecked(m_gc->explicitCoreAffinities());
+    ui->cbEventWorkerPool->setChecked(m_gc->eventWorkerPool());
 
     // devel section
     ui->cbDisplayDevModules->setChecked(m_gc->showDevelModules());
@@ -108,6 +112,24 @@ void GlobalConfigDialog::on_cbEmergencyOOMStop_toggled(bool checked)
         m_gc->setEmergencyOOMStop(checked);
 }
 
+void GlobalConfigDialog::on_cbTraceConnLatency_toggled(bool checked)
+{
+    if (m_acceptChanges)
+        m_gc->setTraceConnectionLatency(checked);
+}
+
+void GlobalConfigDialog::on_cbRecordPerfProfile_toggled(bool checked)
+{
+    if (m_acceptChanges)
+        m_gc->setRecordPerfProfile(checked);
+}
+
+void GlobalConfigDialog::on_cbConcurrentPrepare_toggled(bool checked)
+{
+    if (m_acceptChanges)
+        m_gc->setConcurrentPrepare(checked);
+}
+
 void GlobalConfigDialog::on_cbNetEnabled_toggled(bool checked)
 {
     if (m_acceptChanges)
@@ -176,6 +198,12 @@ void GlobalConfigDialog::on_cpuAffinityWarnButton_clicked()
             "see if it helps your individual setup's performance or latency."));
 }
 
+void GlobalConfigDialog::on_cbEventWorkerPool_toggled(bool checked)
+{
+    if (m_acceptChanges)
+        m_gc->setEventWorkerPool(checked);
+}
+
 void GlobalConfigDialog::on_cbDisplayDevModules_toggled(bool checked)
 {
     if (m_acceptChanges)
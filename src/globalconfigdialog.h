@@ -40,6 +40,9 @@ public:
 private slots:
     void on_colorModeComboBox_currentIndexChanged(int index);
     void on_cbEmergencyOOMStop_toggled(bool checked);
+    void on_cbTraceConnLatency_toggled(bool checked);
+    void on_cbRecordPerfProfile_toggled(bool checked);
+    void on_cbConcurrentPrepare_toggled(bool checked);
     void on_cbNetEnabled_toggled(bool checked);
     void on_sbNetControlPort_valueChanged(int arg1);
     void on_sbNetFeedbackPort_valueChanged(int arg1);
@@ -50,6 +53,7 @@ private slots:
     void on_defaultRTPrioSpinBox_valueChanged(int arg1);
     void on_explicitCoreAffinitiesCheckBox_toggled(bool checked);
     void on_cpuAffinityWarnButton_clicked();
+    void on_cbEventWorkerPool_toggled(bool checked);
 
     void on_cbDisplayDevModules_toggled(bool checked);
     void on_cbSaveDiagnostic_toggled(bool checked);
@@ -325,6 +325,8 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_engine, &Engine::runStopped, this, &MainWindow::onEngineStopped);
     connect(m_engine, &Engine::resourceWarningUpdate, this, &MainWindow::onEngineResourceWarningUpdate);
     connect(m_engine, &Engine::connectionHeatChangedAtPort, this, &MainWindow::onEngineConnectionHeatChanged);
+    connect(m_engine, &Engine::connectionDropsChangedAtPort, this, &MainWindow::onEngineConnectionDropsChanged);
+    connect(m_engine, &Engine::connectionLatencyChangedAtPort, this, &MainWindow::onEngineConnectionLatencyChanged);
     connect(m_engine, &Engine::moduleInitStarted, this, [this]() {
         showBusyIndicatorProcessing();
         setConfigModifyAllowed(false);
@@ -1524,6 +1526,17 @@ void MainWindow::onEngineConnectionHeatChanged(VarStreamInputPort *iport, Connec
     ui->graphForm->setConnectionHeat(iport, hlevel);
 }
 
+void MainWindow::onEngineConnectionDropsChanged(VarStreamInputPort *iport, quint64 droppedCount)
+{
+    ui->graphForm->setConnectionDropCount(iport, droppedCount);
+}
+
+void MainWindow::onEngineConnectionLatencyChanged(VarStreamInputPort *iport, const QueueLatencyStats &stats)
+{
+    ui->graphForm->setConnectionLatency(iport, stats);
+    m_timingsDialog->setConnectionLatency(iport, stats);
+}
+
 void MainWindow::statusMessageChanged(const QString &message)
 {
     setStatusText(message);
@@ -139,6 +139,8 @@ private slots:
     void onEngineStopped();
     void onEngineResourceWarningUpdate(Engine::SystemResource kind, bool resolved, const QString &message);
     void onEngineConnectionHeatChanged(VarStreamInputPort *iport, ConnectionHeatLevel hlevel);
+    void onEngineConnectionDropsChanged(VarStreamInputPort *iport, quint64 droppedCount);
+    void onEngineConnectionLatencyChanged(VarStreamInputPort *iport, const QueueLatencyStats &stats);
     void onElapsedTimeUpdate();
 
     void statusMessageChanged(const QString &message);
@@ -19,8 +19,13 @@
 
 #pragma once
 
-#include <string>
+#include <algorithm>
 #include <expected>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
 #include <iox2/iceoryx2.hpp>
 
 #include "mlink/ipc-types-private.h"
@@ -39,6 +44,7 @@ using IoxByteSlice = iox2::bb::Slice<std::byte>;
 
 using IoxSlicePublisher = iox2::Publisher<iox2::ServiceType::Ipc, IoxByteSlice, void>;
 using IoxSliceSubscriber = iox2::Subscriber<iox2::ServiceType::Ipc, IoxByteSlice, void>;
+using IoxSliceSample = iox2::Sample<iox2::ServiceType::Ipc, IoxByteSlice, void>;
 using IoxListener = iox2::Listener<iox2::ServiceType::Ipc>;
 using IoxNotifier = iox2::Notifier<iox2::ServiceType::Ipc>;
 
@@ -213,7 +219,7 @@ public:
                                .max_nodes(topology.maxNodes)
                                .history_size(SY_IOX_HISTORY_SIZE)
                                .subscriber_max_buffer_size(SY_IOX_QUEUE_CAPACITY)
-                               .subscriber_max_borrowed_samples(1)
+                               .subscriber_max_borrowed_samples(SY_IOX_MAX_BORROWED_SAMPLES)
                                // Non-lossy: when a subscriber's buffer is full, the publisher's
                                // RetryUntilDelivered send blocks instead of overwriting the oldest
                                // sample. With the default safe-overflow ring, RetryUntilDelivered is
@@ -441,6 +447,18 @@ private:
     bool m_valid = false;
 };
 
+/**
+ * Bookkeeping for samples that SySubscriber::handleEventsBatched() handed out as shared owners.
+ *
+ * Owners may be released from any thread, so released samples are parked here and only
+ * returned to the publisher from the subscriber's own thread.
+ */
+struct IoxRetainedSamples {
+    std::mutex mutex;
+    size_t liveCount = 0;
+    std::vector<IoxSliceSample> released;
+};
+
 /**
  * @brief Subscriber side of a Syntalos data channel.
  *
@@ -462,6 +480,8 @@ public:
           m_listener{std::move(other.m_listener)},
           m_serviceName{std::move(other.m_serviceName)},
           m_logFn(std::move(other.m_logFn)),
+          m_retained{std::move(other.m_retained)},
+          m_batchesStalled{other.m_batchesStalled},
           m_valid{other.m_valid}
     {
         other.m_valid = false;
@@ -475,6 +495,8 @@ public:
             m_listener = std::move(other.m_listener);
             m_serviceName = std::move(other.m_serviceName);
             m_logFn = std::move(other.m_logFn);
+            m_retained = std::move(other.m_retained);
+            m_batchesStalled = other.m_batchesStalled;
             m_valid = other.m_valid;
             other.m_valid = false;
         }
@@ -522,7 +544,7 @@ public:
                                .max_nodes(topology.maxNodes)
                                .history_size(SY_IOX_HISTORY_SIZE)
                                .subscriber_max_buffer_size(SY_IOX_QUEUE_CAPACITY)
-                               .subscriber_max_borrowed_samples(1)
+                               .subscriber_max_borrowed_samples(SY_IOX_MAX_BORROWED_SAMPLES)
                                // No overflow, so a slow consumer backpressures the sender
                                // instead of silently dropping data.
                                .enable_safe_overflow(false)
@@ -674,6 +696,89 @@ public:
         }
     }
 
+    /**
+     * Drain all pending samples like handleEvents(), but hand them to @p callback in batches.
+     *
+     * Up to @p maxBatch samples (at most SY_IOX_MAX_BORROWED_SAMPLES) are passed to
+     * @p callback(std::span<const std::shared_ptr<const IoxSliceSample>>) together.
+     * A sample is returned to the publisher once the last copy of its owner is released,
+     * so the callback may keep owners to use the payload after it returned. Kept samples
+     * count against the borrow limit: while all of them are held, delivery stalls
+     * (see batchesStalled()) and the remaining samples stay queued.
+     */
+    template<typename Fn>
+    void handleEventsBatched(size_t maxBatch, Fn &&callback)
+    {
+        maxBatch = std::clamp<size_t>(maxBatch, 1, SY_IOX_MAX_BORROWED_SAMPLES);
+
+        // We receive until the subscriber buffer is empty anyway, so we only need to
+        // drain the listener here to keep the WaitSet from firing again immediately.
+        for (auto event = m_listener.try_wait_one(); event.has_value() && event->has_value();
+             event = m_listener.try_wait_one()) {
+        }
+
+        std::vector<IoxSliceSample> samples;
+        std::vector<std::shared_ptr<const IoxSliceSample>> owners;
+        samples.reserve(maxBatch);
+        owners.reserve(maxBatch);
+
+        const auto dispatchBatch = [&]() {
+            for (auto &sample : samples)
+                owners.push_back(makeSampleOwner(std::move(sample)));
+            samples.clear();
+            callback(std::span<const std::shared_ptr<const IoxSliceSample>>(owners));
+
+            // any sample the callback did not keep goes back to the publisher
+            owners.clear();
+        };
+
+        for (;;) {
+            const auto batchLimit = std::min(maxBatch, returnReleasedSamples());
+            if (batchLimit == 0) {
+                if (!m_batchesStalled)
+                    logMessage(
+                        datactl::LogSeverity::Warning,
+                        "All received samples on {} are still referenced, delaying delivery until some are released",
+                        m_serviceName.to_string().unchecked_access().c_str());
+                m_batchesStalled = true;
+                break;
+            }
+            m_batchesStalled = false;
+
+            if (samples.size() >= batchLimit) {
+                dispatchBatch();
+                continue;
+            }
+
+            auto maybeReceived = m_subscriber.receive();
+            if (!maybeReceived.has_value()) [[unlikely]] {
+                logMessage(
+                    datactl::LogSeverity::Error,
+                    "Failed to receive sample on {}: {}",
+                    m_serviceName.to_string().unchecked_access().c_str(),
+                    iox2::bb::into<const char *>(maybeReceived.error()));
+                break;
+            }
+            auto &sample = maybeReceived.value();
+            if (!sample.has_value())
+                break;
+
+            samples.push_back(std::move(*sample));
+        }
+
+        if (!samples.empty())
+            dispatchBatch();
+    }
+
+    /**
+     * True if the last handleEventsBatched() call left samples queued because all
+     * borrowable samples were still referenced. Call it again once owners were released.
+     */
+    [[nodiscard]] bool batchesStalled() const
+    {
+        return m_batchesStalled;
+    }
+
     /**
      * Discard any pending data.
      */
@@ -704,10 +809,36 @@ private:
           m_listener{std::move(listener)},
           m_serviceName{std::move(serviceName)},
           m_logFn(std::move(logFn)),
+          m_retained{std::make_shared<IoxRetainedSamples>()},
           m_valid{true}
     {
     }
 
+    std::shared_ptr<const IoxSliceSample> makeSampleOwner(IoxSliceSample &&sample)
+    {
+        {
+            std::lock_guard lock(m_retained->mutex);
+            m_retained->liveCount++;
+        }
+        return {
+            new IoxSliceSample(std::move(sample)), [retained = m_retained](IoxSliceSample *released) {
+                std::unique_ptr<IoxSliceSample> owned(released);
+                std::lock_guard lock(retained->mutex);
+                retained->liveCount--;
+                retained->released.push_back(std::move(*owned));
+            }};
+    }
+
+    /**
+     * Return released samples to the publisher and get the number of samples we may still borrow.
+     */
+    size_t returnReleasedSamples()
+    {
+        std::lock_guard lock(m_retained->mutex);
+        m_retained->released.clear();
+        return SY_IOX_MAX_BORROWED_SAMPLES - m_retained->liveCount;
+    }
+
     template<typename... Args>
     inline void logMessage(datactl::LogSeverity severity, std::format_string<Args...> fmt, Args &&...args)
     {
@@ -723,6 +854,8 @@ private:
     IoxListener m_listener;
     iox2::ServiceName m_serviceName;
     IpcLogFn m_logFn = {};
+    std::shared_ptr<IoxRetainedSamples> m_retained;
+    bool m_batchesStalled = false;
     bool m_valid = false;
 };
 
@@ -31,6 +31,9 @@ namespace Syntalos
 // number of elements to hold in the IPC queues
 static constexpr uint64_t SY_IOX_QUEUE_CAPACITY = 16U;
 
+// number of received samples a subscriber may hold at once (for batched delivery)
+static constexpr uint64_t SY_IOX_MAX_BORROWED_SAMPLES = 8U;
+
 // number of elements to hold in the publisher history
 static constexpr uint64_t SY_IOX_HISTORY_SIZE = 1U;
 
@@ -137,6 +137,7 @@ public:
           dataTypeId(pc.dataTypeId),
           sourceTypeId(0),
           metadata(pc.metadata),
+          maxBatchSize(1),
           throttleItemsPerSec(0)
     {
     }
@@ -154,6 +155,9 @@ public:
 
     NewDataRawFn newDataRawCb;
     NewDataFn newDataCb;
+    NewDataRawBatchFn newDataRawBatchCb;
+    size_t maxBatchSize;
+    std::vector<RawDataRef> batchRefs;
     uint throttleItemsPerSec;
 };
 
@@ -201,9 +205,11 @@ void resolveTypedNewDataCallback(InputPortInfo *iport)
             using T = typename decltype(tag)::type;
             if (T::staticTypeId() != dstId)
                 return false;
-            resolved = [varCbPtr](const void *data, size_t size) {
-                T value = T::fromMemory(data, size);
-                (*varCbPtr)(value);
+            // deserialize every sample into the same object, so its buffers are reused
+            // in steady state (a callback that keeps a copy of a shared payload gets a fresh one)
+            resolved = [varCbPtr, value = std::make_shared<T>()](const void *data, size_t size) {
+                deserializeFromMemoryInto(data, size, *value);
+                (*varCbPtr)(*value);
             };
             return true;
         });
@@ -261,6 +267,13 @@ void InputPortInfo::setNewDataCallback(NewDataFn callback)
         resolveTypedNewDataCallback(this);
 }
 
+void InputPortInfo::setNewDataRawBatchCallback(NewDataRawBatchFn callback, size_t maxBatchSize)
+{
+    d->newDataRawBatchCb = std::move(callback);
+    d->maxBatchSize = std::clamp<size_t>(maxBatchSize, 1, SY_IOX_MAX_BORROWED_SAMPLES);
+    d->batchRefs.reserve(d->maxBatchSize);
+}
+
 void InputPortInfo::setThrottleItemsPerSec(uint itemsPerSec)
 {
     d->throttleItemsPerSec = itemsPerSec;
@@ -692,6 +705,39 @@ public:
         }
     }
 
+    /**
+     * Deliver all pending samples of a port with a batch callback.
+     */
+    void dispatchBatches(const std::shared_ptr<InputPortInfo> &iport)
+    {
+        auto &refs = iport->d->batchRefs;
+        iport->d->ioxSub->handleEventsBatched(
+            iport->d->maxBatchSize, [&](std::span<const std::shared_ptr<const IoxSliceSample>> samples) {
+                refs.clear();
+                for (const auto &sample : samples) {
+                    const auto pl = sample->payload();
+                    refs.push_back({pl.data(), pl.number_of_bytes(), sample});
+                }
+                iport->d->newDataRawBatchCb(refs);
+                refs.clear();
+            });
+    }
+
+    /**
+     * Resume batch delivery on ports that stalled because the consumer held on to all samples.
+     *
+     * No new notification arrives for the samples left queued, so we have to poll for them.
+     */
+    void resumeStalledBatches()
+    {
+        for (auto &iport : inPortInfo) {
+            if (!iport->d->connected || !iport->d->ioxSub.has_value() || !iport->d->newDataRawBatchCb)
+                continue;
+            if (iport->d->ioxSub->batchesStalled())
+                dispatchBatches(iport);
+        }
+    }
+
     /**
      * Process any incoming data on the input ports.
      */
@@ -703,7 +749,9 @@ public:
             if (!iport->d->ioxGuard.has_value() || !attachmentId.has_event_from(*iport->d->ioxGuard))
                 continue;
 
-            if (iport->d->newDataRawCb) {
+            if (iport->d->newDataRawBatchCb) {
+                dispatchBatches(iport);
+            } else if (iport->d->newDataRawCb) {
                 iport->d->ioxSub->handleEvents([&](const IoxImmutableByteSlice &pl) {
                     iport->d->newDataRawCb(pl.data(), pl.number_of_bytes());
                 });
@@ -1224,6 +1272,7 @@ void SyntalosLink::awaitData(int timeoutUsec, const std::function<void()> &event
 
             handleRunResult(
                 d->waitSet->wait_and_process_once_with_timeout(onEvent, iox2::bb::Duration::from_millis(250)));
+            d->resumeStalledBatches();
             if (eventFn)
                 eventFn();
 
@@ -1237,6 +1286,7 @@ void SyntalosLink::awaitData(int timeoutUsec, const std::function<void()> &event
     } else {
         handleRunResult(
             d->waitSet->wait_and_process_once_with_timeout(onEvent, iox2::bb::Duration::from_micros(timeoutUsec)));
+        d->resumeStalledBatches();
         if (eventFn)
             eventFn();
     }
@@ -1283,6 +1333,8 @@ void SyntalosLink::awaitDataForever(const std::function<void()> &eventFn, int in
         if (r == iox2::WaitSetRunResult::Interrupt || r == iox2::WaitSetRunResult::TerminationRequest)
             d->shutdownPending = true;
 
+        d->resumeStalledBatches();
+
         // call external event function
         if (eventFn)
             eventFn();
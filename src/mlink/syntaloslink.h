@@ -20,6 +20,8 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <syntalos-datactl>
 
 namespace Syntalos
@@ -44,6 +46,18 @@ using ShutdownFn = std::function<void()>;
 using NewDataRawFn = std::function<void(const void *data, size_t size)>;
 using NewDataFn = std::function<void(BaseDataType &data)>;
 
+/**
+ * @brief Raw wire bytes of a received sample.
+ *
+ * The bytes stay valid for as long as a copy of @p owner exists.
+ */
+struct RawDataRef {
+    const void *data;
+    size_t size;
+    std::shared_ptr<const void> owner;
+};
+using NewDataRawBatchFn = std::function<void(std::span<const RawDataRef> batch)>;
+
 using ShowSettingsFn = std::function<void(void)>;
 using ShowDisplayFn = std::function<void(void)>;
 
@@ -106,6 +120,22 @@ public:
      */
     void setNewDataCallback(NewDataFn callback);
 
+    /**
+     * @brief Set a low-level callback invoked with batches of raw received samples.
+     *
+     * All samples that are pending on this port are delivered in batches of up to
+     * @p maxBatchSize items, with one call per batch. The batch size is capped at the number
+     * of samples a port may hold at once (currently 8). All memory blocks of a batch are
+     * views into the received shared-memory samples. Keep a copy of RawDataRef::owner to use a block
+     * after the call returned; no new data is received while the port's samples are all held this way.
+     * Like with setNewDataRawCallback(), the bytes are in the source's native serialization format.
+     *
+     * This is meant for consumers that have a high per-call overhead, such as script
+     * language bindings. If set, this callback takes precedence over all other data callbacks.
+     * Passing nullptr disables batched delivery again.
+     */
+    void setNewDataRawBatchCallback(NewDataRawBatchFn callback, size_t maxBatchSize);
+
     void setThrottleItemsPerSec(uint itemsPerSec);
 
     /**
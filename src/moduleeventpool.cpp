@@ -0,0 +1,586 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "moduleeventpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
+
+#include "datactl/priv/cpuaffinity.h"
+#include "datactl/priv/rtkit.h"
+#include "perfprofiler.h"
+#include "utils/misc.h"
+
+using namespace Syntalos;
+
+/// Maximum number of epoll events a worker takes in one go
+static constexpr int POOL_MAX_EPOLL_EVENTS = 8;
+
+struct PoolModule;
+
+/**
+ * An event source of a module: a timer or a subscription with new data.
+ */
+struct PoolSource {
+    enum class Kind {
+        Timer,
+        RecvData
+    };
+
+    Kind kind{Kind::Timer};
+    int fd{-1}; // timerfd, or eventfd of the subscription
+    PoolModule *owner{};
+
+    // set by the worker that received the event, cleared by the worker running the module
+    std::atomic_bool pending{false};
+
+    // set before the workers start, only cleared by the worker running the owning module
+    std::atomic_bool registered{false};
+
+    int interval{0};
+    intervalEventFunc_t intervalFn{};
+
+    recvDataEventFunc_t recvFn{};
+    VariantStreamSubscription *sub{};
+};
+
+/**
+ * A module participating in the pool. Its event handlers are serialized, the module
+ * is only ever run by one worker at a time.
+ */
+struct PoolModule {
+    AbstractModule *mod{};
+    std::vector<std::unique_ptr<PoolSource>> sources;
+    std::atomic_bool scheduled{false};
+    bool failed{false};
+};
+
+struct PoolWorker {
+    std::thread thread;
+    std::mutex mutex;
+    std::deque<PoolModule *> tasks;
+    ThreadCpuClock cpuClock;
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+class ModuleEventPool::Private
+{
+public:
+    Private() {}
+    ~Private() {}
+
+    QString poolName;
+    std::atomic_bool running;
+    std::atomic_bool failed;
+    bool threadsActive;
+    QuillLogger *log;
+
+    int epollFd;
+    int stopFd; // level-triggered, written once to release all workers
+    int wakeFd; // wakes idle workers so they can steal queued tasks
+    std::atomic_uint idleWorkers;
+
+    std::vector<std::unique_ptr<PoolModule>> modules;
+    std::vector<std::unique_ptr<PoolWorker>> workers;
+
+    std::vector<uint> cpuAffinity;
+    bool realtime;
+    int rtPriority;
+    int niceness;
+};
+#pragma GCC diagnostic pop
+
+static bool armSourceTimer(PoolSource *src)
+{
+    // an interval of 0 means the callback is run as often as possible, just like
+    // a GLib timeout source with a zero interval
+    struct itimerspec spec = {};
+    if (src->interval == 0) {
+        spec.it_interval.tv_nsec = 1;
+    } else {
+        spec.it_interval.tv_sec = src->interval / 1000;
+        spec.it_interval.tv_nsec = static_cast<long>(src->interval % 1000) * 1000 * 1000;
+    }
+    spec.it_value = spec.it_interval;
+    return timerfd_settime(src->fd, 0, &spec, nullptr) == 0;
+}
+
+static bool registerSource(int epollFd, PoolSource *src)
+{
+    // added disarmed, the source only reports events once it was armed via rearmSource()
+    struct epoll_event ev = {};
+    ev.events = EPOLLONESHOT;
+    ev.data.ptr = src;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, src->fd, &ev) != 0)
+        return false;
+    src->registered = true;
+    return true;
+}
+
+static bool rearmSource(int epollFd, PoolSource *src)
+{
+    if (!src->registered)
+        return true;
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = src;
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, src->fd, &ev) == 0)
+        return true;
+
+    // the module may have failed and dropped its sources while we were arming this one
+    return errno == ENOENT && !src->registered;
+}
+
+static bool unregisterSource(int epollFd, PoolSource *src)
+{
+    if (!src->registered.exchange(false))
+        return true;
+    return epoll_ctl(epollFd, EPOLL_CTL_DEL, src->fd, nullptr) == 0;
+}
+
+ModuleEventPool::ModuleEventPool(uint workerCount, const QString &poolName)
+    : d(new ModuleEventPool::Private)
+{
+    d->running = false;
+    d->failed = false;
+    d->threadsActive = false;
+    d->idleWorkers = 0;
+    d->realtime = false;
+    d->rtPriority = 0;
+    d->niceness = 0;
+
+    const auto name = poolName.isEmpty() ? createRandomString(9) : poolName;
+    d->poolName = QStringLiteral("evp:%1").arg(name);
+    d->log = getLogger(QStringLiteral("evp.%1").arg(name));
+
+    for (uint i = 0; i < std::max(workerCount, 1u); i++)
+        d->workers.push_back(std::make_unique<PoolWorker>());
+
+    d->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    d->stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    d->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (d->epollFd < 0 || d->stopFd < 0 || d->wakeFd < 0) {
+        LOG_CRITICAL(d->log, "Unable to create event pool file descriptors: {}", std::strerror(errno));
+        d->log->flush_log();
+        std::abort();
+    }
+
+    // the stop and wakeup descriptors are identified by a null pointer / their fd
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(d->epollFd, EPOLL_CTL_ADD, d->stopFd, &ev) != 0) {
+        LOG_CRITICAL(d->log, "Unable to watch event pool stop descriptor: {}", std::strerror(errno));
+        d->log->flush_log();
+        std::abort();
+    }
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = &d->wakeFd;
+    if (epoll_ctl(d->epollFd, EPOLL_CTL_ADD, d->wakeFd, &ev) != 0)
+        LOG_ERROR(d->log, "Unable to watch event pool wakeup descriptor: {}", std::strerror(errno));
+}
+
+ModuleEventPool::~ModuleEventPool()
+{
+    shutdownWorkers();
+
+    for (const auto &pm : d->modules) {
+        for (const auto &src : pm->sources) {
+            if (src->kind == PoolSource::Kind::Timer)
+                ::close(src->fd);
+        }
+    }
+    ::close(d->wakeFd);
+    ::close(d->stopFd);
+    ::close(d->epollFd);
+}
+
+bool ModuleEventPool::isRunning() const
+{
+    return d->running;
+}
+
+bool ModuleEventPool::isFailed() const
+{
+    return d->failed;
+}
+
+QString ModuleEventPool::threadName() const
+{
+    return d->poolName;
+}
+
+uint ModuleEventPool::workerCount() const
+{
+    return d->workers.size();
+}
+
+void ModuleEventPool::setFailed(bool failed)
+{
+    d->failed = failed;
+}
+
+QuillLogger *ModuleEventPool::logger() const
+{
+    return d->log;
+}
+
+std::vector<const ThreadCpuClock *> ModuleEventPool::workerCpuClocks() const
+{
+    std::vector<const ThreadCpuClock *> clocks;
+    clocks.reserve(d->workers.size());
+    for (const auto &worker : d->workers)
+        clocks.push_back(&worker->cpuClock);
+    return clocks;
+}
+
+void ModuleEventPool::run(
+    const QList<AbstractModule *> &mods,
+    OptionalWaitCondition *waitCondition,
+    const std::vector<uint> &cpuAffinity,
+    bool realtime,
+    int rtPriority,
+    int niceness)
+{
+    if (d->threadsActive)
+        return;
+
+    d->cpuAffinity = cpuAffinity;
+    d->realtime = realtime;
+    d->rtPriority = rtPriority;
+    d->niceness = niceness;
+
+    // create and register the event sources before any worker runs,
+    // they are only armed once the run has started
+    d->modules.clear();
+    for (const auto &mod : mods) {
+        auto pm = std::make_unique<PoolModule>();
+        pm->mod = mod;
+
+        // add "timer" event sources
+        for (const auto &ev : mod->intervalEventCallbacks()) {
+            if (ev.second < 0)
+                continue;
+
+            auto src = std::make_unique<PoolSource>();
+            src->kind = PoolSource::Kind::Timer;
+            src->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+            if (src->fd < 0) {
+                LOG_CRITICAL(d->log, "Unable to create timer for module '{}': {}", mod->name(), std::strerror(errno));
+                continue;
+            }
+            src->owner = pm.get();
+            src->interval = ev.second;
+            src->intervalFn = ev.first;
+            pm->sources.push_back(std::move(src));
+        }
+
+        // add "received data in subscription" event sources
+        for (const auto &ev : mod->recvDataEventCallbacks()) {
+            auto sub = ev.second;
+            if (sub == nullptr) {
+                LOG_CRITICAL(
+                    d->log,
+                    "Bad event destination in module '{}'. Was the event subscription valid?",
+                    mod->name());
+                continue;
+            }
+
+            auto src = std::make_unique<PoolSource>();
+            src->kind = PoolSource::Kind::RecvData;
+            src->fd = sub->enableNotify();
+            src->owner = pm.get();
+            src->recvFn = ev.first;
+            src->sub = sub.get();
+            pm->sources.push_back(std::move(src));
+        }
+
+        for (const auto &src : pm->sources) {
+            if (!registerSource(d->epollFd, src.get()))
+                LOG_CRITICAL(
+                    d->log, "Unable to watch event source of module '{}': {}", mod->name(), std::strerror(errno));
+        }
+
+        d->modules.push_back(std::move(pm));
+    }
+
+    d->running = true;
+    d->threadsActive = true;
+    for (uint i = 0; i < d->workers.size(); i++)
+        d->workers[i]->thread = std::thread(&ModuleEventPool::workerThreadFunc, this, i, waitCondition);
+}
+
+void ModuleEventPool::stop()
+{
+    shutdownWorkers();
+}
+
+void ModuleEventPool::shutdownWorkers()
+{
+    if (!d->threadsActive)
+        return;
+    d->running = false;
+
+    // the stop descriptor is level-triggered and never read, so it releases every worker
+    const uint64_t buffer = 1;
+    if (write(d->stopFd, &buffer, sizeof(buffer)) == -1)
+        LOG_ERROR(d->log, "Unable to signal event pool workers to stop: {}", std::strerror(errno));
+
+    for (auto &worker : d->workers)
+        worker->thread.join();
+    d->threadsActive = false;
+
+    // no worker is left that could dispatch events, so drop all sources from the epoll set
+    for (const auto &pm : d->modules) {
+        for (const auto &src : pm->sources) {
+            if (!unregisterSource(d->epollFd, src.get()))
+                LOG_WARNING(
+                    d->log,
+                    "Unable to unwatch event source of module '{}': {}",
+                    pm->mod->name(),
+                    std::strerror(errno));
+        }
+    }
+}
+
+void ModuleEventPool::workerThreadFunc(uint index, OptionalWaitCondition *waitCondition)
+{
+    const auto threadName = QStringLiteral("%1-%2").arg(d->poolName.mid(0, 12)).arg(index);
+    pthread_setname_np(pthread_self(), qPrintable(threadName.mid(0, 15)));
+    auto &self = *d->workers[index];
+    self.cpuClock.captureCurrentThread();
+
+    if (!d->cpuAffinity.empty())
+        thread_set_affinity_from_vec(pthread_self(), d->cpuAffinity);
+
+    // every worker may run any module, so all of them get the same elevation
+    if (d->realtime) {
+        if (setCurrentThreadRealtime(d->rtPriority))
+            LOG_INFO(d->log, "Event pool worker '{}' set to realtime mode.", threadName);
+    } else if (d->niceness != 0) {
+        setCurrentThreadNiceness(d->niceness);
+    }
+
+    // wait for us to start
+    waitCondition->wait();
+
+    // the first worker arms all registered event sources, the others pick up events as soon as they arrive
+    if (index == 0) {
+        size_t activeCount = 0;
+        for (const auto &pm : d->modules) {
+            // modules which signal that they will not be doing anything don't need to be called
+            if (pm->mod->state() == ModuleState::IDLE)
+                continue;
+            activeCount++;
+
+            for (const auto &src : pm->sources) {
+                if (src->kind == PoolSource::Kind::Timer && !armSourceTimer(src.get())) {
+                    LOG_ERROR(
+                        d->log,
+                        "Unable to arm timer of module '{}': {}",
+                        pm->mod->name(),
+                        std::strerror(errno));
+                    continue;
+                }
+                if (!rearmSource(d->epollFd, src.get()))
+                    LOG_ERROR(
+                        d->log,
+                        "Unable to arm event source of module '{}': {}",
+                        pm->mod->name(),
+                        std::strerror(errno));
+            }
+        }
+
+        if (activeCount == 0 || d->failed) {
+            if (activeCount == 0)
+                LOG_INFO(d->log, "All evented modules are idle, shutting down their worker pool.");
+            const uint64_t buffer = 1;
+            if (write(d->stopFd, &buffer, sizeof(buffer)) == -1)
+                LOG_ERROR(d->log, "Unable to signal event pool workers to stop: {}", std::strerror(errno));
+        }
+    }
+
+    const auto popLocalTask = [&self]() -> PoolModule * {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (self.tasks.empty())
+            return nullptr;
+        auto task = self.tasks.back();
+        self.tasks.pop_back();
+        return task;
+    };
+
+    const auto stealTask = [this, index]() -> PoolModule * {
+        // steal the oldest task of the first busy worker, starting with our neighbor
+        const auto workerCount = d->workers.size();
+        for (size_t i = 1; i < workerCount; i++) {
+            auto &victim = *d->workers[(index + i) % workerCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty())
+                continue;
+            auto task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return task;
+        }
+        return nullptr;
+    };
+
+    const auto scheduleTask = [this, &self](PoolModule *pm) {
+        if (pm->scheduled.exchange(true))
+            return; // already queued or running, the running worker will pick the event up
+        size_t queueLen;
+        {
+            std::lock_guard<std::mutex> lock(self.mutex);
+            self.tasks.push_back(pm);
+            queueLen = self.tasks.size();
+        }
+
+        // we have more work than we can do right now, let an idle worker steal some of it
+        if (queueLen > 1 && d->idleWorkers > 0) {
+            const uint64_t buffer = 1;
+            if (write(d->wakeFd, &buffer, sizeof(buffer)) == -1 && errno != EAGAIN)
+                LOG_WARNING(d->log, "Unable to wake idle event pool worker: {}", std::strerror(errno));
+        }
+    };
+
+    const auto dispatchSource = [this](PoolModule *pm, PoolSource *src) {
+        if (src->kind == PoolSource::Kind::Timer) {
+            uint64_t expirations;
+            if (read(src->fd, &expirations, sizeof(expirations)) == -1 && errno != EAGAIN)
+                LOG_WARNING(d->log, "Failed to read timer of module '{}': {}", pm->mod->name(), std::strerror(errno));
+
+            int interval = src->interval;
+            std::invoke(src->intervalFn, pm->mod, interval);
+
+            // interval < 0 means we should stop this event source
+            if (interval < 0) {
+                if (!unregisterSource(d->epollFd, src))
+                    LOG_WARNING(
+                        d->log, "Unable to stop timer of module '{}': {}", pm->mod->name(), std::strerror(errno));
+                return;
+            }
+
+            // the interval was adjusted, so the timer needs to fire at a different rate
+            if (interval != src->interval) {
+                src->interval = interval;
+                armSourceTimer(src);
+            }
+        } else {
+            // drains the eventfd and clears the coalesced-wakeup flag
+            src->sub->acknowledgeNotify();
+            src->recvFn();
+
+            // the handler may only process a bounded batch per dispatch; re-arm so we
+            // are woken again until the queue is drained
+            src->sub->rearmNotifyIfPending();
+        }
+
+        if (pm->mod->state() == ModuleState::ERROR) {
+            // ewww, this module failed. suspend execution of all its handlers
+            pm->failed = true;
+            setFailed(true);
+            LOG_INFO(d->log, "Module '{}' failed in event pool. Stopping.", pm->mod->name());
+            for (const auto &s : pm->sources) {
+                if (!unregisterSource(d->epollFd, s.get()))
+                    LOG_WARNING(
+                        d->log,
+                        "Unable to unwatch event source of module '{}': {}",
+                        pm->mod->name(),
+                        std::strerror(errno));
+            }
+            return;
+        }
+
+        if (!rearmSource(d->epollFd, src))
+            LOG_ERROR(
+                d->log, "Unable to re-arm event source of module '{}': {}", pm->mod->name(), std::strerror(errno));
+    };
+
+    const auto runTask = [&dispatchSource](PoolModule *pm) {
+        while (true) {
+            for (const auto &src : pm->sources) {
+                if (pm->failed)
+                    break;
+                if (src->pending.exchange(false))
+                    dispatchSource(pm, src.get());
+            }
+            pm->scheduled = false;
+
+            // an event may have arrived while we were running this module, and the worker
+            // that received it could not schedule the module again
+            const bool hasPending = !pm->failed
+                                    && std::any_of(pm->sources.cbegin(), pm->sources.cend(), [](const auto &src) {
+                                           return src->pending.load();
+                                       });
+            if (!hasPending || pm->scheduled.exchange(true))
+                break;
+        }
+    };
+
+    bool stopRequested = false;
+    while (!stopRequested) {
+        auto task = popLocalTask();
+        if (task == nullptr)
+            task = stealTask();
+        if (task != nullptr) {
+            runTask(task);
+            continue;
+        }
+
+        struct epoll_event events[POOL_MAX_EPOLL_EVENTS];
+        d->idleWorkers++;
+        const auto n = epoll_wait(d->epollFd, events, POOL_MAX_EPOLL_EVENTS, -1);
+        d->idleWorkers--;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR(d->log, "Event pool worker failed to wait for events: {}", std::strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            const auto ptr = events[i].data.ptr;
+            if (ptr == nullptr) {
+                stopRequested = true;
+            } else if (ptr == &d->wakeFd) {
+                uint64_t buffer;
+                if (read(d->wakeFd, &buffer, sizeof(buffer)) == -1 && errno != EAGAIN)
+                    LOG_WARNING(d->log, "Unable to read event pool wakeup: {}", std::strerror(errno));
+            } else {
+                auto src = static_cast<PoolSource *>(ptr);
+                src->pending = true;
+                scheduleTask(src->owner);
+            }
+        }
+    }
+
+    // process the events we already took, but don't wait for new ones
+    while (auto task = popLocalTask())
+        runTask(task);
+}
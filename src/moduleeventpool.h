@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "moduleapi.h"
+#include "optionalwaitcondition.h"
+
+namespace Syntalos
+{
+
+class ThreadCpuClock;
+
+/**
+ * @brief Runs evented modules on a fixed-size pool of worker threads
+ *
+ * This is an alternative to running every group of evented modules on its own
+ * ModuleEventThread. Instead of one GMainLoop per group, all timer and
+ * new-data events of the participating modules are watched by a single epoll
+ * instance, and whichever worker is idle dispatches them. Workers that run out
+ * of work steal pending module tasks from busy workers.
+ *
+ * The event handlers of a single module are never run concurrently, so modules
+ * observe the same execution guarantees as on a dedicated event thread.
+ */
+class ModuleEventPool
+{
+public:
+    explicit ModuleEventPool(uint workerCount, const QString &poolName = QString());
+    ~ModuleEventPool();
+
+    bool isRunning() const;
+    bool isFailed() const;
+    QString threadName() const;
+    uint workerCount() const;
+
+    void setFailed(bool failed);
+
+    /**
+     * @brief Start the worker threads for the given modules.
+     *
+     * If @p cpuAffinity is not empty, all workers are bound to the given CPU cores.
+     * Every worker is elevated in the same way: if @p realtime is set it switches to
+     * realtime (SCHED_RR) scheduling at @p rtPriority, otherwise - if @p niceness is
+     * negative - it lowers its niceness.
+     */
+    void run(
+        const QList<AbstractModule *> &mods,
+        OptionalWaitCondition *waitCondition,
+        const std::vector<uint> &cpuAffinity = {},
+        bool realtime = false,
+        int rtPriority = 0,
+        int niceness = 0);
+    void stop();
+
+    QuillLogger *logger() const;
+
+    /**
+     * CPU time clocks of all workers, valid while the pool is running.
+     */
+    std::vector<const ThreadCpuClock *> workerCpuClocks() const;
+
+private:
+    class Private;
+    Q_DISABLE_COPY(ModuleEventPool)
+    std::unique_ptr<Private> d;
+
+    void shutdownWorkers();
+    void workerThreadFunc(uint index, OptionalWaitCondition *waitCondition);
+};
+
+} // namespace Syntalos
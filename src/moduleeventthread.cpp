@@ -20,10 +20,15 @@
 #include "moduleeventthread.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <glib.h>
+#include <sys/timerfd.h>
 #include <thread>
+#include <unistd.h>
 
 #include "datactl/priv/rtkit.h"
+#include "perfprofiler.h"
 #include "utils/misc.h"
 
 using namespace Syntalos;
@@ -40,6 +45,35 @@ public:
     GMainContext *context{};
 };
 
+/**
+ * A timed event that is run from a timerfd with absolute deadlines, instead of a GLib timeout.
+ */
+class PreciseTimerEventPayload
+{
+public:
+    ~PreciseTimerEventPayload()
+    {
+        if (timerFd >= 0)
+            close(timerFd);
+    }
+
+    int interval{0}; // in µs
+    AbstractModule *module{};
+    intervalEventFunc_t fn{};
+
+    ModuleEventThread *self{};
+    GSource *source{};
+    int timerFd{-1};
+    int64_t nextDeadlineNs{0};
+
+    // deadline statistics, lateness is measured from the deadline to the dispatch of the event
+    uint64_t dispatchCount{0};
+    uint64_t missedCount{0};
+    double latenessMeanUs{0};
+    double latenessM2{0};
+    double latenessMaxUs{0};
+};
+
 class RecvDataEventPayload
 {
 public:
@@ -66,6 +100,9 @@ public:
     bool threadActive;
     std::thread thread;
     std::atomic<GMainLoop *> activeLoop;
+    ThreadCpuClock cpuClock;
+
+    std::vector<PreciseTimerStats> preciseTimerStats;
 };
 #pragma GCC diagnostic pop
 
@@ -146,6 +183,65 @@ static gboolean timerEventDispatch(gpointer udata)
     return FALSE;
 }
 
+static int64_t monotonicTimeNs()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<int64_t>(ts.tv_sec) * NS_PER_US * US_PER_S) + ts.tv_nsec;
+}
+
+static bool armPreciseTimer(PreciseTimerEventPayload *pl)
+{
+    // An interval of 0 means the callback is run as often as possible, just like a GLib timeout
+    // source with a zero interval. All deadlines after the first one are derived from it by the
+    // kernel, so the period does not drift, no matter how late an event is dispatched.
+    const int64_t intervalNs = pl->interval == 0 ? 1 : pl->interval * NS_PER_US;
+    pl->nextDeadlineNs = monotonicTimeNs() + intervalNs;
+
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = intervalNs / (NS_PER_US * US_PER_S);
+    spec.it_interval.tv_nsec = intervalNs % (NS_PER_US * US_PER_S);
+    spec.it_value.tv_sec = pl->nextDeadlineNs / (NS_PER_US * US_PER_S);
+    spec.it_value.tv_nsec = pl->nextDeadlineNs % (NS_PER_US * US_PER_S);
+    return timerfd_settime(pl->timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0;
+}
+
+static gboolean preciseTimerEventDispatch(gpointer udata)
+{
+    const auto pl = static_cast<PreciseTimerEventPayload *>(udata);
+    int interval = pl->interval;
+    std::invoke(pl->fn, pl->module, interval);
+
+    if (pl->module->state() == ModuleState::ERROR) {
+        // ewww, this module failed. suspend execution
+        pl->self->setFailed(true);
+        LOG_INFO(pl->self->logger(), "Module '{}' failed in event loop. Stopping.", pl->module->name());
+        return FALSE;
+    }
+
+    // interval wasn't changed, we continue as normal
+    if (interval == pl->interval)
+        return TRUE;
+
+    // interval < 0 means we should stop this event source
+    if (interval < 0)
+        return FALSE;
+
+    // the interval was adjusted, so we start over with new deadlines
+    pl->interval = interval;
+    if (!armPreciseTimer(pl)) {
+        pl->self->setFailed(true);
+        LOG_ERROR(
+            pl->self->logger(),
+            "Unable to change precise timer interval of module '{}': {}. Stopping.",
+            pl->module->name(),
+            std::strerror(errno));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 static gboolean recvDataEventDispatch(gpointer udata)
 {
     const auto pl = static_cast<RecvDataEventPayload *>(udata);
@@ -216,6 +312,103 @@ static GSource *efd_signal_source_new(int event_fd, VariantStreamSubscription *s
     return (GSource *)source;
 }
 
+typedef struct {
+    GSource source;
+    gpointer timer_fd_tag;
+    PreciseTimerEventPayload *pl;
+} PreciseTimerSource;
+
+static gboolean precise_timer_source_dispatch(GSource *source, GSourceFunc callback, gpointer user_data)
+{
+    PreciseTimerSource *pt_source = (PreciseTimerSource *)source;
+    auto pl = pt_source->pl;
+
+    unsigned events = g_source_query_unix_fd(source, pt_source->timer_fd_tag);
+    if (events & G_IO_HUP || events & G_IO_ERR || events & G_IO_NVAL) {
+        return G_SOURCE_REMOVE;
+    }
+    if (!(events & G_IO_IN))
+        return G_SOURCE_CONTINUE;
+
+    // the expiration count tells us how many deadlines have passed since we were last dispatched
+    uint64_t expirations = 0;
+    if (read(pl->timerFd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0)
+        return G_SOURCE_CONTINUE;
+    const auto nowNs = monotonicTimeNs();
+
+    if (pl->interval > 0) {
+        const int64_t intervalNs = pl->interval * NS_PER_US;
+        const auto deadlineNs = pl->nextDeadlineNs + (static_cast<int64_t>(expirations - 1) * intervalNs);
+        pl->nextDeadlineNs = deadlineNs + intervalNs;
+
+        // update lateness mean and variance (Welford's algorithm)
+        const auto latenessUs = static_cast<double>(nowNs - deadlineNs) / NS_PER_US;
+        pl->dispatchCount++;
+        pl->missedCount += expirations - 1;
+        const auto delta = latenessUs - pl->latenessMeanUs;
+        pl->latenessMeanUs += delta / static_cast<double>(pl->dispatchCount);
+        pl->latenessM2 += delta * (latenessUs - pl->latenessMeanUs);
+        pl->latenessMaxUs = std::max(pl->latenessMaxUs, latenessUs);
+    }
+
+    return callback(user_data);
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+static GSourceFuncs precise_timer_source_funcs =
+    {.prepare = efd_signal_source_prepare, .check = NULL, .dispatch = precise_timer_source_dispatch, .finalize = NULL};
+#pragma GCC diagnostic pop
+
+static GSource *precise_timer_source_new(PreciseTimerEventPayload *pl)
+{
+    auto source = (PreciseTimerSource *)g_source_new(&precise_timer_source_funcs, sizeof(PreciseTimerSource));
+    source->pl = pl;
+    source->timer_fd_tag = g_source_add_unix_fd(
+        (GSource *)source,
+        pl->timerFd,
+        (GIOCondition)(G_IO_IN | G_IO_ERR | G_IO_HUP | G_IO_NVAL));
+    return (GSource *)source;
+}
+
+static PreciseTimerStats preciseTimerStatsFor(const PreciseTimerEventPayload *pl)
+{
+    PreciseTimerStats stats;
+    stats.moduleName = pl->module->name();
+    stats.intervalUs = pl->interval;
+    stats.dispatchCount = pl->dispatchCount;
+    stats.missedCount = pl->missedCount;
+    stats.latenessMeanUs = pl->latenessMeanUs;
+    stats.latenessStdDevUs = pl->dispatchCount > 1
+                                 ? std::sqrt(pl->latenessM2 / static_cast<double>(pl->dispatchCount - 1))
+                                 : 0.0;
+    stats.latenessMaxUs = pl->latenessMaxUs;
+    return stats;
+}
+
+static void logPreciseTimerStats(QuillLogger *log, const PreciseTimerStats &stats)
+{
+    if (stats.dispatchCount == 0)
+        return;
+
+    if (stats.missedCount > 0)
+        LOG_WARNING(
+            log,
+            "Precise timer of module '{}' missed {} of {} deadlines",
+            stats.moduleName,
+            stats.missedCount,
+            stats.missedCount + stats.dispatchCount);
+    LOG_INFO(
+        log,
+        "Precise timer of module '{}' ({} µs) ran {} times, lateness mean {:.1f} µs, stddev {:.1f} µs, max {:.1f} µs",
+        stats.moduleName,
+        stats.intervalUs,
+        stats.dispatchCount,
+        stats.latenessMeanUs,
+        stats.latenessStdDevUs,
+        stats.latenessMaxUs);
+}
+
 void ModuleEventThread::moduleEventThreadFunc(
     QList<AbstractModule *> mods,
     OptionalWaitCondition *waitCondition,
@@ -224,6 +417,7 @@ void ModuleEventThread::moduleEventThreadFunc(
     int niceness)
 {
     pthread_setname_np(pthread_self(), qPrintable(d->threadName.mid(0, 15)));
+    d->cpuClock.captureCurrentThread();
 
     // Elevate this shared event thread as a whole, if the engine approved it. Realtime
     // takes precedence over niceness.
@@ -241,6 +435,7 @@ void ModuleEventThread::moduleEventThreadFunc(
 
     // add event sources
     std::vector<std::unique_ptr<TimerEventPayload>> intervalPayloads;
+    std::vector<std::unique_ptr<PreciseTimerEventPayload>> preciseTimerPayloads;
     std::vector<std::unique_ptr<RecvDataEventPayload>> recvDataPayloads;
     for (const auto &mod : mods) {
         // add "timer" event sources
@@ -260,6 +455,32 @@ void ModuleEventThread::moduleEventThreadFunc(
             intervalPayloads.push_back(std::move(pl));
         }
 
+        // add precise timer event sources, which are only armed once we actually start
+        for (const auto &ev : mod->preciseIntervalEventCallbacks()) {
+            if (ev.second < 0)
+                continue;
+
+            auto pl = std::make_unique<PreciseTimerEventPayload>();
+            pl->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+            if (pl->timerFd < 0) {
+                LOG_ERROR(
+                    d->log,
+                    "Unable to create precise timer for module '{}': {}",
+                    mod->name(),
+                    std::strerror(errno));
+                d->failed = true;
+                continue;
+            }
+            pl->interval = ev.second;
+            pl->module = mod;
+            pl->fn = ev.first;
+            pl->self = this;
+            pl->source = precise_timer_source_new(pl.get());
+            g_source_set_callback(pl->source, &preciseTimerEventDispatch, pl.get(), NULL);
+            g_source_attach(pl->source, context);
+            preciseTimerPayloads.push_back(std::move(pl));
+        }
+
         // add "received data in subscription" event sources
         for (const auto &ev : mod->recvDataEventCallbacks()) {
             auto sub = ev.second;
@@ -313,6 +534,22 @@ void ModuleEventThread::moduleEventThreadFunc(
     if (!d->running)
         goto out;
 
+    // start the precise timers right before running, so waiting for the start does not count as missed deadlines
+    for (const auto &pl : preciseTimerPayloads) {
+        if (armPreciseTimer(pl.get()))
+            continue;
+        LOG_ERROR(
+            d->log,
+            "Unable to start precise timer for module '{}': {}",
+            pl->module->name(),
+            std::strerror(errno));
+        d->failed = true;
+    }
+    if (d->failed) {
+        d->activeLoop = nullptr;
+        goto out;
+    }
+
     // run the event loop
     g_main_loop_run(loop);
 
@@ -331,6 +568,14 @@ out:
         g_source_destroy(pl->source);
         g_source_unref(pl->source);
     }
+    for (const auto &pl : preciseTimerPayloads) {
+        g_source_destroy(pl->source);
+        g_source_unref(pl->source);
+
+        auto stats = preciseTimerStatsFor(pl.get());
+        logPreciseTimerStats(d->log, stats);
+        d->preciseTimerStats.push_back(std::move(stats));
+    }
     for (const auto &pl : recvDataPayloads) {
         g_source_destroy(pl->source);
         g_source_unref(pl->source);
@@ -349,6 +594,7 @@ void ModuleEventThread::run(
 
     d->running = true;
     d->threadActive = true;
+    d->preciseTimerStats.clear();
     d->thread = std::thread(
         &ModuleEventThread::moduleEventThreadFunc,
         this,
@@ -379,3 +625,15 @@ QuillLogger *ModuleEventThread::logger() const
 {
     return d->log;
 }
+
+const ThreadCpuClock *ModuleEventThread::cpuClock() const
+{
+    return &d->cpuClock;
+}
+
+std::vector<PreciseTimerStats> ModuleEventThread::preciseTimerStats() const
+{
+    if (d->threadActive)
+        return {};
+    return d->preciseTimerStats;
+}
@@ -26,6 +26,24 @@
 namespace Syntalos
 {
 
+class ThreadCpuClock;
+
+/**
+ * @brief Deadline statistics of a precise timed event
+ *
+ * Lateness is measured from the deadline to the dispatch of the event.
+ * @see AbstractModule::registerPreciseTimedEvent()
+ */
+struct PreciseTimerStats {
+    QString moduleName;
+    int intervalUs{0};
+    uint64_t dispatchCount{0};
+    uint64_t missedCount{0};
+    double latenessMeanUs{0};
+    double latenessStdDevUs{0};
+    double latenessMaxUs{0};
+};
+
 /**
  * @brief Manages a thread which is running evented modules
  *
@@ -72,6 +90,16 @@ public:
 
     QuillLogger *logger() const;
 
+    /**
+     * CPU time clock of the event thread, valid while the thread is running.
+     */
+    const ThreadCpuClock *cpuClock() const;
+
+    /**
+     * Statistics of all precise timers of the last run, available once the thread has stopped.
+     */
+    std::vector<PreciseTimerStats> preciseTimerStats() const;
+
 signals:
     void failed();
 
@@ -20,10 +20,17 @@
 #include "modulegraphform.h"
 #include "ui_modulegraphform.h"
 
+#include <QComboBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
 #include <QObject>
+#include <QSpinBox>
 #include <QToolButton>
+#include <QVBoxLayout>
 
 #include "engine.h"
 #include "moduleapi.h"
@@ -78,6 +85,7 @@ ModuleGraphForm::ModuleGraphForm(QWidget *parent)
     ui->graphView->setPortTypeColor(LineCommand::staticTypeId(), QColor::fromRgb(0xc7abff));
     ui->graphView->setPortTypeColor(LineReading::staticTypeId(), QColor::fromRgb(0xD38DEF));
     ui->graphView->setPortTypeColor(TableRow::staticTypeId(), QColor::fromRgb(0x8FD6FE));
+    ui->graphView->setPortTypeColor(TableRecord::staticTypeId(), QColor::fromRgb(0x5DADE2));
     ui->graphView->setPortTypeColor(SignalBlockI32::staticTypeId(), QColor::fromRgb(0x2ECC71));
     ui->graphView->setPortTypeColor(SignalBlockF32::staticTypeId(), QColor::fromRgb(0xAECC70));
     ui->graphView->setPortTypeColor(SignalBlockU16::staticTypeId(), QColor::fromRgb(0x2ECCAE));
@@ -126,6 +134,20 @@ ModuleGraphForm::ModuleGraphForm(QWidget *parent)
         modifiers.setFlag(ModuleModifier::STOP_ON_FAILURE, checked);
         mod->setModifiers(modifiers);
     });
+
+    // queue limits of the module's inputs
+    m_modifiersMenu->addSeparator();
+    auto queueLimitAction = new QAction("Input queue limits…", this);
+    m_modifiersMenu->addAction(queueLimitAction);
+    connect(queueLimitAction, &QAction::triggered, [this]() {
+        auto node = selectedSingleNode();
+        if (node == nullptr)
+            return;
+        auto mod = node->module();
+        if (mod == nullptr)
+            return;
+        editInputQueueLimits(mod);
+    });
 }
 
 ModuleGraphForm::~ModuleGraphForm()
@@ -169,17 +191,15 @@ void ModuleGraphForm::setModifyPossible(bool allowModify)
     ui->graphView->setAllowEdit(m_modifyPossible);
 }
 
-void ModuleGraphForm::setConnectionHeat(const VarStreamInputPort *inPort, ConnectionHeatLevel hlevel)
+FlowGraphEdge *ModuleGraphForm::edgeForInputPort(const VarStreamInputPort *inPort)
 {
     // fast path: we already resolved the edge for this port during this run
-    if (auto cachedEdge = m_portEdgeHeatCache.value(inPort)) {
-        cachedEdge->setHeatLevel(hlevel);
-        return;
-    }
+    if (auto cachedEdge = m_portEdgeHeatCache.value(inPort))
+        return cachedEdge;
 
     const auto outPort = inPort->outPort();
     if (outPort == nullptr)
-        return;
+        return nullptr;
 
     const auto inNode = m_modNodeMap.value(inPort->owner());
     const auto outNode = m_modNodeMap.value(outPort->owner());
@@ -187,9 +207,9 @@ void ModuleGraphForm::setConnectionHeat(const VarStreamInputPort *inPort, Connec
     if ((inNode == nullptr) || (outNode == nullptr)) {
         LOG_ERROR(
             m_log,
-            "Unable to find port graph nodes to update edge heat level. Source owner: {}",
+            "Unable to find port graph nodes to update edge status. Source owner: {}",
             inPort->owner()->name());
-        return;
+        return nullptr;
     }
 
     const auto graphInPort = inNode->findPort(inPort->id(), FlowGraphNodePort::Input, inPort->dataTypeId());
@@ -199,14 +219,32 @@ void ModuleGraphForm::setConnectionHeat(const VarStreamInputPort *inPort, Connec
     if (edge == nullptr) {
         LOG_ERROR(
             m_log,
-            "Unable to find graph edge connecting {} and {} to update its heat level.",
+            "Unable to find graph edge connecting {} and {} to update its status.",
             inPort->owner()->name(),
             outPort->owner()->name());
-        return;
+        return nullptr;
     }
 
-    edge->setHeatLevel(hlevel);
     m_portEdgeHeatCache.insert(inPort, edge);
+    return edge;
+}
+
+void ModuleGraphForm::setConnectionHeat(const VarStreamInputPort *inPort, ConnectionHeatLevel hlevel)
+{
+    if (auto edge = edgeForInputPort(inPort))
+        edge->setHeatLevel(hlevel);
+}
+
+void ModuleGraphForm::setConnectionDropCount(const VarStreamInputPort *inPort, quint64 count)
+{
+    if (auto edge = edgeForInputPort(inPort))
+        edge->setDroppedCount(count);
+}
+
+void ModuleGraphForm::setConnectionLatency(const VarStreamInputPort *inPort, const QueueLatencyStats &stats)
+{
+    if (auto edge = edgeForInputPort(inPort))
+        edge->setQueueLatency(stats);
 }
 
 void ModuleGraphForm::resetAllConnectionHeat()
@@ -220,6 +258,80 @@ void ModuleGraphForm::resetAllConnectionHeat()
     m_portEdgeHeatCache.clear();
 }
 
+void ModuleGraphForm::editInputQueueLimits(AbstractModule *mod)
+{
+    QList<std::shared_ptr<VarStreamInputPort>> ports;
+    for (const auto &iport : mod->inPorts()) {
+        if (iport->hasSubscription())
+            ports.append(iport);
+    }
+    if (ports.isEmpty()) {
+        QMessageBox::information(
+            this,
+            QStringLiteral("Input queue limits"),
+            QStringLiteral("Module \"%1\" has no connected inputs.").arg(mod->name()));
+        return;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(QStringLiteral("Input queue limits of %1").arg(mod->name()));
+
+    auto infoLabel = new QLabel(
+        QStringLiteral("Limit how many items may wait in the queue of a connected input. "
+                       "Once the limit is reached, the selected policy decides whether the sender waits "
+                       "or data is discarded. A limit of 0 means the queue is unbounded."),
+        &dialog);
+    infoLabel->setWordWrap(true);
+
+    auto formLayout = new QFormLayout;
+    QList<QPair<QSpinBox *, QComboBox *>> editors;
+    for (const auto &iport : ports) {
+        auto capSpinBox = new QSpinBox(&dialog);
+        capSpinBox->setRange(0, 1000000);
+        capSpinBox->setSpecialValueText(QStringLiteral("Unbounded"));
+        capSpinBox->setValue(static_cast<int>(std::min<size_t>(iport->queueCapacity(), 1000000)));
+
+        auto policyComboBox = new QComboBox(&dialog);
+        for (const auto policy :
+             {SubscriptionOverflowPolicy::DropNewest,
+              SubscriptionOverflowPolicy::DropOldest,
+              SubscriptionOverflowPolicy::Block})
+            policyComboBox->addItem(overflowPolicyToHumanString(policy), static_cast<int>(policy));
+        policyComboBox->setCurrentIndex(policyComboBox->findData(static_cast<int>(iport->overflowPolicy())));
+        policyComboBox->setEnabled(capSpinBox->value() > 0);
+        connect(capSpinBox, qOverload<int>(&QSpinBox::valueChanged), policyComboBox, [policyComboBox](int value) {
+            policyComboBox->setEnabled(value > 0);
+        });
+
+        auto rowLayout = new QHBoxLayout;
+        rowLayout->addWidget(capSpinBox, 1);
+        rowLayout->addWidget(policyComboBox, 1);
+        formLayout->addRow(
+            QStringLiteral("%1 (from %2)").arg(iport->title(), iport->outPort()->owner()->name()), rowLayout);
+        editors.append(qMakePair(capSpinBox, policyComboBox));
+    }
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    auto layout = new QVBoxLayout;
+    layout->addWidget(infoLabel);
+    layout->addLayout(formLayout);
+    layout->addWidget(buttonBox);
+    dialog.setLayout(layout);
+
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    for (int i = 0; i < ports.size(); i++) {
+        const auto &[capSpinBox, policyComboBox] = editors[i];
+        ports[i]->setQueueLimit(
+            static_cast<size_t>(capSpinBox->value()),
+            static_cast<SubscriptionOverflowPolicy>(policyComboBox->currentData().toInt()));
+    }
+}
+
 void ModuleGraphForm::moduleAdded(ModuleInfo *info, AbstractModule *mod)
 {
     connect(mod, &AbstractModule::stateChanged, this, &ModuleGraphForm::receiveStateChange);
@@ -253,7 +365,14 @@ void ModuleGraphForm::on_actionAddModule_triggered()
     if (modDialog.exec() == QDialog::Accepted) {
         AbstractModule *mod = nullptr;
         if (!modDialog.selectedEntryId().isEmpty()) {
-            mod = m_engine->createModule(modDialog.selectedEntryId());
+            const auto res = m_engine->createModule(modDialog.selectedEntryId());
+            if (res.has_value())
+                mod = *res;
+            else
+                QMessageBox::critical(
+                    this,
+                    QStringLiteral("Module creation failed"),
+                    QStringLiteral("%1\nThe module can not be added.").arg(res.error()));
         }
 
         if (mod) {
@@ -60,6 +60,8 @@ public:
     void setModifyPossible(bool allowModify);
 
     void setConnectionHeat(const VarStreamInputPort *inPort, ConnectionHeatLevel hlevel);
+    void setConnectionDropCount(const VarStreamInputPort *inPort, quint64 count);
+    void setConnectionLatency(const VarStreamInputPort *inPort, const QueueLatencyStats &stats);
     void resetAllConnectionHeat();
 
 private slots:
@@ -101,6 +103,8 @@ private:
     QHash<const VarStreamInputPort *, FlowGraphEdge *> m_portEdgeHeatCache;
 
     FlowGraphNode *selectedSingleNode() const;
+    FlowGraphEdge *edgeForInputPort(const VarStreamInputPort *inPort);
+    void editInputQueueLimits(AbstractModule *mod);
 };
 
 #endif // MODULEGRAPHFORM_H
@@ -25,14 +25,21 @@
 #include <QDirIterator>
 #include <QLibrary>
 #include <QMessageBox>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <functional>
 
 #include "logging.h"
 #include "globalconfig.h"
 #include "sysinfo.h"
 #include "moduleloader-ext.h"
 #include "moduleloader-py.h"
+#include "utils/style.h"
 #include "utils/tomlutils.h"
 
+// version of the module index format, bump this to discard existing indices
+static constexpr int MODULE_INDEX_VERSION = 2;
+
 class ModuleLocation
 {
 public:
@@ -43,6 +50,150 @@ public:
           isBuildLocal(buildLocal) {};
 };
 
+/**
+ * Module info of a library module, served from the module index.
+ *
+ * The module's shared library, and with it all of its (often heavy) dependencies,
+ * is only loaded once the first instance of the module is created, or if an icon
+ * is needed that is not in the index yet.
+ */
+class LazyLibraryModuleInfo : public ModuleInfo
+{
+public:
+    using LoaderFn = std::function<ModuleInfo *()>;
+
+    explicit LazyLibraryModuleInfo(const QVariantHash &entry, QString iconCacheDir, LoaderFn loader)
+        : m_id(entry.value("id").toString()),
+          m_name(entry.value("name").toString()),
+          m_summary(entry.value("summary").toString()),
+          m_description(entry.value("description").toString()),
+          m_authors(entry.value("authors").toString()),
+          m_license(entry.value("license").toString()),
+          m_storageGroupName(entry.value("storage_group").toString()),
+          m_categories(ModuleCategories::fromInt(entry.value("categories").toInt())),
+          m_singleton(entry.value("singleton").toBool()),
+          m_color(QColor::fromString(entry.value("color").toString())),
+          m_iconCacheDir(std::move(iconCacheDir)),
+          m_loader(std::move(loader))
+    {
+    }
+
+    QString id() const override
+    {
+        return m_id;
+    }
+
+    QString name() const override
+    {
+        return m_name;
+    }
+
+    QString summary() const override
+    {
+        return m_summary;
+    }
+
+    QString description() const override
+    {
+        return m_description;
+    }
+
+    QString authors() const override
+    {
+        return m_authors;
+    }
+
+    QString license() const override
+    {
+        return m_license;
+    }
+
+    ModuleCategories categories() const override
+    {
+        return m_categories;
+    }
+
+    QString storageGroupName() const override
+    {
+        return m_storageGroupName;
+    }
+
+    bool singleton() const override
+    {
+        return m_singleton;
+    }
+
+    QColor color() const override
+    {
+        if (m_info)
+            return m_info->color();
+
+        // modules without a fixed color use the default one, derived from their (cached) icon
+        if (m_color.isValid())
+            return m_color;
+        return ModuleInfo::color();
+    }
+
+    void refreshIcon() override
+    {
+        // icons may differ between light and dark themes, so we cache one per theme
+        const auto themeName = currentThemeIsDark() ? QStringLiteral("dark") : QStringLiteral("light");
+        const auto iconFname = QDir(m_iconCacheDir).filePath(QStringLiteral("%1-%2.png").arg(m_id, themeName));
+        if (!m_info && QFileInfo::exists(iconFname)) {
+            setIcon(QIcon(iconFname));
+            return;
+        }
+        if (!resolve()) {
+            ModuleInfo::refreshIcon();
+            return;
+        }
+
+        m_info->refreshIcon();
+        const auto icon = m_info->icon();
+        setIcon(icon);
+        if (!QFileInfo::exists(iconFname) && QDir().mkpath(m_iconCacheDir))
+            icon.pixmap(128, 128).save(iconFname, "PNG");
+    }
+
+    AbstractModule *createModule(QObject *parent = nullptr) override
+    {
+        if (!resolve())
+            return nullptr;
+        return m_info->createModule(parent);
+    }
+
+    /**
+     * Use an already loaded module info, instead of loading it on demand.
+     */
+    void setLoadedInfo(ModuleInfo *info)
+    {
+        m_info.reset(info);
+    }
+
+private:
+    QString m_id;
+    QString m_name;
+    QString m_summary;
+    QString m_description;
+    QString m_authors;
+    QString m_license;
+    QString m_storageGroupName;
+    ModuleCategories m_categories;
+    bool m_singleton;
+    QColor m_color;
+
+    QString m_iconCacheDir;
+    LoaderFn m_loader;
+    std::unique_ptr<ModuleInfo> m_info;
+
+    bool resolve()
+    {
+        if (!m_info)
+            m_info.reset(m_loader());
+        return m_info != nullptr;
+    }
+};
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpadded"
 class ModuleLibrary::Private
@@ -56,7 +207,14 @@ public:
     QMap<QString, QSharedPointer<ModuleInfo>> modInfos;
     bool isInFlatpakSandbox = false;
 
+    // index of library module metadata, by module directory
+    QString indexFname;
+    QString iconCacheDir;
+    QHash<QString, QVariantHash> moduleIndex;
+    QHash<QString, QVariantHash> newModuleIndex;
+
     QStringList issueLog;
+    QHash<QString, QString> loadErrors;
     QuillLogger *log;
 };
 #pragma GCC diagnostic pop
@@ -97,6 +255,10 @@ ModuleLibrary::ModuleLibrary(GlobalConfig *gconf, QObject *parent)
     }
     if (QDir(userModulesDir).exists())
         d->locations.append(ModuleLocation(userModulesDir));
+
+    const QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    d->indexFname = cacheDir.filePath(QStringLiteral("module-index.toml"));
+    d->iconCacheDir = cacheDir.filePath(QStringLiteral("module-icons"));
 }
 
 ModuleLibrary::~ModuleLibrary() = default;
@@ -124,6 +286,9 @@ bool ModuleLibrary::load()
         ensureLinkerLibraryPath("/app/lib");
     }
 
+    loadModuleIndex();
+    d->newModuleIndex.clear();
+
     for (const auto &loc : d->locations) {
         LOG_INFO(d->log, "Loading modules from location: {}", loc.path);
         d->issueLog.append(QStringLiteral("Loading modules from: %1").arg(loc.path));
@@ -177,16 +342,142 @@ bool ModuleLibrary::load()
         d->issueLog.append(QStringLiteral(""));
     }
 
+    // only keep modules that still exist in the index
+    if (d->newModuleIndex != d->moduleIndex)
+        saveModuleIndex();
+    d->moduleIndex = d->newModuleIndex;
+    d->newModuleIndex.clear();
+
     return true;
 }
 
+void ModuleLibrary::loadModuleIndex()
+{
+    d->moduleIndex.clear();
+    if (!QFileInfo::exists(d->indexFname))
+        return;
+
+    QString errorMessage;
+    const auto data = parseTomlFile(d->indexFname, errorMessage);
+    if (data.isEmpty()) {
+        LOG_WARNING(d->log, "Unable to read module index, rebuilding it: {}", errorMessage);
+        return;
+    }
+
+    // the index is only valid for the module API it was created with
+    if (data.value("version").toInt() != MODULE_INDEX_VERSION || data.value("api_id").toString() != d->syntalosApiId) {
+        LOG_INFO(d->log, "Module index is outdated, rebuilding it");
+        return;
+    }
+
+    for (const auto &var : data.value("modules").toList()) {
+        const auto entry = var.toHash();
+        d->moduleIndex.insert(entry.value("root_dir").toString(), entry);
+    }
+}
+
+void ModuleLibrary::saveModuleIndex()
+{
+    QVariantList modules;
+    for (const auto &entry : d->newModuleIndex)
+        modules.append(entry);
+
+    QVariantHash data;
+    data.insert("version", MODULE_INDEX_VERSION);
+    data.insert("api_id", d->syntalosApiId);
+    data.insert("modules", modules);
+
+    QDir().mkpath(QFileInfo(d->indexFname).absolutePath());
+    QSaveFile file(d->indexFname);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(d->log, "Unable to write module index: {}", file.errorString());
+        return;
+    }
+    file.write(qVariantHashToTomlData(data));
+    if (!file.commit())
+        LOG_WARNING(d->log, "Unable to write module index: {}", file.errorString());
+}
+
 void ModuleLibrary::refreshIcons()
 {
     for (const auto &modInfo : d->modInfos.values())
         modInfo->refreshIcon();
 }
 
+/**
+ * Check if the index entry for a module still matches its files on disk.
+ */
+static bool moduleIndexEntryIsCurrent(const QVariantHash &entry, const QFileInfo &tomlFi, const QFileInfo &libFi)
+{
+    return entry.value("library").toString() == libFi.filePath()
+           && entry.value("toml_mtime").toLongLong() == tomlFi.lastModified().toMSecsSinceEpoch()
+           && entry.value("toml_size").toLongLong() == tomlFi.size()
+           && entry.value("lib_mtime").toLongLong() == libFi.lastModified().toMSecsSinceEpoch()
+           && entry.value("lib_size").toLongLong() == libFi.size();
+}
+
 bool ModuleLibrary::loadLibraryModInfo(const QString &modId, const QString &modDir, const QString &libFname)
+{
+    const QFileInfo tomlFi(QDir(modDir).filePath("module.toml"));
+    const QFileInfo libFi(libFname);
+    auto loader = [this, modId, modDir, libFname]() -> ModuleInfo * {
+        LOG_DEBUG(d->log, "Loading library of module '{}'", modId);
+        auto info = loadLibraryModInfoFromLib(modId, libFname);
+        if (info != nullptr)
+            info->setRootDir(modDir);
+        return info;
+    };
+
+    // use the indexed metadata, if the module did not change since we indexed it
+    auto entry = d->moduleIndex.value(modDir);
+    if (!entry.isEmpty() && moduleIndexEntryIsCurrent(entry, tomlFi, libFi)) {
+        QSharedPointer<LazyLibraryModuleInfo> info(new LazyLibraryModuleInfo(entry, d->iconCacheDir, loader));
+        info->setRootDir(modDir);
+        d->modInfos.insert(info->id(), info);
+        d->newModuleIndex.insert(modDir, entry);
+        return true;
+    }
+
+    auto modInfo = loader();
+    if (modInfo == nullptr)
+        return false;
+
+    entry.clear();
+    entry.insert("root_dir", modDir);
+    entry.insert("library", libFi.filePath());
+    entry.insert("toml_mtime", tomlFi.lastModified().toMSecsSinceEpoch());
+    entry.insert("toml_size", tomlFi.size());
+    entry.insert("lib_mtime", libFi.lastModified().toMSecsSinceEpoch());
+    entry.insert("lib_size", libFi.size());
+    entry.insert("id", modInfo->id());
+    entry.insert("name", modInfo->name());
+    entry.insert("summary", modInfo->summary());
+    entry.insert("description", modInfo->description());
+    entry.insert("authors", modInfo->authors());
+    entry.insert("license", modInfo->license());
+    entry.insert("storage_group", modInfo->storageGroupName());
+    entry.insert("categories", static_cast<int>(modInfo->categories().toInt()));
+    entry.insert("singleton", modInfo->singleton());
+
+    // the default color depends on the icon of the current theme, so only a module-defined color is stored
+    const auto color = modInfo->color();
+    if (color != modInfo->ModuleInfo::color())
+        entry.insert("color", color.name(QColor::HexArgb));
+    d->newModuleIndex.insert(modDir, entry);
+
+    // drop icons of a previous version of this module, they are cached again from the loaded library
+    for (const auto &variant : {QStringLiteral("light"), QStringLiteral("dark")})
+        QFile::remove(QDir(d->iconCacheDir).filePath(QStringLiteral("%1-%2.png").arg(modInfo->id(), variant)));
+
+    // register
+    QSharedPointer<LazyLibraryModuleInfo> info(new LazyLibraryModuleInfo(entry, d->iconCacheDir, loader));
+    info->setLoadedInfo(modInfo);
+    info->setRootDir(modDir);
+    d->modInfos.insert(info->id(), info);
+    return true;
+}
+
+ModuleInfo *ModuleLibrary::loadLibraryModInfoFromLib(const QString &modId, const QString &libFname)
 {
     typedef ModuleInfo *(*SyntalosModInfoFn)();
     typedef const char *(*SyntalosModAPIIdFn)();
@@ -197,7 +488,7 @@ bool ModuleLibrary::loadLibraryModInfo(const QString &modId, const QString &modD
     if (!modLib.load()) {
         LOG_WARNING(d->log, "Unable to load library for module '{}': {}", modId, modLib.errorString());
         logModuleIssue(modId, "lib", modLib.errorString());
-        return false;
+        return nullptr;
     }
 
     auto fnAPIId = (SyntalosModAPIIdFn)modLib.resolve("syntalos_module_api_id");
@@ -208,7 +499,7 @@ bool ModuleLibrary::loadLibraryModInfo(const QString &modId, const QString &modD
             modId,
             "Library is not a Syntalos module, 'syntalos_module_api_id' symbol not found.");
         logModuleIssue(modId, "api", "'syntalos_module_api_id' not found.");
-        return false;
+        return nullptr;
     }
 
     auto fnModInfo = (SyntalosModInfoFn)modLib.resolve("syntalos_module_info");
@@ -219,7 +510,7 @@ bool ModuleLibrary::loadLibraryModInfo(const QString &modId, const QString &modD
             modId,
             "Library is not a Syntalos module, 'syntalos_module_info' symbol not found.");
         logModuleIssue(modId, "api", "'syntalos_module_info' not found.");
-        return false;
+        return nullptr;
     }
 
     const auto modApiId = QString::fromUtf8(fnAPIId());
@@ -228,7 +519,7 @@ bool ModuleLibrary::loadLibraryModInfo(const QString &modId, const QString &modD
                                           .arg(modApiId, d->syntalosApiId);
         LOG_WARNING(d->log, "Prevented module load for '{}': {}", modId, apiMismatchError);
         logModuleIssue(modId, "api", apiMismatchError);
-        return false;
+        return nullptr;
     }
 
     // now we can load the module info object from the module's shared library
@@ -236,14 +527,10 @@ bool ModuleLibrary::loadLibraryModInfo(const QString &modId, const QString &modD
     if (modInfo == nullptr) {
         LOG_WARNING(d->log, "Prevented module load for '{}': {}", modId, "Received invalid (NULL) module info data.");
         logModuleIssue(modId, "api", "Module info was NULL");
-        return false;
+        return nullptr;
     }
 
-    // register
-    QSharedPointer<ModuleInfo> info(modInfo);
-    info->setRootDir(modDir);
-    d->modInfos.insert(info->id(), info);
-    return true;
+    return modInfo;
 }
 
 bool ModuleLibrary::loadPythonModInfo(const QString &modId, const QString &modDir, const QVariantHash &modData)
@@ -289,6 +576,7 @@ bool ModuleLibrary::loadExtModInfo(const QString &modId, const QString &modDir,
 void ModuleLibrary::logModuleIssue(const QString &modId, const QString &context, const QString &msg)
 {
     d->issueLog.append(QStringLiteral("<b>%1</b>: <i>&lt;%2&gt;</i> %3").arg(modId).arg(context).arg(msg));
+    d->loadErrors.insert(modId, msg);
 }
 
 QList<QSharedPointer<ModuleInfo>> ModuleLibrary::moduleInfo() const
@@ -305,3 +593,8 @@ QString ModuleLibrary::issueLogHtml() const
 {
     return d->issueLog.join("<br/>");
 }
+
+QString ModuleLibrary::moduleLoadError(const QString &modId) const
+{
+    return d->loadErrors.value(modId);
+}
@@ -49,12 +49,20 @@ public:
 
     QString issueLogHtml() const;
 
+    /**
+     * Reason why the module with the given ID could not be loaded the last time, if any.
+     */
+    QString moduleLoadError(const QString &modId) const;
+
 private:
     Q_DISABLE_COPY(ModuleLibrary)
     class Private;
     std::unique_ptr<Private> d;
 
+    void loadModuleIndex();
+    void saveModuleIndex();
     bool loadLibraryModInfo(const QString &modId, const QString &modDir, const QString &libFname);
+    ModuleInfo *loadLibraryModInfoFromLib(const QString &modId, const QString &libFname);
     bool loadPythonModInfo(const QString &modId, const QString &modDir, const QVariantHash &modData);
     bool loadExtModInfo(const QString &modId, const QString &modDir, const QVariantHash &modData);
     void logModuleIssue(const QString &modId, const QString &context, const QString &msg);
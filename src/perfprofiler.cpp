@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "perfprofiler.h"
+
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "datactl/priv/perfprofile.h"
+
+using namespace Syntalos;
+
+/**
+ * A thread, group of threads or process whose CPU usage we record.
+ */
+struct CpuSource {
+    QString name;
+    std::vector<const ThreadCpuClock *> clocks;
+    qint64 pid{0};
+    nanoseconds_t lastCpuTime{-1};
+};
+
+struct ConnectionSource {
+    VariantStreamSubscription *sub;
+    QString name;
+    size_t fallbackItemBytes;
+    uint64_t lastEnqueued;
+    uint64_t lastDropped;
+    uint64_t lastThrottled;
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+class PerfProfiler::Private
+{
+public:
+    Private() {}
+    ~Private() {}
+
+    QuillLogger *log;
+    std::unique_ptr<PerfProfileWriter> writer;
+
+    ThreadCpuClock mainThreadClock;
+    std::vector<CpuSource> cpuSources;
+    std::vector<ConnectionSource> connections;
+
+    bool haveBaseline;
+    microseconds_t lastTime;
+    std::vector<float> values;
+};
+#pragma GCC diagnostic pop
+
+static QString sourceNameForModules(const QString &name, const QList<AbstractModule *> &mods)
+{
+    QStringList modNames;
+    modNames.reserve(mods.size());
+    for (const auto mod : mods)
+        modNames.append(mod->name());
+    return QStringLiteral("%1 [%2]").arg(name, modNames.join(QStringLiteral(", ")));
+}
+
+/**
+ * Read the CPU time used by all threads of a process, from /proc/<pid>/stat.
+ */
+static nanoseconds_t processCpuTime(qint64 pid)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%lld/stat", static_cast<long long>(pid));
+    FILE *f = std::fopen(path, "r");
+    if (f == nullptr)
+        return nanoseconds_t(-1);
+
+    char buf[1024];
+    const auto len = std::fread(buf, 1, sizeof(buf) - 1, f);
+    std::fclose(f);
+    buf[len] = '\0';
+
+    // the process name may contain spaces and parentheses, so we start after its last ')'
+    const char *pos = std::strrchr(buf, ')');
+    if (pos == nullptr)
+        return nanoseconds_t(-1);
+
+    unsigned long long utime = 0, stime = 0;
+    if (std::sscanf(pos + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) != 2)
+        return nanoseconds_t(-1);
+
+    static const long ticksPerSec = sysconf(_SC_CLK_TCK);
+    return nanoseconds_t(static_cast<int64_t>((utime + stime) * (1000 * 1000 * 1000ull / ticksPerSec)));
+}
+
+static nanoseconds_t ownProcessCpuTime()
+{
+    struct timespec ts = {};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+        return nanoseconds_t(-1);
+    return std::chrono::seconds(ts.tv_sec) + nanoseconds_t(ts.tv_nsec);
+}
+
+static double ownResidentMemoryBytes()
+{
+    FILE *f = std::fopen("/proc/self/statm", "r");
+    if (f == nullptr)
+        return NAN;
+
+    unsigned long long sizePages = 0, residentPages = 0;
+    const auto n = std::fscanf(f, "%llu %llu", &sizePages, &residentPages);
+    std::fclose(f);
+    if (n != 2)
+        return NAN;
+
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    return static_cast<double>(residentPages) * static_cast<double>(pageSize);
+}
+
+PerfProfiler::PerfProfiler()
+    : d(new PerfProfiler::Private)
+{
+    d->log = getLogger("perfprofile");
+    d->haveBaseline = false;
+    d->lastTime = microseconds_t(0);
+
+    // we are created on the main thread, which runs the UI and some modules
+    d->mainThreadClock.captureCurrentThread();
+
+    // all threads of Syntalos itself, as first source
+    CpuSource total;
+    total.name = QStringLiteral("Syntalos");
+    total.pid = -1;
+    d->cpuSources.push_back(total);
+
+    CpuSource mainThread;
+    mainThread.name = QStringLiteral("main thread");
+    mainThread.clocks.push_back(&d->mainThreadClock);
+    d->cpuSources.push_back(mainThread);
+}
+
+PerfProfiler::~PerfProfiler()
+{
+    close();
+}
+
+void PerfProfiler::addThread(const QString &name, const QList<AbstractModule *> &mods, const ThreadCpuClock *clock)
+{
+    CpuSource src;
+    src.name = mods.size() == 1 && name.isEmpty() ? mods.first()->name() : sourceNameForModules(name, mods);
+    src.clocks.push_back(clock);
+    d->cpuSources.push_back(src);
+}
+
+void PerfProfiler::addThreadPool(
+    const QString &name,
+    const QList<AbstractModule *> &mods,
+    const std::vector<const ThreadCpuClock *> &clocks)
+{
+    CpuSource src;
+    src.name = sourceNameForModules(name, mods);
+    src.clocks = clocks;
+    d->cpuSources.push_back(src);
+}
+
+void PerfProfiler::addProcess(AbstractModule *mod, qint64 pid)
+{
+    if (pid <= 0)
+        return;
+
+    CpuSource src;
+    src.name = QStringLiteral("%1 [worker process]").arg(mod->name());
+    src.pid = pid;
+    d->cpuSources.push_back(src);
+}
+
+void PerfProfiler::addConnection(VarStreamInputPort *port, size_t fallbackItemBytes)
+{
+    if (!port->hasSubscription())
+        return;
+
+    ConnectionSource conn;
+    conn.sub = port->subscriptionVar().get();
+    conn.fallbackItemBytes = fallbackItemBytes;
+    conn.lastEnqueued = 0;
+    conn.lastDropped = 0;
+    conn.lastThrottled = 0;
+
+    const auto target = QStringLiteral("%1:%2").arg(port->owner()->name(), port->title());
+    if (auto oport = port->outPort())
+        conn.name = QStringLiteral("%1:%2 → %3").arg(oport->owner()->name(), oport->title(), target);
+    else
+        conn.name = target;
+
+    d->connections.push_back(conn);
+}
+
+std::expected<void, QString> PerfProfiler::open(
+    const QString &fname,
+    const Uuid &collectionId,
+    const milliseconds_t &interval)
+{
+    std::vector<PerfProfileSeries> series;
+    series.push_back({PerfSeriesKind::RESIDENT_MEMORY, "Syntalos"});
+    for (const auto &src : d->cpuSources)
+        series.push_back({PerfSeriesKind::CPU_USAGE, src.name.toStdString()});
+    for (const auto &conn : d->connections) {
+        const auto name = conn.name.toStdString();
+        series.push_back({PerfSeriesKind::QUEUE_DEPTH, name});
+        series.push_back({PerfSeriesKind::QUEUE_BYTES, name});
+        series.push_back({PerfSeriesKind::ITEM_RATE, name});
+        series.push_back({PerfSeriesKind::DROPPED_ITEMS, name});
+        series.push_back({PerfSeriesKind::THROTTLED_ITEMS, name});
+    }
+
+    d->writer = std::make_unique<PerfProfileWriter>();
+    if (!d->writer->open(fname.toStdString(), collectionId, series, interval)) {
+        const auto error = QString::fromStdString(d->writer->lastError());
+        d->writer.reset();
+        return std::unexpected(error);
+    }
+
+    d->values.resize(series.size());
+    d->haveBaseline = false;
+    LOG_DEBUG(
+        d->log,
+        "Recording performance profile of {} CPU sources and {} connections",
+        d->cpuSources.size(),
+        d->connections.size());
+
+    return {};
+}
+
+void PerfProfiler::close()
+{
+    if (!d->writer)
+        return;
+
+    d->writer->close();
+    if (!d->writer->lastError().empty())
+        LOG_WARNING(d->log, "Failed to write performance profile: {}", d->writer->lastError());
+    d->writer.reset();
+}
+
+bool PerfProfiler::isOpen() const
+{
+    return d->writer != nullptr;
+}
+
+void PerfProfiler::sample(const microseconds_t &time)
+{
+    if (!d->writer)
+        return;
+
+    const bool haveBaseline = d->haveBaseline;
+    const auto intervalSec = static_cast<double>((time - d->lastTime).count()) / (1000.0 * 1000.0);
+    d->haveBaseline = true;
+    d->lastTime = time;
+
+    size_t idx = 0;
+    d->values[idx++] = static_cast<float>(ownResidentMemoryBytes());
+
+    for (auto &src : d->cpuSources) {
+        nanoseconds_t cpuTime(0);
+        if (src.pid < 0) {
+            cpuTime = ownProcessCpuTime();
+        } else if (src.pid > 0) {
+            cpuTime = processCpuTime(src.pid);
+        } else {
+            // threads that have not started yet or already exited count as idle
+            for (const auto clock : src.clocks)
+                cpuTime += std::max(clock->cpuTime(), nanoseconds_t(0));
+        }
+
+        float usage = NAN;
+        if (haveBaseline && cpuTime.count() >= 0 && src.lastCpuTime.count() >= 0 && intervalSec > 0)
+            usage = static_cast<float>(
+                static_cast<double>((cpuTime - src.lastCpuTime).count()) / (intervalSec * 1000.0 * 1000.0 * 10.0));
+        src.lastCpuTime = cpuTime;
+        d->values[idx++] = usage;
+    }
+
+    for (auto &conn : d->connections) {
+        const auto pending = conn.sub->approxPendingCount();
+        const auto sampledItemBytes = conn.sub->approxItemMemSize();
+        const auto itemBytes = sampledItemBytes > 0 ? static_cast<size_t>(sampledItemBytes) : conn.fallbackItemBytes;
+        const auto enqueued = conn.sub->enqueuedCount();
+        const auto dropped = conn.sub->droppedCount();
+        const auto throttled = conn.sub->throttledCount();
+
+        d->values[idx++] = static_cast<float>(pending);
+        d->values[idx++] = static_cast<float>(pending * itemBytes);
+        d->values[idx++] = haveBaseline && intervalSec > 0
+                               ? static_cast<float>(static_cast<double>(enqueued - conn.lastEnqueued) / intervalSec)
+                               : NAN;
+        d->values[idx++] = haveBaseline ? static_cast<float>(dropped - conn.lastDropped) : NAN;
+        d->values[idx++] = haveBaseline ? static_cast<float>(throttled - conn.lastThrottled) : NAN;
+
+        conn.lastEnqueued = enqueued;
+        conn.lastDropped = dropped;
+        conn.lastThrottled = throttled;
+    }
+
+    // the baseline is only needed to compute rates, it is not a sample of its own
+    if (!haveBaseline)
+        return;
+
+    if (!d->writer->writeSample(time, d->values)) {
+        LOG_WARNING(d->log, "Unable to write performance profile, stopping recording: {}", d->writer->lastError());
+        d->writer.reset();
+    }
+}
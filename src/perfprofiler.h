@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <expected>
+#include <memory>
+#include <pthread.h>
+#include <time.h>
+
+#include "datactl/syclock.h"
+#include "datactl/uuid.h"
+#include "moduleapi.h"
+
+namespace Syntalos
+{
+
+/**
+ * @brief CPU time clock of a thread
+ *
+ * The thread publishes its clock itself once it is running. Afterwards, the
+ * clock can be read from any thread for as long as the thread is alive.
+ */
+class ThreadCpuClock
+{
+public:
+    ThreadCpuClock()
+        : m_clock(0),
+          m_valid(false)
+    {
+    }
+
+    /**
+     * Publish the clock of the calling thread.
+     */
+    void captureCurrentThread()
+    {
+        clockid_t cid;
+        if (pthread_getcpuclockid(pthread_self(), &cid) != 0)
+            return;
+        m_clock.store(cid, std::memory_order_relaxed);
+        m_valid.store(true, std::memory_order_release);
+    }
+
+    /**
+     * CPU time the thread has consumed so far, or a negative value if it is not
+     * known (yet, or anymore).
+     */
+    nanoseconds_t cpuTime() const
+    {
+        if (!m_valid.load(std::memory_order_acquire))
+            return nanoseconds_t(-1);
+
+        struct timespec ts = {};
+        if (clock_gettime(m_clock.load(std::memory_order_relaxed), &ts) != 0)
+            return nanoseconds_t(-1);
+        return std::chrono::seconds(ts.tv_sec) + nanoseconds_t(ts.tv_nsec);
+    }
+
+private:
+    std::atomic<clockid_t> m_clock;
+    std::atomic_bool m_valid;
+};
+
+/**
+ * @brief Samples a performance profile of a run
+ *
+ * All registered sources are sampled together whenever sample() is called, and
+ * the values are written to a profile file that is stored with the run's data.
+ * CPU usage is recorded for the threads and worker processes modules run in,
+ * as well as for Syntalos as a whole. For every connection, its queue and
+ * throughput is recorded.
+ */
+class PerfProfiler
+{
+public:
+    explicit PerfProfiler();
+    ~PerfProfiler();
+
+    /**
+     * Record the CPU usage of a thread, which runs the given modules.
+     * The clock must stay valid until the profiler is closed.
+     */
+    void addThread(const QString &name, const QList<AbstractModule *> &mods, const ThreadCpuClock *clock);
+
+    /**
+     * Record the CPU usage of a pool of threads that together run the given modules.
+     */
+    void addThreadPool(
+        const QString &name,
+        const QList<AbstractModule *> &mods,
+        const std::vector<const ThreadCpuClock *> &clocks);
+
+    /**
+     * Record the CPU usage of the worker process of an out-of-process module.
+     */
+    void addProcess(AbstractModule *mod, qint64 pid);
+
+    /**
+     * Record the queue and throughput of the connection to @p port.
+     * Queued bytes are estimated with @p fallbackItemBytes per item, until
+     * the stream knows the actual size of its items.
+     */
+    void addConnection(VarStreamInputPort *port, size_t fallbackItemBytes);
+
+    std::expected<void, QString> open(const QString &fname, const Uuid &collectionId, const milliseconds_t &interval);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * Sample all sources and write the values for the given run time.
+     * The first call only takes the baseline values.
+     */
+    void sample(const microseconds_t &time);
+
+private:
+    class Private;
+    Q_DISABLE_COPY(PerfProfiler)
+    std::unique_ptr<Private> d;
+};
+
+} // namespace Syntalos
@@ -142,13 +142,17 @@ static bool saveProjectConfigInternal(
         modInfo.insert("enabled", mod->modifiers().testFlag(ModuleModifier::ENABLED));
         modInfo.insert("stop_on_failure", mod->modifiers().testFlag(ModuleModifier::STOP_ON_FAILURE));
 
-        // save info about port subscriptions in
-        // the form inPortId -> sourceModuleName
+        // save info about port subscriptions in the form
+        // inPortId -> [sourceModuleName, sourcePortId, (queueCapacity, overflowPolicy)]
         QVariantHash modSubs;
         for (const auto &iport : mod->inPorts()) {
             if (!iport->hasSubscription())
                 continue;
             QVariantList srcVal = {iport->outPort()->owner()->name(), iport->outPort()->id()};
+            if (iport->queueCapacity() > 0) {
+                srcVal.append(static_cast<qint64>(iport->queueCapacity()));
+                srcVal.append(overflowPolicyToString(iport->overflowPolicy()));
+            }
             modSubs.insert(iport->id(), srcVal);
         }
 
@@ -372,30 +376,47 @@ bool loadProjectConfigurationInteractive(
         const auto jSubs = iobj.value("subscriptions").toHash();
 
         setStatusText(statusFn, QStringLiteral("Instantiating module: %1(%2)").arg(modId, modName));
-        auto mod = engine->createModule(modId, modName);
-        if (mod == nullptr) {
-            QMessageBox::critical(
-                parent,
-                QStringLiteral("Can not load settings"),
-                QStringLiteral(
-                    "Unable to find module '%1' - please install the module first, then "
-                    "attempt to load this configuration again.")
-                    .arg(modId));
+        const auto modRes = engine->createModule(modId, modName);
+        if (!modRes.has_value()) {
+            // only a module that is not installed at all can be fixed by installing it
+            const bool modMissing = engine->library()->moduleInfo(modId) == nullptr;
+            if (modMissing)
+                QMessageBox::critical(
+                    parent,
+                    QStringLiteral("Can not load settings"),
+                    QStringLiteral(
+                        "Unable to find module '%1' - please install the module first, then "
+                        "attempt to load this configuration again.")
+                        .arg(modId));
+            else
+                QMessageBox::critical(
+                    parent,
+                    QStringLiteral("Can not load settings"),
+                    QStringLiteral("Unable to create module '%1'.\n%2").arg(modName, modRes.error()));
             setStatusText(statusFn, "Failed to load settings.");
 
             const auto reply = QMessageBox::question(
                 parent,
-                QStringLiteral("Ignore missing module?"),
-                QStringLiteral(
-                    "While installing the missing module is the right solution to load this board, "
-                    "you can also enforce loading it. Please be aware that loading may fail. Load anyway?"),
+                modMissing ? QStringLiteral("Ignore missing module?") : QStringLiteral("Ignore failed module?"),
+                modMissing ? QStringLiteral(
+                                 "While installing the missing module is the right solution to load this board, "
+                                 "you can also enforce loading it. Please be aware that loading may fail. Load anyway?")
+                           : QStringLiteral(
+                                 "You can also load this board without the module. Please be aware that loading "
+                                 "may fail. Load anyway?"),
                 QMessageBox::Yes | QMessageBox::No);
             if (reply == QMessageBox::Yes) {
-                LOG_WARNING(log, "Module {}[{}] was missing, but trying to load board anyway.", modId, modName);
+                LOG_WARNING(
+                    log,
+                    "Module {}[{}] could not be created ({}), but trying to load board anyway.",
+                    modId,
+                    modName,
+                    modRes.error());
                 continue;
             }
             return false;
         }
+        auto mod = *modRes;
 
         // load module modifiers
         auto modModifiers = mod->modifiers();
@@ -463,7 +484,7 @@ bool loadProjectConfigurationInteractive(
         const auto jSubs = pair.second;
         for (const QString &iPortId : jSubs.keys()) {
             const auto modPortPair = jSubs.value(iPortId).toList();
-            if (modPortPair.size() != 2) {
+            if (modPortPair.size() != 2 && modPortPair.size() != 4) {
                 LOG_WARNING(log, "Malformed project data: Invalid project port pair in {} settings.", mod->name());
                 continue;
             }
@@ -498,6 +519,12 @@ bool loadProjectConfigurationInteractive(
                     srcModOutPortId);
                 continue;
             }
+            if (modPortPair.size() == 4) {
+                const auto capacity = modPortPair[2].toLongLong();
+                inPort->setQueueLimit(
+                    capacity > 0 ? static_cast<size_t>(capacity) : 0,
+                    overflowPolicyFromString(modPortPair[3].toString()));
+            }
             inPort->setSubscription(outPort.get(), outPort->subscribe());
         }
     }
@@ -25,6 +25,7 @@
 
 #include <chrono>
 #include <iostream>
+#include <span>
 #include <pybind11/chrono.h>
 #include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
@@ -38,6 +39,7 @@
 #include "cvnp/cvnp.h"
 #include "datactl/datatypes.h"
 #include "datactl/frametype.h"
+#include "shmarrayview.h"
 #include "sydatatopy.h" // needed for stream data type conversion
 
 namespace py = pybind11;
@@ -49,6 +51,7 @@ static SyntalosLink *getActiveLink();
 static PySyLinkManager *g_pslMgr = nullptr;
 
 using PyNewDataFn = std::function<void(const py::object &obj)>;
+using PyBatchItemFn = std::function<py::object(const RawDataRef &sample)>;
 
 SyntalosPyError::SyntalosPyError(const char *what_arg)
     : std::runtime_error(what_arg) {};
@@ -79,6 +82,73 @@ static bool handlePyError(SyntalosLink *m_slink, const py::error_already_set &e)
     return true;
 }
 
+/**
+ * Read-only view of a received signal block, used for batched data delivery.
+ */
+struct SignalBlockView {
+    py::array timestamps;
+    py::array data;
+};
+
+/**
+ * Read-only view of a received video frame, used for batched data delivery.
+ */
+struct FrameView {
+    uint64_t index;
+    microseconds_t time;
+    py::array mat;
+};
+
+/**
+ * Create a read-only NumPy array for the pixels of a serialized frame, shaped like cvnp
+ * shapes OpenCV matrices. Returns nothing for unsupported element types.
+ */
+static std::optional<py::array> makeReadOnlyFrameView(const Frame::MemoryView &view, const py::handle &base)
+{
+    py::dtype dtype;
+    switch (CV_MAT_DEPTH(view.type)) {
+    case CV_8U:
+        dtype = py::dtype::of<uint8_t>();
+        break;
+    case CV_8S:
+        dtype = py::dtype::of<int8_t>();
+        break;
+    case CV_16U:
+        dtype = py::dtype::of<uint16_t>();
+        break;
+    case CV_16S:
+        dtype = py::dtype::of<int16_t>();
+        break;
+    case CV_32S:
+        dtype = py::dtype::of<int32_t>();
+        break;
+    case CV_32F:
+        dtype = py::dtype::of<float>();
+        break;
+    case CV_64F:
+        dtype = py::dtype::of<double>();
+        break;
+    case CV_16F:
+        dtype = py::dtype("float16");
+        break;
+    default:
+        return std::nullopt;
+    }
+
+    // the pixel rows of a serialized frame are tightly packed
+    const auto rows = static_cast<py::ssize_t>(view.height);
+    const auto cols = static_cast<py::ssize_t>(view.width);
+    const auto pixelStride = static_cast<py::ssize_t>(CV_ELEM_SIZE(view.type));
+    const auto rowStride = cols * pixelStride;
+    if (CV_MAT_CN(view.type) == 1)
+        return makeReadOnlyArrayView(dtype, view.pixels, base, {rows, cols}, {rowStride, pixelStride});
+
+    const auto channels = static_cast<py::ssize_t>(CV_MAT_CN(view.type));
+    const auto channelStride = static_cast<py::ssize_t>(CV_ELEM_SIZE1(view.type));
+    return makeReadOnlyArrayView(
+        dtype, view.pixels, base, {rows, cols, channels}, {rowStride, pixelStride, channelStride});
+}
+
 /**
  * Python binding for a Syntalos input port.
  */
@@ -129,6 +199,126 @@ struct InputPort {
         return _on_data_cb;
     }
 
+    /**
+     * Resolve the function turning raw wire bytes of source type @p srcId into a Python object
+     * of our declared type. Frames and signal blocks are exposed as views into the received memory
+     * if no type conversion is needed, anything else is deserialized.
+     * Malformed data results in a null object.
+     */
+    [[nodiscard]] PyBatchItemFn resolve_batch_item_caster(int srcId) const
+    {
+        PyBatchItemFn itemCaster;
+        if (srcId == _dataTypeId) {
+            forEachStreamType([&](auto tag) {
+                using T = typename decltype(tag)::type;
+                if (syDataTypeId<T>() != _dataTypeId)
+                    return false;
+                if constexpr (std::same_as<T, Frame>) {
+                    // the pixels live in read-only shared memory, so they must not be writable from Python
+                    itemCaster = [](const RawDataRef &sample) {
+                        Frame::MemoryView view;
+                        if (!Frame::viewFromMemory(sample.data, sample.size, view))
+                            return py::object();
+                        auto mat = makeReadOnlyFrameView(view, makeOwnerCapsule(sample.owner));
+                        if (!mat)
+                            return py::object();
+                        return py::cast(FrameView{view.index, view.time, std::move(*mat)});
+                    };
+                } else if constexpr (requires { typename T::MemoryView; }) {
+                    itemCaster = [](const RawDataRef &sample) {
+                        typename T::MemoryView view;
+                        if (!T::viewFromMemory(sample.data, sample.size, view))
+                            return py::object();
+                        const auto length = static_cast<py::ssize_t>(view.length);
+                        const auto rows = static_cast<py::ssize_t>(view.rows);
+                        const auto cols = static_cast<py::ssize_t>(view.cols);
+                        const auto owner = makeOwnerCapsule(sample.owner);
+                        return py::cast(
+                            SignalBlockView{
+                                makeReadOnlyArrayView<uint64_t>(view.timestamps, owner, {length}),
+                                makeReadOnlyArrayView<typename T::Scalar>(view.data, owner, {rows, cols})});
+                    };
+                } else {
+                    itemCaster = [](const RawDataRef &sample) {
+                        return py::cast(T::fromMemory(sample.data, sample.size));
+                    };
+                }
+                return true;
+            });
+        } else {
+            forEachStreamType([&](auto fromTag) {
+                using From = typename decltype(fromTag)::type;
+                if (syDataTypeId<From>() != srcId)
+                    return false;
+                return forEachStreamType([&](auto toTag) {
+                    using To = typename decltype(toTag)::type;
+                    if constexpr (!std::same_as<From, To> && std::constructible_from<To, From>) {
+                        if (syDataTypeId<To>() != _dataTypeId)
+                            return false;
+                        itemCaster = [](const RawDataRef &sample) {
+                            return py::cast(To(From::fromMemory(sample.data, sample.size)));
+                        };
+                        return true;
+                    } else {
+                        return false;
+                    }
+                });
+            });
+        }
+
+        return itemCaster;
+    }
+
+    void set_on_data_batch(PyNewDataFn fn, size_t maxItems)
+    {
+        if (fn && _throttle_items_per_sec > 0)
+            throw SyntalosPyError(
+                std::format("Can not deliver batches on throttled input port {}. Disable throttling first.", _id));
+
+        _on_data_batch_cb = std::move(fn);
+        _batch_item_caster = nullptr;
+        _batch_source_type_id = 0;
+        if (!_on_data_batch_cb) {
+            _iport->setNewDataRawBatchCallback(nullptr, 1);
+            return;
+        }
+
+        _iport->setNewDataRawBatchCallback(
+            [this](std::span<const RawDataRef> batch) {
+                // the source type is only known once the port was connected, so we resolve lazily
+                const auto srcId = _iport->sourceTypeId() != 0 ? _iport->sourceTypeId() : _dataTypeId;
+                if (!_batch_item_caster || srcId != _batch_source_type_id) {
+                    _batch_item_caster = resolve_batch_item_caster(srcId);
+                    _batch_source_type_id = srcId;
+                    if (!_batch_item_caster) {
+                        getActiveLink()->raiseError(
+                            std::format("Cannot convert data of type {} for input port {}.", srcId, _id));
+                        return;
+                    }
+                }
+
+                try {
+                    py::list items;
+                    for (const auto &sample : batch) {
+                        auto item = _batch_item_caster(sample);
+                        if (item)
+                            items.append(std::move(item));
+                    }
+                    if (!items.empty())
+                        _on_data_batch_cb(items);
+                } catch (py::error_already_set &e) {
+                    if (!handlePyError(getActiveLink(), e))
+                        throw;
+                }
+            },
+            maxItems);
+    }
+
+    [[nodiscard]] PyNewDataFn get_on_data_batch() const
+    {
+        return _on_data_batch_cb;
+    }
+
     [[nodiscard]] MetaStringMap metadata() const
     {
         return _iport->metadata();
@@ -136,6 +326,12 @@ struct InputPort {
 
     void set_throttle_items_per_sec(uint itemsPerSec)
     {
+        // batches deliver everything that is pending at once, which a throttle can not apply to
+        if (itemsPerSec > 0 && _on_data_batch_cb)
+            throw SyntalosPyError(
+                std::format("Can not throttle input port {}, it delivers data in batches.", _id));
+
+        _throttle_items_per_sec = itemsPerSec;
         _iport->setThrottleItemsPerSec(itemsPerSec);
         getActiveLink()->updateInputPort(_iport);
     }
@@ -144,6 +340,10 @@ struct InputPort {
     int _dataTypeId;
     const std::shared_ptr<InputPortInfo> _iport;
     PyNewDataFn _on_data_cb;
+    PyNewDataFn _on_data_batch_cb;
+    PyBatchItemFn _batch_item_caster;
+    int _batch_source_type_id{0};
+    uint _throttle_items_per_sec{0};
 };
 
 /**
@@ -165,9 +365,9 @@ struct OutputPort {
             using T = typename decltype(tag)::type;
             if (syDataTypeId<T>() != _oport->dataTypeId())
                 return false;
-            if constexpr (std::is_same_v<T, TableRow>) {
+            if constexpr (std::is_same_v<T, TableRow> || std::is_same_v<T, TableRecord>) {
                 // value-cast for sequence-construction path from Python list-like objects
-                auto row = py::cast<TableRow>(pyObj);
+                auto row = py::cast<T>(pyObj);
                 submitted = slink->submitOutput(_oport, row);
             } else {
                 submitted = slink->submitOutput(_oport, py::cast<const T &>(pyObj));
@@ -1012,6 +1212,24 @@ PYBIND11_MODULE(syntalos_mlink, m)
             },
             "Time when the frame was recorded, as an integer in µs.");
 
+    py::class_<FrameView>(
+        m,
+        "FrameView",
+        "Read-only view of a received video frame, passed to ``on_data_batch`` callbacks.\n"
+        "\n"
+        "The image directly references the received shared memory, which stays reserved for as long\n"
+        "as the array is referenced. Copy it (e.g. with ``frame.mat.copy()``) to modify it or to keep it\n"
+        "for longer than the callback, as new data can not be received while all samples are held.")
+        .def_readonly("index", &FrameView::index, "Number of the frame.")
+        .def_readonly("time", &FrameView::time, "Time when the frame was recorded, as a duration.")
+        .def_readonly("mat", &FrameView::mat, "Read-only frame image data as a NumPy array.")
+        .def_property_readonly(
+            "time_usec",
+            [](const FrameView &f) {
+                return f.time.count();
+            },
+            "Time when the frame was recorded, as an integer in µs.");
+
     /**
      ** Data Type IDs
      **/
@@ -1024,7 +1242,8 @@ PYBIND11_MODULE(syntalos_mlink, m)
         .value("LineReading", BaseDataType::TypeId::LineReading, "Timestamped reading from a hardware signal line.")
         .value("SignalBlockI32", BaseDataType::TypeId::SignalBlockI32, "A block of 32-bit integer samples.")
         .value("SignalBlockU16", BaseDataType::TypeId::SignalBlockU16, "A block of 16-bit unsigned integer samples.")
-        .value("SignalBlockF32", BaseDataType::TypeId::SignalBlockF32, "A block of 32-bit float samples.");
+        .value("SignalBlockF32", BaseDataType::TypeId::SignalBlockF32, "A block of 32-bit float samples.")
+        .value("TableRecord", BaseDataType::TypeId::TableRecord, "A row of numeric table cells.");
 
     /**
      ** Control Command
@@ -1117,28 +1336,105 @@ PYBIND11_MODULE(syntalos_mlink, m)
 
     py::class_<SignalBlockI32>(m, "SignalBlockI32", "A block of timestamped 32-bit integer signal data.")
         .def(py::init<>())
-        .def_readwrite("timestamps", &SignalBlockI32::timestamps, "1-D array of sample timestamps in µs.")
-        .def_readwrite("data", &SignalBlockI32::data, "2-D data matrix: rows = samples, columns = channels.")
+        .def_property(
+            "timestamps",
+            [](SignalBlockI32 &b) -> VectorXu64 & {
+                return b.mutableTimestamps();
+            },
+            [](SignalBlockI32 &b, VectorXu64 ts) {
+                b.setTimestamps(std::move(ts));
+            },
+            "1-D array of sample timestamps in µs.")
+        .def_property(
+            "data",
+            [](SignalBlockI32 &b) -> MatrixXi32 & {
+                return b.mutableData();
+            },
+            [](SignalBlockI32 &b, MatrixXi32 data) {
+                b.setData(std::move(data));
+            },
+            "2-D data matrix: rows = samples, columns = channels.")
         .def_property_readonly("length", &SignalBlockI32::length, "Number of samples (rows) in this block.")
         .def_property_readonly("rows", &SignalBlockI32::rows, "Number of rows (samples).")
         .def_property_readonly("cols", &SignalBlockI32::cols, "Number of columns (channels).");
 
     py::class_<SignalBlockU16>(m, "SignalBlockU16", "A block of timestamped 16-bit unsigned integer signal data.")
         .def(py::init<>())
-        .def_readwrite("timestamps", &SignalBlockU16::timestamps, "1-D array of sample timestamps in µs.")
-        .def_readwrite("data", &SignalBlockU16::data, "2-D data matrix: rows = samples, columns = channels.")
+        .def_property(
+            "timestamps",
+            [](SignalBlockU16 &b) -> VectorXu64 & {
+                return b.mutableTimestamps();
+            },
+            [](SignalBlockU16 &b, VectorXu64 ts) {
+                b.setTimestamps(std::move(ts));
+            },
+            "1-D array of sample timestamps in µs.")
+        .def_property(
+            "data",
+            [](SignalBlockU16 &b) -> MatrixXu16 & {
+                return b.mutableData();
+            },
+            [](SignalBlockU16 &b, MatrixXu16 data) {
+                b.setData(std::move(data));
+            },
+            "2-D data matrix: rows = samples, columns = channels.")
         .def_property_readonly("length", &SignalBlockU16::length, "Number of samples (rows) in this block.")
         .def_property_readonly("rows", &SignalBlockU16::rows, "Number of rows (samples).")
         .def_property_readonly("cols", &SignalBlockU16::cols, "Number of columns (channels).");
 
     py::class_<SignalBlockF32>(m, "SignalBlockF32", "A block of timestamped 32-bit float signal data.")
         .def(py::init<>())
-        .def_readwrite("timestamps", &SignalBlockF32::timestamps, "1-D array of sample timestamps in µs.")
-        .def_readwrite("data", &SignalBlockF32::data, "2-D data matrix: rows = samples, columns = channels.")
+        .def_property(
+            "timestamps",
+            [](SignalBlockF32 &b) -> VectorXu64 & {
+                return b.mutableTimestamps();
+            },
+            [](SignalBlockF32 &b, VectorXu64 ts) {
+                b.setTimestamps(std::move(ts));
+            },
+            "1-D array of sample timestamps in µs.")
+        .def_property(
+            "data",
+            [](SignalBlockF32 &b) -> MatrixXf & {
+                return b.mutableData();
+            },
+            [](SignalBlockF32 &b, MatrixXf data) {
+                b.setData(std::move(data));
+            },
+            "2-D data matrix: rows = samples, columns = channels.")
         .def_property_readonly("length", &SignalBlockF32::length, "Number of samples (rows) in this block.")
         .def_property_readonly("rows", &SignalBlockF32::rows, "Number of rows (samples).")
         .def_property_readonly("cols", &SignalBlockF32::cols, "Number of columns (channels).");
 
+    py::class_<SignalBlockView>(
+        m,
+        "SignalBlockView",
+        "Read-only view of a received signal block, passed to ``on_data_batch`` callbacks.\n"
+        "\n"
+        "The arrays directly reference the received shared memory, which stays reserved for as long\n"
+        "as they are referenced. Copy them (e.g. with ``numpy.array(view.data)``) to keep the data for\n"
+        "longer than the callback, as new data can not be received while all samples are held.")
+        .def_readonly("timestamps", &SignalBlockView::timestamps, "1-D array of sample timestamps in µs.")
+        .def_readonly("data", &SignalBlockView::data, "2-D data matrix: rows = samples, columns = channels.")
+        .def_property_readonly(
+            "length",
+            [](const SignalBlockView &v) {
+                return v.timestamps.shape(0);
+            },
+            "Number of samples in this block.")
+        .def_property_readonly(
+            "rows",
+            [](const SignalBlockView &v) {
+                return v.data.shape(0);
+            },
+            "Number of rows (samples).")
+        .def_property_readonly(
+            "cols",
+            [](const SignalBlockView &v) {
+                return v.data.shape(1);
+            },
+            "Number of columns (channels).");
+
     /**
      * Ports
      */
@@ -1154,6 +1450,30 @@ PYBIND11_MODULE(syntalos_mlink, m)
             "(e.g. :class:`Frame`, :class:`TableRow`). Set to ``None`` to remove the callback.\n"
             "\n"
             "Type: ``Callable[[object], None] | None``.")
+        .def_property_readonly(
+            "on_data_batch",
+            &InputPort::get_on_data_batch,
+            "The batch callback set via :func:`set_on_data_batch`, or ``None``.")
+        .def(
+            "set_on_data_batch",
+            &InputPort::set_on_data_batch,
+            "Receive incoming data in batches, with one callback invocation per batch.\n"
+            "\n"
+            "The callback is invoked with a ``list`` of all items that arrived since the last call,\n"
+            "up to ``max_items`` at a time. This avoids the per-item call overhead of ``on_data``\n"
+            "for high-rate streams. If set, it replaces any ``on_data`` callback.\n"
+            "\n"
+            "To avoid copies, frames (passed as :class:`FrameView`) and signal blocks (passed as\n"
+            ":class:`SignalBlockView`) reference the received shared memory directly. Their arrays are\n"
+            "read-only and keep their sample reserved while referenced. At most 8 samples can be held\n"
+            "at once, so copy any data you want to keep beyond the callback.\n"
+            "\n"
+            "Batched delivery can not be combined with :func:`set_throttle_items_per_sec`.\n"
+            "\n"
+            ":param callback: Callable accepting a ``list`` of items, or ``None`` to disable batching.\n"
+            ":param max_items: Maximum number of items per batch; capped at 8.",
+            py::arg("callback"),
+            py::arg("max_items") = 8)
         .def_property_readonly(
             "metadata",
             &InputPort::metadata,
@@ -1165,6 +1485,7 @@ PYBIND11_MODULE(syntalos_mlink, m)
             "set_throttle_items_per_sec",
             &InputPort::set_throttle_items_per_sec,
             "Limit the number of items delivered to ``on_data`` per second.\n"
+            "Throttling is not available for ports using :func:`set_on_data_batch`.\n"
             "\n"
             ":param items_per_sec: Maximum items per second; ``0`` disables throttling.\n"
             ":type items_per_sec: int",
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+namespace Syntalos
+{
+
+namespace py = pybind11;
+
+/**
+ * Create a Python object that keeps @p owner alive until it is garbage-collected.
+ */
+inline py::capsule makeOwnerCapsule(std::shared_ptr<const void> owner)
+{
+    return py::capsule(new std::shared_ptr<const void>(std::move(owner)), [](void *ptr) {
+        delete static_cast<std::shared_ptr<const void> *>(ptr);
+    });
+}
+
+/**
+ * Create a read-only NumPy array that wraps @p data without copying it.
+ * The array holds a reference to @p base, which has to keep the memory alive.
+ */
+inline py::array makeReadOnlyArrayView(
+    const py::dtype &dtype,
+    const void *data,
+    const py::handle &base,
+    std::vector<py::ssize_t> shape,
+    std::vector<py::ssize_t> strides = {})
+{
+    // passing a base object makes pybind11 wrap the memory instead of copying it
+    py::array arr(dtype, std::move(shape), std::move(strides), data, base);
+    py::detail::array_proxy(arr.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return arr;
+}
+
+template<typename T>
+inline py::array makeReadOnlyArrayView(const void *data, const py::handle &base, std::vector<py::ssize_t> shape)
+{
+    return makeReadOnlyArrayView(py::dtype::of<T>(), data, base, std::move(shape));
+}
+
+} // namespace Syntalos
@@ -98,6 +98,42 @@ public:
     }
 };
 
+/**
+ * TableRecord conversion
+ */
+template<>
+class type_caster<TableRecord>
+{
+public:
+    // Accept any sequence of numbers when loading a TableRecord.
+    PYBIND11_TYPE_CASTER(TableRecord, io_name("typing.Sequence[float]", "list[float]"));
+
+    bool load(handle src, bool convert)
+    {
+        if (!isinstance<sequence>(src) || isinstance<str>(src))
+            return false;
+
+        auto seq = reinterpret_borrow<sequence>(src);
+        value.values.clear();
+        value.values.reserve(seq.size());
+        for (auto &&item : seq) {
+            make_caster<double> conv;
+            if (!conv.load(item, convert))
+                return false;
+            value.values.push_back(cast_op<double>(conv));
+        }
+        return true;
+    }
+
+    static handle cast(const TableRecord &record, return_value_policy /* policy */, handle /* parent */)
+    {
+        list lst(record.values.size());
+        for (size_t i = 0; i < record.values.size(); ++i)
+            PyList_SET_ITEM(lst.ptr(), static_cast<Py_ssize_t>(i), PyFloat_FromDouble(record.values[i]));
+        return lst.release();
+    }
+};
+
 template<>
 class type_caster<Syntalos::MetaValue>
 {
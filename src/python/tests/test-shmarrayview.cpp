@@ -0,0 +1,153 @@
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "mlink/ipc-iox-private.h"
+#include "shmarrayview.h"
+
+namespace py = pybind11;
+using namespace Syntalos;
+
+#define TEST_ASSERT(v)                                                     \
+    do {                                                                   \
+        if (!(v)) {                                                        \
+            std::stringstream ss;                                          \
+            ss << "TEST_ASSERT failed at " << __FILE__ << ":" << __LINE__; \
+            throw std::runtime_error(ss.str());                            \
+        }                                                                  \
+    } while (false)
+
+static constexpr size_t SAMPLE_SIZE = 512;
+
+using SampleOwnerSpan = std::span<const std::shared_ptr<const IoxSliceSample>>;
+
+/**
+ * Publisher and subscriber of one channel, both living in this process.
+ */
+struct TestChannel {
+    iox2::Node<iox2::ServiceType::Ipc> subNode;
+    iox2::Node<iox2::ServiceType::Ipc> pubNode;
+    SySubscriber sub;
+    SyPublisher pub;
+
+    explicit TestChannel(const std::string &instanceId)
+        : subNode(makeIoxNode(instanceId + "-sub")),
+          pubNode(makeIoxNode(instanceId + "-pub")),
+          sub(SySubscriber::create(subNode, instanceId, "data", IpcServiceTopology(), {})),
+          pub(SyPublisher::create(pubNode, instanceId, "data", IpcServiceTopology(), {}))
+    {
+        pub.handleEvents();
+    }
+
+    void publish(uint8_t fill)
+    {
+        auto loan = pub.loanSlice(SAMPLE_SIZE);
+        std::memset(loan.payload_mut().data(), fill, SAMPLE_SIZE);
+        pub.sendSlice(std::move(loan));
+    }
+};
+
+static py::array makeSampleView(const std::shared_ptr<const IoxSliceSample> &sample)
+{
+    const auto payload = sample->payload();
+    return makeReadOnlyArrayView<uint8_t>(
+        payload.data(), makeOwnerCapsule(sample), {static_cast<py::ssize_t>(payload.number_of_bytes())});
+}
+
+static bool viewFilledWith(const py::handle &obj, uint8_t fill)
+{
+    const auto arr = py::array_t<uint8_t>::ensure(obj);
+    if (!arr || arr.size() != static_cast<py::ssize_t>(SAMPLE_SIZE) || arr.writeable())
+        return false;
+    for (py::ssize_t i = 0; i < arr.size(); i++) {
+        if (arr.data()[i] != fill)
+            return false;
+    }
+    return true;
+}
+
+static void test_view_outlives_callback()
+{
+    TestChannel chan(std::format("shmview-keep-{}", getpid()));
+
+    py::list kept;
+    chan.publish(1);
+    chan.publish(2);
+    chan.sub.handleEventsBatched(SY_IOX_MAX_BORROWED_SAMPLES, [&](SampleOwnerSpan samples) {
+        for (const auto &sample : samples)
+            kept.append(makeSampleView(sample));
+    });
+    TEST_ASSERT(kept.size() == 2);
+
+    // push plenty of other data through the channel, which would reuse any returned sample
+    for (uint i = 0; i < 6; i++) {
+        for (uint j = 0; j < SY_IOX_MAX_BORROWED_SAMPLES - 2; j++)
+            chan.publish(0xEE);
+        size_t received = 0;
+        chan.sub.handleEventsBatched(SY_IOX_MAX_BORROWED_SAMPLES, [&](SampleOwnerSpan samples) {
+            for (const auto &sample : samples)
+                TEST_ASSERT(viewFilledWith(makeSampleView(sample), 0xEE));
+            received += samples.size();
+        });
+        TEST_ASSERT(received == SY_IOX_MAX_BORROWED_SAMPLES - 2);
+    }
+
+    TEST_ASSERT(viewFilledWith(kept[0], 1));
+    TEST_ASSERT(viewFilledWith(kept[1], 2));
+}
+
+static void test_held_views_stall_delivery()
+{
+    TestChannel chan(std::format("shmview-stall-{}", getpid()));
+
+    for (uint i = 0; i < SY_IOX_MAX_BORROWED_SAMPLES + 2; i++)
+        chan.publish(static_cast<uint8_t>(i));
+
+    py::list kept;
+    chan.sub.handleEventsBatched(SY_IOX_MAX_BORROWED_SAMPLES, [&](SampleOwnerSpan samples) {
+        for (const auto &sample : samples)
+            kept.append(makeSampleView(sample));
+    });
+
+    // all borrowable samples are referenced from Python, the rest has to wait
+    TEST_ASSERT(kept.size() == SY_IOX_MAX_BORROWED_SAMPLES);
+    TEST_ASSERT(chan.sub.batchesStalled());
+    for (uint i = 0; i < SY_IOX_MAX_BORROWED_SAMPLES; i++)
+        TEST_ASSERT(viewFilledWith(kept[i], static_cast<uint8_t>(i)));
+
+    // dropping the views returns the samples, so delivery resumes
+    kept = py::list();
+    chan.sub.handleEventsBatched(SY_IOX_MAX_BORROWED_SAMPLES, [&](SampleOwnerSpan samples) {
+        for (const auto &sample : samples)
+            kept.append(makeSampleView(sample));
+    });
+    TEST_ASSERT(!chan.sub.batchesStalled());
+    TEST_ASSERT(kept.size() == 2);
+    TEST_ASSERT(viewFilledWith(kept[0], static_cast<uint8_t>(SY_IOX_MAX_BORROWED_SAMPLES)));
+    TEST_ASSERT(viewFilledWith(kept[1], static_cast<uint8_t>(SY_IOX_MAX_BORROWED_SAMPLES + 1)));
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <path_to_site_packages>\n";
+        return 1;
+    }
+
+    py::scoped_interpreter guard{};
+
+    // pybind11 needs NumPy from the site-packages directory
+    py::module_::import("sys").attr("path").attr("append")(argv[1]);
+
+    test_view_outlives_callback();
+    test_held_views_stall_delivery();
+    std::cout << "shmarrayview tests passed\n";
+    return 0;
+}
@@ -79,6 +79,19 @@ TimingsDialog::TimingsDialog(QWidget *parent)
 {
     ui->setupUi(this);
     setWindowTitle(QStringLiteral("System Timing & Latency Information"));
+
+    // queueing latency of module connections, only visible if latency tracing is enabled
+    m_latencyTree = new QTreeWidget(this);
+    m_latencyTree->setHeaderLabels(
+        {QStringLiteral("Connection"),
+         QStringLiteral("Items"),
+         QStringLiteral("p50"),
+         QStringLiteral("p99"),
+         QStringLiteral("Max")});
+    m_latencyTree->setRootIsDecorated(false);
+    m_latencyTree->setSelectionMode(QAbstractItemView::NoSelection);
+    m_latencyTree->setVisible(false);
+    ui->verticalLayout->addWidget(m_latencyTree);
 }
 
 TimingsDialog::~TimingsDialog()
@@ -120,9 +133,41 @@ void TimingsDialog::onSynchronizerOffsetChanged(const std::string &id, const mic
     tdisp->setCurrentOffset(currentOffset);
 }
 
+void TimingsDialog::setConnectionLatency(const VarStreamInputPort *iport, const QueueLatencyStats &stats)
+{
+    auto item = m_latencyItems.value(iport);
+    if (item == nullptr) {
+        // the engine resets all connections with empty stats, which we do not need to list
+        if (stats.count == 0)
+            return;
+
+        QString srcName = QStringLiteral("?");
+        if (auto oport = iport->outPort())
+            srcName = QStringLiteral("%1:%2").arg(oport->owner()->name(), oport->title());
+        const auto dstName = QStringLiteral("%1:%2").arg(iport->owner()->name(), iport->title());
+
+        item = new QTreeWidgetItem(m_latencyTree);
+        item->setText(0, QStringLiteral("%1 → %2").arg(srcName, dstName));
+        for (int i = 1; i < m_latencyTree->columnCount(); i++)
+            item->setTextAlignment(i, Qt::AlignRight | Qt::AlignVCenter);
+        m_latencyItems[iport] = item;
+        m_latencyTree->setVisible(true);
+        m_latencyTree->resizeColumnToContents(0);
+    }
+
+    item->setText(1, QString::number(stats.count));
+    item->setText(2, queueLatencyToHumanString(stats.p50));
+    item->setText(3, queueLatencyToHumanString(stats.p99));
+    item->setText(4, queueLatencyToHumanString(stats.max));
+}
+
 void TimingsDialog::clear()
 {
     foreach (auto w, m_tdispMap.values())
         delete w;
     m_tdispMap.clear();
+
+    m_latencyTree->clear();
+    m_latencyItems.clear();
+    m_latencyTree->setVisible(false);
 }
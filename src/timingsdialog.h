@@ -21,6 +21,7 @@
 
 #include <QDialog>
 #include <QLabel>
+#include <QTreeWidget>
 
 #include "moduleapi.h"
 
@@ -65,6 +66,7 @@ public:
         const TimeSyncStrategies &strategies,
         const microseconds_t &tolerance);
     void onSynchronizerOffsetChanged(const std::string &id, const microseconds_t &currentOffset);
+    void setConnectionLatency(const VarStreamInputPort *iport, const QueueLatencyStats &stats);
 
     void clear();
 
@@ -72,6 +74,8 @@ private:
     Ui::TimingsDialog *ui;
 
     QHash<AbstractModule *, TimingDisplayWidget *> m_tdispMap;
+    QTreeWidget *m_latencyTree;
+    QHash<const VarStreamInputPort *, QTreeWidgetItem *> m_latencyItems;
 };
 
 }; // namespace Syntalos
@@ -0,0 +1,599 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark stream throughput and end-to-end latency.
+ *
+ * Usage: bench-streams [--json FILE] [--type TYPE] [--scenario SCENARIO] [--quick]
+ *
+ * Every stream data type is sent through a set of connection topologies:
+ *   1to1      - one producer, one subscriber
+ *   1toN      - one producer, several subscribers
+ *   chain     - one producer, forwarded through relay streams to one subscriber
+ *   throttled - one producer, one subscriber with a throttled subscription
+ *   ipc       - one producer, one subscriber connected via iceoryx2 shared memory
+ *
+ * Each topology is run once with the producer emitting as fast as it can (saturated),
+ * and once with a fixed emission rate (paced). Latencies are measured from just before
+ * an item is pushed until a subscriber has received it.
+ * With --json, the results are additionally written to FILE as a JSON array.
+ */
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <latch>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+
+#include "symemopt.h"
+#include "datactl/datatypes.h"
+#include "datactl/frametype.h"
+#include "mlink/ipc-iox-private.h"
+#include "streams/stream.h"
+
+using namespace Syntalos;
+using namespace Syntalos::ipc;
+
+using SteadyClock = std::chrono::steady_clock;
+
+/// Number of subscribers in the 1toN topology
+static constexpr int FANOUT_SUBSCRIBERS = 4;
+/// Number of relay streams in the chain topology
+static constexpr int CHAIN_RELAYS = 3;
+/// Throttle value of the subscription in the throttled topology
+static constexpr uint THROTTLE_ITEMS_PER_SEC = 100;
+/// Emission rate of the producer in paced mode
+static constexpr double PACED_ITEMS_PER_SEC = 1000.0;
+/// Number of items emitted in paced mode
+static constexpr size_t PACED_ITEM_COUNT = 2000;
+
+enum class Scenario {
+    OneToOne,
+    OneToMany,
+    Chain,
+    Throttled,
+    Ipc
+};
+
+static const char *scenarioToString(Scenario scenario)
+{
+    switch (scenario) {
+    case Scenario::OneToOne:
+        return "1to1";
+    case Scenario::OneToMany:
+        return "1toN";
+    case Scenario::Chain:
+        return "chain";
+    case Scenario::Throttled:
+        return "throttled";
+    case Scenario::Ipc:
+        return "ipc";
+    }
+    return "unknown";
+}
+
+/**
+ * Creates benchmark items of a stream data type, and recovers the sequence
+ * number we embedded in them on the receiving side.
+ */
+template<typename T>
+struct BenchItem;
+
+template<>
+struct BenchItem<ControlCommand> {
+    static constexpr size_t saturatedCount = 200000;
+
+    static ControlCommand make(uint64_t seq)
+    {
+        ControlCommand cmd(ControlCommandKind::STEP);
+        cmd.duration = milliseconds_t(seq);
+        return cmd;
+    }
+
+    static uint64_t seq(const ControlCommand &cmd)
+    {
+        return cmd.duration.count();
+    }
+};
+
+template<>
+struct BenchItem<TableRow> {
+    static constexpr size_t saturatedCount = 200000;
+
+    static TableRow make(uint64_t seq)
+    {
+        return TableRow({std::to_string(seq), "1250.5", "42", "trial-start", "left"});
+    }
+
+    static uint64_t seq(const TableRow &row)
+    {
+        return std::stoull(row.data.front());
+    }
+};
+
+template<>
+struct BenchItem<TableRecord> {
+    static constexpr size_t saturatedCount = 200000;
+
+    static TableRecord make(uint64_t seq)
+    {
+        return TableRecord({static_cast<double>(seq), 1250.5, 42.0, 310.25, 122.75});
+    }
+
+    static uint64_t seq(const TableRecord &record)
+    {
+        return static_cast<uint64_t>(record.values.front());
+    }
+};
+
+template<>
+struct BenchItem<Frame> {
+    static constexpr size_t saturatedCount = 5000;
+
+    static Frame make(uint64_t seq)
+    {
+        // VGA color frame, the pixel buffer is shared the same way camera modules share theirs
+        static const cv::Mat mat(480, 640, CV_8UC3, cv::Scalar(67, 42, 30));
+        return Frame(mat, seq, microseconds_t(seq));
+    }
+
+    static uint64_t seq(const Frame &frame)
+    {
+        return frame.index;
+    }
+};
+
+template<>
+struct BenchItem<LineCommand> {
+    static constexpr size_t saturatedCount = 200000;
+
+    static LineCommand make(uint64_t seq)
+    {
+        LineCommand cmd(LineCommandKind::WRITE_DIGITAL_PULSE, 2, static_cast<uint32_t>(seq));
+        cmd.duration = microseconds_t(500);
+        return cmd;
+    }
+
+    static uint64_t seq(const LineCommand &cmd)
+    {
+        return cmd.value;
+    }
+};
+
+template<>
+struct BenchItem<LineReading> {
+    static constexpr size_t saturatedCount = 200000;
+
+    static LineReading make(uint64_t seq)
+    {
+        LineReading reading;
+        reading.lineId = 3;
+        reading.value = static_cast<uint32_t>(seq);
+        reading.time = microseconds_t(seq);
+        return reading;
+    }
+
+    static uint64_t seq(const LineReading &reading)
+    {
+        return reading.value;
+    }
+};
+
+/**
+ * Signal blocks are sized like a typical electrophysiology acquisition block
+ * (256 samples of 64 channels).
+ */
+template<typename T>
+struct SignalBlockBenchItem {
+    static constexpr size_t saturatedCount = 20000;
+
+    static T make(uint64_t seq)
+    {
+        T block(256, 64);
+        block.mutableData().setConstant(typename T::Scalar(7));
+        block.mutableTimestamps().setConstant(seq);
+        return block;
+    }
+
+    static uint64_t seq(const T &block)
+    {
+        return block.timestamps()(0);
+    }
+};
+
+template<>
+struct BenchItem<SignalBlockI32> : SignalBlockBenchItem<SignalBlockI32> {
+};
+template<>
+struct BenchItem<SignalBlockU16> : SignalBlockBenchItem<SignalBlockU16> {
+};
+template<>
+struct BenchItem<SignalBlockF32> : SignalBlockBenchItem<SignalBlockF32> {
+};
+
+struct BenchResult {
+    std::string typeName;
+    Scenario scenario;
+    bool paced;
+    int subscribers;
+    size_t produced;
+    size_t delivered;
+    size_t itemBytes;
+    double seconds;
+    double p50Usec;
+    double p99Usec;
+    double p999Usec;
+    double maxUsec;
+};
+
+/**
+ * Latencies recorded by one subscriber, in nanoseconds.
+ */
+using LatencyLog = std::vector<int64_t>;
+
+static void recordLatency(
+    LatencyLog &log,
+    const std::vector<SteadyClock::time_point> &sendTimes,
+    uint64_t seq,
+    const SteadyClock::time_point &recvTime)
+{
+    if (seq >= sendTimes.size()) [[unlikely]] {
+        std::cerr << "Received item with invalid sequence number " << seq << std::endl;
+        return;
+    }
+    log.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(recvTime - sendTimes[seq]).count());
+}
+
+static double percentileUsec(const LatencyLog &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1]) / 1000.0;
+}
+
+/**
+ * Size of an item when serialized, which is what IPC connections transfer.
+ */
+template<typename T>
+static size_t serializedSize(const T &item)
+{
+    const auto memSize = item.memorySize();
+    if (memSize >= 0)
+        return static_cast<size_t>(memSize);
+    ByteVector buffer;
+    item.toBytes(buffer);
+    return buffer.size();
+}
+
+/**
+ * Emit all items, either as fast as possible or at the given rate.
+ * The send time of each item is recorded right before it is handed to @p emit.
+ */
+template<typename T, typename EmitFn>
+static void runProducer(std::vector<SteadyClock::time_point> &sendTimes, double rate, EmitFn &&emit)
+{
+    const auto startTime = SteadyClock::now();
+    for (size_t i = 0; i < sendTimes.size(); ++i) {
+        if (rate > 0)
+            std::this_thread::sleep_until(
+                startTime
+                + std::chrono::duration_cast<SteadyClock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(i) / rate)));
+        auto item = BenchItem<T>::make(i);
+        sendTimes[i] = SteadyClock::now();
+        emit(std::move(item));
+    }
+}
+
+template<typename T>
+static void consumeStream(
+    const std::shared_ptr<StreamSubscription<T>> &sub,
+    const std::vector<SteadyClock::time_point> &sendTimes,
+    LatencyLog &log)
+{
+    pthread_setname_np(pthread_self(), "bench_consumer");
+    log.reserve(sendTimes.size());
+    while (auto item = sub->next())
+        recordLatency(log, sendTimes, BenchItem<T>::seq(*item), SteadyClock::now());
+}
+
+template<typename T>
+static void relayStream(const std::shared_ptr<StreamSubscription<T>> &sub, DataStream<T> *out)
+{
+    pthread_setname_np(pthread_self(), "bench_relay");
+    while (auto item = sub->next())
+        out->push(std::move(*item));
+    out->terminate();
+}
+
+template<typename T>
+static std::vector<LatencyLog> runInProcess(
+    Scenario scenario,
+    std::vector<SteadyClock::time_point> &sendTimes,
+    double rate)
+{
+    std::vector<std::shared_ptr<DataStream<T>>> streams;
+    std::vector<std::shared_ptr<StreamSubscription<T>>> sinks;
+    std::vector<std::thread> relayThreads;
+
+    streams.push_back(std::make_shared<DataStream<T>>());
+    switch (scenario) {
+    case Scenario::OneToMany:
+        for (int i = 0; i < FANOUT_SUBSCRIBERS; ++i)
+            sinks.push_back(streams.front()->subscribe());
+        break;
+    case Scenario::Throttled:
+        sinks.push_back(streams.front()->subscribe());
+        sinks.back()->setThrottleItemsPerSec(THROTTLE_ITEMS_PER_SEC);
+        break;
+    case Scenario::Chain:
+        for (int i = 0; i < CHAIN_RELAYS; ++i) {
+            auto sub = streams.back()->subscribe();
+            streams.push_back(std::make_shared<DataStream<T>>());
+            relayThreads.emplace_back(relayStream<T>, sub, streams.back().get());
+        }
+        sinks.push_back(streams.back()->subscribe());
+        break;
+    default:
+        sinks.push_back(streams.front()->subscribe());
+        break;
+    }
+    for (auto &stream : streams)
+        stream->start();
+
+    std::vector<LatencyLog> logs(sinks.size());
+    std::vector<std::thread> consumerThreads;
+    for (size_t i = 0; i < sinks.size(); ++i)
+        consumerThreads.emplace_back(consumeStream<T>, sinks[i], std::cref(sendTimes), std::ref(logs[i]));
+
+    auto &source = streams.front();
+    runProducer<T>(sendTimes, rate, [&](T &&item) {
+        source->push(std::move(item));
+    });
+    source->terminate();
+
+    for (auto &t : relayThreads)
+        t.join();
+    for (auto &t : consumerThreads)
+        t.join();
+
+    return logs;
+}
+
+template<typename T>
+static std::vector<LatencyLog> runIpc(std::vector<SteadyClock::time_point> &sendTimes, double rate)
+{
+    const auto instanceId = std::format("sybench{}{}", getpid(), T::staticTypeName());
+    const std::string channelName = "o/bench";
+    const IpcServiceTopology topology(1, 1);
+
+    std::latch subscriberReady(1);
+    std::atomic_bool producerDone = false;
+    std::vector<LatencyLog> logs(1);
+
+    std::thread consumer([&] {
+        pthread_setname_np(pthread_self(), "bench_ipc_sub");
+        auto &log = logs.front();
+        log.reserve(sendTimes.size());
+
+        auto node = makeIoxNode(instanceId + "-sub");
+        auto sub = SySubscriber::create(node, instanceId, channelName, topology, {});
+        auto waitSet = iox2::WaitSetBuilder().create<iox2::ServiceType::Ipc>().value();
+        auto guard = waitSet.attach_notification(sub).value();
+        subscriberReady.count_down();
+
+        const auto onSample = [&](const IoxImmutableByteSlice &pl) {
+            const auto item = T::fromMemory(pl.data(), pl.number_of_bytes());
+            recordLatency(log, sendTimes, BenchItem<T>::seq(item), SteadyClock::now());
+        };
+        const auto onEvent =
+            [&](const iox2::WaitSetAttachmentId<iox2::ServiceType::Ipc> &) -> iox2::CallbackProgression {
+            sub.handleEvents(onSample);
+            return iox2::CallbackProgression::Continue;
+        };
+
+        while (log.size() < sendTimes.size()) {
+            const auto countBefore = log.size();
+            const bool done = producerDone;
+            waitSet.wait_and_process_once_with_timeout(onEvent, iox2::bb::Duration::from_millis(50)).value();
+            sub.handleEvents(onSample);
+
+            // the producer is gone and nothing arrived anymore, some samples must have been lost
+            if (done && log.size() == countBefore)
+                break;
+        }
+    });
+
+    subscriberReady.wait();
+    auto node = makeIoxNode(instanceId + "-pub");
+    auto pub = SyPublisher::create(node, instanceId, channelName, topology, {});
+    pub.handleEvents();
+
+    // same serialization as an output port of an out-of-process module
+    ByteVector buffer;
+    runProducer<T>(sendTimes, rate, [&](T &&item) {
+        const auto memSize = item.memorySize();
+        if (memSize < 0) {
+            item.toBytes(buffer);
+            pub.sendBytes(buffer.data(), buffer.size());
+        } else {
+            auto loan = pub.loanSlice(static_cast<size_t>(memSize));
+            item.writeToMemory(loan.payload_mut().data(), memSize);
+            pub.sendSlice(std::move(loan));
+        }
+    });
+    producerDone = true;
+    consumer.join();
+
+    return logs;
+}
+
+template<typename T>
+static BenchResult runBenchmark(Scenario scenario, bool paced, double countScale)
+{
+    const auto baseCount = paced ? PACED_ITEM_COUNT : BenchItem<T>::saturatedCount;
+    const auto count = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(baseCount) * countScale));
+    const double rate = paced ? PACED_ITEMS_PER_SEC : 0;
+    std::vector<SteadyClock::time_point> sendTimes(count);
+
+    const auto startTime = SteadyClock::now();
+    auto logs = scenario == Scenario::Ipc ? runIpc<T>(sendTimes, rate) : runInProcess<T>(scenario, sendTimes, rate);
+    const auto elapsed = std::chrono::duration<double>(SteadyClock::now() - startTime).count();
+
+    LatencyLog latencies;
+    for (const auto &log : logs)
+        latencies.insert(latencies.end(), log.begin(), log.end());
+    std::sort(latencies.begin(), latencies.end());
+
+    BenchResult result;
+    result.typeName = T::staticTypeName();
+    result.scenario = scenario;
+    result.paced = paced;
+    result.subscribers = static_cast<int>(logs.size());
+    result.produced = count;
+    result.delivered = latencies.size();
+    result.itemBytes = serializedSize(BenchItem<T>::make(0));
+    result.seconds = elapsed;
+    result.p50Usec = percentileUsec(latencies, 0.5);
+    result.p99Usec = percentileUsec(latencies, 0.99);
+    result.p999Usec = percentileUsec(latencies, 0.999);
+    result.maxUsec = latencies.empty() ? 0 : static_cast<double>(latencies.back()) / 1000.0;
+
+    return result;
+}
+
+static QJsonObject resultToJson(const BenchResult &r)
+{
+    QJsonObject obj;
+    obj["type"] = QString::fromStdString(r.typeName);
+    obj["scenario"] = scenarioToString(r.scenario);
+    obj["mode"] = r.paced ? "paced" : "saturated";
+    obj["subscribers"] = r.subscribers;
+    obj["items_produced"] = static_cast<qint64>(r.produced);
+    obj["items_delivered"] = static_cast<qint64>(r.delivered);
+    obj["item_bytes"] = static_cast<qint64>(r.itemBytes);
+    obj["seconds"] = r.seconds;
+    obj["items_per_sec"] = static_cast<double>(r.delivered) / r.seconds;
+    obj["bytes_per_sec"] = static_cast<double>(r.delivered * r.itemBytes) / r.seconds;
+    obj["latency_p50_usec"] = r.p50Usec;
+    obj["latency_p99_usec"] = r.p99Usec;
+    obj["latency_p999_usec"] = r.p999Usec;
+    obj["latency_max_usec"] = r.maxUsec;
+    return obj;
+}
+
+int main(int argc, char **argv)
+{
+    QString jsonFname;
+    std::string typeFilter;
+    std::string scenarioFilter;
+    double countScale = 1.0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            jsonFname = QString::fromUtf8(argv[++i]);
+        } else if (arg == "--type" && i + 1 < argc) {
+            typeFilter = argv[++i];
+        } else if (arg == "--scenario" && i + 1 < argc) {
+            scenarioFilter = argv[++i];
+        } else if (arg == "--quick") {
+            countScale = 0.1;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--json FILE] [--type TYPE] [--scenario SCENARIO] [--quick]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    configureMimallocDefaultAllocator();
+    initializeSyLogSystem(quill::LogLevel::Warning);
+
+    std::cout << std::format(
+        "{:<15} {:<10} {:<10} {:>4} {:>9} {:>12} {:>10} {:>10} {:>10} {:>10}\n",
+        "Type",
+        "Scenario",
+        "Mode",
+        "Subs",
+        "Delivered",
+        "Items/s",
+        "MB/s",
+        "p50 µs",
+        "p99 µs",
+        "p999 µs");
+
+    QJsonArray jsonResults;
+    const auto reportResult = [&](const BenchResult &r) {
+        std::cout << std::format(
+            "{:<15} {:<10} {:<10} {:>4} {:>9} {:>12.0f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+            r.typeName,
+            scenarioToString(r.scenario),
+            r.paced ? "paced" : "saturated",
+            r.subscribers,
+            r.delivered,
+            static_cast<double>(r.delivered) / r.seconds,
+            static_cast<double>(r.delivered * r.itemBytes) / r.seconds / 1.0e6,
+            r.p50Usec,
+            r.p99Usec,
+            r.p999Usec);
+        std::cout.flush();
+        jsonResults.append(resultToJson(r));
+    };
+
+    forEachStreamType([&](auto tag) {
+        using T = typename decltype(tag)::type;
+        if (!typeFilter.empty() && typeFilter != T::staticTypeName())
+            return false;
+
+        for (const auto scenario :
+             {Scenario::OneToOne, Scenario::OneToMany, Scenario::Chain, Scenario::Throttled, Scenario::Ipc}) {
+            if (!scenarioFilter.empty() && scenarioFilter != scenarioToString(scenario))
+                continue;
+            for (const bool paced : {false, true}) {
+                try {
+                    reportResult(runBenchmark<T>(scenario, paced, countScale));
+                } catch (const std::exception &e) {
+                    std::cerr << std::format(
+                        "{} / {} failed: {}\n", T::staticTypeName(), scenarioToString(scenario), e.what());
+                }
+            }
+        }
+        return false;
+    });
+
+    if (!jsonFname.isEmpty()) {
+        QFile file(jsonFname);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "Unable to write results to " << jsonFname.toStdString() << std::endl;
+            return 1;
+        }
+        file.write(QJsonDocument(jsonResults).toJson());
+    }
+
+    return 0;
+}
@@ -47,11 +47,14 @@ eatmydata apt-get install -yq --no-install-recommends \
     libqt6svg6-dev \
     libswscale-dev \
     libtomlplusplus-dev \
+    liburing-dev \
     libusb-1.0-0-dev \
     libv4l-dev \
     libxml2-dev \
     libxxhash-dev \
     libzstd-dev \
+    liblz4-dev \
+    libblosc-dev \
     libsystemd-dev \
     systemd-dev \
     meson \
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "minitest.h"
 #include "common/simplethread.h"
@@ -102,6 +103,7 @@ public:
 		REGISTER_TEST(max_capacity);
 		REGISTER_TEST(threaded);
 		REGISTER_TEST(blocking);
+		REGISTER_TEST(dequeue_many);
 		REGISTER_TEST(vector);
 #if MOODYCAMEL_HAS_EMPLACE
 		REGISTER_TEST(emplace);
@@ -499,6 +501,31 @@ public:
 		return true;
 	}
 
+	bool dequeue_many()
+	{
+		BlockingReaderWriterQueue<int> q(8);
+		std::vector<int> items;
+		ASSERT_OR_FAIL(q.try_dequeue_many(4, [&](int v) { items.push_back(v); }) == 0);
+
+		for (int i = 0; i != 10; ++i)
+			q.enqueue(i);
+
+		ASSERT_OR_FAIL(q.try_dequeue_many(4, [&](int v) { items.push_back(v); }) == 4);
+		ASSERT_OR_FAIL(q.size_approx() == 6);
+		ASSERT_OR_FAIL(q.try_dequeue_many(static_cast<size_t>(-1), [&](int v) { items.push_back(v); }) == 6);
+		ASSERT_OR_FAIL(q.size_approx() == 0);
+		ASSERT_OR_FAIL(items.size() == 10);
+		for (int i = 0; i != 10; ++i)
+			ASSERT_OR_FAIL(items[i] == i);
+
+		// the queue keeps working normally afterwards
+		int item;
+		q.enqueue(42);
+		ASSERT_OR_FAIL(q.try_dequeue(item) && item == 42);
+		ASSERT_OR_FAIL(!q.try_dequeue(item));
+		return true;
+	}
+
 	bool blocking()
 	{
 		{
@@ -1,9 +1,16 @@
 
 #include <QDebug>
 #include <QtTest>
+#include <cmath>
+#include <filesystem>
 #include <iostream>
 #include <limits>
 #include "datactl/datatypes.h"
+#include "datactl/frametype.h"
+#include "datactl/priv/asyncio.h"
+#include "datactl/priv/perfprofile.h"
+#include "logging.h"
+#include "streams/stream.h"
 
 using namespace Syntalos;
 
@@ -12,6 +19,12 @@ class TestBasic : public QObject
     Q_OBJECT
 private:
 private slots:
+    void initTestCase()
+    {
+        // data streams need the logging system
+        initializeSyLogSystem(quill::LogLevel::Warning);
+    }
+
     void testNumToStringIntegers()
     {
         // Signed integers
@@ -103,6 +116,299 @@ private slots:
         QCOMPARE(numToString(true), "true");
         QCOMPARE(numToString(false), "false");
     }
+
+    void testSignalBlockCopyOnWrite()
+    {
+        SignalBlockF32 block(4, 2);
+        block.mutableData().setConstant(1.0f);
+        block.mutableTimestamps().setConstant(10);
+
+        // clones share the payload until one of them is modified
+        auto copy = block.clone();
+        QVERIFY(block.isShared());
+        QVERIFY(copy.isShared());
+        QCOMPARE(copy.data().data(), block.data().data());
+
+        copy.mutableData()(0, 0) = 5.0f;
+        QVERIFY(!block.isShared());
+        QVERIFY(!copy.isShared());
+        QCOMPARE(block.data()(0, 0), 1.0f);
+        QCOMPARE(copy.data()(0, 0), 5.0f);
+        QCOMPARE(copy.timestamps()(3), uint64_t(10));
+
+        // replacing one array of a shared block keeps the other one
+        auto tsCopy = copy.clone();
+        VectorXu64 newTimestamps(4);
+        newTimestamps.setConstant(20);
+        tsCopy.setTimestamps(newTimestamps);
+        QVERIFY(!tsCopy.isShared());
+        QCOMPARE(tsCopy.timestamps()(3), uint64_t(20));
+        QCOMPARE(tsCopy.data()(0, 0), 5.0f);
+        QCOMPARE(copy.timestamps()(3), uint64_t(10));
+
+        // moved-from blocks remain usable
+        auto moved = std::move(block);
+        QCOMPARE(moved.rows(), size_t(4));
+        QCOMPARE(block.rows(), size_t(0));
+        block.mutableData().resize(2, 2);
+        QCOMPARE(block.rows(), size_t(2));
+
+        // conversions take over the timestamps
+        SignalBlockI32 iblock(std::move(copy));
+        QCOMPARE(iblock.data()(0, 0), 5);
+        QCOMPARE(iblock.length(), size_t(4));
+    }
+
+    void testSignalBlockPushLoop()
+    {
+        constexpr int blockCount = 16;
+        DataStream<SignalBlockF32> stream;
+        auto subA = stream.subscribe();
+        auto subB = stream.subscribe();
+        stream.start();
+
+        // a producer reusing one block, like the hardware modules do: set the timestamps,
+        // fill the data and hand the block over to the stream
+        SignalBlockF32 block(8, 2);
+        int detaches = 0;
+        for (int n = 0; n < blockCount; n++) {
+            VectorXu64 timestamps(8);
+            timestamps.setConstant(n);
+            block.setTimestamps(std::move(timestamps));
+
+            // a shared payload would be copied by mutableData()
+            detaches += block.isShared() ? 1 : 0;
+            auto &data = block.mutableData();
+            data.resize(8, 2);
+            data.setConstant(static_cast<float>(n));
+            stream.push(std::move(block));
+        }
+        QCOMPARE(detaches, 0);
+
+        // both subscribers received every block, sharing one payload per block
+        for (int n = 0; n < blockCount; n++) {
+            auto a = subA->peekNext();
+            auto b = subB->peekNext();
+            QVERIFY(a.has_value() && b.has_value());
+            QCOMPARE(a->data().data(), b->data().data());
+            QCOMPARE(a->timestamps()(7), uint64_t(n));
+            QCOMPARE(a->data()(7, 1), static_cast<float>(n));
+        }
+        QVERIFY(!subA->peekNext().has_value());
+
+        // modifying a block that was pushed as a copy detaches it on every further iteration
+        block = SignalBlockF32(8, 2);
+        detaches = 0;
+        for (int n = 0; n < blockCount; n++) {
+            detaches += block.isShared() ? 1 : 0;
+            block.mutableData().setConstant(static_cast<float>(n));
+            stream.push(block);
+        }
+        QCOMPARE(detaches, blockCount - 1);
+        stream.stop();
+    }
+
+    void testTableRecordMemory()
+    {
+        TableRecord record({1500.0, 12.5, -3.25, 1.0});
+        QCOMPARE(record.memorySize(), ssize_t(sizeof(uint64_t) + 4 * sizeof(double)));
+
+        ByteVector buffer;
+        QVERIFY(record.toBytes(buffer));
+        QCOMPARE(buffer.size(), size_t(record.memorySize()));
+        QVERIFY(!record.writeToMemory(buffer.data(), record.memorySize() - 1));
+
+        auto copy = TableRecord::fromMemory(buffer.data(), buffer.size());
+        QCOMPARE(copy.values, record.values);
+        QVERIFY_THROWS_EXCEPTION(std::runtime_error, TableRecord::fromMemory(buffer.data(), buffer.size() - 1));
+
+        // records can be read by consumers of plain table rows
+        const TableRow row(copy);
+        QCOMPARE(row.data, std::vector<std::string>({"1500", "12.5", "-3.25", "1"}));
+
+        QCOMPARE(formatTableCell(1.0, TableColumnType::Bool), "true");
+        QCOMPARE(formatTableCell(2.0e9, TableColumnType::Integer), "2000000000");
+        QCOMPARE(tableColumnTypeFromString(toString(TableColumnType::Integer)), TableColumnType::Integer);
+    }
+
+    void testFrameMemoryView()
+    {
+        cv::Mat img(6, 8, CV_8UC3, cv::Scalar(1, 2, 3));
+        Frame frame(img, 42, microseconds_t(1000));
+
+        ByteVector buffer;
+        buffer.resize(frame.memorySize());
+        QCOMPARE(frame.memorySize(), Frame::memorySizeFor(8, 6, CV_8UC3));
+        QVERIFY(frame.writeToMemory(buffer.data(), static_cast<ssize_t>(buffer.size())));
+
+        // views point to the serialized pixel memory without copying it
+        Frame::MemoryView view;
+        QVERIFY(Frame::viewFromMemory(buffer.data(), buffer.size(), view));
+        QCOMPARE(view.index, uint64_t(42));
+        QCOMPARE(view.time.count(), 1000);
+        QCOMPARE(view.width, 8);
+        QCOMPARE(view.height, 6);
+        QCOMPARE(view.type, CV_8UC3);
+        QCOMPARE(view.pixels, static_cast<const void *>(buffer.data() + Frame::headerSize));
+        QCOMPARE(static_cast<const uchar *>(view.pixels)[(5 * 8 + 7) * 3 + 2], uchar(3));
+        QVERIFY(!Frame::viewFromMemory(buffer.data(), buffer.size() - 1, view));
+        QVERIFY(!Frame::viewFromMemory(buffer.data(), Frame::headerSize - 1, view));
+
+        // deserializing copies the pixels
+        auto copy = Frame::fromMemory(buffer.data(), buffer.size());
+        QCOMPARE(copy.index, uint64_t(42));
+        QVERIFY(static_cast<const void *>(copy.mat.data) != view.pixels);
+        QCOMPARE(copy.mat.at<cv::Vec3b>(5, 7)[2], uchar(3));
+    }
+
+    void testSignalBlockMemoryView()
+    {
+        SignalBlockF32 block(3, 2);
+        block.mutableTimestamps() << 10, 20, 30;
+        block.mutableData() << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f;
+
+        ByteVector buffer;
+        buffer.resize(block.memorySize());
+        QVERIFY(block.writeToMemory(buffer.data(), static_cast<ssize_t>(buffer.size())));
+
+        SignalBlockF32::MemoryView view;
+        QVERIFY(SignalBlockF32::viewFromMemory(buffer.data(), buffer.size(), view));
+        QCOMPARE(view.length, size_t(3));
+        QCOMPARE(view.rows, size_t(3));
+        QCOMPARE(view.cols, size_t(2));
+
+        uint64_t lastTs;
+        std::memcpy(&lastTs, static_cast<const uint64_t *>(view.timestamps) + 2, sizeof(lastTs));
+        QCOMPARE(lastTs, uint64_t(30));
+
+        // data is stored in row-major order
+        float values[6];
+        std::memcpy(values, view.data, sizeof(values));
+        QCOMPARE(values[1], 2.0f);
+        QCOMPARE(values[4], 5.0f);
+
+        QVERIFY(!SignalBlockF32::viewFromMemory(buffer.data(), buffer.size() - 1, view));
+        QVERIFY(!SignalBlockF32::viewFromMemory(buffer.data(), 20, view));
+    }
+
+    void testDeserializeInto()
+    {
+        SignalBlockI32 block(3, 2);
+        block.mutableTimestamps() << 10, 20, 30;
+        block.mutableData() << 1, 2, 3, 4, 5, 6;
+        ByteVector buffer;
+        QVERIFY(block.toBytes(buffer));
+
+        // an exclusively owned payload is overwritten in place
+        SignalBlockI32 scratch(0);
+        deserializeFromMemoryInto(buffer.data(), buffer.size(), scratch);
+        const auto dataPtr = scratch.data().data();
+        deserializeFromMemoryInto(buffer.data(), buffer.size(), scratch);
+        QCOMPARE(scratch.data().data(), dataPtr);
+        QCOMPARE(scratch.data()(2, 1), 6);
+        QCOMPARE(scratch.timestamps()(1), uint64_t(20));
+
+        // a shared payload is left alone
+        const auto kept = scratch.clone();
+        block.mutableData()(2, 1) = 7;
+        buffer.clear();
+        QVERIFY(block.toBytes(buffer));
+        deserializeFromMemoryInto(buffer.data(), buffer.size(), scratch);
+        QVERIFY(scratch.data().data() != kept.data().data());
+        QCOMPARE(kept.data()(2, 1), 6);
+        QCOMPARE(scratch.data()(2, 1), 7);
+
+        TableRow row(std::vector<std::string>({"a rather long first cell of this row", "b"}));
+        buffer.clear();
+        QVERIFY(row.toBytes(buffer));
+        TableRow rowScratch;
+        deserializeFromMemoryInto(buffer.data(), buffer.size(), rowScratch);
+        const auto cellPtr = rowScratch.data[0].data();
+        deserializeFromMemoryInto(buffer.data(), buffer.size(), rowScratch);
+        QCOMPARE(rowScratch.data, row.data);
+        QCOMPARE(static_cast<const void *>(rowScratch.data[0].data()), static_cast<const void *>(cellPtr));
+    }
+
+    void testAsyncFileWriter()
+    {
+        QTemporaryDir tmpDir;
+        QVERIFY(tmpDir.isValid());
+        const auto fname = tmpDir.filePath("async.bin").toStdString();
+
+        uint64_t lastTag = 0;
+        bool inOrder = true;
+        AsyncFileWriter writer(4);
+        writer.setCompletionCallback([&](const AsyncWriteCompletion &c) {
+            inOrder = inOrder && c.tag == lastTag + 1 && c.result >= 0;
+            lastTag = c.tag;
+        });
+        QVERIFY(writer.open(fname).has_value());
+
+        // append chunks, each followed by a trailer that the next chunk overwrites,
+        // like the Zarr writer does with its shard index
+        QByteArray expected;
+        uint64_t tag = 0;
+        for (int i = 0; i < 500; i++) {
+            auto chunk = writer.takeBuffer();
+            chunk.assign(64 + (i % 32), std::byte('a' + (i % 26)));
+            expected.append(QByteArray(static_cast<qsizetype>(chunk.size()), char('a' + (i % 26))));
+            QVERIFY(writer.append(std::move(chunk), ++tag));
+
+            auto trailer = writer.takeBuffer();
+            trailer.assign(16, std::byte('#'));
+            QVERIFY(writer.writeAt(writer.appendOffset(), std::move(trailer), ++tag));
+        }
+        QVERIFY(writer.sync(++tag));
+        QVERIFY(writer.close());
+        QVERIFY(!writer.hasError());
+        QVERIFY(inOrder);
+        QCOMPARE(lastTag, tag);
+
+        expected.append(QByteArray(16, '#'));
+        QFile f(QString::fromStdString(fname));
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        QCOMPARE(f.readAll(), expected);
+
+        AsyncFileWriter badWriter;
+        QVERIFY(!badWriter.open(tmpDir.filePath("nonexistent/async.bin").toStdString()).has_value());
+        QVERIFY(!badWriter.append(ByteVector(8)));
+    }
+
+    void testPerfProfile()
+    {
+        QTemporaryDir tmpDir;
+        QVERIFY(tmpDir.isValid());
+        const auto fname = tmpDir.filePath("profile.sprof").toStdString();
+
+        const auto collectionId = newUuid7();
+        const std::vector<PerfProfileSeries> series = {
+            {PerfSeriesKind::CPU_USAGE, "module"},
+            {PerfSeriesKind::QUEUE_DEPTH, "source:out → module:in"}};
+        PerfProfileWriter writer;
+        QVERIFY(writer.open(fname, collectionId, series, milliseconds_t(1000)));
+        for (int i = 0; i < 5; i++)
+            QVERIFY(writer.writeSample(microseconds_t(i * 1000 * 1000), {i * 10.0f, NAN}));
+        QVERIFY(!writer.writeSample(microseconds_t(0), {1.0f}));
+        writer.close();
+
+        PerfProfileReader reader;
+        QVERIFY(reader.open(fname));
+        QCOMPARE(reader.collectionId().toHex(), collectionId.toHex());
+        QCOMPARE(reader.interval().count(), 1000);
+        QCOMPARE(reader.series().size(), series.size());
+        QCOMPARE(reader.series()[1].source, series[1].source);
+        QCOMPARE(reader.times().size(), size_t(5));
+        QCOMPARE(reader.times()[3].count(), 3 * 1000 * 1000);
+        QCOMPARE(reader.values()[3][0], 30.0f);
+        QVERIFY(std::isnan(reader.values()[3][1]));
+        QVERIFY(!reader.truncated());
+
+        // an incomplete last sample, as left by a crash, is skipped
+        std::filesystem::resize_file(fname, std::filesystem::file_size(fname) - 3);
+        QVERIFY(reader.open(fname));
+        QCOMPARE(reader.times().size(), size_t(4));
+        QVERIFY(reader.truncated());
+    }
 };
 
 QTEST_MAIN(TestBasic)
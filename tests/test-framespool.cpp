@@ -0,0 +1,240 @@
+#include <QDebug>
+#include <QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include <chrono>
+#include <cstring>
+#include <opencv2/core.hpp>
+#include <unistd.h>
+
+#include "framespool.h"
+
+using namespace std::chrono;
+
+static constexpr int TEST_WIDTH = 96;
+static constexpr int TEST_HEIGHT = 64;
+static constexpr size_t TEST_FRAME_COUNT = 12;
+
+/**
+ * Make a frame whose pixels all depend on @p n, so frames can be told apart.
+ */
+static cv::Mat makeTestFrame(size_t n, int type = CV_8UC3)
+{
+    cv::Mat mat(TEST_HEIGHT, TEST_WIDTH, type);
+    for (int y = 0; y < mat.rows; y++) {
+        auto row = mat.ptr<uint8_t>(y);
+        for (size_t i = 0; i < mat.cols * mat.elemSize(); i++)
+            row[i] = static_cast<uint8_t>(n * 31 + y * 7 + i);
+    }
+    return mat;
+}
+
+static bool framesEqual(const cv::Mat &a, const cv::Mat &b)
+{
+    if (a.size() != b.size() || a.type() != b.type())
+        return false;
+    const size_t rowSize = a.cols * a.elemSize();
+    for (int y = 0; y < a.rows; y++) {
+        if (std::memcmp(a.ptr(y), b.ptr(y), rowSize) != 0)
+            return false;
+    }
+    return true;
+}
+
+static microseconds testTimestamp(size_t n)
+{
+    return microseconds(static_cast<int64_t>(n) * 33333 + 17);
+}
+
+/**
+ * Read the trailer at the end of a closed spool file, returning the offset of its index.
+ */
+static qint64 spoolIndexOffset(const QString &fname)
+{
+    QFile f(fname);
+    if (!f.open(QIODevice::ReadOnly))
+        return -1;
+    // trailer layout: magic[8], indexOffset, frameCount, reserved
+    f.seek(f.size() - 32 + 8);
+    uint64_t offset = 0;
+    if (f.read(reinterpret_cast<char *>(&offset), sizeof(offset)) != sizeof(offset))
+        return -1;
+    return static_cast<qint64>(offset);
+}
+
+static void overwriteBytes(const QString &fname, qint64 pos, const QByteArray &data)
+{
+    QFile f(fname);
+    QVERIFY(f.open(QIODevice::ReadWrite));
+    QVERIFY(f.seek(pos));
+    QCOMPARE(f.write(data), static_cast<qint64>(data.size()));
+}
+
+class TestFrameSpool : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_tmpDir;
+
+    QString writeTestSpool(const QString &name)
+    {
+        const auto fname = m_tmpDir.filePath(name + QString::fromUtf8(FRAME_SPOOL_FILE_EXT));
+        FrameSpoolWriter writer;
+        const auto res = writer.open(fname.toStdString(), 30.0);
+        if (!res) {
+            qWarning() << "Unable to open spool:" << QString::fromStdString(res.error());
+            return {};
+        }
+
+        for (size_t i = 0; i < TEST_FRAME_COUNT; i++) {
+            // odd frames come from a non-continuous ROI of a larger image
+            cv::Mat frame = makeTestFrame(i);
+            if (i % 2 == 1) {
+                cv::Mat large(TEST_HEIGHT + 8, TEST_WIDTH + 8, CV_8UC3, cv::Scalar(255, 0, 0));
+                frame.copyTo(large(cv::Rect(4, 4, TEST_WIDTH, TEST_HEIGHT)));
+                frame = large(cv::Rect(4, 4, TEST_WIDTH, TEST_HEIGHT));
+            }
+            if (!writer.appendFrame(frame, testTimestamp(i)))
+                return {};
+        }
+        if (!writer.close())
+            return {};
+        return fname;
+    }
+
+    void verifyFrames(const FrameSpoolReader &reader, size_t count)
+    {
+        QCOMPARE(reader.frameCount(), count);
+        for (size_t i = 0; i < count; i++) {
+            QCOMPARE(reader.entry(i).timestampUsec, testTimestamp(i).count());
+            QVERIFY2(framesEqual(reader.frame(i), makeTestFrame(i)), qPrintable(QStringLiteral("frame %1").arg(i)));
+        }
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tmpDir.isValid());
+    }
+
+    void testWriteRead()
+    {
+        const auto fname = writeTestSpool(QStringLiteral("write-read"));
+        QVERIFY(!fname.isEmpty());
+        QVERIFY(FrameSpoolReader::isSpoolFile(fname.toStdString()));
+
+        FrameSpoolReader reader;
+        QVERIFY(reader.open(fname.toStdString()).has_value());
+        QVERIFY(!reader.indexRecovered());
+        QCOMPARE(reader.skippedFrameCount(), static_cast<size_t>(0));
+        QCOMPARE(reader.framerate(), 30.0);
+        QCOMPARE(reader.entry(0).width, TEST_WIDTH);
+        QCOMPARE(reader.entry(0).height, TEST_HEIGHT);
+        QCOMPARE(reader.entry(0).type, CV_8UC3);
+        verifyFrames(reader, TEST_FRAME_COUNT);
+    }
+
+    void testRejectMismatchedFrames()
+    {
+        FrameSpoolWriter writer;
+        QVERIFY(writer.open(m_tmpDir.filePath(QStringLiteral("reject.syspool")).toStdString(), 30.0).has_value());
+
+        QVERIFY(!writer.appendFrame(cv::Mat(), testTimestamp(0)).has_value());
+        QVERIFY(writer.appendFrame(makeTestFrame(0), testTimestamp(0)).has_value());
+        QVERIFY(!writer.appendFrame(cv::Mat(), testTimestamp(1)).has_value());
+        QVERIFY(!writer.appendFrame(cv::Mat(TEST_HEIGHT, TEST_WIDTH + 2, CV_8UC3), testTimestamp(1)).has_value());
+        QVERIFY(!writer.appendFrame(cv::Mat(TEST_HEIGHT / 2, TEST_WIDTH, CV_8UC3), testTimestamp(1)).has_value());
+        QVERIFY(!writer.appendFrame(makeTestFrame(1, CV_8UC1), testTimestamp(1)).has_value());
+        QVERIFY(writer.appendFrame(makeTestFrame(1), testTimestamp(1)).has_value());
+        QCOMPARE(writer.frameCount(), static_cast<size_t>(2));
+        QVERIFY(writer.close().has_value());
+    }
+
+    void testCrashRecovery()
+    {
+        const auto fname = writeTestSpool(QStringLiteral("recovery"));
+        QVERIFY(!fname.isEmpty());
+        const auto indexOffset = spoolIndexOffset(fname);
+        QVERIFY(indexOffset > 0);
+
+        // drop the index and its trailer, as if the recorder crashed before closing the file
+        QVERIFY(truncate(QFile::encodeName(fname).constData(), indexOffset) == 0);
+        FrameSpoolReader reader;
+        QVERIFY(reader.open(fname.toStdString()).has_value());
+        QVERIFY(reader.indexRecovered());
+        verifyFrames(reader, TEST_FRAME_COUNT);
+        reader.close();
+
+        // a torn last record is dropped, all complete ones are kept
+        QVERIFY(truncate(QFile::encodeName(fname).constData(), indexOffset - 100) == 0);
+        QVERIFY(reader.open(fname.toStdString()).has_value());
+        QVERIFY(reader.indexRecovered());
+        verifyFrames(reader, TEST_FRAME_COUNT - 1);
+    }
+
+    void testDamagedRecordTruncates()
+    {
+        const auto fname = writeTestSpool(QStringLiteral("damaged-record"));
+        QVERIFY(!fname.isEmpty());
+        const auto indexOffset = spoolIndexOffset(fname);
+        QVERIFY(indexOffset > 0);
+        QVERIFY(truncate(QFile::encodeName(fname).constData(), indexOffset) == 0);
+
+        FrameSpoolReader reader;
+        QVERIFY(reader.open(fname.toStdString()).has_value());
+        QVERIFY(reader.indexRecovered());
+        verifyFrames(reader, TEST_FRAME_COUNT);
+        const auto damagedOffset = static_cast<qint64>(reader.entry(5).offset);
+        reader.close();
+
+        // without an index, we can not find any frame after a damaged record header
+        overwriteBytes(fname, damagedOffset, QByteArray(8, '\xFF'));
+        QVERIFY(reader.open(fname.toStdString()).has_value());
+        verifyFrames(reader, 5);
+    }
+
+    void testDamagedIndexEntrySkipped()
+    {
+        const auto fname = writeTestSpool(QStringLiteral("damaged-index"));
+        QVERIFY(!fname.isEmpty());
+        const auto indexOffset = spoolIndexOffset(fname);
+        QVERIFY(indexOffset > 0);
+
+        // give the entry of frame 3 an impossible width; the index is a frame count followed by the entries
+        constexpr qint64 widthPos = 16;
+        overwriteBytes(fname, indexOffset + 8 + 3 * qint64(sizeof(FrameSpoolEntry)) + widthPos, QByteArray(4, '\0'));
+
+        FrameSpoolReader reader;
+        QVERIFY(reader.open(fname.toStdString()).has_value());
+        QVERIFY(!reader.indexRecovered());
+        QCOMPARE(reader.skippedFrameCount(), static_cast<size_t>(1));
+        QCOMPARE(reader.frameCount(), TEST_FRAME_COUNT - 1);
+        for (size_t i = 0; i < reader.frameCount(); i++) {
+            const size_t n = i < 3 ? i : i + 1;
+            QCOMPARE(reader.entry(i).timestampUsec, testTimestamp(n).count());
+            QVERIFY(framesEqual(reader.frame(i), makeTestFrame(n)));
+        }
+    }
+
+    void testModifiedFrameLeavesFileIntact()
+    {
+        const auto fname = writeTestSpool(QStringLiteral("modify"));
+        QVERIFY(!fname.isEmpty());
+
+        {
+            FrameSpoolReader reader;
+            QVERIFY(reader.open(fname.toStdString()).has_value());
+            auto frame = reader.frame(2);
+            frame.setTo(cv::Scalar(0, 0, 0));
+            QVERIFY(!framesEqual(reader.frame(2), makeTestFrame(2)));
+        }
+
+        FrameSpoolReader reader;
+        QVERIFY(reader.open(fname.toStdString()).has_value());
+        verifyFrames(reader, TEST_FRAME_COUNT);
+    }
+};
+
+QTEST_MAIN(TestFrameSpool)
+#include "test-framespool.moc"
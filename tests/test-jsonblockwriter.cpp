@@ -0,0 +1,271 @@
+#include <QtTest>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <zstd.h>
+
+#include "jsonblockwriter.h"
+
+/// Size of the epilogue ZSTD_e_end adds to a flushed frame: an empty last block and the checksum
+static constexpr size_t ZSTD_FRAME_EPILOGUE_SIZE = 3 + 4;
+
+static std::string readFile(const QString &fname)
+{
+    QFile f(fname);
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+    return f.readAll().toStdString();
+}
+
+/**
+ * Decompress the zstd frame in @p data, returning false on error.
+ * @p frameComplete tells whether the frame was properly ended.
+ */
+static bool zstdDecode(const std::string &data, std::string &text, bool &frameComplete)
+{
+    std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    std::vector<char> outBuffer(ZSTD_DStreamOutSize());
+    ZSTD_inBuffer input = {data.data(), data.size(), 0};
+
+    text.clear();
+    size_t ret = 1;
+    ZSTD_outBuffer output = {outBuffer.data(), outBuffer.size(), 0};
+    while (input.pos < input.size || output.pos == output.size) {
+        output = {outBuffer.data(), outBuffer.size(), 0};
+        ret = ZSTD_decompressStream(dctx.get(), &output, &input);
+        if (ZSTD_isError(ret)) {
+            qWarning().noquote() << "Unable to decompress:" << ZSTD_getErrorName(ret);
+            return false;
+        }
+        text.append(outBuffer.data(), output.pos);
+        if (ret == 0 && input.pos == input.size)
+            break;
+    }
+
+    frameComplete = ret == 0;
+    return true;
+}
+
+/**
+ * Write a few rows of mixed data, the same way the JSON writer module does.
+ */
+static void writeTestRows(JsonBlockWriter &writer, size_t rowCount)
+{
+    writer.append(std::string_view("{\"columns\": [\"timestamp\",\"value\",\"label\"]"));
+    writer.append(writer.newlineDelimited() ? std::string_view("}\n") : std::string_view(",\n\"data\": [\n"));
+    for (size_t i = 0; i < rowCount; i++) {
+        writer.beginRow();
+        writer.appendNumber(static_cast<uint64_t>(i * 1000));
+        writer.append(',');
+        writer.appendNumber(static_cast<double>(i) / 7.0);
+        writer.append(',');
+        writer.appendString("row " + std::to_string(i % 97) + " \"µs\"\t");
+        writer.endRow();
+    }
+    if (!writer.newlineDelimited())
+        writer.append(std::string_view("\n]}\n"));
+}
+
+class TestJsonBlockWriter : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_tmpDir;
+
+    QString tmpFile(const QString &name)
+    {
+        return m_tmpDir.filePath(name);
+    }
+
+    /**
+     * Return the text written by @p writeFn to a fresh file.
+     */
+    template<typename Fn>
+    std::string writtenText(Fn writeFn)
+    {
+        const auto fname = tmpFile(QStringLiteral("scratch.json"));
+        JsonBlockWriter writer;
+        if (!writer.open(fname.toStdString(), false).has_value())
+            return {};
+        writeFn(writer);
+        if (!writer.close().has_value())
+            return {};
+        return readFile(fname);
+    }
+
+    template<typename T>
+    std::string formatNumber(T value)
+    {
+        return writtenText([value](JsonBlockWriter &writer) {
+            writer.appendNumber(value);
+        });
+    }
+
+    template<typename T>
+    bool numberRoundTrips(T value)
+    {
+        const auto text = formatNumber(value);
+        T parsed{};
+        const auto res = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        return res.ec == std::errc() && res.ptr == text.data() + text.size() && parsed == value;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tmpDir.isValid());
+    }
+
+    void testStringEscaping()
+    {
+        const std::string str = "say \"hi\" \\ \n\r\t\x01\x1f\x7f µs äöü 漢字";
+        QCOMPARE(
+            writtenText([&str](JsonBlockWriter &writer) {
+                writer.appendString(str);
+            }),
+            std::string("\"say \\\"hi\\\" \\\\ \\n\\r\\t\\u0001\\u001f\x7f µs äöü 漢字\""));
+
+        // any JSON parser has to get the original text back
+        const auto text = writtenText([&str](JsonBlockWriter &writer) {
+            writer.append('[');
+            writer.appendString(str);
+            writer.append(',');
+            writer.appendString("");
+            writer.append(']');
+        });
+
+        QJsonParseError error;
+        const auto doc = QJsonDocument::fromJson(QByteArray::fromStdString(text), &error);
+        QVERIFY2(!doc.isNull(), qPrintable(error.errorString()));
+        QCOMPARE(doc.array().size(), 2);
+        QCOMPARE(doc.array()[0].toString(), QString::fromStdString(str));
+        QCOMPARE(doc.array()[1].toString(), QString());
+    }
+
+    void testNumberFormatting()
+    {
+        QCOMPARE(formatNumber(0), std::string("0"));
+        QCOMPARE(formatNumber(-42), std::string("-42"));
+        QCOMPARE(formatNumber(std::numeric_limits<int64_t>::min()), std::string("-9223372036854775808"));
+        QCOMPARE(formatNumber(std::numeric_limits<uint64_t>::max()), std::string("18446744073709551615"));
+        QCOMPARE(formatNumber(1.0), std::string("1"));
+        QCOMPARE(formatNumber(0.1), std::string("0.1"));
+        QCOMPARE(formatNumber(-2.5f), std::string("-2.5"));
+        QCOMPARE(formatNumber(1e300), std::string("1e+300"));
+
+        // floating point values have to survive a round trip with the shortest representation
+        const double doubles[] = {
+            1.0 / 3.0, -123456.789, 5e-324, std::numeric_limits<double>::max(), 0.30000000000000004};
+        for (const auto v : doubles)
+            QVERIFY2(numberRoundTrips(v), formatNumber(v).c_str());
+        const float floats[] = {1.0f / 3.0f, 0.1f, std::numeric_limits<float>::denorm_min(), 16777217.0f};
+        for (const auto v : floats)
+            QVERIFY2(numberRoundTrips(v), formatNumber(v).c_str());
+
+        // non-finite values use the names Pandas and Python's json module read back
+        QCOMPARE(formatNumber(std::numeric_limits<double>::quiet_NaN()), std::string("NaN"));
+        QCOMPARE(formatNumber(-std::numeric_limits<float>::quiet_NaN()), std::string("NaN"));
+        QCOMPARE(formatNumber(std::numeric_limits<double>::infinity()), std::string("Infinity"));
+        QCOMPARE(formatNumber(-std::numeric_limits<float>::infinity()), std::string("-Infinity"));
+    }
+
+    void testArrayLayout()
+    {
+        const auto fname = tmpFile(QStringLiteral("rows.json"));
+        JsonBlockWriter writer;
+        QVERIFY(writer.open(fname.toStdString(), false).has_value());
+        writeTestRows(writer, 20);
+        QVERIFY(writer.close().has_value());
+
+        QJsonParseError error;
+        const auto doc = QJsonDocument::fromJson(QByteArray::fromStdString(readFile(fname)), &error);
+        QVERIFY2(!doc.isNull(), qPrintable(error.errorString()));
+        const auto data = doc.object().value(QStringLiteral("data")).toArray();
+        QCOMPARE(data.size(), 20);
+        QCOMPARE(data[3].toArray()[0].toInteger(), qint64(3000));
+        QCOMPARE(data[3].toArray()[2].toString(), QStringLiteral("row 3 \"µs\"\t"));
+    }
+
+    void testNdjsonLayout()
+    {
+        const auto fname = tmpFile(QStringLiteral("rows.ndjson"));
+        JsonBlockWriter writer;
+        writer.setNewlineDelimited(true);
+        QVERIFY(writer.open(fname.toStdString(), false).has_value());
+        writeTestRows(writer, 20);
+        QVERIFY(writer.close().has_value());
+
+        // the header object is on the first line, then there is exactly one row per line
+        const auto lines = QByteArray::fromStdString(readFile(fname)).split('\n');
+        QCOMPARE(lines.size(), 22);
+        QVERIFY(lines.last().isEmpty());
+
+        QJsonParseError error;
+        const auto header = QJsonDocument::fromJson(lines[0], &error);
+        QVERIFY2(header.isObject(), qPrintable(error.errorString()));
+        QCOMPARE(header.object().value(QStringLiteral("columns")).toArray().size(), 3);
+        for (qsizetype i = 1; i < lines.size() - 1; i++) {
+            const auto row = QJsonDocument::fromJson(lines[i], &error);
+            QVERIFY2(row.isArray(), qPrintable(error.errorString()));
+            QCOMPARE(row.array().size(), 3);
+            QCOMPARE(row.array()[0].toInteger(), (i - 1) * 1000);
+        }
+
+        // reopening the writer starts a new file without a row separator
+        QVERIFY(writer.open(fname.toStdString(), false).has_value());
+        writer.setNewlineDelimited(false);
+        writer.beginRow();
+        writer.endRow();
+        QVERIFY(writer.close().has_value());
+        QCOMPARE(readFile(fname), std::string("[]"));
+    }
+
+    void testZstdStream()
+    {
+        // write enough data to fill several blocks, plain and compressed
+        constexpr size_t rowCount = 80000;
+        const auto plainFname = tmpFile(QStringLiteral("large.ndjson"));
+        const auto zstdFname = tmpFile(QStringLiteral("large.ndjson.zst"));
+        JsonBlockWriter plainWriter;
+        JsonBlockWriter zstdWriter;
+        plainWriter.setNewlineDelimited(true);
+        zstdWriter.setNewlineDelimited(true);
+        QVERIFY(plainWriter.open(plainFname.toStdString(), false).has_value());
+        QVERIFY(zstdWriter.open(zstdFname.toStdString(), true).has_value());
+        writeTestRows(plainWriter, rowCount);
+        writeTestRows(zstdWriter, rowCount);
+        QVERIFY(plainWriter.close().has_value());
+        QVERIFY(zstdWriter.close().has_value());
+        QVERIFY(!zstdWriter.failed());
+
+        const auto expected = readFile(plainFname);
+        QVERIFY(expected.size() > 3 * 1024 * 1024);
+        const auto compressed = readFile(zstdFname);
+        QVERIFY(!compressed.empty());
+        QVERIFY(compressed.size() < expected.size());
+
+        // the file is one complete frame which decompresses to exactly the plain text
+        std::string text;
+        bool frameComplete = false;
+        QVERIFY(zstdDecode(compressed, text, frameComplete));
+        QVERIFY(frameComplete);
+        QVERIFY(text == expected);
+
+        // every block was flushed on its own, so without the frame epilogue that is only written
+        // on close(), as if we had crashed, all data can still be read back
+        QVERIFY(compressed.size() > ZSTD_FRAME_EPILOGUE_SIZE);
+        QVERIFY(zstdDecode(compressed.substr(0, compressed.size() - ZSTD_FRAME_EPILOGUE_SIZE), text, frameComplete));
+        QVERIFY(!frameComplete);
+        QVERIFY(text == expected);
+    }
+};
+
+QTEST_MAIN(TestJsonBlockWriter)
+#include "test-jsonblockwriter.moc"
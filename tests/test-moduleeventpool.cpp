@@ -0,0 +1,339 @@
+#include <QtTest>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "logging.h"
+#include "moduleeventpool.h"
+#include "streams/stream.h"
+
+using namespace Syntalos;
+using namespace std::chrono;
+
+namespace Syntalos
+{
+/**
+ * Only the engine may release an OptionalWaitCondition and change module states,
+ * so we stand in for it here.
+ */
+class Engine
+{
+public:
+    static void releaseWaitCondition(OptionalWaitCondition *waitCondition)
+    {
+        // once released, workers pass the condition without waiting at all
+        waitCondition->wakeAll();
+    }
+
+    static void setModuleRunning(AbstractModule *mod)
+    {
+        mod->setState(ModuleState::RUNNING);
+    }
+};
+} // namespace Syntalos
+
+/**
+ * Module with counting timer and data callbacks, which records whether any two of
+ * its callbacks ever ran at the same time, and on which threads they ran.
+ */
+class PoolTestModule : public AbstractModule
+{
+public:
+    explicit PoolTestModule(const QString &name, microseconds callbackDuration)
+        : AbstractModule(),
+          m_callbackDuration(callbackDuration)
+    {
+        setName(name);
+    }
+
+    bool prepare(const TestSubject &) override
+    {
+        return true;
+    }
+
+    void addTimer(milliseconds interval)
+    {
+        registerTimedEvent(&PoolTestModule::onTimer, interval);
+    }
+
+    void addSecondTimer(milliseconds interval)
+    {
+        registerTimedEvent(&PoolTestModule::onSecondTimer, interval);
+    }
+
+    void addDataSource(std::shared_ptr<StreamSubscription<TableRow>> sub)
+    {
+        m_sub = sub;
+        registerDataReceivedEvent(&PoolTestModule::onData, sub);
+    }
+
+    /**
+     * Also count callbacks in counters shared with other modules.
+     */
+    void shareActivityCounter(std::atomic_int *active, std::atomic_int *maxActive)
+    {
+        m_sharedActive = active;
+        m_sharedMaxActive = maxActive;
+    }
+
+    /// Stop the first timer after this many calls by returning a negative interval
+    int stopTimerAfter{-1};
+
+    /// Raise an error in the first timer after this many calls
+    int failAfter{-1};
+
+    std::atomic_int timerCalls{0};
+    std::atomic_int secondTimerCalls{0};
+    std::atomic_int dataCalls{0};
+    std::atomic_int rowsReceived{0};
+    std::atomic_int maxActive{0};
+
+    std::set<std::thread::id> threadIds() const
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        return m_threadIds;
+    }
+
+private:
+    microseconds m_callbackDuration;
+    std::shared_ptr<StreamSubscription<TableRow>> m_sub;
+    std::atomic_int m_active{0};
+    std::atomic_int *m_sharedActive{nullptr};
+    std::atomic_int *m_sharedMaxActive{nullptr};
+
+    mutable std::mutex m_threadsMutex;
+    std::set<std::thread::id> m_threadIds;
+
+    static void countActive(std::atomic_int &active, std::atomic_int &maxActive)
+    {
+        const auto value = ++active;
+        int prevMax = maxActive.load();
+        while (value > prevMax && !maxActive.compare_exchange_weak(prevMax, value)) {
+        }
+    }
+
+    void enterCallback()
+    {
+        countActive(m_active, maxActive);
+        if (m_sharedActive != nullptr)
+            countActive(*m_sharedActive, *m_sharedMaxActive);
+
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        m_threadIds.insert(std::this_thread::get_id());
+    }
+
+    void leaveCallback()
+    {
+        std::this_thread::sleep_for(m_callbackDuration);
+        if (m_sharedActive != nullptr)
+            (*m_sharedActive)--;
+        m_active--;
+    }
+
+    void onTimer(int &interval)
+    {
+        enterCallback();
+        const auto calls = ++timerCalls;
+        if (calls == stopTimerAfter)
+            interval = -1;
+        if (calls == failAfter)
+            raiseError(QStringLiteral("Failing on purpose"));
+        leaveCallback();
+    }
+
+    void onSecondTimer(int &)
+    {
+        enterCallback();
+        secondTimerCalls++;
+        leaveCallback();
+    }
+
+    void onData()
+    {
+        enterCallback();
+        dataCalls++;
+        while (m_sub->peekNext().has_value())
+            rowsReceived++;
+        leaveCallback();
+    }
+};
+
+/**
+ * Push rows into a stream from a separate thread until stopped.
+ */
+class RowProducer
+{
+public:
+    RowProducer()
+    {
+        m_stream.start();
+    }
+
+    ~RowProducer()
+    {
+        stop();
+    }
+
+    std::shared_ptr<StreamSubscription<TableRow>> subscribe()
+    {
+        return m_stream.subscribe();
+    }
+
+    void run(microseconds interval)
+    {
+        m_running = true;
+        m_thread = std::thread([this, interval]() {
+            while (m_running) {
+                m_stream.push(TableRow(std::vector<std::string>{"row"}));
+                pushed++;
+                std::this_thread::sleep_for(interval);
+            }
+        });
+    }
+
+    void stop()
+    {
+        m_running = false;
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    std::atomic_int pushed{0};
+
+private:
+    DataStream<TableRow> m_stream;
+    std::thread m_thread;
+    std::atomic_bool m_running{false};
+};
+
+static void runPool(ModuleEventPool &pool, const QList<AbstractModule *> &mods, milliseconds duration)
+{
+    OptionalWaitCondition waitCondition;
+    Engine::releaseWaitCondition(&waitCondition);
+    pool.run(mods, &waitCondition);
+    std::this_thread::sleep_for(duration);
+    pool.stop();
+}
+
+class TestModuleEventPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        initializeSyLogSystem(quill::LogLevel::Warning);
+    }
+
+    void testModuleCallbacksSerialized()
+    {
+        // several sources of one module firing all the time, with more workers than sources
+        RowProducer producer;
+        PoolTestModule mod(QStringLiteral("serial"), microseconds(200));
+        mod.addTimer(milliseconds(0));
+        mod.addSecondTimer(milliseconds(0));
+        mod.addDataSource(producer.subscribe());
+        Engine::setModuleRunning(&mod);
+
+        ModuleEventPool pool(4, QStringLiteral("test-serial"));
+        producer.run(microseconds(100));
+        runPool(pool, {&mod}, milliseconds(300));
+        producer.stop();
+
+        QVERIFY(!pool.isFailed());
+        QVERIFY(mod.timerCalls > 0);
+        QVERIFY(mod.secondTimerCalls > 0);
+        QVERIFY(mod.dataCalls > 0);
+        QVERIFY(mod.rowsReceived > 0);
+        QCOMPARE(mod.maxActive.load(), 1);
+    }
+
+    void testBusyModulesSpreadAcrossWorkers()
+    {
+        // modules that keep their worker busy; events queued on one worker have to be taken
+        // over by the idle ones, otherwise the modules would never run at the same time
+        constexpr int modCount = 4;
+        std::atomic_int poolActive{0};
+        std::atomic_int poolMaxActive{0};
+        std::vector<std::unique_ptr<PoolTestModule>> mods;
+        QList<AbstractModule *> modList;
+        for (int i = 0; i < modCount; i++) {
+            auto mod = std::make_unique<PoolTestModule>(QStringLiteral("busy-%1").arg(i), milliseconds(5));
+            mod->addTimer(milliseconds(1));
+            mod->shareActivityCounter(&poolActive, &poolMaxActive);
+            Engine::setModuleRunning(mod.get());
+            modList.append(mod.get());
+            mods.push_back(std::move(mod));
+        }
+
+        ModuleEventPool pool(modCount, QStringLiteral("test-steal"));
+        runPool(pool, modList, milliseconds(300));
+
+        std::set<std::thread::id> threads;
+        for (const auto &mod : mods) {
+            QCOMPARE(mod->maxActive.load(), 1);
+            QVERIFY(mod->timerCalls > 0);
+            const auto modThreads = mod->threadIds();
+            threads.insert(modThreads.cbegin(), modThreads.cend());
+        }
+        QVERIFY2(threads.size() > 1, "All modules ran on the same worker");
+        QVERIFY2(poolMaxActive > 1, "Modules never ran in parallel");
+    }
+
+    void testNegativeIntervalStopsTimer()
+    {
+        PoolTestModule mod(QStringLiteral("stop-timer"), microseconds(0));
+        mod.stopTimerAfter = 5;
+        mod.addTimer(milliseconds(1));
+        mod.addSecondTimer(milliseconds(1));
+        Engine::setModuleRunning(&mod);
+
+        ModuleEventPool pool(2, QStringLiteral("test-stop"));
+        runPool(pool, {&mod}, milliseconds(200));
+
+        // the other timer of the module keeps running
+        QVERIFY(!pool.isFailed());
+        QCOMPARE(mod.timerCalls.load(), 5);
+        QVERIFY(mod.secondTimerCalls > 10);
+    }
+
+    void testFailedModuleStops()
+    {
+        RowProducer producer;
+        PoolTestModule failing(QStringLiteral("failing"), microseconds(0));
+        failing.failAfter = 3;
+        failing.addTimer(milliseconds(1));
+        failing.addDataSource(producer.subscribe());
+        Engine::setModuleRunning(&failing);
+
+        PoolTestModule healthy(QStringLiteral("healthy"), microseconds(0));
+        healthy.addTimer(milliseconds(1));
+        Engine::setModuleRunning(&healthy);
+
+        ModuleEventPool pool(2, QStringLiteral("test-fail"));
+        OptionalWaitCondition waitCondition;
+        Engine::releaseWaitCondition(&waitCondition);
+        pool.run({&failing, &healthy}, &waitCondition);
+
+        QTRY_VERIFY_WITH_TIMEOUT(pool.isFailed(), 5000);
+        QVERIFY(failing.state() == ModuleState::ERROR);
+        const int failedDataCalls = failing.dataCalls;
+
+        // neither new data nor the timer may reach the failed module anymore
+        producer.run(microseconds(200));
+        const int healthyCalls = healthy.timerCalls;
+        std::this_thread::sleep_for(milliseconds(100));
+        pool.stop();
+        producer.stop();
+
+        QCOMPARE(failing.timerCalls.load(), 3);
+        QCOMPARE(failing.dataCalls.load(), failedDataCalls);
+        QVERIFY(producer.pushed > 0);
+        QVERIFY(healthy.timerCalls > healthyCalls);
+    }
+};
+
+QTEST_MAIN(TestModuleEventPool)
+#include "test-moduleeventpool.moc"
@@ -0,0 +1,205 @@
+#include <QtTest>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "logging.h"
+#include "moduleeventthread.h"
+
+using namespace Syntalos;
+using namespace std::chrono;
+
+namespace Syntalos
+{
+/**
+ * Only the engine may release an OptionalWaitCondition and change module states,
+ * so we stand in for it here.
+ */
+class Engine
+{
+public:
+    static void releaseWaitCondition(OptionalWaitCondition *waitCondition)
+    {
+        // once released, the event thread passes the condition without waiting at all
+        waitCondition->wakeAll();
+    }
+
+    static void setModuleRunning(AbstractModule *mod)
+    {
+        mod->setState(ModuleState::RUNNING);
+    }
+};
+} // namespace Syntalos
+
+/**
+ * Module with a precise timer, which records when it was called.
+ */
+class PreciseTimerTestModule : public AbstractModule
+{
+public:
+    explicit PreciseTimerTestModule(const QString &name, microseconds interval)
+        : AbstractModule()
+    {
+        setName(name);
+        registerPreciseTimedEvent(&PreciseTimerTestModule::onTimer, interval);
+    }
+
+    bool prepare(const TestSubject &) override
+    {
+        return true;
+    }
+
+    /// Stop the timer after this many calls by returning a negative interval
+    int stopAfter{-1};
+
+    /// Block every n-th call for longer than the interval, so deadlines are missed
+    int slowEvery{-1};
+    microseconds slowDuration{0};
+
+    std::atomic_int calls{0};
+
+    std::vector<steady_clock::time_point> callTimes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_callTimes;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<steady_clock::time_point> m_callTimes;
+
+    void onTimer(int &interval)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_callTimes.push_back(steady_clock::now());
+        }
+        const auto n = ++calls;
+        if (slowEvery > 0 && n % slowEvery == 0)
+            std::this_thread::sleep_for(slowDuration);
+        if (n == stopAfter)
+            interval = -1;
+    }
+};
+
+/**
+ * Run the event thread for @p mods until @p mod has been called @p calls times.
+ */
+static void runUntilCalled(
+    ModuleEventThread &evThread,
+    const QList<AbstractModule *> &mods,
+    const PreciseTimerTestModule &mod,
+    int calls)
+{
+    OptionalWaitCondition waitCondition;
+    Engine::releaseWaitCondition(&waitCondition);
+    evThread.run(mods, &waitCondition);
+    QTRY_VERIFY_WITH_TIMEOUT(mod.calls >= calls, 10000);
+    evThread.stop();
+}
+
+static PreciseTimerStats statsFor(const ModuleEventThread &evThread, const QString &modName)
+{
+    for (const auto &stats : evThread.preciseTimerStats()) {
+        if (stats.moduleName == modName)
+            return stats;
+    }
+    return {};
+}
+
+class TestModuleEventThread : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        initializeSyLogSystem(quill::LogLevel::Warning);
+    }
+
+    void testPreciseTimerPeriod()
+    {
+        constexpr int callCount = 300;
+        constexpr int64_t intervalUs = 2000;
+        PreciseTimerTestModule mod(QStringLiteral("period"), microseconds(intervalUs));
+        mod.stopAfter = callCount;
+        Engine::setModuleRunning(&mod);
+
+        ModuleEventThread evThread(QStringLiteral("test-period"));
+        runUntilCalled(evThread, {&mod}, mod, callCount);
+        QVERIFY(!evThread.isFailed());
+        QCOMPARE(mod.calls.load(), callCount);
+
+        const auto stats = statsFor(evThread, mod.name());
+        QCOMPARE(stats.intervalUs, static_cast<int>(intervalUs));
+        QCOMPARE(stats.dispatchCount, static_cast<uint64_t>(callCount));
+        QVERIFY(stats.latenessMeanUs >= 0);
+        QVERIFY(stats.latenessStdDevUs >= 0);
+        QVERIFY(stats.latenessMaxUs >= stats.latenessMeanUs);
+
+        // deadlines are absolute, so the calls never come faster than the interval, and the time
+        // between the first and the last call (counting missed deadlines) does not drift beyond
+        // the lateness of single calls
+        const auto times = mod.callTimes();
+        QCOMPARE(times.size(), static_cast<size_t>(callCount));
+        const auto elapsedUs = duration_cast<microseconds>(times.back() - times.front()).count();
+        const auto toleranceUs = static_cast<int64_t>(stats.latenessMaxUs) + 1000;
+        const auto minUs = (callCount - 1) * intervalUs - toleranceUs;
+        const auto maxUs = static_cast<int64_t>(callCount - 1 + stats.missedCount) * intervalUs + toleranceUs;
+        QVERIFY2(
+            elapsedUs >= minUs && elapsedUs <= maxUs,
+            qPrintable(QStringLiteral("elapsed %1 µs, expected %2 to %3 µs").arg(elapsedUs).arg(minUs).arg(maxUs)));
+    }
+
+    void testPreciseTimerMissedDeadlines()
+    {
+        // every 10th call blocks for more than two intervals, so at least the deadline
+        // right after it is missed
+        constexpr int callCount = 100;
+        constexpr int slowEvery = 10;
+        PreciseTimerTestModule mod(QStringLiteral("missed"), microseconds(1000));
+        mod.stopAfter = callCount;
+        mod.slowEvery = slowEvery;
+        mod.slowDuration = microseconds(2500);
+        Engine::setModuleRunning(&mod);
+
+        ModuleEventThread evThread(QStringLiteral("test-missed"));
+        runUntilCalled(evThread, {&mod}, mod, callCount);
+        QVERIFY(!evThread.isFailed());
+
+        // the last slow call stopped the timer, so no deadline after it is counted
+        const auto stats = statsFor(evThread, mod.name());
+        QCOMPARE(stats.dispatchCount, static_cast<uint64_t>(callCount));
+        QVERIFY2(
+            stats.missedCount >= static_cast<uint64_t>(callCount / slowEvery - 1),
+            qPrintable(QString::number(stats.missedCount)));
+        QVERIFY(stats.latenessMaxUs >= stats.latenessMeanUs);
+        QVERIFY(stats.latenessStdDevUs >= 0);
+    }
+
+    void testStatsOfAllModules()
+    {
+        PreciseTimerTestModule fast(QStringLiteral("fast"), microseconds(500));
+        PreciseTimerTestModule slow(QStringLiteral("slow"), microseconds(5000));
+        Engine::setModuleRunning(&fast);
+        Engine::setModuleRunning(&slow);
+
+        ModuleEventThread evThread(QStringLiteral("test-multi"));
+        QVERIFY(evThread.preciseTimerStats().empty());
+        runUntilCalled(evThread, {&fast, &slow}, slow, 20);
+        QVERIFY(!evThread.isFailed());
+
+        const auto allStats = evThread.preciseTimerStats();
+        QCOMPARE(allStats.size(), static_cast<size_t>(2));
+        QCOMPARE(statsFor(evThread, fast.name()).intervalUs, 500);
+        QCOMPARE(statsFor(evThread, slow.name()).intervalUs, 5000);
+        QCOMPARE(statsFor(evThread, fast.name()).dispatchCount, static_cast<uint64_t>(fast.calls.load()));
+        QCOMPARE(statsFor(evThread, slow.name()).dispatchCount, static_cast<uint64_t>(slow.calls.load()));
+        QVERIFY(fast.calls > slow.calls);
+    }
+};
+
+QTEST_MAIN(TestModuleEventThread)
+#include "test-moduleeventthread.moc"
@@ -0,0 +1,189 @@
+#include <QtTest>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "sampleringbuffer.h"
+
+static constexpr size_t TEST_CAPACITY = 5000;
+
+/**
+ * Append @p n pseudo-random samples to both @p buf and @p all.
+ * Values are drawn from a small set of integers, so ties are common.
+ */
+static void addSamples(SampleRingBuffer &buf, std::vector<float> &all, size_t n, uint32_t &seed)
+{
+    std::vector<float> chunk(n);
+    for (auto &v : chunk) {
+        seed = seed * 1664525u + 1013904223u;
+        v = static_cast<float>(static_cast<int>((seed >> 16) % 64) - 32);
+    }
+    all.insert(all.end(), chunk.cbegin(), chunk.cend());
+    buf.add(chunk.data(), chunk.size());
+}
+
+/**
+ * Compare every bucket of every pyramid level with a brute-force scan over all samples
+ * ever added, @p all.
+ */
+static void verifyLevels(const SampleRingBuffer &buf, const std::vector<float> &all, size_t capacity)
+{
+    const uint64_t total = all.size();
+    QCOMPARE(buf.totalAdded(), total);
+    QCOMPARE(buf.size(), std::min<size_t>(all.size(), capacity));
+    const uint64_t base = total - buf.size();
+
+    for (size_t l = 0; l < buf.levelCount(); l++) {
+        const uint64_t bs = buf.levelBucketSize(l);
+        const uint64_t childBs = (l == 0) ? 1 : buf.levelBucketSize(l - 1);
+        for (uint64_t bn = 0; bn <= total / bs + 1; bn++) {
+            const uint64_t start = bn * bs;
+
+            // an incomplete bucket only holds the samples of complete child buckets
+            uint64_t count = 0;
+            bool held = false;
+            if (start + bs <= total) {
+                count = bs;
+                held = start + bs > base;
+            } else if (start < total) {
+                count = (total - start) / childBs * childBs;
+                held = count > 0;
+            }
+
+            const auto mm = buf.levelBucket(l, bn);
+            QVERIFY2(mm.has_value() == held, qPrintable(QStringLiteral("level %1 bucket %2").arg(l).arg(bn)));
+            if (!held)
+                continue;
+
+            // ties resolve to the earliest sample
+            const auto first = all.cbegin() + static_cast<ptrdiff_t>(start);
+            const auto last = first + static_cast<ptrdiff_t>(count);
+            const auto minIt = std::min_element(first, last);
+            const auto maxIt = std::max_element(first, last);
+            QCOMPARE(mm->start, start);
+            QCOMPARE(mm->count, count);
+            QCOMPARE(mm->min, *minIt);
+            QCOMPARE(mm->max, *maxIt);
+            QCOMPARE(mm->minPos, static_cast<uint64_t>(minIt - all.cbegin()));
+            QCOMPARE(mm->maxPos, static_cast<uint64_t>(maxIt - all.cbegin()));
+        }
+    }
+}
+
+class TestSampleRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testLevelLayout()
+    {
+        SampleRingBuffer buf(TEST_CAPACITY);
+        QCOMPARE(buf.levelCount(), static_cast<size_t>(3));
+        QCOMPARE(buf.levelBucketSize(0), static_cast<size_t>(32));
+        QCOMPARE(buf.levelBucketSize(1), static_cast<size_t>(256));
+        QCOMPARE(buf.levelBucketSize(2), static_cast<size_t>(2048));
+
+        // too small to hold a single bucket
+        SampleRingBuffer tiny(16);
+        QCOMPARE(tiny.levelCount(), static_cast<size_t>(0));
+    }
+
+    void testPartialBuckets()
+    {
+        // add samples one by one, so we see every fill state of the incomplete buckets
+        SampleRingBuffer buf(TEST_CAPACITY);
+        std::vector<float> all;
+        uint32_t seed = 1;
+        for (size_t i = 0; i < 600; i++) {
+            addSamples(buf, all, 1, seed);
+            verifyLevels(buf, all, TEST_CAPACITY);
+            if (QTest::currentTestFailed())
+                return;
+        }
+    }
+
+    void testLevelsWithWraparound()
+    {
+        // chunks of all kinds of sizes, some across bucket borders and one larger than the ring
+        const size_t chunkSizes[] = {1, 7, 31, 32, 100, 333, 2048, 4999, 12000, 5000, 257};
+        SampleRingBuffer buf(TEST_CAPACITY);
+        std::vector<float> all;
+        uint32_t seed = 42;
+        for (size_t round = 0; round < 4; round++) {
+            for (const auto n : chunkSizes) {
+                addSamples(buf, all, n, seed);
+                verifyLevels(buf, all, TEST_CAPACITY);
+                if (QTest::currentTestFailed())
+                    return;
+            }
+        }
+        QVERIFY(all.size() > 10 * TEST_CAPACITY);
+    }
+
+    void testClearAndResize()
+    {
+        SampleRingBuffer buf(TEST_CAPACITY);
+        std::vector<float> all;
+        uint32_t seed = 7;
+        addSamples(buf, all, 7777, seed);
+
+        // nothing of the old data may show up again
+        buf.clear();
+        all.clear();
+        verifyLevels(buf, all, TEST_CAPACITY);
+        addSamples(buf, all, 3000, seed);
+        verifyLevels(buf, all, TEST_CAPACITY);
+
+        buf.setCapacity(300);
+        all.clear();
+        QCOMPARE(buf.levelCount(), static_cast<size_t>(2));
+        addSamples(buf, all, 1234, seed);
+        verifyLevels(buf, all, 300);
+    }
+
+    void testEnvelope()
+    {
+        SampleRingBuffer buf(TEST_CAPACITY);
+        std::vector<float> all;
+        uint32_t seed = 3;
+        addSamples(buf, all, 23456, seed);
+        const uint64_t base = all.size() - buf.size();
+
+        struct Window {
+            size_t from;
+            size_t len;
+            size_t nBins;
+        };
+        const Window windows[] = {
+            {0, TEST_CAPACITY, 100},
+            {0, TEST_CAPACITY, 7},
+            {13, 4321, 64},
+            {1000, 50, 50},
+            {4999, 1, 10},
+            {17, 3000, 3},
+        };
+        std::vector<size_t> idx;
+        std::vector<float> values;
+        for (const auto &w : windows) {
+            buf.minMaxEnvelope(w.from, w.len, w.nBins, idx, values);
+            QVERIFY(!idx.empty());
+            QCOMPARE(idx.size(), values.size());
+
+            // points are in time order, inside the window and show the actual samples
+            for (size_t i = 0; i < idx.size(); i++) {
+                QVERIFY(idx[i] >= w.from && idx[i] < w.from + w.len);
+                QVERIFY(i == 0 || idx[i] > idx[i - 1]);
+                QCOMPARE(values[i], all[base + idx[i]]);
+            }
+
+            // the envelope has to include the extremes of the whole window
+            const auto first = all.cbegin() + static_cast<ptrdiff_t>(base + w.from);
+            const auto last = first + static_cast<ptrdiff_t>(w.len);
+            QCOMPARE(*std::min_element(values.cbegin(), values.cend()), *std::min_element(first, last));
+            QCOMPARE(*std::max_element(values.cbegin(), values.cend()), *std::max_element(first, last));
+        }
+    }
+};
+
+QTEST_MAIN(TestSampleRingBuffer)
+#include "test-sampleringbuffer.moc"
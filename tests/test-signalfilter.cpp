@@ -0,0 +1,263 @@
+#include <QDebug>
+#include <QtTest>
+#include <Iir.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+#include "filterpipeline.h"
+
+static constexpr double TEST_SAMPLE_RATE = 20000.0;
+
+using ReferenceFilter = std::function<double(double)>;
+
+template<typename IirT, typename... Args>
+static ReferenceFilter makeReference(Args... args)
+{
+    auto filter = std::make_shared<IirT>();
+    filter->setup(args...);
+    return [filter](double x) {
+        return filter->filter(x);
+    };
+}
+
+/**
+ * Build a plain per-sample iir1 filter for @p st, as the signal filter used before
+ * all stages were flattened into one cascade. Only covers the designs used below.
+ */
+static ReferenceFilter makeReferenceFilter(const FilterStage &st, double fs)
+{
+    using State = Iir::TransposedDirectFormII;
+
+    switch (st.family) {
+    case FilterFamily::Butterworth:
+        if (st.response == FilterResponse::HighPass)
+            return makeReference<Iir::Butterworth::HighPass<MAX_FILTER_ORDER, State>>(st.order, fs, st.freq1);
+        if (st.response == FilterResponse::BandPass)
+            return makeReference<Iir::Butterworth::BandPass<MAX_FILTER_ORDER, State>>(
+                st.order, fs, st.freq1, st.freq2);
+        break;
+    case FilterFamily::ChebyshevI:
+        if (st.response == FilterResponse::LowPass)
+            return makeReference<Iir::ChebyshevI::LowPass<MAX_FILTER_ORDER, State>>(
+                st.order, fs, st.freq1, st.rippleDb);
+        break;
+    case FilterFamily::ChebyshevII:
+        if (st.response == FilterResponse::BandStop)
+            return makeReference<Iir::ChebyshevII::BandStop<MAX_FILTER_ORDER, State>>(
+                st.order, fs, st.freq1, st.freq2, st.stopbandDb);
+        break;
+    case FilterFamily::RbjNotch:
+        return makeReference<Iir::RBJ::IIRNotch>(fs, st.freq1, st.qFactor);
+    case FilterFamily::CustomSOS: {
+        // unused sections are padded with the identity biquad
+        double coeffs[MAX_SOS_SECTIONS][6];
+        for (int i = 0; i < MAX_SOS_SECTIONS; ++i) {
+            const auto &row = i < static_cast<int>(st.sos.size()) ? st.sos[static_cast<size_t>(i)]
+                                                                  : std::array<double, 6>{1, 0, 0, 1, 0, 0};
+            for (int j = 0; j < 6; ++j)
+                coeffs[i][j] = row[static_cast<size_t>(j)];
+        }
+        auto filter = std::make_shared<Iir::Custom::SOSCascade<MAX_SOS_SECTIONS, State>>();
+        filter->setup(coeffs);
+        return [filter](double x) {
+            return filter->filter(x);
+        };
+    }
+    }
+
+    qFatal("No reference filter for this stage design");
+}
+
+/**
+ * A linear chirp with a step, slightly different on every channel so that
+ * mixed-up channels are noticed.
+ */
+static std::vector<double> makeTestSignal(size_t rows, size_t cols)
+{
+    std::vector<double> signal(rows * cols);
+    for (size_t r = 0; r < rows; ++r) {
+        const double t = static_cast<double>(r) / TEST_SAMPLE_RATE;
+        for (size_t c = 0; c < cols; ++c) {
+            const double f0 = 20.0 + 5.0 * static_cast<double>(c);
+            const double chirp = std::sin(2.0 * std::numbers::pi * (f0 + 20000.0 * t) * t);
+            const double step = r >= rows / 4 ? 10.0 * static_cast<double>(c + 1) : 0.0;
+            signal[r * cols + c] = 100.0 * chirp + step;
+        }
+    }
+
+    return signal;
+}
+
+class TestSignalFilter : public QObject
+{
+    Q_OBJECT
+private:
+    /**
+     * Filter the test signal with a pipeline and with plain iir1 filters, and
+     * check that all selected channels match within @p relTolerance.
+     */
+    template<typename Sample>
+    void verifyAgainstReference(
+        const std::vector<FilterStage> &stages,
+        FilterPrecision precision,
+        double relTolerance,
+        size_t cols = 3,
+        int threads = 1,
+        const std::vector<bool> &mask = {})
+    {
+        const size_t rows = 2048;
+        const size_t blockRows = 256;
+        const auto input = makeTestSignal(rows, cols);
+
+        FilterPipeline pipeline;
+        pipeline.setStages(stages);
+        pipeline.setSampleRate(TEST_SAMPLE_RATE);
+        pipeline.setPrecision(precision);
+        pipeline.setThreadCount(threads);
+        std::string error;
+        QVERIFY2(pipeline.build(static_cast<int>(cols), mask, &error), error.c_str());
+
+        // filter in several blocks, so the delay lines have to carry over
+        std::vector<Sample> output(input.begin(), input.end());
+        for (size_t r = 0; r < rows; r += blockRows)
+            pipeline.processBlock(output.data() + r * cols, blockRows, cols);
+
+        for (size_t c = 0; c < cols; ++c) {
+            const bool active = mask.empty() || mask[c];
+
+            std::vector<ReferenceFilter> refs;
+            for (const auto &st : stages)
+                refs.push_back(makeReferenceFilter(st, TEST_SAMPLE_RATE));
+
+            double peak = 0;
+            double maxError = 0;
+            for (size_t r = 0; r < rows; ++r) {
+                double expected = static_cast<Sample>(input[r * cols + c]);
+                if (active) {
+                    for (auto &ref : refs)
+                        expected = ref(expected);
+                }
+
+                peak = std::max(peak, std::abs(expected));
+                maxError = std::max(maxError, std::abs(static_cast<double>(output[r * cols + c]) - expected));
+            }
+
+            if (!active) {
+                QCOMPARE(maxError, 0.0);
+                continue;
+            }
+            QVERIFY2(
+                maxError <= relTolerance * std::max(peak, 1.0),
+                qPrintable(QStringLiteral("channel %1: max. error %2 at peak %3").arg(c).arg(maxError).arg(peak)));
+        }
+    }
+
+    void verifyStages(const std::vector<FilterStage> &stages)
+    {
+        verifyAgainstReference<double>(stages, FilterPrecision::Double, 1e-9);
+        verifyAgainstReference<float>(stages, FilterPrecision::Single, 1e-3);
+    }
+
+private slots:
+    void testButterworth()
+    {
+        FilterStage highPass;
+        highPass.family = FilterFamily::Butterworth;
+        highPass.response = FilterResponse::HighPass;
+        highPass.order = 4;
+        highPass.freq1 = 300.0;
+        verifyStages({highPass});
+
+        FilterStage bandPass;
+        bandPass.family = FilterFamily::Butterworth;
+        bandPass.response = FilterResponse::BandPass;
+        bandPass.order = 3;
+        bandPass.freq1 = 1000.0;
+        bandPass.freq2 = 400.0;
+        verifyStages({bandPass});
+    }
+
+    void testChebyshevI()
+    {
+        FilterStage lowPass;
+        lowPass.family = FilterFamily::ChebyshevI;
+        lowPass.response = FilterResponse::LowPass;
+        lowPass.order = 4;
+        lowPass.freq1 = 2000.0;
+        lowPass.rippleDb = 1.0;
+        verifyStages({lowPass});
+    }
+
+    void testChebyshevII()
+    {
+        FilterStage bandStop;
+        bandStop.family = FilterFamily::ChebyshevII;
+        bandStop.response = FilterResponse::BandStop;
+        bandStop.order = 4;
+        bandStop.freq1 = 1000.0;
+        bandStop.freq2 = 200.0;
+        bandStop.stopbandDb = 40.0;
+        verifyStages({bandStop});
+    }
+
+    void testCustomSos()
+    {
+        // 4th-order Butterworth low-pass, the second section is not normalised to a0 = 1
+        FilterStage custom;
+        custom.family = FilterFamily::CustomSOS;
+        custom.sos = {
+            {0.0218839, 0.0437677, 0.0218839, 1.0, -1.7009643, 0.7884997},
+            {0.0380737, 0.0761473, 0.0380737, 2.0, -2.9593484, 1.1116431},
+        };
+        verifyStages({custom});
+
+        // invalid coefficients are rejected when building
+        custom.sos[1][3] = 0.0;
+        FilterPipeline pipeline;
+        pipeline.setStages({custom});
+        QVERIFY(!pipeline.build(1, {}));
+    }
+
+    void testStageChain()
+    {
+        FilterStage highPass;
+        highPass.family = FilterFamily::Butterworth;
+        highPass.response = FilterResponse::HighPass;
+        highPass.order = 2;
+        highPass.freq1 = 300.0;
+
+        FilterStage notch;
+        notch.family = FilterFamily::RbjNotch;
+        notch.freq1 = 50.0;
+        notch.qFactor = 20.0;
+
+        verifyStages({highPass, notch});
+    }
+
+    void testThreadedChannels()
+    {
+        FilterStage bandPass;
+        bandPass.family = FilterFamily::Butterworth;
+        bandPass.response = FilterResponse::BandPass;
+        bandPass.order = 4;
+        bandPass.freq1 = 1000.0;
+        bandPass.freq2 = 400.0;
+
+        // enough channels and work per block to be split over worker threads,
+        // with a channel count that does not divide evenly into aligned ranges
+        const size_t cols = 150;
+        std::vector<bool> mask(cols, true);
+        for (size_t c = 0; c < cols; c += 7)
+            mask[c] = false;
+
+        verifyAgainstReference<double>({bandPass}, FilterPrecision::Double, 1e-9, cols, 4, mask);
+        verifyAgainstReference<float>({bandPass}, FilterPrecision::Single, 1e-3, cols, 4, mask);
+    }
+};
+
+QTEST_MAIN(TestSignalFilter)
+#include "test-signalfilter.moc"
@@ -1,5 +1,6 @@
 
 #include <QtTest>
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <opencv2/imgproc.hpp>
@@ -8,6 +9,7 @@
 
 #include "symemopt.h"
 #include "datactl/frametype.h"
+#include "framepool.h"
 #include "streams/stream.h"
 #include "testbarrier.h"
 
@@ -245,6 +247,187 @@ private slots:
                 t.join();
         }
     }
+
+    void runBoundedQueues()
+    {
+        auto stream = std::make_shared<DataStream<Frame>>();
+        auto subNewest = stream->subscribe();
+        auto subOldest = stream->subscribe();
+        auto subBlock = stream->subscribe();
+        subNewest->setQueueLimit(4, SubscriptionOverflowPolicy::DropNewest);
+        subOldest->setQueueLimit(4, SubscriptionOverflowPolicy::DropOldest);
+        subBlock->setQueueLimit(4, SubscriptionOverflowPolicy::Block);
+        stream->start();
+
+        // blocking consumer drains slowly while the producer runs ahead
+        std::vector<uint64_t> blockReceived;
+        std::thread blockConsumer([&]() {
+            while (true) {
+                auto data = subBlock->next();
+                if (!data.has_value())
+                    break;
+                blockReceived.push_back(data->index);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        for (size_t i = 1; i <= 20; ++i) {
+            Frame frame;
+            frame.index = i;
+            frame.mat = cv::Mat(4, 4, CV_8UC1);
+            stream->push(std::move(frame));
+        }
+        stream->terminate();
+        blockConsumer.join();
+
+        // the blocking subscription must not lose anything
+        QCOMPARE(subBlock->droppedCount(), uint64_t(0));
+        QCOMPARE(blockReceived.size(), size_t(20));
+        QCOMPARE(blockReceived.back(), uint64_t(20));
+
+        // drop-newest keeps the first items
+        QCOMPARE(subNewest->droppedCount(), uint64_t(16));
+        QCOMPARE(subNewest->next()->index, uint64_t(1));
+
+        // drop-oldest keeps the most recent ones
+        QCOMPARE(subOldest->droppedCount(), uint64_t(16));
+        QCOMPARE(subOldest->next()->index, uint64_t(17));
+    }
+
+    void runLatestValueMailbox()
+    {
+        auto stream = std::make_shared<DataStream<Frame>>();
+        auto subLatest = stream->subscribe();
+        auto subQueued = stream->subscribe();
+        subLatest->setLatestValueOnly(true);
+        stream->start();
+
+        // nothing is pending before the first push
+        QVERIFY(!subLatest->peekNext().has_value());
+
+        for (size_t i = 1; i <= 20; ++i) {
+            Frame frame;
+            frame.index = i;
+            frame.mat = cv::Mat(4, 4, CV_8UC1);
+            stream->push(std::move(frame));
+
+            // a mailbox never holds more than a single item
+            QCOMPARE(subLatest->approxPendingCount(), size_t(1));
+        }
+
+        // only the newest item is kept, all others were replaced
+        QCOMPARE(subLatest->enqueuedCount(), uint64_t(20));
+        QCOMPARE(subLatest->droppedCount(), uint64_t(19));
+        QCOMPARE(subLatest->next()->index, uint64_t(20));
+        QVERIFY(!subLatest->hasPending());
+        QVERIFY(!subLatest->peekNext().has_value());
+
+        // regular subscriptions of the same stream are not affected
+        QCOMPARE(subQueued->approxPendingCount(), size_t(20));
+
+        // a consumer blocked on the mailbox is woken by new data, and by the end of the stream
+        std::vector<uint64_t> received;
+        std::thread consumer([&]() {
+            while (true) {
+                auto data = subLatest->next();
+                if (!data.has_value())
+                    break;
+                received.push_back(data->index);
+            }
+        });
+        for (size_t i = 21; i <= 1000; ++i) {
+            Frame frame;
+            frame.index = i;
+            stream->push(std::move(frame));
+        }
+        stream->terminate();
+        consumer.join();
+
+        QVERIFY(std::is_sorted(received.begin(), received.end()));
+        QVERIFY(std::adjacent_find(received.begin(), received.end()) == received.end());
+
+        // the end of the stream does not replace the last item
+        QVERIFY(!received.empty());
+        QCOMPARE(received.back(), uint64_t(1000));
+    }
+
+    void runLatencyTracing()
+    {
+        auto stream = std::make_shared<DataStream<Frame>>();
+        auto subTraced = stream->subscribe();
+        auto subPlain = stream->subscribe();
+        subTraced->setLatencyTracing(true);
+        stream->start();
+
+        for (size_t i = 1; i <= 10; ++i) {
+            Frame frame;
+            frame.index = i;
+            stream->push(frame);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        QCOMPARE(subTraced->next()->index, uint64_t(1));
+        std::vector<Frame> batch;
+        QCOMPARE(subTraced->drainInto(batch), size_t(9));
+        QCOMPARE(subPlain->drainInto(batch), size_t(10));
+
+        // every item of the traced subscription waited for at least 2 msec,
+        // percentiles are only accurate to the power-of-two histogram bucket
+        const auto stats = subTraced->queueLatencyStats();
+        QCOMPARE(stats.count, uint64_t(10));
+        QVERIFY(stats.max >= std::chrono::milliseconds(2));
+        QVERIFY(stats.p50 >= std::chrono::milliseconds(1));
+        QVERIFY(stats.p50 <= stats.p99);
+        QVERIFY(stats.p99 <= stats.max);
+        QCOMPARE(subPlain->queueLatencyStats().count, uint64_t(0));
+
+        // restarting the stream resets the statistics, but keeps tracing enabled
+        stream->stop();
+        stream->start();
+        QCOMPARE(subTraced->queueLatencyStats().count, uint64_t(0));
+        QVERIFY(subTraced->latencyTracingEnabled());
+        stream->terminate();
+    }
+
+    void runFramePool()
+    {
+        auto pool = std::make_unique<FrameBufferPool>(QStringLiteral("test"), 2);
+        pool->reserve(480, 640, CV_8UC3, 1);
+        QCOMPARE(pool->stats().buffersIdle, size_t(1));
+
+        // a released frame hands its buffer back for the next one
+        auto a = pool->acquire(480, 640, CV_8UC3);
+        const auto aData = a.data;
+        Frame frame(a, 1, microseconds_t(0));
+        a.release();
+        QCOMPARE(pool->stats().buffersIdle, size_t(0));
+        frame.mat.release();
+        QCOMPARE(pool->stats().buffersIdle, size_t(1));
+
+        auto b = pool->acquire(480, 640, CV_8UC3);
+        QCOMPARE(b.data, aData);
+        auto c = pool->acquire(480, 640, CV_8UC3);
+        auto d = pool->acquire(480, 640, CV_8UC3);
+
+        auto stats = pool->stats();
+        QCOMPARE(stats.hits, uint64_t(2));
+        QCOMPARE(stats.misses, uint64_t(2));
+        QCOMPARE(stats.buffersInUse, size_t(3));
+
+        // only two buffers per size class are kept around
+        b.release();
+        c.release();
+        d.release();
+        stats = pool->stats();
+        QCOMPARE(stats.buffersIdle, size_t(2));
+        QCOMPARE(stats.evictions, uint64_t(1));
+
+        // frames may outlive their pool
+        auto e = pool->acquire(480, 640, CV_8UC3);
+        pool.reset();
+        e.setTo(cv::Scalar(1, 2, 3));
+        e.release();
+    }
 };
 
 QTEST_MAIN(TestStreamPerf)
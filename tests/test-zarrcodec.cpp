@@ -0,0 +1,377 @@
+#include <QDebug>
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <blosc.h>
+#include <cmath>
+#include <cstring>
+#include <expected>
+#include <limits>
+#include <lz4.h>
+#include <random>
+#include <vector>
+#include <zstd.h>
+
+#include "zarrv3writer.h"
+
+using ByteArray = std::vector<std::byte>;
+
+static const QList<ZarrV3Array::DType> ALL_DTYPES = {
+    ZarrV3Array::DType::Int32,
+    ZarrV3Array::DType::UInt16,
+    ZarrV3Array::DType::UInt32,
+    ZarrV3Array::DType::UInt64,
+    ZarrV3Array::DType::Float32,
+    ZarrV3Array::DType::Float64,
+};
+
+static const QList<ZarrCodecConfig::Compressor> ALL_COMPRESSORS = {
+    ZarrCodecConfig::Compressor::Zstd,
+    ZarrCodecConfig::Compressor::Lz4,
+    ZarrCodecConfig::Compressor::BloscLz4,
+    ZarrCodecConfig::Compressor::BloscZstd,
+};
+
+static bool isFloatDType(ZarrV3Array::DType dtype)
+{
+    return dtype == ZarrV3Array::DType::Float32 || dtype == ZarrV3Array::DType::Float64;
+}
+
+template<typename T>
+static void fillTestValues(ByteArray &data, int64_t rows, int nCols)
+{
+    std::mt19937 gen(42);
+    std::normal_distribution<double> noise(0.0, 4.0);
+
+    auto *values = reinterpret_cast<T *>(data.data());
+    for (int c = 0; c < nCols; ++c) {
+        double level = 1000.0 * (c + 1);
+        for (int64_t r = 0; r < rows; ++r) {
+            T value;
+            if constexpr (std::is_floating_point_v<T>) {
+                value = static_cast<T>(std::sin(r * 0.01 * (c + 1)) * 250.0 + noise(gen));
+            } else if constexpr (sizeof(T) == 8) {
+                // timestamps: monotonic, with jitter
+                value = static_cast<T>(r * 1000 + (r % 7) * 3);
+            } else {
+                // a random walk with occasional jumps, which makes the deltas wrap around
+                level += noise(gen);
+                if (r % 97 == 0)
+                    level = -level;
+                value = static_cast<T>(static_cast<int64_t>(level));
+            }
+            values[r * nCols + c] = value;
+        }
+    }
+
+    // values that must survive the codec chain bit-exactly
+    if constexpr (std::is_floating_point_v<T>) {
+        values[0] = std::numeric_limits<T>::quiet_NaN();
+        values[1] = std::numeric_limits<T>::infinity();
+        values[2] = -std::numeric_limits<T>::infinity();
+        values[3] = static_cast<T>(-0.0);
+        values[4] = std::numeric_limits<T>::denorm_min();
+    } else {
+        values[0] = std::numeric_limits<T>::max();
+        values[1] = std::numeric_limits<T>::min();
+    }
+}
+
+static ByteArray makeTestData(ZarrV3Array::DType dtype, int64_t rows, int nCols)
+{
+    ByteArray data(static_cast<size_t>(rows) * nCols * zarrDTypeSize(dtype));
+    switch (dtype) {
+    case ZarrV3Array::DType::Int32:
+        fillTestValues<int32_t>(data, rows, nCols);
+        break;
+    case ZarrV3Array::DType::UInt16:
+        fillTestValues<uint16_t>(data, rows, nCols);
+        break;
+    case ZarrV3Array::DType::UInt32:
+        fillTestValues<uint32_t>(data, rows, nCols);
+        break;
+    case ZarrV3Array::DType::UInt64:
+        fillTestValues<uint64_t>(data, rows, nCols);
+        break;
+    case ZarrV3Array::DType::Float32:
+        fillTestValues<float>(data, rows, nCols);
+        break;
+    case ZarrV3Array::DType::Float64:
+        fillTestValues<double>(data, rows, nCols);
+        break;
+    }
+
+    return data;
+}
+
+/**
+ * Undo "numcodecs.delta" on a flattened array: a running sum that wraps like NumPy's.
+ */
+template<typename U>
+static void deltaDecode(ByteArray &data)
+{
+    auto *values = reinterpret_cast<U *>(data.data());
+    const size_t count = data.size() / sizeof(U);
+    U prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        prev = static_cast<U>(prev + values[i]);
+        values[i] = prev;
+    }
+}
+
+/**
+ * Decode one inner chunk by applying the inverse of each codec in @p codecs,
+ * exactly as declared in zarr.json, from the last to the first.
+ */
+static std::expected<ByteArray, QString> decodeChunk(
+    const QJsonArray &codecs,
+    ByteArray data,
+    int64_t rows,
+    int nCols,
+    int typeSize)
+{
+    const size_t chunkBytes = static_cast<size_t>(rows) * nCols * typeSize;
+
+    for (auto ci = codecs.size() - 1; ci >= 0; --ci) {
+        const auto codec = codecs.at(ci).toObject();
+        const auto name = codec.value("name").toString();
+        const auto conf = codec.value("configuration").toObject();
+
+        ByteArray out;
+        if (name == "zstd") {
+            out.resize(chunkBytes);
+            const auto size = ZSTD_decompress(out.data(), out.size(), data.data(), data.size());
+            if (ZSTD_isError(size) || size != chunkBytes)
+                return std::unexpected(QStringLiteral("zstd: %1").arg(QString::fromUtf8(ZSTD_getErrorName(size))));
+        } else if (name == "numcodecs.lz4") {
+            uint32_t size = 0;
+            if (data.size() < sizeof(size))
+                return std::unexpected(QStringLiteral("lz4: truncated header"));
+            std::memcpy(&size, data.data(), sizeof(size));
+            if (size != chunkBytes)
+                return std::unexpected(QStringLiteral("lz4: unexpected size %1").arg(size));
+            out.resize(size);
+            const int dsize = LZ4_decompress_safe(
+                reinterpret_cast<const char *>(data.data() + sizeof(size)),
+                reinterpret_cast<char *>(out.data()),
+                static_cast<int>(data.size() - sizeof(size)),
+                static_cast<int>(out.size()));
+            if (dsize != static_cast<int>(size))
+                return std::unexpected(QStringLiteral("lz4: decompression failed (%1)").arg(dsize));
+        } else if (name == "blosc") {
+            if (conf.value("typesize").toInt() != typeSize)
+                return std::unexpected(QStringLiteral("blosc: wrong typesize"));
+            out.resize(chunkBytes);
+            const int dsize = blosc_decompress_ctx(data.data(), out.data(), out.size(), 1);
+            if (dsize != static_cast<int>(chunkBytes))
+                return std::unexpected(QStringLiteral("blosc: decompression failed (%1)").arg(dsize));
+        } else if (name == "numcodecs.shuffle") {
+            const auto elementSize = static_cast<size_t>(conf.value("elementsize").toInt());
+            const size_t count = data.size() / elementSize;
+            out = data;
+            for (size_t i = 0; i < count; ++i)
+                for (size_t b = 0; b < elementSize; ++b)
+                    out[i * elementSize + b] = data[b * count + i];
+        } else if (name == "bytes") {
+            if (conf.value("endian").toString() != "little")
+                return std::unexpected(QStringLiteral("bytes: unexpected endianness"));
+            out = std::move(data);
+        } else if (name == "numcodecs.delta") {
+            const auto dtype = conf.value("dtype").toString();
+            out = std::move(data);
+            if (dtype == "<u2")
+                deltaDecode<uint16_t>(out);
+            else if (dtype == "<i4" || dtype == "<u4")
+                deltaDecode<uint32_t>(out);
+            else if (dtype == "<u8")
+                deltaDecode<uint64_t>(out);
+            else
+                return std::unexpected(QStringLiteral("delta: unsupported dtype %1").arg(dtype));
+        } else if (name == "transpose") {
+            // the encoded chunk has the shape [nCols, rows]
+            if (conf.value("order").toArray() != QJsonArray{1, 0})
+                return std::unexpected(QStringLiteral("transpose: unexpected order"));
+            out.resize(data.size());
+            for (int64_t r = 0; r < rows; ++r)
+                for (int c = 0; c < nCols; ++c)
+                    std::memcpy(
+                        out.data() + (r * nCols + c) * typeSize,
+                        data.data() + (c * rows + r) * typeSize,
+                        static_cast<size_t>(typeSize));
+        } else {
+            return std::unexpected(QStringLiteral("unknown codec: %1").arg(name));
+        }
+
+        data = std::move(out);
+    }
+
+    if (data.size() != chunkBytes)
+        return std::unexpected(
+            QStringLiteral("decoded chunk has %1 bytes, expected %2").arg(data.size()).arg(chunkBytes));
+    return data;
+}
+
+static QByteArray readFileData(const QString &fname)
+{
+    QFile f(fname);
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+    return f.readAll();
+}
+
+class TestZarrCodec : public QObject
+{
+    Q_OBJECT
+private:
+    /**
+     * Write @p rows rows through a ZarrV3Array, then read the store back using only
+     * its zarr.json and shard index, and check that we get the original bytes.
+     */
+    void verifyRoundTrip(
+        ZarrV3Array::DType dtype,
+        int nCols,
+        const ZarrCodecConfig &config,
+        const std::shared_ptr<ZarrCompressionPool> &pool = nullptr)
+    {
+        const int64_t chunkRows = 256;
+        const int64_t rows = chunkRows * 5 + 77; // the last chunk is padded
+        const int typeSize = zarrDTypeSize(dtype);
+        const auto input = makeTestData(dtype, rows, nCols);
+        const auto caseName = QStringLiteral("dtype %1, %2 cols, %3, shuffle %4, delta %5")
+                                  .arg(static_cast<int>(dtype))
+                                  .arg(nCols)
+                                  .arg(zarrCompressorToString(config.compressor))
+                                  .arg(config.shuffle ? QStringLiteral("on") : QStringLiteral("off"))
+                                  .arg(config.delta ? QStringLiteral("on") : QStringLiteral("off"));
+
+        QTemporaryDir tmpDir;
+        QVERIFY(tmpDir.isValid());
+        {
+            ZarrV3Array array(tmpDir.path(), QStringLiteral("data"), dtype, chunkRows, nCols);
+            array.setCodecConfig(config);
+            array.setCompressionPool(pool);
+            const auto res = array.open();
+            QVERIFY2(res.has_value(), qPrintable(caseName + ": " + res.error()));
+
+            // append in uneven pieces, so chunks are assembled from several calls
+            const size_t rowBytes = static_cast<size_t>(nCols) * typeSize;
+            int64_t written = 0;
+            while (written < rows) {
+                const auto n = std::min<int64_t>(rows - written, 100);
+                array.appendBytes(input.data() + written * rowBytes, n);
+                written += n;
+            }
+            QVERIFY2(array.finalize(), qPrintable(caseName + ": " + array.errorMessage()));
+            QCOMPARE(array.totalRows(), rows);
+        }
+
+        const auto arrayDir = QDir(tmpDir.path()).filePath("data");
+        const auto meta = QJsonDocument::fromJson(readFileData(QDir(arrayDir).filePath("zarr.json"))).object();
+        QCOMPARE(meta.value("shape").toArray().at(0).toInteger(), static_cast<qint64>(rows));
+        const auto shardConf = meta.value("codecs").toArray().at(0).toObject().value("configuration").toObject();
+        const auto innerCodecs = shardConf.value("codecs").toArray();
+        QCOMPARE(shardConf.value("chunk_shape").toArray().at(0).toInteger(), static_cast<qint64>(chunkRows));
+
+        const auto shardData = readFileData(QDir(arrayDir).filePath(nCols == 1 ? "c/0" : "c/0/0"));
+        const auto *shardBegin = reinterpret_cast<const std::byte *>(shardData.constData());
+        const ByteArray shard(shardBegin, shardBegin + shardData.size());
+        const size_t chunkCount = (rows + chunkRows - 1) / chunkRows;
+        const size_t indexBytes = chunkCount * 2 * sizeof(uint64_t);
+        QVERIFY2(shard.size() > indexBytes, qPrintable(caseName));
+        const auto *index = shard.data() + shard.size() - indexBytes;
+
+        const size_t chunkBytes = static_cast<size_t>(chunkRows) * nCols * typeSize;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            uint64_t offset, length;
+            std::memcpy(&offset, index + i * 16, sizeof(offset));
+            std::memcpy(&length, index + i * 16 + 8, sizeof(length));
+            QVERIFY2(offset + length <= shard.size() - indexBytes, qPrintable(caseName));
+
+            const auto decoded = decodeChunk(
+                innerCodecs,
+                ByteArray(shard.begin() + offset, shard.begin() + offset + length),
+                chunkRows,
+                nCols,
+                typeSize);
+            QVERIFY2(decoded.has_value(), qPrintable(caseName + ": " + decoded.error()));
+
+            // compare the real rows, and check that the padding of the last chunk is zero
+            const size_t begin = i * chunkBytes;
+            const size_t validBytes = std::min(chunkBytes, input.size() - begin);
+            QVERIFY2(
+                std::memcmp(decoded->data(), input.data() + begin, validBytes) == 0,
+                qPrintable(caseName + QStringLiteral(": chunk %1 differs").arg(i)));
+            QVERIFY2(
+                std::all_of(
+                    decoded->begin() + validBytes,
+                    decoded->end(),
+                    [](std::byte b) {
+                        return b == std::byte{0};
+                    }),
+                qPrintable(caseName + QStringLiteral(": padding of chunk %1 is not zero").arg(i)));
+        }
+    }
+
+private slots:
+    void testCodecRoundTrip()
+    {
+        for (const auto dtype : ALL_DTYPES) {
+            for (const auto compressor : ALL_COMPRESSORS) {
+                for (const bool shuffle : {false, true}) {
+                    for (const bool delta : {false, true}) {
+                        if (delta && isFloatDType(dtype))
+                            continue;
+
+                        ZarrCodecConfig config;
+                        config.compressor = compressor;
+                        config.shuffle = shuffle;
+                        config.delta = delta;
+                        for (const int nCols : {1, 3}) {
+                            verifyRoundTrip(dtype, nCols, config);
+                            if (QTest::currentTestFailed())
+                                return;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void testWriterFloatData()
+    {
+        // float signals as the writer module stores them, with many channels per row
+        ZarrCodecConfig config;
+        verifyRoundTrip(ZarrV3Array::DType::Float32, 64, config);
+
+        config.compressor = ZarrCodecConfig::Compressor::BloscZstd;
+        config.shuffle = true;
+        config.level = 9;
+        verifyRoundTrip(ZarrV3Array::DType::Float32, 64, config);
+
+        // delta filtering of floats is refused
+        config.delta = true;
+        QTemporaryDir tmpDir;
+        ZarrV3Array array(tmpDir.path(), QStringLiteral("data"), ZarrV3Array::DType::Float32, 256, 4);
+        array.setCodecConfig(config);
+        QVERIFY(!array.open().has_value());
+    }
+
+    void testCompressionPool()
+    {
+        // chunks compressed on the shared pool must end up in the shard in order
+        auto pool = std::make_shared<ZarrCompressionPool>(3);
+        for (const auto compressor : ALL_COMPRESSORS) {
+            ZarrCodecConfig config;
+            config.compressor = compressor;
+            config.shuffle = true;
+            config.delta = true;
+            verifyRoundTrip(ZarrV3Array::DType::Int32, 8, config, pool);
+            verifyRoundTrip(ZarrV3Array::DType::UInt64, 1, config, pool);
+        }
+    }
+};
+
+QTEST_MAIN(TestZarrCodec)
+#include "test-zarrcodec.moc"
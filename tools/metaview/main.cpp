@@ -24,6 +24,7 @@
 #include <iostream>
 
 #include "readtsync.h"
+#include "readperfprofile.h"
 
 int main(int argc, char *argv[])
 {
@@ -43,11 +44,20 @@ int main(int argc, char *argv[])
         QStringLiteral("file"));
     parser.addOption(tsyncOption);
 
+    QCommandLineOption perfProfileOption(
+        QStringLiteral("perf-profile"),
+        QStringLiteral("Read data from a performance profile (.sprof) file"),
+        QStringLiteral("file"));
+    parser.addOption(perfProfileOption);
+
     parser.process(a);
 
     QString tsyncFile = parser.value(tsyncOption);
+    QString perfProfileFile = parser.value(perfProfileOption);
     if (!tsyncFile.isEmpty())
         return displayTSyncMetadata(tsyncFile);
+    else if (!perfProfileFile.isEmpty())
+        return displayPerfProfile(perfProfileFile);
     else {
         std::cout << parser.helpText().toStdString() << std::endl;
         return 0;
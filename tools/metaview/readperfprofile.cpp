@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 3
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "readperfprofile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include "datactl/priv/perfprofile.h"
+
+using namespace Syntalos;
+
+int displayPerfProfile(const QString &fname)
+{
+    auto reader = std::make_unique<PerfProfileReader>();
+    if (!reader->open(fname.toStdString())) {
+        std::cerr << "Unable to open file '" << fname.toStdString() << "': " << reader->lastError() << std::endl;
+        return 1;
+    }
+
+    const auto series = reader->series();
+    const auto times = reader->times();
+    const auto values = reader->values();
+
+    std::cout << "File: "
+              << "PerfProfile"
+              << "\n"
+              << "CollectionID: " << reader->collectionId().toHex() << "\n"
+              << "CreationTimestampUnix: " << reader->creationTime() << "\n"
+              << "Interval: " << reader->interval().count() << " ms\n"
+              << "Samples: " << times.size() << "\n";
+    if (reader->truncated())
+        std::cout << "Truncated: yes\n";
+
+    // summarize each series, ignoring samples without a value
+    std::cout << "Series:\n";
+    for (size_t i = 0; i < series.size(); i++) {
+        double sum = 0;
+        float max = NAN;
+        size_t count = 0;
+        for (const auto &sample : values) {
+            if (std::isnan(sample[i]))
+                continue;
+            sum += sample[i];
+            max = std::isnan(max) ? sample[i] : std::max(max, sample[i]);
+            count++;
+        }
+
+        std::cout << "    " << perfSeriesKindToString(series[i].kind) << " (" << perfSeriesKindUnit(series[i].kind)
+                  << ") " << series[i].source << ": ";
+        if (count == 0)
+            std::cout << "no data\n";
+        else
+            std::cout << "mean " << sum / static_cast<double>(count) << ", max " << max << "\n";
+    }
+    std::cout << std::endl;
+
+    std::cout << "time";
+    for (const auto &s : series)
+        std::cout << ";" << perfSeriesKindToString(s.kind) << ":" << s.source;
+    std::cout << "\n";
+    for (size_t i = 0; i < times.size(); i++) {
+        std::cout << times[i].count();
+        for (const auto v : values[i])
+            std::cout << ";" << v;
+        std::cout << "\n";
+    }
+
+    return 0;
+}